@@ -0,0 +1,514 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+//
+// afdview-analyze prints sockets from columnar snapshots on systems other than Windows, in
+// the same text format as AfdSocketView --analyze. Snapshots are mapped into memory, and each
+// file is processed by a pool of threads while the results still print in the command-line
+// order: the file whose turn it is streams to stdout, and only files that finish early are
+// held in memory.
+//
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "snapshot_report.h"
+
+// The difference between the Windows epoch (1601) and the Unix epoch (1970), in seconds
+#define H2_UNIX_EPOCH_OFFSET 11644473600LL
+
+typedef struct _H2_ANALYZE_ARGUMENTS
+{
+    H2_ULONG64 ProcessId;
+    const char* ProcessFilter;
+    H2_ULONG64 HandleValue;
+    H2_BOOLEAN Verbose;
+    H2_ULONG NumberOfThreads;
+    char** FileNames;
+    H2_ULONG NumberOfFiles;
+} H2_ANALYZE_ARGUMENTS, *PH2_ANALYZE_ARGUMENTS;
+
+typedef struct _H2_ANALYZE_FILE
+{
+    const char* FileName;
+    char* Output; // Text collected before the file's turn
+    size_t OutputLength;
+    size_t OutputCapacity;
+    H2_BOOLEAN Direct; // Writes straight to stdout
+    H2_BOOLEAN Failed;
+    H2_BOOLEAN Completed; // Protected by the context lock
+} H2_ANALYZE_FILE, *PH2_ANALYZE_FILE;
+
+typedef struct _H2_ANALYZE_CONTEXT
+{
+    PH2_ANALYZE_ARGUMENTS Arguments;
+    PH2_ANALYZE_FILE Files;
+    atomic_uint NextFile; // The next file for a worker to take
+    atomic_uint NextToPrint; // The index of the file that owns stdout
+    pthread_mutex_t Lock;
+    pthread_cond_t FileCompleted;
+} H2_ANALYZE_CONTEXT, *PH2_ANALYZE_CONTEXT;
+
+typedef struct _H2_ANALYZE_TURN
+{
+    PH2_ANALYZE_CONTEXT Context;
+    H2_ULONG FileIndex;
+} H2_ANALYZE_TURN, *PH2_ANALYZE_TURN;
+
+/**
+  * \brief Matches a name against a pattern with * and ? wildcards, ignoring case.
+  *
+  * \param[in] Context The zero-terminated pattern.
+  * \param[in] Name The name.
+  * \param[in] Length The number of characters in the name.
+  *
+  * \return Whether the name matches.
+  */
+H2_BOOLEAN H2AnalyzeMatchName(
+    _In_ void* Context,
+    _In_reads_(Length) const H2_CHAR* Name,
+    _In_ size_t Length
+)
+{
+    const char* pattern = Context;
+    const char* starPattern = NULL;
+    size_t starName = 0;
+    size_t i = 0;
+
+    while (i < Length)
+    {
+        if (*pattern == '*')
+        {
+            // Remember the position to retry with a longer match
+            starPattern = ++pattern;
+            starName = i;
+        }
+        else if (*pattern && (*pattern == '?' || tolower((unsigned char)*pattern) == tolower((unsigned char)Name[i])))
+        {
+            pattern++;
+            i++;
+        }
+        else if (starPattern)
+        {
+            pattern = starPattern;
+            i = ++starName;
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    while (*pattern == '*')
+        pattern++;
+
+    return *pattern == '\0';
+}
+
+/**
+  * \brief Sends text either to stdout or to the buffer of the file.
+  *
+  * \param[in] Printer The printer of the file.
+  * \param[in] Text The text.
+  * \param[in] Length The number of characters in the text.
+  */
+void H2AnalyzeWrite(
+    _In_ PH2_PRINTER Printer,
+    _In_reads_(Length) const H2_CHAR* Text,
+    _In_ size_t Length
+)
+{
+    PH2_ANALYZE_FILE file = Printer->Context;
+
+    if (file->Direct)
+    {
+        fwrite(Text, 1, Length, stdout);
+        return;
+    }
+
+    if (file->OutputLength + Length > file->OutputCapacity)
+    {
+        size_t capacity = file->OutputCapacity ? file->OutputCapacity : 0x10000;
+        char* output;
+
+        while (capacity < file->OutputLength + Length)
+            capacity *= 2;
+
+        output = realloc(file->Output, capacity);
+
+        // Drop the text rather than abort the rest of the files
+        if (!output)
+            return;
+
+        file->Output = output;
+        file->OutputCapacity = capacity;
+    }
+
+    memcpy(file->Output + file->OutputLength, Text, Length);
+    file->OutputLength += Length;
+}
+
+/**
+  * \brief Prints and releases the text a file collected.
+  *
+  * \param[in] File The file.
+  */
+void H2AnalyzeFlushFile(
+    _Inout_ PH2_ANALYZE_FILE File
+)
+{
+    if (File->OutputLength)
+        fwrite(File->Output, 1, File->OutputLength, stdout);
+
+    free(File->Output);
+    File->Output = NULL;
+    File->OutputLength = 0;
+    File->OutputCapacity = 0;
+}
+
+/**
+  * \brief Switches a file to stdout once all files before it are printed.
+  *
+  * \param[in] Context The file and the analysis context.
+  */
+void H2AnalyzeTakeTurn(
+    _In_ void* Context
+)
+{
+    PH2_ANALYZE_TURN turn = Context;
+    PH2_ANALYZE_FILE file = &turn->Context->Files[turn->FileIndex];
+
+    if (file->Direct || atomic_load_explicit(&turn->Context->NextToPrint, memory_order_acquire) != turn->FileIndex)
+        return;
+
+    // Print what the file collected while waiting and continue without buffering
+    H2AnalyzeFlushFile(file);
+    file->Direct = TRUE;
+}
+
+/**
+  * \brief Maps one snapshot and formats its sockets.
+  *
+  * \param[in] Context The analysis context.
+  * \param[in] FileIndex The index of the file.
+  */
+void H2AnalyzeFile(
+    _In_ PH2_ANALYZE_CONTEXT Context,
+    _In_ H2_ULONG FileIndex
+)
+{
+    H2_STATUS status;
+    PH2_ANALYZE_ARGUMENTS arguments = Context->Arguments;
+    PH2_ANALYZE_FILE file = &Context->Files[FileIndex];
+    H2_ANALYZE_TURN turn = { Context, FileIndex };
+    H2_REPORT_FILTER filter = { 0 };
+    H2_PRINTER printer = { 0 };
+    H2_COLUMNAR_READER reader;
+    PH2_AFD_SOCKET_RECORD record;
+    struct stat fileInfo;
+    struct tm localTime;
+    time_t seconds;
+    void* view = NULL;
+    int fd;
+
+    printer.Write = H2AnalyzeWrite;
+    printer.Context = file;
+    printer.Raw = arguments->Verbose;
+
+    // Collect the output to print it in order later, unless the file is already next
+    H2AnalyzeTakeTurn(&turn);
+
+    fd = open(file->FileName, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &fileInfo) != 0)
+        goto OPEN_FAILED;
+
+    // Empty files cannot be mapped but are still not columnar files
+    view = fileInfo.st_size ? mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+
+    if (view == MAP_FAILED)
+        goto OPEN_FAILED;
+
+    close(fd);
+    fd = -1;
+
+    status = H2ColumnarOpenView(view ? view : "", (size_t)fileInfo.st_size, &reader);
+
+    if (!H2_SUCCESS(status))
+    {
+        H2WriteString(&printer, "Unable to open the snapshot ");
+        H2WriteString(&printer, file->FileName);
+        H2WriteString(&printer, ": 0x");
+        H2WriteHexadecimal(&printer, (H2_ULONG)status, 8);
+        H2WriteString(&printer, "\n\n");
+        file->Failed = TRUE;
+        goto CLEANUP;
+    }
+
+    // Elapsed times count from the moment of the snapshot, in the time zone of that moment
+    seconds = (time_t)(reader.Timestamp / TICKS_PER_SEC - H2_UNIX_EPOCH_OFFSET);
+
+    if (localtime_r(&seconds, &localTime))
+        printer.TimeZoneBias = -(H2_LONG64)localTime.tm_gmtoff * (H2_LONG64)TICKS_PER_SEC;
+
+    printer.SystemTime = reader.Timestamp;
+    H2ReportSnapshotHeader(&printer, file->FileName, &reader);
+
+    filter.ProcessId = arguments->ProcessId;
+    filter.MatchName = H2AnalyzeMatchName;
+    filter.MatchContext = (void*)arguments->ProcessFilter;
+    filter.HandleValue = arguments->HandleValue;
+    filter.OnRow = H2AnalyzeTakeTurn;
+    filter.RowContext = &turn;
+
+    // The record is too large for the stack of a worker
+    record = malloc(sizeof(H2_AFD_SOCKET_RECORD));
+
+    if (record)
+    {
+        status = H2ReportSnapshot(&printer, &filter, &reader, record);
+        free(record);
+    }
+    else
+    {
+        status = H2_STATUS_NO_MEMORY;
+    }
+
+    if (!H2_SUCCESS(status))
+    {
+        H2WriteString(&printer, "Unable to read the snapshot: 0x");
+        H2WriteHexadecimal(&printer, (H2_ULONG)status, 8);
+        H2WriteString(&printer, "\n\n");
+        file->Failed = TRUE;
+    }
+
+    H2ColumnarCloseView(&reader);
+    goto CLEANUP;
+
+OPEN_FAILED:
+    H2WriteString(&printer, "Unable to open the snapshot ");
+    H2WriteString(&printer, file->FileName);
+    H2WriteString(&printer, ": ");
+    H2WriteString(&printer, strerror(errno));
+    H2WriteString(&printer, "\n\n");
+    file->Failed = TRUE;
+
+CLEANUP:
+    if (fd >= 0)
+        close(fd);
+
+    if (view && view != MAP_FAILED)
+        munmap(view, (size_t)fileInfo.st_size);
+
+    // Text must reach stdout before the next file takes over
+    if (file->Direct)
+        fflush(stdout);
+
+    pthread_mutex_lock(&Context->Lock);
+    file->Completed = TRUE;
+    pthread_cond_broadcast(&Context->FileCompleted);
+    pthread_mutex_unlock(&Context->Lock);
+}
+
+/**
+  * \brief Processes files until none are left.
+  *
+  * \param[in] Parameter The analysis context.
+  *
+  * \return NULL.
+  */
+void* H2AnalyzeWorker(
+    _In_ void* Parameter
+)
+{
+    PH2_ANALYZE_CONTEXT context = Parameter;
+    unsigned int index;
+
+    while ((index = atomic_fetch_add(&context->NextFile, 1)) < context->Arguments->NumberOfFiles)
+        H2AnalyzeFile(context, index);
+
+    return NULL;
+}
+
+/**
+  * \brief Parses a decimal or a 0x-prefixed hexadecimal number.
+  *
+  * \return Whether the whole string is a number.
+  */
+H2_BOOLEAN H2AnalyzeParseInteger(
+    _In_ const char* String,
+    _Out_ H2_ULONG64* Value
+)
+{
+    char* end;
+
+    errno = 0;
+    *Value = strtoull(String, &end, 0);
+
+    return *String && !*end && errno == 0 && *String != '-';
+}
+
+/**
+  * \brief Parses the command line.
+  *
+  * \return Whether the arguments are valid.
+  */
+H2_BOOLEAN H2AnalyzeParseArguments(
+    _In_ int argc,
+    _In_ char* argv[],
+    _Out_ PH2_ANALYZE_ARGUMENTS Arguments
+)
+{
+    H2_ULONG64 value;
+
+    memset(Arguments, 0, sizeof(*Arguments));
+    Arguments->NumberOfThreads = 1;
+    Arguments->FileNames = argv;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-p") == 0)
+        {
+            if (++i >= argc)
+                return FALSE;
+
+            // Either a PID or an image name filter
+            if (H2AnalyzeParseInteger(argv[i], &value))
+                Arguments->ProcessId = value;
+            else
+                Arguments->ProcessFilter = argv[i];
+
+            if (!Arguments->ProcessId && !Arguments->ProcessFilter)
+                return FALSE;
+        }
+        else if (strcmp(argv[i], "-h") == 0)
+        {
+            // We need a valid value
+            if (++i >= argc || !H2AnalyzeParseInteger(argv[i], &Arguments->HandleValue) || !Arguments->HandleValue)
+                return FALSE;
+        }
+        else if (strcmp(argv[i], "-v") == 0)
+        {
+            Arguments->Verbose = TRUE;
+        }
+        else if (strcmp(argv[i], "-j") == 0)
+        {
+            if (++i >= argc || !H2AnalyzeParseInteger(argv[i], &value) || value == 0 || value > 0xFFFF)
+                return FALSE;
+
+            Arguments->NumberOfThreads = (H2_ULONG)value;
+        }
+        else if (argv[i][0] == '-')
+        {
+            // Unrecognized parameter
+            return FALSE;
+        }
+        else
+        {
+            Arguments->FileNames[Arguments->NumberOfFiles++] = argv[i];
+        }
+    }
+
+    return (Arguments->ProcessId || Arguments->ProcessFilter) && Arguments->NumberOfFiles;
+}
+
+int main(
+    _In_ int argc,
+    _In_ char* argv[]
+)
+{
+    H2_ANALYZE_ARGUMENTS arguments;
+    H2_ANALYZE_CONTEXT context = { 0 };
+    pthread_t* threads;
+    H2_ULONG numberOfThreads;
+    H2_ULONG started = 0;
+    int exitCode = 0;
+
+    if (!H2AnalyzeParseArguments(argc, argv, &arguments))
+    {
+        fprintf(stderr,
+            "Usage: afdview-analyze -p [PID or image name] [-h Handle] [-v] [-j Threads] File [File ...]\n"
+            "   -p: select processes by PID or by image name (wildcards * and ? are allowed)\n"
+            "   -h: print all properties of a specific handle\n"
+            "   -v: use raw names and values\n"
+            "   -j: the number of files to process at the same time\n"
+            "Prints sockets from columnar snapshots in the same format as AfdSocketView --analyze.\n"
+        );
+        return 2;
+    }
+
+    context.Arguments = &arguments;
+    context.Files = calloc(arguments.NumberOfFiles, sizeof(H2_ANALYZE_FILE));
+    numberOfThreads = arguments.NumberOfThreads < arguments.NumberOfFiles ? arguments.NumberOfThreads : arguments.NumberOfFiles;
+    threads = calloc(numberOfThreads, sizeof(pthread_t));
+
+    if (!context.Files || !threads)
+    {
+        fputs("Not enough memory\n", stderr);
+        return 1;
+    }
+
+    for (H2_ULONG i = 0; i < arguments.NumberOfFiles; i++)
+        context.Files[i].FileName = arguments.FileNames[i];
+
+    pthread_mutex_init(&context.Lock, NULL);
+    pthread_cond_init(&context.FileCompleted, NULL);
+
+    // With one thread, the files are processed below instead
+    if (numberOfThreads > 1)
+        for (; started < numberOfThreads; started++)
+            if (pthread_create(&threads[started], NULL, H2AnalyzeWorker, &context) != 0)
+                break;
+
+    // Print files in the command-line order; the file at the head writes to stdout itself
+    for (H2_ULONG i = 0; i < arguments.NumberOfFiles; i++)
+    {
+        // Without workers, each file streams to stdout on its turn
+        if (!started)
+            H2AnalyzeFile(&context, i);
+
+        pthread_mutex_lock(&context.Lock);
+
+        while (!context.Files[i].Completed)
+            pthread_cond_wait(&context.FileCompleted, &context.Lock);
+
+        pthread_mutex_unlock(&context.Lock);
+
+        if (!context.Files[i].Direct)
+        {
+            // The file completed before its turn
+            H2AnalyzeFlushFile(&context.Files[i]);
+            fflush(stdout);
+        }
+
+        if (context.Files[i].Failed)
+            exitCode = 1;
+
+        atomic_store_explicit(&context.NextToPrint, i + 1, memory_order_release);
+    }
+
+    for (H2_ULONG i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    pthread_cond_destroy(&context.FileCompleted);
+    pthread_mutex_destroy(&context.Lock);
+    free(threads);
+    free(context.Files);
+    return exitCode;
+}
@@ -28,8 +28,9 @@ NTSTATUS H2ParseArguments(
     _Out_ PH2_ARGUMENTS ParsedArguments
 )
 {
-    NTSTATUS status = STATUS_INVALID_PARAMETER;
+    NTSTATUS status;
     H2_ARGUMENTS parsedArguments = { 0 };
+    BOOLEAN processSelected = FALSE;
     ULONG value;
 
     for (LONG i = 1; i < argc; i++)
@@ -67,7 +68,7 @@ NTSTATUS H2ParseArguments(
                     return status;
             }
 
-            status = STATUS_SUCCESS;
+            processSelected = TRUE;
         }
         else if (lstrcmpW(argv[i], L"-h") == 0)
         {
@@ -90,6 +91,124 @@ NTSTATUS H2ParseArguments(
         {
             parsedArguments.Verbose = TRUE;
         }
+        else if (lstrcmpW(argv[i], L"--exhaustive") == 0)
+        {
+            parsedArguments.Exhaustive = TRUE;
+        }
+        else if (lstrcmpW(argv[i], L"--stats") == 0)
+        {
+            parsedArguments.Stats = TRUE;
+        }
+        else if (lstrcmpW(argv[i], L"-j") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            status = H2ParseInteger(argv[i], &parsedArguments.NumberOfThreads);
+
+            if (!NT_SUCCESS(status))
+                return status;
+
+            if (parsedArguments.NumberOfThreads == 0)
+                return STATUS_INVALID_PARAMETER;
+        }
+        else if (lstrcmpW(argv[i], L"-s") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            status = H2ParseInteger(argv[i], &parsedArguments.SimulatedSockets);
+
+            if (!NT_SUCCESS(status))
+                return status;
+
+            if (parsedArguments.SimulatedSockets == 0)
+                return STATUS_INVALID_PARAMETER;
+        }
+        else if (lstrcmpW(argv[i], L"--cache") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            parsedArguments.CacheFileName = argv[i];
+        }
+        else if (lstrcmpW(argv[i], L"--record") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            parsedArguments.RecordFileName = argv[i];
+        }
+        else if (lstrcmpW(argv[i], L"--trace") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            parsedArguments.TimelineFileName = argv[i];
+        }
+        else if (lstrcmpW(argv[i], L"--output") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            parsedArguments.OutputFileName = argv[i];
+        }
+        else if (lstrcmpW(argv[i], L"--format") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            if (lstrcmpW(argv[i], L"text") == 0)
+                parsedArguments.Format = H2OutputText;
+            else if (lstrcmpW(argv[i], L"jsonl") == 0)
+                parsedArguments.Format = H2OutputJsonLines;
+            else if (lstrcmpW(argv[i], L"columnar") == 0)
+                parsedArguments.Format = H2OutputColumnar;
+            else
+                return STATUS_INVALID_PARAMETER;
+        }
+        else if (lstrcmpW(argv[i], L"--watch") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            status = H2ParseInteger(argv[i], &parsedArguments.WatchInterval);
+
+            if (!NT_SUCCESS(status))
+                return status;
+
+            if (parsedArguments.WatchInterval == 0)
+                return STATUS_INVALID_PARAMETER;
+        }
+        else if (lstrcmpW(argv[i], L"--rates") == 0)
+        {
+            parsedArguments.Rates = TRUE;
+        }
+        else if (lstrcmpW(argv[i], L"--analyze") == 0)
+        {
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            // Make room for all remaining arguments on the first occurrence
+            if (!parsedArguments.SnapshotFileNames)
+            {
+                parsedArguments.SnapshotFileNames = RtlAllocateHeap(RtlProcessHeap(), 0, argc * sizeof(PCWSTR));
+
+                if (!parsedArguments.SnapshotFileNames)
+                    return STATUS_NO_MEMORY;
+            }
+
+            parsedArguments.SnapshotFileNames[parsedArguments.NumberOfSnapshots++] = argv[i];
+        }
+        else if (lstrcmpW(argv[i], L"--replay") == 0 || lstrcmpW(argv[i], L"--replay-fast") == 0)
+        {
+            parsedArguments.ReplayWithoutDelays = lstrcmpW(argv[i], L"--replay-fast") == 0;
+
+            if (++i >= argc)
+                return STATUS_INVALID_PARAMETER;
+
+            parsedArguments.ReplayFileName = argv[i];
+        }
         else
         {
             // Unrecognized parameter
@@ -97,10 +216,36 @@ NTSTATUS H2ParseArguments(
         }
     }
 
-    if (NT_SUCCESS(status))
-        *ParsedArguments = parsedArguments;
+    // Options other than -p only refine the selection
+    if (!processSelected)
+        return STATUS_INVALID_PARAMETER;
+
+    // Traces come either from the system or from a simulation, not from another trace
+    if (parsedArguments.ReplayFileName && (parsedArguments.RecordFileName || parsedArguments.SimulatedSockets))
+        return STATUS_INVALID_PARAMETER_MIX;
+
+    // Snapshots are analyzed without querying the system and print text
+    if (parsedArguments.NumberOfSnapshots &&
+        (parsedArguments.SimulatedSockets || parsedArguments.RecordFileName || parsedArguments.ReplayFileName ||
+         parsedArguments.CacheFileName || parsedArguments.Stats || parsedArguments.Format != H2OutputText))
+        return STATUS_INVALID_PARAMETER_MIX;
+
+    // Watching prints events as text; replaying and caching cannot follow changes
+    if (parsedArguments.WatchInterval &&
+        (parsedArguments.NumberOfSnapshots || parsedArguments.ReplayFileName ||
+         parsedArguments.CacheFileName || parsedArguments.Format != H2OutputText))
+        return STATUS_INVALID_PARAMETER_MIX;
 
-    return status;
+    // Rates compare consecutive scans
+    if (parsedArguments.Rates && !parsedArguments.WatchInterval)
+        return STATUS_INVALID_PARAMETER_MIX;
+
+    // Columnar output is binary and needs a file to go to
+    if (parsedArguments.Format == H2OutputColumnar && !parsedArguments.OutputFileName)
+        return STATUS_INVALID_PARAMETER_MIX;
+
+    *ParsedArguments = parsedArguments;
+    return STATUS_SUCCESS;
 }
 
 /**
@@ -115,4 +260,11 @@ VOID H2FreeArguments(
         RtlFreeUnicodeString(&ParsedArguments->ProcessFilter);
         memset(&ParsedArguments->ProcessFilter, 0, sizeof(UNICODE_STRING));
     }
+
+    if (ParsedArguments->SnapshotFileNames)
+    {
+        RtlFreeHeap(RtlProcessHeap(), 0, (PVOID)ParsedArguments->SnapshotFileNames);
+        ParsedArguments->SnapshotFileNames = NULL;
+        ParsedArguments->NumberOfSnapshots = 0;
+    }
 }
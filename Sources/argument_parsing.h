@@ -14,12 +14,34 @@
 #include <phnt_windows.h>
 #include <phnt.h>
 
+typedef enum _H2_OUTPUT_FORMAT
+{
+    H2OutputText,
+    H2OutputJsonLines, // One JSON object per socket
+    H2OutputColumnar, // A binary file with one column per property
+} H2_OUTPUT_FORMAT;
+
 typedef struct _H2_ARGUMENTS
 {
     UNICODE_STRING ProcessFilter;
     HANDLE ProcessId;
     HANDLE HandleValue;
     BOOLEAN Verbose;
+    BOOLEAN Exhaustive;
+    BOOLEAN Stats;
+    ULONG NumberOfThreads;
+    ULONG SimulatedSockets;
+    PCWSTR RecordFileName;
+    PCWSTR ReplayFileName;
+    BOOLEAN ReplayWithoutDelays;
+    PCWSTR CacheFileName;
+    PCWSTR TimelineFileName;
+    PCWSTR OutputFileName;
+    H2_OUTPUT_FORMAT Format;
+    PCWSTR* SnapshotFileNames; // Columnar files to analyze instead of the system
+    ULONG NumberOfSnapshots;
+    ULONG WatchInterval; // In milliseconds; zero for a single scan
+    BOOLEAN Rates; // Print TCP throughput and retransmissions between scans
 } H2_ARGUMENTS, *PH2_ARGUMENTS;
 
 NTSTATUS
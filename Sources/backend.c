@@ -0,0 +1,536 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "backend.h"
+#include "snapshot_helpers.h"
+#include "stats_backend.h"
+#include "timeline.h"
+
+/**
+  * \brief Duplicates a handle from another process.
+  *
+  * \param[in] ProcessHandle A handle to the source process with PROCESS_DUP_HANDLE access.
+  * \param[in] SourceHandle A handle value in the source process.
+  * \param[out] TargetHandle A variable that receives a handle in the current process.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2NativeDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+)
+{
+    return NtDuplicateObject(
+        ProcessHandle,
+        SourceHandle,
+        NtCurrentProcess(),
+        TargetHandle,
+        0,
+        0,
+        DUPLICATE_SAME_ACCESS
+    );
+}
+
+/**
+  * \brief Determines the name of the device backing a file handle.
+  *
+  * \param[in] FileHandle A file handle.
+  * \param[out] Buffer A buffer that receives the volume name information.
+  * \param[in] BufferSize The size of the buffer in bytes.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2NativeQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+)
+{
+    IO_STATUS_BLOCK ioStatusBlock;
+
+    return NtQueryInformationFile(
+        FileHandle,
+        &ioStatusBlock,
+        Buffer,
+        BufferSize,
+        FileVolumeNameInformation
+    );
+}
+
+// The event for waiting on IOCTLs issued by the current thread
+__declspec(thread) HANDLE H2NativeThreadEvent;
+
+// The events for waiting on batched IOCTLs issued by the current thread
+__declspec(thread) HANDLE H2NativeBatchEvents[H2_NATIVE_BATCH_MAX_IN_FLIGHT];
+
+// The number of batched IOCTLs that can still be issued across all threads
+volatile LONG H2NativeInFlightBudget = H2_NATIVE_MAX_IN_FLIGHT;
+
+/**
+  * \brief Releases the events the current thread uses for IOCTLs. Threads call it before exiting.
+  */
+VOID H2NativeReleaseThreadEvents(
+    VOID
+)
+{
+    if (H2NativeThreadEvent)
+    {
+        NtClose(H2NativeThreadEvent);
+        H2NativeThreadEvent = NULL;
+    }
+
+    for (ULONG i = 0; i < H2_NATIVE_BATCH_MAX_IN_FLIGHT; i++)
+    {
+        if (H2NativeBatchEvents[i])
+        {
+            NtClose(H2NativeBatchEvents[i]);
+            H2NativeBatchEvents[i] = NULL;
+        }
+    }
+}
+
+/**
+  * \brief Issues an IOCTL on a file handle and waits for its completion.
+  *
+  * \param[in] FileHandle A file handle.
+  * \param[in] IoControlCode I/O control code
+  * \param[in] InBuffer Input buffer.
+  * \param[in] InBufferSize Input buffer size.
+  * \param[out] OutputBuffer Output Buffer.
+  * \param[in] OutputBufferSize Output buffer size.
+  * \param[out] BytesReturned Optionally set to the number of bytes returned.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2NativeDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+)
+{
+    NTSTATUS status;
+    IO_STATUS_BLOCK ioStatusBlock;
+
+    // We cannot wait on the file handle because it might not grant SYNCHRONIZE access.
+    // Always use an event instead. Each thread creates one on first use and keeps it;
+    // the I/O manager resets the event when issuing the request, so it needs no reset here.
+
+    if (!H2NativeThreadEvent)
+    {
+        status = NtCreateEvent(
+            &H2NativeThreadEvent,
+            EVENT_ALL_ACCESS,
+            NULL,
+            SynchronizationEvent,
+            FALSE
+        );
+
+        if (!NT_SUCCESS(status))
+        {
+            H2NativeThreadEvent = NULL;
+            return status;
+        }
+    }
+
+    status = NtDeviceIoControlFile(
+        FileHandle,
+        H2NativeThreadEvent,
+        NULL,
+        NULL,
+        &ioStatusBlock,
+        IoControlCode,
+        InBuffer,
+        InBufferSize,
+        OutputBuffer,
+        OutputBufferSize
+    );
+
+    if (status == STATUS_PENDING)
+    {
+        H2_STATS_COUNT_PENDING_WAIT();
+        H2_TIMELINE_BEGIN("Wait for IOCTL", IoControlCode);
+        NtWaitForSingleObject(H2NativeThreadEvent, FALSE, NULL);
+        H2_TIMELINE_END("Wait for IOCTL");
+        status = ioStatusBlock.Status;
+    }
+
+    if (BytesReturned)
+    {
+        *BytesReturned = (ULONG)ioStatusBlock.Information;
+    }
+
+    return status;
+}
+
+/**
+  * \brief Takes slots for in-flight IOCTLs from the global budget.
+  *
+  * \param[in] Wanted The number of slots the caller can use.
+  *
+  * \return The number of slots taken, at least one. The caller must return them via H2NativeReturnInFlight.
+  */
+LONG H2NativeReserveInFlight(
+    _In_ LONG Wanted
+)
+{
+    LONG available;
+    LONG taken;
+
+    do
+    {
+        available = ReadNoFence(&H2NativeInFlightBudget);
+
+        // Always allow one request so that an exhausted budget degrades to sequential I/O instead of blocking
+        taken = min(Wanted, max(available, 1));
+
+    } while (InterlockedCompareExchange(&H2NativeInFlightBudget, available - taken, available) != available);
+
+    return taken;
+}
+
+/**
+  * \brief Returns slots for in-flight IOCTLs to the global budget.
+  *
+  * \param[in] Taken The number of slots returned by H2NativeReserveInFlight.
+  */
+VOID H2NativeReturnInFlight(
+    _In_ LONG Taken
+)
+{
+    InterlockedExchangeAdd(&H2NativeInFlightBudget, Taken);
+}
+
+// The memory the driver accesses during a batch. Requests that don't complete in time keep it, so it's leaked then.
+typedef struct _H2_NATIVE_BATCH_MEMORY
+{
+    IO_STATUS_BLOCK IoStatusBlocks[H2_NATIVE_BATCH_MAX_IN_FLIGHT];
+    // UCHAR Buffers[NumberOfSlots][SlotSize]; (the input, then the output)
+} H2_NATIVE_BATCH_MEMORY, *PH2_NATIVE_BATCH_MEMORY;
+
+#define H2_NATIVE_BATCH_ALIGN(Value) (((SIZE_T)(Value) + 7) & ~(SIZE_T)7)
+#define H2_NATIVE_BATCH_INPUT(Memory, SlotSize, Slot) ((PUCHAR)((Memory) + 1) + (Slot) * (SlotSize))
+#define H2_NATIVE_BATCH_OUTPUT(Memory, SlotSize, Slot, Request) \
+    (H2_NATIVE_BATCH_INPUT(Memory, SlotSize, Slot) + H2_NATIVE_BATCH_ALIGN((Request)->InBufferSize))
+
+/**
+  * \brief Copies the result of a completed request from the memory of the batch.
+  *
+  * \param[in,out] Request The request.
+  * \param[in] IoStatusBlock The I/O status block of the request.
+  * \param[in] OutputBuffer The output buffer the driver wrote to.
+  */
+VOID H2NativeCompleteRequest(
+    _Inout_ PH2_IOCTL_REQUEST Request,
+    _In_ PIO_STATUS_BLOCK IoStatusBlock,
+    _In_ PUCHAR OutputBuffer
+)
+{
+    Request->Status = IoStatusBlock->Status;
+    Request->BytesReturned = (ULONG)min(IoStatusBlock->Information, Request->OutputBufferSize);
+
+    if (Request->BytesReturned)
+        memcpy(Request->OutputBuffer, OutputBuffer, Request->BytesReturned);
+}
+
+/**
+  * \brief Converts a deadline into a relative timeout for waiting.
+  *
+  * \param[in] Deadline The deadline in performance counter ticks.
+  * \param[in] Frequency The performance counter frequency.
+  * \param[out] Timeout The remaining time in the format of wait functions.
+  */
+VOID H2NativeRemainingTime(
+    _In_ LONG64 Deadline,
+    _In_ LONG64 Frequency,
+    _Out_ PLARGE_INTEGER Timeout
+)
+{
+    LARGE_INTEGER counter;
+    LONG64 remaining;
+
+    RtlQueryPerformanceCounter(&counter);
+    remaining = max(Deadline - counter.QuadPart, 0);
+    Timeout->QuadPart = -((remaining / Frequency) * 10000000 + (remaining % Frequency) * 10000000 / Frequency);
+}
+
+/**
+  * \brief Issues independent IOCTLs on a file handle concurrently and waits for all of them.
+  *  The driver only accesses memory owned by the batch, so requests may use buffers on the stack
+  *  as long as their input doesn't point to other memory.
+  *
+  * \param[in] FileHandle A file handle.
+  * \param[in,out] Requests The requests to issue. Each receives its status and the number of bytes returned.
+  * \param[in] NumberOfRequests The number of requests.
+  *
+  * \return STATUS_SUCCESS when all requests completed, STATUS_IO_TIMEOUT when the rest were abandoned, or an error
+  *  if the batch could not start.
+  */
+NTSTATUS H2NativeDeviceIoControlBatch(
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    PH2_NATIVE_BATCH_MEMORY memory;
+    SIZE_T slotSize = 0;
+    ULONG slotRequests[H2_NATIVE_BATCH_MAX_IN_FLIGHT];
+    BOOLEAN slotBusy[H2_NATIVE_BATCH_MAX_IN_FLIGHT] = { 0 };
+    HANDLE waitHandles[H2_NATIVE_BATCH_MAX_IN_FLIGHT];
+    ULONG waitSlots[H2_NATIVE_BATCH_MAX_IN_FLIGHT];
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER deadline;
+    LARGE_INTEGER timeout;
+    LONG numberOfSlots;
+    ULONG nextRequest = 0;
+    ULONG active = 0;
+    BOOLEAN abandoned = FALSE;
+
+    if (NumberOfRequests == 0)
+        return STATUS_SUCCESS;
+
+    // Each slot holds the input and the output of one request at a time
+    for (ULONG i = 0; i < NumberOfRequests; i++)
+        slotSize = max(slotSize, H2_NATIVE_BATCH_ALIGN(Requests[i].InBufferSize) + H2_NATIVE_BATCH_ALIGN(Requests[i].OutputBufferSize));
+
+    numberOfSlots = H2NativeReserveInFlight((LONG)min(NumberOfRequests, H2_NATIVE_BATCH_MAX_IN_FLIGHT));
+    memory = RtlAllocateHeap(RtlProcessHeap(), 0, sizeof(H2_NATIVE_BATCH_MEMORY) + numberOfSlots * slotSize);
+
+    if (!memory)
+    {
+        H2NativeReturnInFlight(numberOfSlots);
+        return STATUS_NO_MEMORY;
+    }
+
+    // Each slot waits on its own event because the file handle might not grant SYNCHRONIZE access.
+    // Completion ports are not an option: binding a socket we duplicated from another process to
+    // our port would redirect the completions of the owning application to us.
+
+    for (LONG i = 0; i < numberOfSlots; i++)
+    {
+        if (H2NativeBatchEvents[i])
+            continue;
+
+        status = NtCreateEvent(&H2NativeBatchEvents[i], EVENT_ALL_ACCESS, NULL, SynchronizationEvent, FALSE);
+
+        if (!NT_SUCCESS(status))
+        {
+            H2NativeBatchEvents[i] = NULL;
+
+            if (i == 0)
+            {
+                H2NativeReturnInFlight(numberOfSlots);
+                RtlFreeHeap(RtlProcessHeap(), 0, memory);
+                return status;
+            }
+
+            // Make do with fewer slots
+            H2NativeReturnInFlight(numberOfSlots - i);
+            numberOfSlots = i;
+            status = STATUS_SUCCESS;
+            break;
+        }
+    }
+
+    // The timeout applies to the whole batch, not to each completion
+    RtlQueryPerformanceFrequency(&frequency);
+    RtlQueryPerformanceCounter(&deadline);
+    deadline.QuadPart += frequency.QuadPart * H2_NATIVE_BATCH_TIMEOUT_MS / 1000;
+
+    while (nextRequest < NumberOfRequests || active > 0)
+    {
+        NTSTATUS waitStatus;
+        ULONG numberOfWaits = 0;
+
+        // Fill the free slots
+        for (LONG slot = 0; slot < numberOfSlots && nextRequest < NumberOfRequests; slot++)
+        {
+            PH2_IOCTL_REQUEST request;
+            PUCHAR inBuffer;
+            PUCHAR outputBuffer;
+            NTSTATUS issueStatus;
+
+            if (slotBusy[slot])
+                continue;
+
+            request = &Requests[nextRequest];
+            inBuffer = H2_NATIVE_BATCH_INPUT(memory, slotSize, slot);
+            outputBuffer = H2_NATIVE_BATCH_OUTPUT(memory, slotSize, slot, request);
+            memory->IoStatusBlocks[slot].Status = STATUS_PENDING;
+            memory->IoStatusBlocks[slot].Information = 0;
+
+            if (request->InBufferSize)
+                memcpy(inBuffer, request->InBuffer, request->InBufferSize);
+
+            issueStatus = NtDeviceIoControlFile(
+                FileHandle,
+                H2NativeBatchEvents[slot],
+                NULL,
+                NULL,
+                &memory->IoStatusBlocks[slot],
+                request->IoControlCode,
+                request->InBufferSize ? inBuffer : NULL,
+                request->InBufferSize,
+                request->OutputBufferSize ? outputBuffer : NULL,
+                request->OutputBufferSize
+            );
+
+            if (issueStatus == STATUS_PENDING)
+            {
+                H2_STATS_COUNT_PENDING_WAIT();
+                slotRequests[slot] = nextRequest;
+                slotBusy[slot] = TRUE;
+                active++;
+            }
+            else
+            {
+                memory->IoStatusBlocks[slot].Status = issueStatus;
+                H2NativeCompleteRequest(request, &memory->IoStatusBlocks[slot], outputBuffer);
+            }
+
+            nextRequest++;
+        }
+
+        if (active == 0)
+            continue;
+
+        for (LONG slot = 0; slot < numberOfSlots; slot++)
+        {
+            if (slotBusy[slot])
+            {
+                waitHandles[numberOfWaits] = H2NativeBatchEvents[slot];
+                waitSlots[numberOfWaits] = slot;
+                numberOfWaits++;
+            }
+        }
+
+        H2NativeRemainingTime(deadline.QuadPart, frequency.QuadPart, &timeout);
+        H2_TIMELINE_BEGIN("Wait for IOCTL batch", numberOfWaits);
+        waitStatus = NtWaitForMultipleObjects(numberOfWaits, waitHandles, WaitAny, FALSE, &timeout);
+        H2_TIMELINE_END("Wait for IOCTL batch");
+
+        if (waitStatus >= STATUS_WAIT_0 && waitStatus < STATUS_WAIT_0 + numberOfWaits)
+        {
+            ULONG slot = waitSlots[waitStatus - STATUS_WAIT_0];
+            PH2_IOCTL_REQUEST request = &Requests[slotRequests[slot]];
+
+            H2NativeCompleteRequest(request, &memory->IoStatusBlocks[slot], H2_NATIVE_BATCH_OUTPUT(memory, slotSize, slot, request));
+            slotBusy[slot] = FALSE;
+            active--;
+            continue;
+        }
+
+        // A hung transport; cancel what's in flight and give up on the rest
+        for (ULONG i = 0; i < numberOfWaits; i++)
+        {
+            IO_STATUS_BLOCK cancelIoStatusBlock;
+
+            NtCancelIoFileEx(FileHandle, &memory->IoStatusBlocks[waitSlots[i]], &cancelIoStatusBlock);
+        }
+
+        // The transport might not honor cancellation either, so give it a bounded grace period
+        RtlQueryPerformanceCounter(&deadline);
+        deadline.QuadPart += frequency.QuadPart * H2_NATIVE_BATCH_CANCEL_TIMEOUT_MS / 1000;
+
+        for (ULONG i = 0; i < numberOfWaits; i++)
+        {
+            ULONG slot = waitSlots[i];
+            PH2_IOCTL_REQUEST request = &Requests[slotRequests[slot]];
+
+            H2NativeRemainingTime(deadline.QuadPart, frequency.QuadPart, &timeout);
+
+            if (NtWaitForSingleObject(H2NativeBatchEvents[slot], FALSE, &timeout) == STATUS_WAIT_0)
+            {
+                H2NativeCompleteRequest(request, &memory->IoStatusBlocks[slot], H2_NATIVE_BATCH_OUTPUT(memory, slotSize, slot, request));
+            }
+            else
+            {
+                // The driver still owns the memory and signals the event later; leave both to it
+                request->Status = STATUS_IO_TIMEOUT;
+                request->BytesReturned = 0;
+                NtClose(H2NativeBatchEvents[slot]);
+                H2NativeBatchEvents[slot] = NULL;
+                abandoned = TRUE;
+            }
+        }
+
+        for (; nextRequest < NumberOfRequests; nextRequest++)
+        {
+            Requests[nextRequest].Status = STATUS_IO_TIMEOUT;
+            Requests[nextRequest].BytesReturned = 0;
+        }
+
+        status = NT_SUCCESS(waitStatus) ? STATUS_IO_TIMEOUT : waitStatus;
+        break;
+    }
+
+    if (!abandoned)
+        RtlFreeHeap(RtlProcessHeap(), 0, memory);
+
+    H2NativeReturnInFlight(numberOfSlots);
+    return status;
+}
+
+/**
+  * \brief Issues independent IOCTLs on a file handle one after another.
+  *  Backends pass their own single-request routine rather than going through H2Backend,
+  *  which may be a wrapper (such as statistics) that already accounts for the batch.
+  *
+  * \param[in] DeviceIoControl The routine of the owning backend that issues one request.
+  * \param[in] FileHandle A file handle.
+  * \param[in,out] Requests The requests to issue. Each receives its status and the number of bytes returned.
+  * \param[in] NumberOfRequests The number of requests.
+  *
+  * \return Successful status.
+  */
+NTSTATUS H2SequentialDeviceIoControlBatch(
+    _In_ PH2_BACKEND_DEVICE_IO_CONTROL DeviceIoControl,
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+)
+{
+    for (ULONG i = 0; i < NumberOfRequests; i++)
+    {
+        Requests[i].BytesReturned = 0;
+        Requests[i].Status = DeviceIoControl(
+            FileHandle,
+            Requests[i].IoControlCode,
+            Requests[i].InBuffer,
+            Requests[i].InBufferSize,
+            Requests[i].OutputBuffer,
+            Requests[i].OutputBufferSize,
+            &Requests[i].BytesReturned
+        );
+    }
+
+    return STATUS_SUCCESS;
+}
+
+const H2_BACKEND H2NativeBackend =
+{
+    L"Native",
+    H2SnapshotProcesses,
+    H2SnapshotHandles,
+    H2FindKernelTypeIndex,
+    H2OpenProcess,
+    H2NativeDuplicateHandle,
+    H2NativeQueryVolumeName,
+    H2NativeDeviceIoControl,
+    H2NativeDeviceIoControlBatch,
+    NtClose
+};
+
+PCH2_BACKEND H2Backend = &H2NativeBackend;
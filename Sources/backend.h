@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _BACKEND_H
+#define _BACKEND_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+
+// Enumerates processes; the caller releases the snapshot via H2Free
+typedef NTSTATUS (NTAPI *PH2_BACKEND_SNAPSHOT_PROCESSES)(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+    );
+
+// Enumerates handles; the caller releases the snapshot via H2Free
+typedef NTSTATUS (NTAPI *PH2_BACKEND_SNAPSHOT_HANDLES)(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+    );
+
+typedef NTSTATUS (NTAPI *PH2_BACKEND_FIND_KERNEL_TYPE_INDEX)(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+    );
+
+typedef NTSTATUS (NTAPI *PH2_BACKEND_OPEN_PROCESS)(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+    );
+
+// Duplicates a handle from a process opened via OpenProcess with the same access
+typedef NTSTATUS (NTAPI *PH2_BACKEND_DUPLICATE_HANDLE)(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+    );
+
+// Queries FileVolumeNameInformation; returns STATUS_BUFFER_OVERFLOW for truncated names
+typedef NTSTATUS (NTAPI *PH2_BACKEND_QUERY_VOLUME_NAME)(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+    );
+
+// Issues an IOCTL and waits for its completion
+typedef NTSTATUS (NTAPI *PH2_BACKEND_DEVICE_IO_CONTROL)(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+    );
+
+// One request in a batch of IOCTLs
+typedef struct _H2_IOCTL_REQUEST
+{
+    ULONG IoControlCode;
+    PVOID InBuffer;
+    ULONG InBufferSize;
+    PVOID OutputBuffer;
+    ULONG OutputBufferSize;
+    NTSTATUS Status; // Filled in on completion
+    ULONG BytesReturned; // Filled in on completion
+} H2_IOCTL_REQUEST, *PH2_IOCTL_REQUEST;
+
+// Issues independent IOCTLs on one file, possibly concurrently, and waits for all of them
+typedef NTSTATUS (NTAPI *PH2_BACKEND_DEVICE_IO_CONTROL_BATCH)(
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+    );
+
+typedef NTSTATUS (NTAPI *PH2_BACKEND_CLOSE)(
+    _In_ HANDLE Handle
+    );
+
+// A table of system calls the enumeration and inspection logic relies on
+typedef struct _H2_BACKEND
+{
+    PCWSTR Name;
+    PH2_BACKEND_SNAPSHOT_PROCESSES SnapshotProcesses;
+    PH2_BACKEND_SNAPSHOT_HANDLES SnapshotHandles;
+    PH2_BACKEND_FIND_KERNEL_TYPE_INDEX FindKernelTypeIndex;
+    PH2_BACKEND_OPEN_PROCESS OpenProcess;
+    PH2_BACKEND_DUPLICATE_HANDLE DuplicateHandle;
+    PH2_BACKEND_QUERY_VOLUME_NAME QueryVolumeName;
+    PH2_BACKEND_DEVICE_IO_CONTROL DeviceIoControl;
+    PH2_BACKEND_DEVICE_IO_CONTROL_BATCH DeviceIoControlBatch;
+    PH2_BACKEND_CLOSE Close;
+} H2_BACKEND, *PH2_BACKEND;
+
+typedef const H2_BACKEND* PCH2_BACKEND;
+
+NTSTATUS
+NTAPI
+H2NativeDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+);
+
+NTSTATUS
+NTAPI
+H2NativeQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+);
+
+NTSTATUS
+NTAPI
+H2NativeDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+);
+
+// The maximum number of IOCTLs a native batch keeps in flight
+#define H2_NATIVE_BATCH_MAX_IN_FLIGHT 16
+
+// The maximum number of batched IOCTLs in flight across all threads
+#define H2_NATIVE_MAX_IN_FLIGHT 128
+
+// How long a native batch waits for all of its requests before cancelling the rest
+#define H2_NATIVE_BATCH_TIMEOUT_MS 5000
+
+// How long a native batch waits for cancelled requests before abandoning them
+#define H2_NATIVE_BATCH_CANCEL_TIMEOUT_MS 1000
+
+NTSTATUS
+NTAPI
+H2NativeDeviceIoControlBatch(
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+);
+
+NTSTATUS
+NTAPI
+H2SequentialDeviceIoControlBatch(
+    _In_ PH2_BACKEND_DEVICE_IO_CONTROL DeviceIoControl,
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+);
+
+VOID
+NTAPI
+H2NativeReleaseThreadEvents(
+    VOID
+);
+
+// The backend that forwards requests to the system
+extern const H2_BACKEND H2NativeBackend;
+
+// The backend currently in use; defaults to H2NativeBackend
+extern PCH2_BACKEND H2Backend;
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "capability_cache.h"
+#include "socket_record.h"
+
+// Occupied slots always have the top bit set, so zero marks a free one
+#define H2_CAPABILITY_KEY(AddressFamily, Protocol) \
+    ((LONG64)(0x8000000000000000ull | ((ULONG64)(USHORT)(AddressFamily) << 32) | (ULONG)(Protocol)))
+
+#define H2_CAPABILITY_WORDS ((H2_AFD_OPTION_MAX + 63) / 64)
+
+// Device names are kept for AFD_QUERY_ADDRESS_HANDLE and AFD_QUERY_CONNECTION_HANDLE
+#define H2_CAPABILITY_TDI_SLOTS 2
+#define H2_CAPABILITY_TDI_CLAIMED(Slot) (1 << (Slot))
+#define H2_CAPABILITY_TDI_VALID(Slot) (1 << (H2_CAPABILITY_TDI_SLOTS + (Slot)))
+
+typedef struct _H2_CAPABILITY_ENTRY
+{
+    volatile LONG64 Key;
+    volatile LONG64 Unsupported[H2_CAPABILITY_WORDS]; // A bitmap of H2_AFD_OPTION
+    NTSTATUS Statuses[H2_AFD_OPTION_MAX]; // Valid for options with a bit set
+    volatile LONG OptionsVerdict; // H2_OPTIONS_VERDICT
+    volatile LONG TdiDeviceFlags; // H2_CAPABILITY_TDI_* bits
+    USHORT TdiDeviceNameLength[H2_CAPABILITY_TDI_SLOTS]; // in bytes
+    WCHAR TdiDeviceName[H2_CAPABILITY_TDI_SLOTS][H2_AFD_DEVICE_NAME_LENGTH];
+} H2_CAPABILITY_ENTRY, *PH2_CAPABILITY_ENTRY;
+
+H2_CAPABILITY_ENTRY H2CapabilityCache[H2_CAPABILITY_CACHE_SIZE];
+
+/**
+  * \brief Determines whether an option query failed because the system doesn't implement the option.
+  *  Other errors might depend on the state of the socket and are never cached.
+  *
+  * \param[in] Status The status of an option query.
+  *
+  * \return Whether the status describes the system rather than the socket.
+  */
+BOOLEAN H2IsCapabilityStatus(
+    _In_ NTSTATUS Status
+)
+{
+    switch (Status)
+    {
+    case STATUS_NOT_SUPPORTED:
+    case STATUS_NOT_IMPLEMENTED:
+    case STATUS_INVALID_DEVICE_REQUEST:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+/**
+  * \brief Finds the slot for a kind of socket.
+  *
+  * \param[in] AddressFamily The address family of the socket.
+  * \param[in] Protocol The protocol of the socket.
+  * \param[in] Create Whether to claim a free slot when the kind is not in the cache yet.
+  *
+  * \return The slot or NULL if it doesn't exist and cannot be created.
+  */
+PH2_CAPABILITY_ENTRY H2FindCapabilityEntry(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ BOOLEAN Create
+)
+{
+    LONG64 key = H2_CAPABILITY_KEY(AddressFamily, Protocol);
+    ULONG start = (ULONG)AddressFamily * 31 + (ULONG)Protocol;
+    PH2_CAPABILITY_ENTRY entry;
+    LONG64 current;
+
+    // Slots are never freed, so the first free slot on the probe sequence ends the search
+    for (ULONG i = 0; i < H2_CAPABILITY_CACHE_SIZE; i++)
+    {
+        entry = &H2CapabilityCache[(start + i) & (H2_CAPABILITY_CACHE_SIZE - 1)];
+        current = ReadAcquire64(&entry->Key);
+
+        if (current == 0)
+        {
+            if (!Create)
+                return NULL;
+
+            current = InterlockedCompareExchange64(&entry->Key, key, 0);
+
+            if (current == 0)
+                return entry;
+        }
+
+        if (current == key)
+            return entry;
+    }
+
+    return NULL;
+}
+
+/**
+  * \brief Looks up whether an option is known to be unsupported for a kind of socket.
+  *
+  * \param[in] AddressFamily The address family of the socket.
+  * \param[in] Protocol The protocol of the socket.
+  * \param[in] Option The option to check.
+  * \param[out] Status The status of the earlier query, if the option is unsupported.
+  *
+  * \return Whether the query can be skipped.
+  */
+BOOLEAN H2CheckCapabilityCache(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ H2_AFD_OPTION Option,
+    _Out_ PNTSTATUS Status
+)
+{
+    PH2_CAPABILITY_ENTRY entry = H2FindCapabilityEntry(AddressFamily, Protocol, FALSE);
+
+    *Status = STATUS_SUCCESS;
+
+    if (!entry || !(ReadAcquire64(&entry->Unsupported[Option / 64]) & (1ll << (Option % 64))))
+        return FALSE;
+
+    *Status = entry->Statuses[Option];
+    return TRUE;
+}
+
+/**
+  * \brief Records the outcome of an option query if it shows the system doesn't support the option.
+  *
+  * \param[in] AddressFamily The address family of the socket.
+  * \param[in] Protocol The protocol of the socket.
+  * \param[in] Option The queried option.
+  * \param[in] Status The status of the query.
+  */
+VOID H2AddCapabilityCache(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ H2_AFD_OPTION Option,
+    _In_ NTSTATUS Status
+)
+{
+    PH2_CAPABILITY_ENTRY entry;
+
+    if (!H2IsCapabilityStatus(Status))
+        return;
+
+    entry = H2FindCapabilityEntry(AddressFamily, Protocol, TRUE);
+
+    // A full cache only means more queries
+    if (!entry)
+        return;
+
+    // Publish the status before the bit that makes it visible
+    entry->Statuses[Option] = Status;
+    InterlockedOr64(&entry->Unsupported[Option / 64], 1ll << (Option % 64));
+}
+
+/**
+  * \brief Looks up whether option queries on a kind of socket are known to be (un)reliable.
+  *
+  * \param[in] AddressFamily The address family of the socket.
+  * \param[in] Protocol The protocol of the socket.
+  *
+  * \return The recorded verdict or H2OptionsVerdictUnknown.
+  */
+H2_OPTIONS_VERDICT H2CheckOptionsVerdict(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol
+)
+{
+    PH2_CAPABILITY_ENTRY entry = H2FindCapabilityEntry(AddressFamily, Protocol, FALSE);
+
+    if (!entry)
+        return H2OptionsVerdictUnknown;
+
+    return (H2_OPTIONS_VERDICT)ReadNoFence(&entry->OptionsVerdict);
+}
+
+/**
+  * \brief Records whether option queries on a kind of socket are reliable.
+  *
+  * \param[in] AddressFamily The address family of the socket.
+  * \param[in] Protocol The protocol of the socket.
+  * \param[in] Verdict The verdict to record.
+  */
+VOID H2SetOptionsVerdict(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ H2_OPTIONS_VERDICT Verdict
+)
+{
+    PH2_CAPABILITY_ENTRY entry = H2FindCapabilityEntry(AddressFamily, Protocol, TRUE);
+
+    if (entry)
+        InterlockedExchange(&entry->OptionsVerdict, Verdict);
+}
+
+/**
+  * \brief Looks up the device behind TDI handles of a kind of socket.
+  *
+  * \param[in] AddressFamily The address family of the socket.
+  * \param[in] Protocol The protocol of the socket.
+  * \param[in] QueryMode Either AFD_QUERY_ADDRESS_HANDLE or AFD_QUERY_CONNECTION_HANDLE.
+  * \param[out] DeviceName A string that receives a reference to the cached name.
+  *
+  * \return Whether the name is known.
+  */
+BOOLEAN H2CheckTdiDeviceCache(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ ULONG QueryMode,
+    _Out_ PUNICODE_STRING DeviceName
+)
+{
+    PH2_CAPABILITY_ENTRY entry = H2FindCapabilityEntry(AddressFamily, Protocol, FALSE);
+    ULONG slot = QueryMode - AFD_QUERY_ADDRESS_HANDLE;
+
+    RtlInitEmptyUnicodeString(DeviceName, NULL, 0);
+
+    if (!entry || slot >= H2_CAPABILITY_TDI_SLOTS ||
+        !(ReadAcquire(&entry->TdiDeviceFlags) & H2_CAPABILITY_TDI_VALID(slot)))
+        return FALSE;
+
+    DeviceName->Buffer = entry->TdiDeviceName[slot];
+    DeviceName->Length = entry->TdiDeviceNameLength[slot];
+    DeviceName->MaximumLength = entry->TdiDeviceNameLength[slot];
+    return TRUE;
+}
+
+/**
+  * \brief Records the device behind TDI handles of a kind of socket.
+  *
+  * \param[in] AddressFamily The address family of the socket.
+  * \param[in] Protocol The protocol of the socket.
+  * \param[in] QueryMode Either AFD_QUERY_ADDRESS_HANDLE or AFD_QUERY_CONNECTION_HANDLE.
+  * \param[in] DeviceName The name of the device.
+  */
+VOID H2AddTdiDeviceCache(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ ULONG QueryMode,
+    _In_ PCUNICODE_STRING DeviceName
+)
+{
+    PH2_CAPABILITY_ENTRY entry;
+    ULONG slot = QueryMode - AFD_QUERY_ADDRESS_HANDLE;
+
+    if (slot >= H2_CAPABILITY_TDI_SLOTS || DeviceName->Length > sizeof(entry->TdiDeviceName[slot]))
+        return;
+
+    entry = H2FindCapabilityEntry(AddressFamily, Protocol, TRUE);
+
+    // Only the first thread to claim the slot writes the name
+    if (!entry || InterlockedOr(&entry->TdiDeviceFlags, H2_CAPABILITY_TDI_CLAIMED(slot)) & H2_CAPABILITY_TDI_CLAIMED(slot))
+        return;
+
+    memcpy(entry->TdiDeviceName[slot], DeviceName->Buffer, DeviceName->Length);
+    entry->TdiDeviceNameLength[slot] = DeviceName->Length;
+    InterlockedOr(&entry->TdiDeviceFlags, H2_CAPABILITY_TDI_VALID(slot));
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _CAPABILITY_CACHE_H
+#define _CAPABILITY_CACHE_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "socket_properties.h"
+
+//
+// The capability cache remembers, for the duration of a run, which options the system does
+// not implement for sockets of a given address family and protocol. Such failures don't
+// depend on the state of an individual socket, so later sockets of the same kind skip the
+// query and reuse the recorded status. The same slots also remember whether the transport
+// answers option queries truthfully and which devices back its TDI handles.
+//
+
+// The number of (family, protocol) slots; must be a power of two
+#define H2_CAPABILITY_CACHE_SIZE 64
+
+// Whether option queries on a kind of socket report meaningful results
+typedef enum _H2_OPTIONS_VERDICT
+{
+    H2OptionsVerdictUnknown,
+    H2OptionsVerdictReliable,
+    H2OptionsVerdictUnreliable, // The transport acknowledges any option query
+} H2_OPTIONS_VERDICT;
+
+BOOLEAN
+NTAPI
+H2IsCapabilityStatus(
+    _In_ NTSTATUS Status
+);
+
+BOOLEAN
+NTAPI
+H2CheckCapabilityCache(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ H2_AFD_OPTION Option,
+    _Out_ PNTSTATUS Status
+);
+
+VOID
+NTAPI
+H2AddCapabilityCache(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ H2_AFD_OPTION Option,
+    _In_ NTSTATUS Status
+);
+
+H2_OPTIONS_VERDICT
+NTAPI
+H2CheckOptionsVerdict(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol
+);
+
+VOID
+NTAPI
+H2SetOptionsVerdict(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ H2_OPTIONS_VERDICT Verdict
+);
+
+BOOLEAN
+NTAPI
+H2CheckTdiDeviceCache(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ ULONG QueryMode,
+    _Out_ PUNICODE_STRING DeviceName
+);
+
+VOID
+NTAPI
+H2AddTdiDeviceCache(
+    _In_ LONG AddressFamily,
+    _In_ LONG Protocol,
+    _In_ ULONG QueryMode,
+    _In_ PCUNICODE_STRING DeviceName
+);
+
+#endif
@@ -0,0 +1,661 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "columnar_output.h"
+#include "file_helpers.h"
+#include "printsocket.h"
+#include "socket_strings.h"
+#include <stdio.h>
+
+// The longest string a dictionary column stores, in bytes
+#define H2_COLUMNAR_MAX_STRING 0x400
+
+/**
+  * \brief Appends bytes to a growable array.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarAppendBytes(
+    _Inout_ PH2_COLUMNAR_BYTES Bytes,
+    _In_reads_bytes_(Size) const VOID* Data,
+    _In_ SIZE_T Size
+)
+{
+    if (Bytes->Length + Size > Bytes->Capacity)
+    {
+        SIZE_T capacity = max(max(Bytes->Capacity * 2, Bytes->Length + Size), 0x1000);
+        PUCHAR buffer;
+
+        if (Bytes->Buffer)
+            buffer = RtlReAllocateHeap(RtlProcessHeap(), 0, Bytes->Buffer, capacity);
+        else
+            buffer = RtlAllocateHeap(RtlProcessHeap(), 0, capacity);
+
+        if (!buffer)
+            return STATUS_NO_MEMORY;
+
+        Bytes->Buffer = buffer;
+        Bytes->Capacity = capacity;
+    }
+
+    memcpy(Bytes->Buffer + Bytes->Length, Data, Size);
+    Bytes->Length += Size;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Appends a value to a column in its encoding.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarAppendValue(
+    _Inout_ PH2_COLUMNAR_COLUMN_STATE Column,
+    _In_ H2_COLUMNAR_ENCODING Encoding,
+    _In_ ULONG64 Value
+)
+{
+    UCHAR varint[10];
+    ULONG length = 0;
+    ULONG64 zigzag;
+    ULONG value32;
+
+    switch (Encoding)
+    {
+    case H2ColumnarPlain64:
+        return H2ColumnarAppendBytes(&Column->Data, &Value, sizeof(ULONG64));
+
+    case H2ColumnarDeltaVarint:
+        zigzag = (Value - Column->Previous) << 1 ^ (ULONG64)((LONG64)(Value - Column->Previous) >> 63);
+        Column->Previous = Value;
+
+        do
+        {
+            varint[length++] = (UCHAR)(zigzag & 0x7F) | (zigzag > 0x7F ? 0x80 : 0);
+            zigzag >>= 7;
+        } while (zigzag);
+
+        return H2ColumnarAppendBytes(&Column->Data, varint, length);
+
+    default:
+        value32 = (ULONG)Value;
+        return H2ColumnarAppendBytes(&Column->Data, &value32, sizeof(ULONG));
+    }
+}
+
+/**
+  * \brief Finds or adds a string to the dictionary of a column and appends its index.
+  *
+  * \param[in,out] Column The dictionary column.
+  * \param[in] String The UTF-8 string or NULL to append H2_COLUMNAR_NO_ENTRY.
+  * \param[in] Length The length of the string in bytes.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarAppendString(
+    _Inout_ PH2_COLUMNAR_COLUMN_STATE Column,
+    _In_reads_bytes_opt_(Length) PCSTR String,
+    _In_ ULONG Length
+)
+{
+    NTSTATUS status;
+    PH2_COLUMNAR_DICTIONARY dictionary = &Column->Dictionary;
+    PULONG offsets;
+    ULONG hash = 2166136261;
+    ULONG index;
+    ULONG slot;
+
+    if (!String)
+    {
+        index = H2_COLUMNAR_NO_ENTRY;
+        return H2ColumnarAppendBytes(&Column->Data, &index, sizeof(ULONG));
+    }
+
+    // Keep the table at most half full
+    if ((dictionary->NumberOfEntries + 1) * 2 > dictionary->SlotMask + 1)
+    {
+        ULONG slotMask = dictionary->Slots ? dictionary->SlotMask * 2 + 1 : 0xFF;
+        PULONG slots = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, (slotMask + 1) * sizeof(ULONG));
+
+        if (!slots)
+            return STATUS_NO_MEMORY;
+
+        offsets = (PULONG)dictionary->Offsets.Buffer;
+
+        // Rehash the existing entries
+        for (ULONG i = 0; i < dictionary->NumberOfEntries; i++)
+        {
+            ULONG entryHash = 2166136261;
+
+            for (ULONG j = offsets[i]; j < offsets[i + 1]; j++)
+                entryHash = (entryHash ^ dictionary->Strings.Buffer[j]) * 16777619;
+
+            for (slot = entryHash & slotMask; slots[slot]; slot = (slot + 1) & slotMask);
+            slots[slot] = i + 1;
+        }
+
+        if (dictionary->Slots)
+            RtlFreeHeap(RtlProcessHeap(), 0, dictionary->Slots);
+
+        dictionary->Slots = slots;
+        dictionary->SlotMask = slotMask;
+    }
+
+    // FNV-1a
+    for (ULONG i = 0; i < Length; i++)
+        hash = (hash ^ (UCHAR)String[i]) * 16777619;
+
+    offsets = (PULONG)dictionary->Offsets.Buffer;
+
+    for (slot = hash & dictionary->SlotMask; dictionary->Slots[slot]; slot = (slot + 1) & dictionary->SlotMask)
+    {
+        index = dictionary->Slots[slot] - 1;
+
+        if (offsets[index + 1] - offsets[index] == Length &&
+            memcmp(dictionary->Strings.Buffer + offsets[index], String, Length) == 0)
+            return H2ColumnarAppendBytes(&Column->Data, &index, sizeof(ULONG));
+    }
+
+    // Add a new entry
+    index = dictionary->NumberOfEntries;
+    status = H2ColumnarAppendBytes(&dictionary->Strings, String, Length);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    slot = (ULONG)dictionary->Strings.Length;
+    status = H2ColumnarAppendBytes(&dictionary->Offsets, &slot, sizeof(ULONG));
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    for (slot = hash & dictionary->SlotMask; dictionary->Slots[slot]; slot = (slot + 1) & dictionary->SlotMask);
+    dictionary->Slots[slot] = index + 1;
+    dictionary->NumberOfEntries++;
+
+    return H2ColumnarAppendBytes(&Column->Data, &index, sizeof(ULONG));
+}
+
+/**
+  * \brief Converts a string to UTF-8 and appends it to a dictionary column.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarAppendUnicodeString(
+    _Inout_ PH2_COLUMNAR_COLUMN_STATE Column,
+    _In_reads_bytes_(Length) PCWCH String,
+    _In_ ULONG Length
+)
+{
+    CHAR buffer[H2_COLUMNAR_MAX_STRING];
+    ULONG bytes = 0;
+
+    // Truncate excessively long strings
+    RtlUnicodeToUTF8N(buffer, sizeof(buffer), &bytes, String, Length);
+
+    return H2ColumnarAppendString(Column, buffer, bytes);
+}
+
+/**
+  * \brief Prepares a writer for collecting rows.
+  *
+  * \param[out] Writer The writer to initialize. The caller must release it via H2ColumnarFree.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarInitialize(
+    _Out_ PH2_COLUMNAR_WRITER Writer
+)
+{
+    H2_COLUMNAR_SOURCE_DESCRIPTOR descriptor;
+    NTSTATUS status = STATUS_SUCCESS;
+    ULONG zero = 0;
+
+    memset(Writer, 0, sizeof(H2_COLUMNAR_WRITER));
+    Writer->Timestamp = ((PLARGE_INTEGER)&USER_SHARED_DATA->SystemTime)->QuadPart;
+    Writer->NumberOfColumns = H2ColumnarNumberOfColumns;
+    Writer->Columns = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, H2ColumnarNumberOfColumns * sizeof(H2_COLUMNAR_COLUMN_STATE));
+
+    if (!Writer->Columns)
+        return STATUS_NO_MEMORY;
+
+    // Dictionaries store the start offset of each entry and the end
+    for (ULONG i = 0; i < Writer->NumberOfColumns && NT_SUCCESS(status); i++)
+    {
+        H2ColumnarGetColumn(i, &descriptor);
+
+        if (H2_COLUMNAR_IS_DICTIONARY(descriptor.Encoding))
+            status = H2ColumnarAppendBytes(&Writer->Columns[i].Dictionary.Offsets, &zero, sizeof(ULONG));
+    }
+
+    if (!NT_SUCCESS(status))
+        H2ColumnarFree(Writer);
+
+    return status;
+}
+
+/**
+  * \brief Appends a row with the values of a socket record.
+  *
+  * \param[in,out] Writer The writer.
+  * \param[in] ProcessName The image name of the process.
+  * \param[in] ProcessId The ID of the process.
+  * \param[in] HandleValue The value of the socket handle in the process.
+  * \param[in] Record The record of the socket.
+  *
+  * \return Successful or errant status. After a failure, the writer ignores further rows.
+  */
+NTSTATUS H2ColumnarAppend(
+    _Inout_ PH2_COLUMNAR_WRITER Writer,
+    _In_ PCUNICODE_STRING ProcessName,
+    _In_ HANDLE ProcessId,
+    _In_ HANDLE HandleValue,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_COLUMNAR_SOURCE_DESCRIPTOR descriptor;
+    NTSTATUS status = Writer->Status;
+    PH2_COLUMNAR_COLUMN_STATE column;
+    PUCHAR member;
+    ULONG64 value;
+
+    for (ULONG i = 0; i < Writer->NumberOfColumns && NT_SUCCESS(status); i++)
+    {
+        H2ColumnarGetColumn(i, &descriptor);
+        column = &Writer->Columns[i];
+        member = (PUCHAR)Record + descriptor.Offset;
+
+        // Values of parts that were not retrieved are missing
+        if (descriptor.Source >= H2ColumnarSourceMember && descriptor.Source < H2ColumnarSourceStatus &&
+            !NT_SUCCESS(Record->Status[descriptor.Field]))
+        {
+            if (H2_COLUMNAR_IS_DICTIONARY(descriptor.Encoding))
+                status = H2ColumnarAppendString(column, NULL, 0);
+            else
+                status = H2ColumnarAppendValue(column, descriptor.Encoding, 0);
+
+            continue;
+        }
+
+        switch (descriptor.Source)
+        {
+        case H2ColumnarSourceProcess:
+            status = H2ColumnarAppendUnicodeString(column, ProcessName->Buffer, ProcessName->Length);
+            break;
+
+        case H2ColumnarSourceProcessId:
+            status = H2ColumnarAppendValue(column, descriptor.Encoding, (ULONG_PTR)ProcessId);
+            break;
+
+        case H2ColumnarSourceHandle:
+            status = H2ColumnarAppendValue(column, descriptor.Encoding, (ULONG_PTR)HandleValue);
+            break;
+
+        case H2ColumnarSourceAddress:
+        {
+            WCHAR buffer[H2_AFD_ADDRESS_MAX_LENGTH];
+            size_t length;
+
+            if (NT_SUCCESS(H2AfdFormatAddressToBuffer((PH2_SOCKADDR_STORAGE)member, 0, buffer, ARRAYSIZE(buffer), &length)))
+                status = H2ColumnarAppendUnicodeString(column, buffer, (ULONG)(length * sizeof(WCHAR)));
+            else
+                status = H2ColumnarAppendString(column, NULL, 0);
+
+            break;
+        }
+
+        case H2ColumnarSourceRawAddress:
+        {
+            ULONG length = sizeof(SOCKADDR_STORAGE);
+
+            // Zeros at the end are implied
+            while (length > 0 && member[length - 1] == 0)
+                length--;
+
+            status = H2ColumnarAppendString(column, (PCSTR)member, length);
+            break;
+        }
+
+        case H2ColumnarSourceDevice:
+        {
+            PH2_AFD_TDI_DEVICE device = (PH2_AFD_TDI_DEVICE)member;
+
+            // Sockets without devices have no value, same as with failed queries
+            if (device->Kind == H2AfdTdiDevice)
+                status = H2ColumnarAppendUnicodeString(column, device->Name, device->NameLength);
+            else
+                status = H2ColumnarAppendString(column, NULL, 0);
+
+            break;
+        }
+
+        case H2ColumnarSourceGuid:
+        {
+            PGUID guid = (PGUID)member;
+            CHAR buffer[40];
+            LONG length;
+
+            length = sprintf_s(buffer, sizeof(buffer), "{%08lX-%04hX-%04hX-%02X%02X-%02X%02X%02X%02X%02X%02X}",
+                guid->Data1, guid->Data2, guid->Data3, guid->Data4[0], guid->Data4[1], guid->Data4[2],
+                guid->Data4[3], guid->Data4[4], guid->Data4[5], guid->Data4[6], guid->Data4[7]);
+
+            status = H2ColumnarAppendString(column, buffer, max(length, 0));
+            break;
+        }
+
+        default:
+            switch (descriptor.Size)
+            {
+            case sizeof(UCHAR):
+                value = *(PUCHAR)member;
+                break;
+            case sizeof(USHORT):
+                value = *(PUSHORT)member;
+                break;
+            case sizeof(ULONG):
+                value = *(PULONG)member;
+                break;
+            default:
+                value = *(PULONG64)member;
+            }
+
+            status = H2ColumnarAppendValue(column, descriptor.Encoding, value);
+        }
+    }
+
+    // Columns must stay the same length, so give up on the rest after a failure
+    if (NT_SUCCESS(status))
+        Writer->NumberOfRows++;
+    else
+        Writer->Status = status;
+
+    return status;
+}
+
+/**
+  * \brief Writes a buffer of any size to a file.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarWriteFile(
+    _In_ HANDLE FileHandle,
+    _In_reads_bytes_(Size) PVOID Buffer,
+    _In_ SIZE_T Size
+)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    SIZE_T written = 0;
+
+    while (written < Size && NT_SUCCESS(status))
+    {
+        ULONG chunk = (ULONG)min(Size - written, 0x40000000);
+
+        status = H2WriteFile(FileHandle, (PUCHAR)Buffer + written, chunk);
+        written += chunk;
+    }
+
+    return status;
+}
+
+/**
+  * \brief Saves the collected rows into a file.
+  *
+  * \param[in] Writer The writer.
+  * \param[in] FileName The name of the file to create or overwrite.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarSave(
+    _In_ PH2_COLUMNAR_WRITER Writer,
+    _In_ PCWSTR FileName
+)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    H2_COLUMNAR_SOURCE_DESCRIPTOR descriptor;
+    H2_COLUMNAR_BYTES metadata = { 0 };
+    PH2_COLUMNAR_HEADER header;
+    PH2_COLUMNAR_COLUMN columns;
+    CHAR name[H2_COLUMNAR_MAX_NAME];
+    ULONG64 offset;
+    ULONG64 padding = 0;
+    HANDLE fileHandle = NULL;
+
+    if (!NT_SUCCESS(Writer->Status))
+        return Writer->Status;
+
+    // Reserve the header and the column table
+    metadata.Length = sizeof(H2_COLUMNAR_HEADER) + Writer->NumberOfColumns * sizeof(H2_COLUMNAR_COLUMN);
+    metadata.Capacity = metadata.Length;
+    metadata.Buffer = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, metadata.Capacity);
+
+    if (!metadata.Buffer)
+    {
+        status = STATUS_NO_MEMORY;
+        goto CLEANUP;
+    }
+
+    // Add column names
+    for (ULONG i = 0; i < Writer->NumberOfColumns && NT_SUCCESS(status); i++)
+    {
+        columns = (PH2_COLUMNAR_COLUMN)(metadata.Buffer + sizeof(H2_COLUMNAR_HEADER));
+        columns[i].NameOffset = (ULONG)metadata.Length;
+        status = H2ColumnarAppendBytes(&metadata, name, H2ColumnarGetColumnName(i, name) + 1);
+    }
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    // Lay out the data after the names
+    offset = H2_COLUMNAR_ALIGN(metadata.Length);
+    header = (PH2_COLUMNAR_HEADER)metadata.Buffer;
+    columns = (PH2_COLUMNAR_COLUMN)(header + 1);
+
+    for (ULONG i = 0; i < Writer->NumberOfColumns; i++)
+    {
+        PH2_COLUMNAR_COLUMN_STATE column = &Writer->Columns[i];
+
+        H2ColumnarGetColumn(i, &descriptor);
+        columns[i].Encoding = (USHORT)descriptor.Encoding;
+        columns[i].ValueSize = H2_COLUMNAR_IS_DICTIONARY(descriptor.Encoding) ? 0 : (USHORT)descriptor.Size;
+        columns[i].DataOffset = offset;
+        columns[i].DataSize = column->Data.Length;
+
+        if (H2_COLUMNAR_IS_DICTIONARY(descriptor.Encoding))
+            columns[i].DataSize = H2_COLUMNAR_ALIGN(column->Data.Length) + 2 * sizeof(ULONG) +
+                column->Dictionary.Offsets.Length + column->Dictionary.Strings.Length;
+
+        offset = H2_COLUMNAR_ALIGN(offset + columns[i].DataSize);
+    }
+
+    header->Magic = H2_COLUMNAR_MAGIC;
+    header->Version = H2_COLUMNAR_VERSION;
+    header->HeaderSize = sizeof(H2_COLUMNAR_HEADER);
+    header->NumberOfColumns = Writer->NumberOfColumns;
+    header->ColumnSize = sizeof(H2_COLUMNAR_COLUMN);
+    header->NumberOfRows = Writer->NumberOfRows;
+    header->Timestamp = Writer->Timestamp;
+
+    status = H2OpenFile(&fileHandle, FileName, FILE_WRITE_DATA, FILE_SHARE_READ, FILE_OVERWRITE_IF);
+
+    if (!NT_SUCCESS(status))
+    {
+        fileHandle = NULL;
+        goto CLEANUP;
+    }
+
+    status = H2ColumnarWriteFile(fileHandle, metadata.Buffer, metadata.Length);
+
+    if (NT_SUCCESS(status))
+        status = H2ColumnarWriteFile(fileHandle, &padding, H2_COLUMNAR_ALIGN(metadata.Length) - metadata.Length);
+
+    // Write the columns in order, each padded to 8 bytes
+    for (ULONG i = 0; i < Writer->NumberOfColumns && NT_SUCCESS(status); i++)
+    {
+        PH2_COLUMNAR_COLUMN_STATE column = &Writer->Columns[i];
+
+        status = H2ColumnarWriteFile(fileHandle, column->Data.Buffer, column->Data.Length);
+
+        if (NT_SUCCESS(status) && H2_COLUMNAR_IS_DICTIONARY(columns[i].Encoding))
+        {
+            ULONG counts[2] = { column->Dictionary.NumberOfEntries, 0 };
+
+            status = H2ColumnarWriteFile(fileHandle, &padding, H2_COLUMNAR_ALIGN(column->Data.Length) - column->Data.Length);
+
+            if (NT_SUCCESS(status))
+                status = H2ColumnarWriteFile(fileHandle, counts, sizeof(counts));
+
+            if (NT_SUCCESS(status))
+                status = H2ColumnarWriteFile(fileHandle, column->Dictionary.Offsets.Buffer, column->Dictionary.Offsets.Length);
+
+            if (NT_SUCCESS(status))
+                status = H2ColumnarWriteFile(fileHandle, column->Dictionary.Strings.Buffer, column->Dictionary.Strings.Length);
+        }
+
+        if (NT_SUCCESS(status))
+            status = H2ColumnarWriteFile(fileHandle, &padding, H2_COLUMNAR_ALIGN(columns[i].DataSize) - columns[i].DataSize);
+    }
+
+CLEANUP:
+    if (fileHandle)
+        NtClose(fileHandle);
+
+    if (metadata.Buffer)
+        RtlFreeHeap(RtlProcessHeap(), 0, metadata.Buffer);
+
+    return status;
+}
+
+/**
+  * \brief Releases the memory of a writer.
+  *
+  * \param[in,out] Writer The writer.
+  */
+VOID H2ColumnarFree(
+    _Inout_ PH2_COLUMNAR_WRITER Writer
+)
+{
+    if (Writer->Columns)
+    {
+        for (ULONG i = 0; i < Writer->NumberOfColumns; i++)
+        {
+            PH2_COLUMNAR_COLUMN_STATE column = &Writer->Columns[i];
+
+            if (column->Data.Buffer)
+                RtlFreeHeap(RtlProcessHeap(), 0, column->Data.Buffer);
+
+            if (column->Dictionary.Slots)
+                RtlFreeHeap(RtlProcessHeap(), 0, column->Dictionary.Slots);
+
+            if (column->Dictionary.Offsets.Buffer)
+                RtlFreeHeap(RtlProcessHeap(), 0, column->Dictionary.Offsets.Buffer);
+
+            if (column->Dictionary.Strings.Buffer)
+                RtlFreeHeap(RtlProcessHeap(), 0, column->Dictionary.Strings.Buffer);
+        }
+
+        RtlFreeHeap(RtlProcessHeap(), 0, Writer->Columns);
+    }
+
+    memset(Writer, 0, sizeof(H2_COLUMNAR_WRITER));
+}
+
+/**
+  * \brief Queries a single socket and saves it into a columnar file with one row.
+  *
+  * \param[in] FileName The name of the file to create.
+  * \param[in] ProcessName The image name of the process.
+  * \param[in] ProcessId The ID of the process.
+  * \param[in] HandleValue The value of the socket handle in the process.
+  * \param[in] SocketHandle A local handle to the socket.
+  * \param[in] QueryFlags A mask of H2_AFD_QUERY_* flags.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarSaveSocket(
+    _In_ PCWSTR FileName,
+    _In_ PCUNICODE_STRING ProcessName,
+    _In_ HANDLE ProcessId,
+    _In_ HANDLE HandleValue,
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG QueryFlags
+)
+{
+    NTSTATUS status;
+    H2_COLUMNAR_WRITER writer;
+    PH2_AFD_SOCKET_RECORD record;
+
+    record = RtlAllocateHeap(RtlProcessHeap(), 0, sizeof(H2_AFD_SOCKET_RECORD));
+
+    if (!record)
+        return STATUS_NO_MEMORY;
+
+    H2AfdQuerySocketRecord(SocketHandle, QueryFlags, record);
+    status = H2ColumnarInitialize(&writer);
+
+    if (NT_SUCCESS(status))
+    {
+        status = H2ColumnarAppend(&writer, ProcessName, ProcessId, HandleValue, record);
+
+        if (NT_SUCCESS(status))
+            status = H2ColumnarSave(&writer, FileName);
+
+        H2ColumnarFree(&writer);
+    }
+
+    RtlFreeHeap(RtlProcessHeap(), 0, record);
+    return status;
+}
+
+/**
+  * \brief Opens a columnar file for reading.
+  *
+  * \param[in] FileName The name of the file.
+  * \param[out] Reader The reader. The caller must release it via H2ColumnarClose.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2ColumnarOpen(
+    _In_ PCWSTR FileName,
+    _Out_ PH2_COLUMNAR_READER Reader
+)
+{
+    NTSTATUS status;
+    PVOID view;
+    SIZE_T viewSize;
+
+    memset(Reader, 0, sizeof(H2_COLUMNAR_READER));
+    status = H2MapFile(FileName, &view, &viewSize);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    status = H2ColumnarOpenView(view, viewSize, Reader);
+
+    if (!NT_SUCCESS(status))
+        H2UnmapFile(view);
+
+    return status;
+}
+
+/**
+  * \brief Unmaps a columnar file and releases the reader.
+  *
+  * \param[in,out] Reader The reader.
+  */
+VOID H2ColumnarClose(
+    _Inout_ PH2_COLUMNAR_READER Reader
+)
+{
+    H2ColumnarCloseView(Reader);
+
+    if (Reader->View)
+        H2UnmapFile((PVOID)Reader->View);
+
+    Reader->View = NULL;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _COLUMNAR_OUTPUT_H
+#define _COLUMNAR_OUTPUT_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "socket_record.h"
+#include "columnar_reader.h"
+
+// The file format and the reader are in columnar_reader.h
+
+// A growable byte array
+typedef struct _H2_COLUMNAR_BYTES
+{
+    PUCHAR Buffer;
+    SIZE_T Length;
+    SIZE_T Capacity;
+} H2_COLUMNAR_BYTES, *PH2_COLUMNAR_BYTES;
+
+// Distinct strings of a dictionary column
+typedef struct _H2_COLUMNAR_DICTIONARY
+{
+    PULONG Slots; // Open-addressed; an entry index plus one or zero when empty
+    ULONG SlotMask;
+    ULONG NumberOfEntries;
+    H2_COLUMNAR_BYTES Offsets; // ULONG per entry, plus the end
+    H2_COLUMNAR_BYTES Strings;
+} H2_COLUMNAR_DICTIONARY, *PH2_COLUMNAR_DICTIONARY;
+
+typedef struct _H2_COLUMNAR_COLUMN_STATE
+{
+    H2_COLUMNAR_BYTES Data;
+    ULONG64 Previous; // For delta encoding
+    H2_COLUMNAR_DICTIONARY Dictionary;
+} H2_COLUMNAR_COLUMN_STATE, *PH2_COLUMNAR_COLUMN_STATE;
+
+// Collects rows in memory until they are saved; not thread-safe
+typedef struct _H2_COLUMNAR_WRITER
+{
+    ULONG64 NumberOfRows;
+    LONG64 Timestamp;
+    NTSTATUS Status; // The first failure to append
+    ULONG NumberOfColumns;
+    PH2_COLUMNAR_COLUMN_STATE Columns;
+} H2_COLUMNAR_WRITER, *PH2_COLUMNAR_WRITER;
+
+NTSTATUS
+NTAPI
+H2ColumnarInitialize(
+    _Out_ PH2_COLUMNAR_WRITER Writer
+);
+
+NTSTATUS
+NTAPI
+H2ColumnarAppend(
+    _Inout_ PH2_COLUMNAR_WRITER Writer,
+    _In_ PCUNICODE_STRING ProcessName,
+    _In_ HANDLE ProcessId,
+    _In_ HANDLE HandleValue,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+);
+
+NTSTATUS
+NTAPI
+H2ColumnarSave(
+    _In_ PH2_COLUMNAR_WRITER Writer,
+    _In_ PCWSTR FileName
+);
+
+NTSTATUS
+NTAPI
+H2ColumnarSaveSocket(
+    _In_ PCWSTR FileName,
+    _In_ PCUNICODE_STRING ProcessName,
+    _In_ HANDLE ProcessId,
+    _In_ HANDLE HandleValue,
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG QueryFlags
+);
+
+VOID
+NTAPI
+H2ColumnarFree(
+    _Inout_ PH2_COLUMNAR_WRITER Writer
+);
+
+NTSTATUS
+NTAPI
+H2ColumnarOpen(
+    _In_ PCWSTR FileName,
+    _Out_ PH2_COLUMNAR_READER Reader
+);
+
+VOID
+NTAPI
+H2ColumnarClose(
+    _Inout_ PH2_COLUMNAR_READER Reader
+);
+
+#endif
@@ -0,0 +1,821 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "columnar_reader.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define H2_COLUMNAR_MEMBER_SIZE(Member) sizeof(((PH2_AFD_SOCKET_RECORD)0)->Member)
+
+#define H2_COLUMNAR_SPECIAL(Source, Encoding, Name) \
+    { Source, Encoding, Name, 0, 0, 0, 0 }
+
+#define H2_COLUMNAR_TYPED(Source, Encoding, Property, Field, Member) \
+    { Source, Encoding, NULL, H2_AFD_PROPERTY_##Property, H2_AFD_FIELD_##Field, \
+      offsetof(H2_AFD_SOCKET_RECORD, Member), H2_COLUMNAR_MEMBER_SIZE(Member) }
+
+// Fields of up to 32 bits
+#define H2_COLUMNAR_VALUE(Property, Field, Member) \
+    H2_COLUMNAR_TYPED(H2ColumnarSourceMember, H2ColumnarPlain32, Property, Field, Member)
+
+// 64-bit counters that grow over time
+#define H2_COLUMNAR_COUNTER(Property, Field, Member) \
+    H2_COLUMNAR_TYPED(H2ColumnarSourceMember, H2ColumnarDeltaVarint, Property, Field, Member)
+
+#define H2_COLUMNAR_STRING(Source, Property, Field, Member) \
+    H2_COLUMNAR_TYPED(Source, H2ColumnarDictionary, Property, Field, Member)
+
+// Values that no property shows directly but that are necessary to restore the record
+#define H2_COLUMNAR_NAMED(Source, Encoding, Name, Field, Member) \
+    { Source, Encoding, Name, 0, H2_AFD_FIELD_##Field, \
+      offsetof(H2_AFD_SOCKET_RECORD, Member), H2_COLUMNAR_MEMBER_SIZE(Member) }
+
+// Columns before the generated option and status columns. Flags that the detailed view
+// splits into booleans are only stored as a whole.
+const H2_COLUMNAR_SOURCE_DESCRIPTOR H2ColumnarFixedColumns[] =
+{
+    H2_COLUMNAR_SPECIAL(H2ColumnarSourceProcess, H2ColumnarDictionary, "process"),
+    H2_COLUMNAR_SPECIAL(H2ColumnarSourceProcessId, H2ColumnarDeltaVarint, "pid"),
+    H2_COLUMNAR_SPECIAL(H2ColumnarSourceHandle, H2ColumnarDeltaVarint, "handle"),
+    H2_COLUMNAR_NAMED(H2ColumnarSourceFlag, H2ColumnarPlain32, "options_unreliable", SHARED_INFO, OptionsUnreliable),
+    H2_COLUMNAR_VALUE(SHARED_STATE, SHARED_INFO, SharedInfo.State),
+    H2_COLUMNAR_VALUE(SHARED_ADDRESS_FAMILY, SHARED_INFO, SharedInfo.AddressFamily),
+    H2_COLUMNAR_VALUE(SHARED_SOCKET_TYPE, SHARED_INFO, SharedInfo.SocketType),
+    H2_COLUMNAR_VALUE(SHARED_PROTOCOL, SHARED_INFO, SharedInfo.Protocol),
+    H2_COLUMNAR_VALUE(SHARED_LOCAL_ADDRESS_LENGTH, SHARED_INFO, SharedInfo.LocalAddressLength),
+    H2_COLUMNAR_VALUE(SHARED_REMOTE_ADDRESS_LENGTH, SHARED_INFO, SharedInfo.RemoteAddressLength),
+    H2_COLUMNAR_VALUE(SHARED_LINGER_ONOFF, SHARED_INFO, SharedInfo.LingerInfo.l_onoff),
+    H2_COLUMNAR_VALUE(SHARED_LINGER_TIMEOUT, SHARED_INFO, SharedInfo.LingerInfo.l_linger),
+    H2_COLUMNAR_VALUE(SHARED_SEND_TIMEOUT, SHARED_INFO, SharedInfo.SendTimeout),
+    H2_COLUMNAR_VALUE(SHARED_RECEIVE_TIMEOUT, SHARED_INFO, SharedInfo.ReceiveTimeout),
+    H2_COLUMNAR_VALUE(SHARED_RECEIVE_BUFFER_SIZE, SHARED_INFO, SharedInfo.ReceiveBufferSize),
+    H2_COLUMNAR_VALUE(SHARED_SEND_BUFFER_SIZE, SHARED_INFO, SharedInfo.SendBufferSize),
+    H2_COLUMNAR_VALUE(SHARED_FLAGS, SHARED_INFO, SharedInfo.Flags),
+    H2_COLUMNAR_VALUE(SHARED_CREATION_FLAGS, SHARED_INFO, SharedInfo.CreationFlags),
+    H2_COLUMNAR_VALUE(SHARED_CATALOG_ENTRY_ID, SHARED_INFO, SharedInfo.CatalogEntryId),
+    H2_COLUMNAR_VALUE(SHARED_SERVICE_FLAGS, SHARED_INFO, SharedInfo.ServiceFlags1),
+    H2_COLUMNAR_VALUE(SHARED_PROVIDER_FLAGS, SHARED_INFO, SharedInfo.ProviderFlags),
+    H2_COLUMNAR_VALUE(SHARED_GROUP_ID, SHARED_INFO, SharedInfo.GroupID),
+    H2_COLUMNAR_VALUE(SHARED_GROUP_TYPE, SHARED_INFO, SharedInfo.GroupType),
+    H2_COLUMNAR_VALUE(SHARED_GROUP_PRIORITY, SHARED_INFO, SharedInfo.GroupPriority),
+    H2_COLUMNAR_VALUE(SHARED_LAST_ERROR, SHARED_INFO, SharedInfo.LastError),
+    H2_COLUMNAR_TYPED(H2ColumnarSourceMember, H2ColumnarPlain64, SHARED_ASYNC_SELECT_WND, SHARED_INFO, SharedInfo.AsyncSelectWnd64),
+    H2_COLUMNAR_VALUE(SHARED_ASYNC_SELECT_SERIAL_NUMBER, SHARED_INFO, SharedInfo.AsyncSelectSerialNumber),
+    H2_COLUMNAR_VALUE(SHARED_ASYNC_SELECTW_MSG, SHARED_INFO, SharedInfo.AsyncSelectwMsg),
+    H2_COLUMNAR_VALUE(SHARED_ASYNC_SELECTL_EVENT, SHARED_INFO, SharedInfo.AsyncSelectlEvent),
+    H2_COLUMNAR_VALUE(SHARED_DISABLED_ASYNC_SELECT_EVENTS, SHARED_INFO, SharedInfo.DisabledAsyncSelectEvents),
+    H2_COLUMNAR_STRING(H2ColumnarSourceGuid, SHARED_PROVIDER_ID, SHARED_INFO, SharedInfo.ProviderId),
+    H2_COLUMNAR_STRING(H2ColumnarSourceAddress, LOCAL_ADDRESS, LOCAL_ADDRESS, LocalAddress),
+    H2_COLUMNAR_STRING(H2ColumnarSourceAddress, REMOTE_ADDRESS, REMOTE_ADDRESS, RemoteAddress),
+    H2_COLUMNAR_NAMED(H2ColumnarSourceRawAddress, H2ColumnarBlobDictionary, "raw.LOCAL_ADDRESS", LOCAL_ADDRESS, LocalAddress),
+    H2_COLUMNAR_NAMED(H2ColumnarSourceRawAddress, H2ColumnarBlobDictionary, "raw.REMOTE_ADDRESS", REMOTE_ADDRESS, RemoteAddress),
+    H2_COLUMNAR_VALUE(AFD_MAX_SEND_SIZE, MAX_SEND_SIZE, MaxSendSize),
+    H2_COLUMNAR_VALUE(AFD_SENDS_PENDING, SENDS_PENDING, SendsPending),
+    H2_COLUMNAR_VALUE(AFD_MAX_PATH_SEND_SIZE, MAX_PATH_SEND_SIZE, MaxPathSendSize),
+    H2_COLUMNAR_VALUE(AFD_RECEIVE_WINDOW_SIZE, RECEIVE_WINDOW_SIZE, ReceiveWindowSize),
+    H2_COLUMNAR_VALUE(AFD_SEND_WINDOW_SIZE, SEND_WINDOW_SIZE, SendWindowSize),
+    H2_COLUMNAR_VALUE(AFD_CONNECT_TIME, CONNECT_TIME, ConnectTime),
+    H2_COLUMNAR_VALUE(AFD_GROUP_ID, GROUP_ID_AND_TYPE, GroupInfo.GroupID),
+    H2_COLUMNAR_VALUE(AFD_GROUP_TYPE, GROUP_ID_AND_TYPE, GroupInfo.GroupType),
+    H2_COLUMNAR_STRING(H2ColumnarSourceDevice, TDI_ADDRESS_DEVICE, TDI_ADDRESS_DEVICE, TdiAddressDevice),
+    H2_COLUMNAR_STRING(H2ColumnarSourceDevice, TDI_CONNECTION_DEVICE, TDI_CONNECTION_DEVICE, TdiConnectionDevice),
+    H2_COLUMNAR_NAMED(H2ColumnarSourceMember, H2ColumnarPlain32, "raw.TDI_ADDRESS_DEVICE_KIND", TDI_ADDRESS_DEVICE, TdiAddressDevice.Kind),
+    H2_COLUMNAR_NAMED(H2ColumnarSourceMember, H2ColumnarPlain32, "raw.TDI_CONNECTION_DEVICE_KIND", TDI_CONNECTION_DEVICE, TdiConnectionDevice.Kind),
+    H2_COLUMNAR_VALUE(TCP_INFO_STATE, TCP_INFO_V0, TcpInfo.State),
+    H2_COLUMNAR_VALUE(TCP_INFO_MSS, TCP_INFO_V0, TcpInfo.Mss),
+    H2_COLUMNAR_COUNTER(TCP_INFO_CONNECTION_TIME, TCP_INFO_V0, TcpInfo.ConnectionTimeMs),
+    H2_COLUMNAR_VALUE(TCP_INFO_TIMESTAMPS_ENABLED, TCP_INFO_V0, TcpInfo.TimestampsEnabled),
+    H2_COLUMNAR_VALUE(TCP_INFO_RTT, TCP_INFO_V0, TcpInfo.RttUs),
+    H2_COLUMNAR_VALUE(TCP_INFO_MINRTT, TCP_INFO_V0, TcpInfo.MinRttUs),
+    H2_COLUMNAR_VALUE(TCP_INFO_BYTES_IN_FLIGHT, TCP_INFO_V0, TcpInfo.BytesInFlight),
+    H2_COLUMNAR_VALUE(TCP_INFO_CONGESTION_WINDOW, TCP_INFO_V0, TcpInfo.Cwnd),
+    H2_COLUMNAR_VALUE(TCP_INFO_SEND_WINDOW, TCP_INFO_V0, TcpInfo.SndWnd),
+    H2_COLUMNAR_VALUE(TCP_INFO_RECEIVE_WINDOW, TCP_INFO_V0, TcpInfo.RcvWnd),
+    H2_COLUMNAR_VALUE(TCP_INFO_RECEIVE_BUFFER, TCP_INFO_V0, TcpInfo.RcvBuf),
+    H2_COLUMNAR_COUNTER(TCP_INFO_BYTES_OUT, TCP_INFO_V0, TcpInfo.BytesOut),
+    H2_COLUMNAR_COUNTER(TCP_INFO_BYTES_IN, TCP_INFO_V0, TcpInfo.BytesIn),
+    H2_COLUMNAR_VALUE(TCP_INFO_BYTES_REORDERED, TCP_INFO_V0, TcpInfo.BytesReordered),
+    H2_COLUMNAR_VALUE(TCP_INFO_BYTES_RETRANSMITTED, TCP_INFO_V0, TcpInfo.BytesRetrans),
+    H2_COLUMNAR_VALUE(TCP_INFO_FAST_RETRANSMIT, TCP_INFO_V0, TcpInfo.FastRetrans),
+    H2_COLUMNAR_VALUE(TCP_INFO_DUPLICATE_ACKS_IN, TCP_INFO_V0, TcpInfo.DupAcksIn),
+    H2_COLUMNAR_VALUE(TCP_INFO_TIMEOUT_EPISODES, TCP_INFO_V0, TcpInfo.TimeoutEpisodes),
+    H2_COLUMNAR_VALUE(TCP_INFO_SYN_RETRANSMITS, TCP_INFO_V0, TcpInfo.SynRetrans),
+    H2_COLUMNAR_VALUE(TCP_INFO_RECEIVER_LIMITED_TRANSITIONS, TCP_INFO_V1, TcpInfo.SndLimTransRwin),
+    H2_COLUMNAR_VALUE(TCP_INFO_RECEIVER_LIMITED_TIME, TCP_INFO_V1, TcpInfo.SndLimTimeRwin),
+    H2_COLUMNAR_COUNTER(TCP_INFO_RECEIVER_LIMITED_BYTES, TCP_INFO_V1, TcpInfo.SndLimBytesRwin),
+    H2_COLUMNAR_VALUE(TCP_INFO_CONGESTION_LIMITED_TRANSITIONS, TCP_INFO_V1, TcpInfo.SndLimTransCwnd),
+    H2_COLUMNAR_VALUE(TCP_INFO_CONGESTION_LIMITED_TIME, TCP_INFO_V1, TcpInfo.SndLimTimeCwnd),
+    H2_COLUMNAR_COUNTER(TCP_INFO_CONGESTION_LIMITED_BYTES, TCP_INFO_V1, TcpInfo.SndLimBytesCwnd),
+    H2_COLUMNAR_VALUE(TCP_INFO_SENDER_LIMITED_TRANSITIONS, TCP_INFO_V1, TcpInfo.SndLimTransSnd),
+    H2_COLUMNAR_VALUE(TCP_INFO_SENDER_LIMITED_TIME, TCP_INFO_V1, TcpInfo.SndLimTimeSnd),
+    H2_COLUMNAR_COUNTER(TCP_INFO_SENDER_LIMITED_BYTES, TCP_INFO_V1, TcpInfo.SndLimBytesSnd),
+    H2_COLUMNAR_VALUE(TCP_INFO_OUT_OF_ORDER_PACKETS, TCP_INFO_V2, TcpInfo.OutOfOrderPktsIn),
+    H2_COLUMNAR_VALUE(TCP_INFO_ECN_NEGOTIATED, TCP_INFO_V2, TcpInfo.EcnNegotiated),
+    H2_COLUMNAR_VALUE(TCP_INFO_ECE_ACKS_IN, TCP_INFO_V2, TcpInfo.EceAcksIn),
+    H2_COLUMNAR_VALUE(TCP_INFO_PTO_EPISODES, TCP_INFO_V2, TcpInfo.PtoEpisodes),
+};
+
+#define H2_COLUMNAR_NUMBER_OF_FIXED_COLUMNS (sizeof(H2ColumnarFixedColumns) / sizeof(H2ColumnarFixedColumns[0]))
+#define H2_COLUMNAR_FIRST_OPTION_COLUMN H2_COLUMNAR_NUMBER_OF_FIXED_COLUMNS
+#define H2_COLUMNAR_FIRST_STATUS_COLUMN (H2_COLUMNAR_FIRST_OPTION_COLUMN + H2_AFD_OPTION_MAX)
+
+const H2_ULONG H2ColumnarNumberOfColumns = (H2_ULONG)(H2_COLUMNAR_FIRST_STATUS_COLUMN + H2_AFD_FIELD_MAX);
+
+// Names of the record parts before the options, for status columns
+const char* const H2ColumnarFieldNames[H2_AFD_FIELD_OPTIONS] =
+{
+    "SHARED_INFO",
+    "LOCAL_ADDRESS",
+    "REMOTE_ADDRESS",
+    "MAX_SEND_SIZE",
+    "SENDS_PENDING",
+    "MAX_PATH_SEND_SIZE",
+    "RECEIVE_WINDOW_SIZE",
+    "SEND_WINDOW_SIZE",
+    "CONNECT_TIME",
+    "GROUP_ID_AND_TYPE",
+    "TDI_ADDRESS_DEVICE",
+    "TDI_CONNECTION_DEVICE",
+    "TCP_INFO_V0",
+    "TCP_INFO_V1",
+    "TCP_INFO_V2",
+};
+
+/**
+  * \brief Describes where a column takes its values from, including generated columns.
+  *
+  * \param[in] Column The index of the column.
+  * \param[out] Descriptor The descriptor of the column.
+  */
+void H2ColumnarGetColumn(
+    _In_ H2_ULONG Column,
+    _Out_ PH2_COLUMNAR_SOURCE_DESCRIPTOR Descriptor
+)
+{
+    if (Column < H2_COLUMNAR_FIRST_OPTION_COLUMN)
+    {
+        *Descriptor = H2ColumnarFixedColumns[Column];
+    }
+    else if (Column < H2_COLUMNAR_FIRST_STATUS_COLUMN)
+    {
+        H2_ULONG option = (H2_ULONG)(Column - H2_COLUMNAR_FIRST_OPTION_COLUMN);
+
+        Descriptor->Source = H2ColumnarSourceOption;
+        Descriptor->Encoding = H2ColumnarPlain32;
+        Descriptor->Name = NULL;
+        Descriptor->Property = H2AfdOptionDescriptors[option].Property;
+        Descriptor->Field = H2_AFD_OPTION_FIELD(option);
+        Descriptor->Offset = (H2_ULONG)(offsetof(H2_AFD_SOCKET_RECORD, Options) + option * sizeof(H2_ULONG));
+        Descriptor->Size = sizeof(H2_ULONG);
+    }
+    else
+    {
+        H2_ULONG field = (H2_ULONG)(Column - H2_COLUMNAR_FIRST_STATUS_COLUMN);
+
+        Descriptor->Source = H2ColumnarSourceStatus;
+        Descriptor->Encoding = H2ColumnarPlain32;
+        Descriptor->Name = NULL;
+        Descriptor->Property = field >= H2_AFD_FIELD_OPTIONS ? H2AfdOptionDescriptors[field - H2_AFD_FIELD_OPTIONS].Property : 0;
+        Descriptor->Field = (H2_AFD_FIELD)field;
+        Descriptor->Offset = (H2_ULONG)(offsetof(H2_AFD_SOCKET_RECORD, Status) + field * sizeof(H2_STATUS));
+        Descriptor->Size = sizeof(H2_STATUS);
+    }
+}
+
+/**
+  * \brief Determines the name of a column.
+  *
+  * \param[in] Column The index of the column.
+  * \param[out] Buffer A buffer that receives the zero-terminated ASCII name.
+  *
+  * \return The length of the name in bytes, without the terminator.
+  */
+H2_ULONG H2ColumnarGetColumnName(
+    _In_ H2_ULONG Column,
+    _Out_writes_z_(H2_COLUMNAR_MAX_NAME) char* Buffer
+)
+{
+    H2_COLUMNAR_SOURCE_DESCRIPTOR descriptor;
+    const char* name;
+    H2_ULONG length = 0;
+
+    H2ColumnarGetColumn(Column, &descriptor);
+
+    if (descriptor.Source == H2ColumnarSourceStatus)
+    {
+        memcpy(Buffer, "status.", sizeof("status.") - 1);
+        length = sizeof("status.") - 1;
+
+        if (descriptor.Field >= H2_AFD_FIELD_OPTIONS)
+            name = H2AfdGetPropertyKey(descriptor.Property);
+        else
+            name = H2ColumnarFieldNames[descriptor.Field];
+    }
+    else
+    {
+        name = descriptor.Name ? descriptor.Name : H2AfdGetPropertyKey(descriptor.Property);
+    }
+
+    for (; *name && length < H2_COLUMNAR_MAX_NAME - 1; name++)
+        Buffer[length++] = *name;
+
+    Buffer[length] = '\0';
+    return length;
+}
+
+/**
+  * \brief Reads a little-endian ULONG from a possibly unaligned location.
+  *
+  * \return The value.
+  */
+H2_ULONG H2ColumnarReadUlong(
+    _In_reads_bytes_(sizeof(H2_ULONG)) const H2_UCHAR* Data
+)
+{
+    return (H2_ULONG)Data[0] | (H2_ULONG)Data[1] << 8 | (H2_ULONG)Data[2] << 16 | (H2_ULONG)Data[3] << 24;
+}
+
+/**
+  * \brief Reads a little-endian ULONG64 from a possibly unaligned location.
+  *
+  * \return The value.
+  */
+H2_ULONG64 H2ColumnarReadUlong64(
+    _In_reads_bytes_(sizeof(H2_ULONG64)) const H2_UCHAR* Data
+)
+{
+    return (H2_ULONG64)H2ColumnarReadUlong(Data) | (H2_ULONG64)H2ColumnarReadUlong(Data + 4) << 32;
+}
+
+/**
+  * \brief Checks a column of a mapped file and matches it to a known column.
+  *
+  * \param[in] Reader The reader with the mapped file.
+  * \param[in] Entry The column table entry.
+  * \param[out] Column The state for reading the column.
+  *
+  * \return Successful or errant status.
+  */
+H2_STATUS H2ColumnarOpenColumn(
+    _In_ PH2_COLUMNAR_READER Reader,
+    _In_ PH2_COLUMNAR_COLUMN Entry,
+    _Out_ PH2_COLUMNAR_READER_COLUMN Column
+)
+{
+    H2_COLUMNAR_SOURCE_DESCRIPTOR descriptor;
+    char name[H2_COLUMNAR_MAX_NAME];
+    const char* fileName;
+    H2_ULONG nameLength = 0;
+    H2_ULONG64 indexSize;
+
+    memset(Column, 0, sizeof(H2_COLUMNAR_READER_COLUMN));
+    Column->Column = H2_COLUMNAR_NO_ENTRY;
+
+    if (Entry->NameOffset >= Reader->ViewSize ||
+        Entry->DataOffset > Reader->ViewSize ||
+        Entry->DataSize > Reader->ViewSize - Entry->DataOffset)
+        return H2_STATUS_FILE_CORRUPT_ERROR;
+
+    fileName = (const char*)Reader->View + Entry->NameOffset;
+
+    // Longer names cannot match any known column
+    while (Entry->NameOffset + nameLength < Reader->ViewSize && fileName[nameLength] && nameLength < H2_COLUMNAR_MAX_NAME)
+        nameLength++;
+
+    Column->Name = fileName;
+    Column->NameLength = nameLength;
+    Column->Encoding = (H2_COLUMNAR_ENCODING)Entry->Encoding;
+    Column->Data = Reader->View + Entry->DataOffset;
+    Column->DataSize = Entry->DataSize;
+
+    switch (Entry->Encoding)
+    {
+    case H2ColumnarPlain32:
+        if (Entry->DataSize < Reader->NumberOfRows * sizeof(H2_ULONG))
+            return H2_STATUS_FILE_CORRUPT_ERROR;
+        break;
+
+    case H2ColumnarPlain64:
+        if (Entry->DataSize < Reader->NumberOfRows * sizeof(H2_ULONG64))
+            return H2_STATUS_FILE_CORRUPT_ERROR;
+        break;
+
+    case H2ColumnarDeltaVarint:
+        // Checked while decoding
+        break;
+
+    case H2ColumnarDictionary:
+    case H2ColumnarBlobDictionary:
+        indexSize = H2_COLUMNAR_ALIGN(Reader->NumberOfRows * sizeof(H2_ULONG));
+
+        if (Entry->DataSize < indexSize + 2 * sizeof(H2_ULONG))
+            return H2_STATUS_FILE_CORRUPT_ERROR;
+
+        Column->NumberOfEntries = H2ColumnarReadUlong(Column->Data + indexSize);
+
+        if ((Entry->DataSize - indexSize - 2 * sizeof(H2_ULONG)) / sizeof(H2_ULONG) <= Column->NumberOfEntries)
+            return H2_STATUS_FILE_CORRUPT_ERROR;
+
+        // Offsets are checked on use
+        Column->Offsets = Column->Data + indexSize + 2 * sizeof(H2_ULONG);
+        Column->Strings = Column->Offsets + ((H2_ULONG64)Column->NumberOfEntries + 1) * sizeof(H2_ULONG);
+        Column->StringsSize = (H2_ULONG)(Entry->DataSize - (H2_ULONG64)(Column->Strings - Column->Data) < 0xFFFFFFFF ?
+            Entry->DataSize - (H2_ULONG64)(Column->Strings - Column->Data) : 0xFFFFFFFF);
+        break;
+
+    default:
+        // Columns in encodings from newer versions are ignored
+        return H2_STATUS_SUCCESS;
+    }
+
+    for (H2_ULONG i = 0; i < H2ColumnarNumberOfColumns; i++)
+    {
+        if (H2ColumnarGetColumnName(i, name) != nameLength || memcmp(name, fileName, nameLength) != 0)
+            continue;
+
+        H2ColumnarGetColumn(i, &descriptor);
+
+        // Columns with a different layout are ignored as well
+        if (descriptor.Encoding == Column->Encoding &&
+            (H2_COLUMNAR_IS_DICTIONARY(descriptor.Encoding) || descriptor.Size == Entry->ValueSize))
+            Column->Column = i;
+
+        break;
+    }
+
+    return H2_STATUS_SUCCESS;
+}
+
+/**
+  * \brief Starts reading a columnar file that is already in memory.
+  *
+  * \param[in] View The contents of the file. It must stay valid until the reader is closed.
+  * \param[in] ViewSize The size of the file in bytes.
+  * \param[out] Reader The reader. The caller must release it via H2ColumnarCloseView.
+  *
+  * \return Successful or errant status.
+  */
+H2_STATUS H2ColumnarOpenView(
+    _In_reads_bytes_(ViewSize) const void* View,
+    _In_ size_t ViewSize,
+    _Out_ PH2_COLUMNAR_READER Reader
+)
+{
+    H2_STATUS status = H2_STATUS_SUCCESS;
+    H2_COLUMNAR_SOURCE_DESCRIPTOR descriptor;
+    H2_COLUMNAR_HEADER header;
+    H2_COLUMNAR_COLUMN entry;
+
+    memset(Reader, 0, sizeof(H2_COLUMNAR_READER));
+    Reader->View = View;
+    Reader->ViewSize = ViewSize;
+    Reader->ProcessNameIndex = H2_COLUMNAR_NO_ENTRY;
+
+    if (ViewSize < sizeof(H2_COLUMNAR_HEADER))
+        return H2_STATUS_FILE_INVALID;
+
+    memcpy(&header, View, sizeof(H2_COLUMNAR_HEADER));
+
+    if (header.Magic != H2_COLUMNAR_MAGIC)
+        return H2_STATUS_FILE_INVALID;
+
+    if (header.Version != H2_COLUMNAR_VERSION)
+        return H2_STATUS_REVISION_MISMATCH;
+
+    // Every row takes at least a byte in each column
+    if (header.HeaderSize < sizeof(H2_COLUMNAR_HEADER) ||
+        header.HeaderSize > ViewSize ||
+        header.ColumnSize < sizeof(H2_COLUMNAR_COLUMN) ||
+        (H2_ULONG64)header.NumberOfColumns * header.ColumnSize > ViewSize - header.HeaderSize ||
+        header.NumberOfRows > ViewSize)
+        return H2_STATUS_FILE_CORRUPT_ERROR;
+
+    Reader->NumberOfRows = header.NumberOfRows;
+    Reader->Timestamp = header.Timestamp;
+    Reader->NumberOfColumns = header.NumberOfColumns;
+    Reader->Columns = malloc((header.NumberOfColumns ? header.NumberOfColumns : 1) * sizeof(H2_COLUMNAR_READER_COLUMN));
+
+    if (!Reader->Columns)
+        return H2_STATUS_NO_MEMORY;
+
+    for (H2_ULONG i = 0; i < Reader->NumberOfColumns; i++)
+    {
+        PH2_COLUMNAR_READER_COLUMN column = &Reader->Columns[i];
+
+        // Entries are not necessarily aligned
+        memcpy(&entry, Reader->View + header.HeaderSize + (size_t)i * header.ColumnSize, sizeof(H2_COLUMNAR_COLUMN));
+        status = H2ColumnarOpenColumn(Reader, &entry, column);
+
+        if (!H2_SUCCESS(status))
+            goto CLEANUP;
+
+        if (column->Column == H2_COLUMNAR_NO_ENTRY)
+            continue;
+
+        H2ColumnarGetColumn(column->Column, &descriptor);
+
+        if (descriptor.Source == H2ColumnarSourceProcess)
+            Reader->ProcessColumn = column;
+        else if (descriptor.Source == H2ColumnarSourceProcessId)
+            Reader->ProcessIdColumn = column;
+        else if (descriptor.Source == H2ColumnarSourceHandle)
+            Reader->HandleColumn = column;
+    }
+
+    // Rows are meaningless without the owner
+    if (!Reader->ProcessColumn || !Reader->ProcessIdColumn || !Reader->HandleColumn)
+        status = H2_STATUS_FILE_CORRUPT_ERROR;
+
+CLEANUP:
+    if (!H2_SUCCESS(status))
+        H2ColumnarCloseView(Reader);
+
+    return status;
+}
+
+/**
+  * \brief Retrieves the value of a numeric or dictionary column in the current row.
+  *
+  * \return The value or the index of the dictionary entry.
+  */
+H2_ULONG64 H2ColumnarGetValue(
+    _In_ PH2_COLUMNAR_READER Reader,
+    _In_ PH2_COLUMNAR_READER_COLUMN Column
+)
+{
+    switch (Column->Encoding)
+    {
+    case H2ColumnarPlain64:
+        return H2ColumnarReadUlong64(Column->Data + (Reader->Row - 1) * sizeof(H2_ULONG64));
+
+    case H2ColumnarDeltaVarint:
+        return Column->Value;
+
+    default:
+        return H2ColumnarReadUlong(Column->Data + (Reader->Row - 1) * sizeof(H2_ULONG));
+    }
+}
+
+/**
+  * \brief Locates the dictionary entry of a column in the current row.
+  *
+  * \param[in] Reader The reader.
+  * \param[in] Column The dictionary column.
+  * \param[out] Entry Receives the entry or NULL if the row has no value.
+  * \param[out] Length Receives the length of the entry in bytes.
+  *
+  * \return Successful or errant status.
+  */
+H2_STATUS H2ColumnarGetEntry(
+    _In_ PH2_COLUMNAR_READER Reader,
+    _In_ PH2_COLUMNAR_READER_COLUMN Column,
+    _Outptr_result_bytebuffer_maybenull_(*Length) const H2_UCHAR** Entry,
+    _Out_ H2_ULONG* Length
+)
+{
+    H2_ULONG index = (H2_ULONG)H2ColumnarGetValue(Reader, Column);
+    H2_ULONG start;
+    H2_ULONG end;
+
+    *Entry = NULL;
+    *Length = 0;
+
+    if (index == H2_COLUMNAR_NO_ENTRY)
+        return H2_STATUS_SUCCESS;
+
+    if (index >= Column->NumberOfEntries)
+        return H2_STATUS_FILE_CORRUPT_ERROR;
+
+    start = H2ColumnarReadUlong(Column->Offsets + (size_t)index * sizeof(H2_ULONG));
+    end = H2ColumnarReadUlong(Column->Offsets + ((size_t)index + 1) * sizeof(H2_ULONG));
+
+    if (start > end || end > Column->StringsSize)
+        return H2_STATUS_FILE_CORRUPT_ERROR;
+
+    *Entry = Column->Strings + start;
+    *Length = end - start;
+    return H2_STATUS_SUCCESS;
+}
+
+/**
+  * \brief Moves to the next row and retrieves its owner.
+  *
+  * \param[in,out] Reader The reader.
+  * \param[out] ProcessName Receives the UTF-8 image name of the process, without a terminator.
+  *  The string is valid until the reader is closed.
+  * \param[out] ProcessNameLength Receives the length of the name in bytes.
+  * \param[out] ProcessId Receives the ID of the process.
+  * \param[out] HandleValue Receives the value of the socket handle in the process.
+  *
+  * \return Successful or errant status. H2_STATUS_NO_MORE_ENTRIES indicates the end of the file.
+  */
+H2_STATUS H2ColumnarReadRow(
+    _Inout_ PH2_COLUMNAR_READER Reader,
+    _Out_ const char** ProcessName,
+    _Out_ H2_ULONG* ProcessNameLength,
+    _Out_ H2_ULONG64* ProcessId,
+    _Out_ H2_ULONG64* HandleValue
+)
+{
+    H2_STATUS status;
+    const H2_UCHAR* entry;
+    H2_ULONG length;
+
+    if (Reader->Row >= Reader->NumberOfRows)
+        return H2_STATUS_NO_MORE_ENTRIES;
+
+    Reader->Row++;
+
+    // Delta columns can only be decoded in order, even if the caller skips the row
+    for (H2_ULONG i = 0; i < Reader->NumberOfColumns; i++)
+    {
+        PH2_COLUMNAR_READER_COLUMN column = &Reader->Columns[i];
+        H2_ULONG64 zigzag = 0;
+        H2_ULONG shift = 0;
+        H2_UCHAR byte;
+
+        if (column->Encoding != H2ColumnarDeltaVarint)
+            continue;
+
+        do
+        {
+            if (column->Position >= column->DataSize || shift > 63)
+                return H2_STATUS_FILE_CORRUPT_ERROR;
+
+            byte = column->Data[column->Position++];
+            zigzag |= (H2_ULONG64)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        column->Value += (zigzag >> 1) ^ (0 - (zigzag & 1));
+    }
+
+    status = H2ColumnarGetEntry(Reader, Reader->ProcessColumn, &entry, &length);
+
+    if (!H2_SUCCESS(status))
+        return status;
+
+    Reader->ProcessNameIndex = (H2_ULONG)H2ColumnarGetValue(Reader, Reader->ProcessColumn);
+    *ProcessName = entry ? (const char*)entry : "";
+    *ProcessNameLength = length;
+    *ProcessId = H2ColumnarGetValue(Reader, Reader->ProcessIdColumn);
+    *HandleValue = H2ColumnarGetValue(Reader, Reader->HandleColumn);
+    return H2_STATUS_SUCCESS;
+}
+
+/**
+  * \brief Converts UTF-8 to UTF-16 the same way as RtlUTF8ToUnicodeN: invalid sequences
+  *  become U+FFFD, and the output is truncated to the buffer.
+  *
+  * \param[out] Buffer The buffer for the UTF-16 string.
+  * \param[in] BufferLength The size of the buffer in characters.
+  * \param[in] String The UTF-8 string.
+  * \param[in] Length The length of the UTF-8 string in bytes.
+  *
+  * \return The length of the converted string in characters.
+  */
+H2_ULONG H2ColumnarConvertUtf8(
+    _Out_writes_(BufferLength) H2_WCHAR* Buffer,
+    _In_ H2_ULONG BufferLength,
+    _In_reads_bytes_(Length) const H2_UCHAR* String,
+    _In_ H2_ULONG Length
+)
+{
+    H2_ULONG written = 0;
+    H2_ULONG i = 0;
+
+    while (i < Length)
+    {
+        H2_ULONG codePoint = String[i++];
+        H2_UCHAR low = 0x80;
+        H2_UCHAR high = 0xBF;
+        H2_ULONG extra;
+
+        if (codePoint < 0x80)
+            extra = 0;
+        else if (codePoint >= 0xC2 && codePoint <= 0xDF)
+            extra = 1;
+        else if (codePoint >= 0xE0 && codePoint <= 0xEF)
+            extra = 2;
+        else if (codePoint >= 0xF0 && codePoint <= 0xF4)
+            extra = 3;
+        else
+        {
+            // A stray continuation byte or an invalid lead byte
+            extra = 0;
+            codePoint = 0xFFFD;
+        }
+
+        // Exclude overlong forms, surrogates, and values above U+10FFFF via the second byte
+        if (codePoint == 0xE0)
+            low = 0xA0;
+        else if (codePoint == 0xED)
+            high = 0x9F;
+        else if (codePoint == 0xF0)
+            low = 0x90;
+        else if (codePoint == 0xF4)
+            high = 0x8F;
+
+        if (extra)
+            codePoint &= 0x3F >> extra;
+
+        // Each maximal invalid subpart becomes one replacement character, as in RtlUTF8ToUnicodeN
+        for (; extra; extra--)
+        {
+            if (i >= Length || String[i] < low || String[i] > high)
+            {
+                codePoint = 0xFFFD;
+                break;
+            }
+
+            codePoint = codePoint << 6 | (String[i++] & 0x3F);
+            low = 0x80;
+            high = 0xBF;
+        }
+
+        if (codePoint >= 0x10000)
+        {
+            // Don't split surrogate pairs
+            if (written + 2 > BufferLength)
+                break;
+
+            codePoint -= 0x10000;
+            Buffer[written++] = (H2_WCHAR)(0xD800 | codePoint >> 10);
+            Buffer[written++] = (H2_WCHAR)(0xDC00 | (codePoint & 0x3FF));
+        }
+        else
+        {
+            if (written + 1 > BufferLength)
+                break;
+
+            Buffer[written++] = (H2_WCHAR)codePoint;
+        }
+    }
+
+    return written;
+}
+
+/**
+  * \brief Parses a GUID in the "{XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}" form.
+  *
+  * \param[in] String The string, without a terminator.
+  * \param[in] Length The length of the string in bytes.
+  * \param[out] Guid The GUID; only written on success.
+  *
+  * \return Whether the string is a well-formed GUID.
+  */
+H2_BOOLEAN H2ColumnarParseGuid(
+    _In_reads_bytes_(Length) const H2_UCHAR* String,
+    _In_ H2_ULONG Length,
+    _Out_ PH2_GUID Guid
+)
+{
+    // Positions of the hex digits of each byte, in the order of the GUID fields
+    static const H2_UCHAR positions[16] = { 1, 3, 5, 7, 10, 12, 15, 17, 20, 22, 25, 27, 29, 31, 33, 35 };
+    H2_UCHAR bytes[16];
+
+    if (Length != 38 || String[0] != '{' || String[9] != '-' || String[14] != '-' ||
+        String[19] != '-' || String[24] != '-' || String[37] != '}')
+        return FALSE;
+
+    for (H2_ULONG i = 0; i < 16; i++)
+    {
+        H2_UCHAR value = 0;
+
+        for (H2_ULONG j = 0; j < 2; j++)
+        {
+            H2_UCHAR digit = String[positions[i] + j];
+
+            if (digit >= '0' && digit <= '9')
+                value = (H2_UCHAR)(value << 4 | (digit - '0'));
+            else if ((digit | 0x20) >= 'a' && (digit | 0x20) <= 'f')
+                value = (H2_UCHAR)(value << 4 | ((digit | 0x20) - 'a' + 10));
+            else
+                return FALSE;
+        }
+
+        bytes[i] = value;
+    }
+
+    Guid->Data1 = (H2_ULONG)bytes[0] << 24 | (H2_ULONG)bytes[1] << 16 | (H2_ULONG)bytes[2] << 8 | bytes[3];
+    Guid->Data2 = (H2_USHORT)(bytes[4] << 8 | bytes[5]);
+    Guid->Data3 = (H2_USHORT)(bytes[6] << 8 | bytes[7]);
+    memcpy(Guid->Data4, bytes + 8, sizeof(Guid->Data4));
+    return TRUE;
+}
+
+/**
+  * \brief Restores the socket record of the current row.
+  *
+  * \param[in] Reader The reader after a successful call to H2ColumnarReadRow.
+  * \param[out] Record The record. Parts without columns in the file remain not queried.
+  *
+  * \return Successful or errant status.
+  */
+H2_STATUS H2ColumnarGetRecord(
+    _In_ PH2_COLUMNAR_READER Reader,
+    _Out_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_STATUS status = H2_STATUS_SUCCESS;
+    H2_COLUMNAR_SOURCE_DESCRIPTOR descriptor;
+    H2_UCHAR* member;
+    const H2_UCHAR* entry;
+    H2_ULONG length;
+    H2_ULONG64 value;
+
+    H2AfdInitializeSocketRecord(Record);
+
+    for (H2_ULONG i = 0; i < Reader->NumberOfColumns && H2_SUCCESS(status); i++)
+    {
+        PH2_COLUMNAR_READER_COLUMN column = &Reader->Columns[i];
+
+        if (column->Column == H2_COLUMNAR_NO_ENTRY)
+            continue;
+
+        H2ColumnarGetColumn(column->Column, &descriptor);
+        member = (H2_UCHAR*)Record + descriptor.Offset;
+
+        switch (descriptor.Source)
+        {
+        case H2ColumnarSourceProcess:
+        case H2ColumnarSourceProcessId:
+        case H2ColumnarSourceHandle:
+        case H2ColumnarSourceAddress:
+            // Not part of the record or restored from raw columns
+            break;
+
+        case H2ColumnarSourceRawAddress:
+            status = H2ColumnarGetEntry(Reader, column, &entry, &length);
+
+            if (H2_SUCCESS(status) && entry)
+                memcpy(member, entry, length < sizeof(H2_SOCKADDR_STORAGE) ? length : sizeof(H2_SOCKADDR_STORAGE));
+
+            break;
+
+        case H2ColumnarSourceDevice:
+        {
+            PH2_AFD_TDI_DEVICE device = (PH2_AFD_TDI_DEVICE)member;
+            H2_ULONG characters = 0;
+
+            status = H2ColumnarGetEntry(Reader, column, &entry, &length);
+
+            if (H2_SUCCESS(status) && entry)
+                characters = H2ColumnarConvertUtf8(device->Name, H2_AFD_DEVICE_NAME_LENGTH, entry, length);
+
+            device->NameLength = (H2_USHORT)(characters * sizeof(H2_WCHAR));
+            break;
+        }
+
+        case H2ColumnarSourceGuid:
+            status = H2ColumnarGetEntry(Reader, column, &entry, &length);
+
+            // Leave malformed identifiers empty
+            if (H2_SUCCESS(status) && entry)
+                H2ColumnarParseGuid(entry, length, (PH2_GUID)member);
+
+            break;
+
+        default:
+            value = H2ColumnarGetValue(Reader, column);
+
+            switch (descriptor.Size)
+            {
+            case sizeof(H2_UCHAR):
+                *(H2_UCHAR*)member = (H2_UCHAR)value;
+                break;
+            case sizeof(H2_USHORT):
+                *(H2_USHORT*)member = (H2_USHORT)value;
+                break;
+            case sizeof(H2_ULONG):
+                *(H2_ULONG*)member = (H2_ULONG)value;
+                break;
+            default:
+                *(H2_ULONG64*)member = value;
+            }
+        }
+    }
+
+    return status;
+}
+
+/**
+  * \brief Releases a reader. The caller unmaps the file.
+  *
+  * \param[in,out] Reader The reader.
+  */
+void H2ColumnarCloseView(
+    _Inout_ PH2_COLUMNAR_READER Reader
+)
+{
+    free(Reader->Columns);
+    Reader->Columns = NULL;
+    Reader->NumberOfColumns = 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _COLUMNAR_READER_H
+#define _COLUMNAR_READER_H
+
+#include "portable_types.h"
+#include "socket_layout.h"
+
+//
+// The columnar format stores one row per socket handle and one column per record value, so
+// readers can map the file and scan the columns they need. All integers are little-endian.
+// The file starts with H2_COLUMNAR_HEADER, followed by an array of H2_COLUMNAR_COLUMN entries,
+// their names (UTF-8, zero-terminated), and the data of each column at an 8-byte aligned offset.
+//
+// Column names are the property identifiers (such as SHARED_STATE or TCP_INFO_RTT) and the
+// "process", "pid", and "handle" columns. Columns named "status.<FIELD>" hold the NTSTATUS of
+// each independently queried part of the record; values of parts that failed are zero.
+// Columns named "raw.<NAME>" keep what text columns cannot restore, such as the SOCKADDR
+// bytes of addresses (without trailing zeros).
+// Numeric values are the bits of the underlying field, zero-extended to the column width.
+//
+// The reader below only depends on the C runtime, so the format can be read (and checked
+// against the Windows writer) on any system.
+//
+
+#define H2_COLUMNAR_MAGIC 0x4C433248 // "H2CL"
+#define H2_COLUMNAR_VERSION 1
+
+// The index in dictionary columns for rows without a value
+#define H2_COLUMNAR_NO_ENTRY 0xFFFFFFFF
+
+typedef enum _H2_COLUMNAR_ENCODING
+{
+    // ULONG per row
+    H2ColumnarPlain32 = 1,
+
+    // ULONG64 per row
+    H2ColumnarPlain64 = 2,
+
+    // The difference from the value in the previous row (or zero for the first row), zigzag-encoded
+    // as a signed 64-bit integer and stored in 7-bit groups, low first, with the high bit set on
+    // all but the last byte
+    H2ColumnarDeltaVarint = 3,
+
+    // ULONG per row with an index of a string (or H2_COLUMNAR_NO_ENTRY), padded to 8 bytes, followed
+    // by a ULONG with the number of strings, a reserved ULONG, a ULONG offset of each string plus
+    // the end offset, and the UTF-8 strings without terminators
+    H2ColumnarDictionary = 4,
+
+    // Same as H2ColumnarDictionary, but with binary entries
+    H2ColumnarBlobDictionary = 5,
+} H2_COLUMNAR_ENCODING;
+
+typedef struct _H2_COLUMNAR_HEADER
+{
+    H2_ULONG Magic;
+    H2_USHORT Version;
+    H2_USHORT HeaderSize; // Readers should skip unknown trailing fields
+    H2_ULONG NumberOfColumns;
+    H2_ULONG ColumnSize; // The size of each H2_COLUMNAR_COLUMN entry
+    H2_ULONG64 NumberOfRows;
+    H2_LONG64 Timestamp; // The system time of the inspection
+} H2_COLUMNAR_HEADER, *PH2_COLUMNAR_HEADER;
+
+typedef struct _H2_COLUMNAR_COLUMN
+{
+    H2_ULONG NameOffset; // From the start of the file
+    H2_USHORT Encoding; // H2_COLUMNAR_ENCODING
+    H2_USHORT ValueSize; // The size of the underlying field in bytes; zero for dictionaries
+    H2_ULONG64 DataOffset; // From the start of the file
+    H2_ULONG64 DataSize;
+} H2_COLUMNAR_COLUMN, *PH2_COLUMNAR_COLUMN;
+
+#define H2_COLUMNAR_ALIGN(Value) (((Value) + 7) & ~(H2_ULONG64)7)
+
+#define H2_COLUMNAR_IS_DICTIONARY(Encoding) \
+    ((Encoding) == H2ColumnarDictionary || (Encoding) == H2ColumnarBlobDictionary)
+
+// The size of a buffer for column names, in bytes
+#define H2_COLUMNAR_MAX_NAME 0x80
+
+/* Known columns */
+
+typedef enum _H2_COLUMNAR_SOURCE
+{
+    H2ColumnarSourceProcess,
+    H2ColumnarSourceProcessId,
+    H2ColumnarSourceHandle,
+    H2ColumnarSourceFlag, // A numeric member of the record that is always valid
+    H2ColumnarSourceMember, // A numeric member of the record
+    H2ColumnarSourceAddress, // A SOCKADDR_STORAGE member, as text
+    H2ColumnarSourceRawAddress, // A SOCKADDR_STORAGE member, as bytes
+    H2ColumnarSourceDevice, // An H2_AFD_TDI_DEVICE member, as text
+    H2ColumnarSourceGuid, // A GUID member, as text
+    H2ColumnarSourceOption, // Generated for each H2_AFD_OPTION
+    H2ColumnarSourceStatus, // Generated for each H2_AFD_FIELD
+} H2_COLUMNAR_SOURCE;
+
+typedef struct _H2_COLUMNAR_SOURCE_DESCRIPTOR
+{
+    H2_COLUMNAR_SOURCE Source;
+    H2_COLUMNAR_ENCODING Encoding;
+    const char* Name; // NULL to use the property key
+    H2_AFD_PROPERTY Property;
+    H2_AFD_FIELD Field; // The part of the record that holds the value
+    H2_ULONG Offset;
+    H2_ULONG Size;
+} H2_COLUMNAR_SOURCE_DESCRIPTOR, *PH2_COLUMNAR_SOURCE_DESCRIPTOR;
+
+typedef const H2_COLUMNAR_SOURCE_DESCRIPTOR *PCH2_COLUMNAR_SOURCE_DESCRIPTOR;
+
+// The number of columns the writer produces and the reader recognizes
+extern const H2_ULONG H2ColumnarNumberOfColumns;
+
+/* Reader */
+
+// A column of a mapped file
+typedef struct _H2_COLUMNAR_READER_COLUMN
+{
+    H2_ULONG Column; // The matching known column or H2_COLUMNAR_NO_ENTRY if unknown
+    H2_COLUMNAR_ENCODING Encoding;
+    const char* Name; // Not terminated
+    H2_ULONG NameLength;
+    const H2_UCHAR* Data;
+    H2_ULONG64 DataSize;
+    H2_ULONG64 Position; // The next byte to decode, for delta encoding
+    H2_ULONG64 Value; // The value in the current row, for delta encoding
+    const H2_UCHAR* Offsets; // ULONG per entry plus the end, for dictionaries
+    const H2_UCHAR* Strings;
+    H2_ULONG NumberOfEntries;
+    H2_ULONG StringsSize;
+} H2_COLUMNAR_READER_COLUMN, *PH2_COLUMNAR_READER_COLUMN;
+
+// Reads rows of a mapped file in order; not thread-safe
+typedef struct _H2_COLUMNAR_READER
+{
+    const H2_UCHAR* View;
+    size_t ViewSize;
+    H2_ULONG64 NumberOfRows;
+    H2_ULONG64 Row; // The current row, starting from one after the first read
+    H2_LONG64 Timestamp;
+    H2_ULONG NumberOfColumns;
+    PH2_COLUMNAR_READER_COLUMN Columns;
+    PH2_COLUMNAR_READER_COLUMN ProcessColumn;
+    PH2_COLUMNAR_READER_COLUMN ProcessIdColumn;
+    PH2_COLUMNAR_READER_COLUMN HandleColumn;
+    H2_ULONG ProcessNameIndex; // The dictionary entry of the process name in the current row
+} H2_COLUMNAR_READER, *PH2_COLUMNAR_READER;
+
+void
+H2ColumnarGetColumn(
+    _In_ H2_ULONG Column,
+    _Out_ PH2_COLUMNAR_SOURCE_DESCRIPTOR Descriptor
+);
+
+H2_ULONG
+H2ColumnarGetColumnName(
+    _In_ H2_ULONG Column,
+    _Out_writes_z_(H2_COLUMNAR_MAX_NAME) char* Buffer
+);
+
+H2_STATUS
+H2ColumnarOpenView(
+    _In_reads_bytes_(ViewSize) const void* View,
+    _In_ size_t ViewSize,
+    _Out_ PH2_COLUMNAR_READER Reader
+);
+
+H2_STATUS
+H2ColumnarReadRow(
+    _Inout_ PH2_COLUMNAR_READER Reader,
+    _Out_ const char** ProcessName,
+    _Out_ H2_ULONG* ProcessNameLength,
+    _Out_ H2_ULONG64* ProcessId,
+    _Out_ H2_ULONG64* HandleValue
+);
+
+H2_ULONG64
+H2ColumnarGetValue(
+    _In_ PH2_COLUMNAR_READER Reader,
+    _In_ PH2_COLUMNAR_READER_COLUMN Column
+);
+
+H2_STATUS
+H2ColumnarGetEntry(
+    _In_ PH2_COLUMNAR_READER Reader,
+    _In_ PH2_COLUMNAR_READER_COLUMN Column,
+    _Outptr_result_bytebuffer_maybenull_(*Length) const H2_UCHAR** Entry,
+    _Out_ H2_ULONG* Length
+);
+
+H2_ULONG
+H2ColumnarConvertUtf8(
+    _Out_writes_(BufferLength) H2_WCHAR* Buffer,
+    _In_ H2_ULONG BufferLength,
+    _In_reads_bytes_(Length) const H2_UCHAR* String,
+    _In_ H2_ULONG Length
+);
+
+H2_STATUS
+H2ColumnarGetRecord(
+    _In_ PH2_COLUMNAR_READER Reader,
+    _Out_ PH2_AFD_SOCKET_RECORD Record
+);
+
+void
+H2ColumnarCloseView(
+    _Inout_ PH2_COLUMNAR_READER Reader
+);
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "file_helpers.h"
+
+/**
+  * \brief Opens or creates a file by its Win32 name for synchronous I/O.
+  *
+  * \param[out] FileHandle A variable that receives the file handle.
+  * \param[in] FileName The Win32 name of the file.
+  * \param[in] DesiredAccess The access to request.
+  * \param[in] ShareAccess The sharing mode.
+  * \param[in] CreateDisposition What to do if the file exists or doesn't exist.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2OpenFile(
+    _Out_ PHANDLE FileHandle,
+    _In_ PCWSTR FileName,
+    _In_ ACCESS_MASK DesiredAccess,
+    _In_ ULONG ShareAccess,
+    _In_ ULONG CreateDisposition
+)
+{
+    NTSTATUS status;
+    UNICODE_STRING ntName;
+    OBJECT_ATTRIBUTES objAttr;
+    IO_STATUS_BLOCK ioStatusBlock;
+
+    status = RtlDosPathNameToNtPathName_U_WithStatus(FileName, &ntName, NULL, NULL);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    InitializeObjectAttributes(&objAttr, &ntName, OBJ_CASE_INSENSITIVE, NULL, NULL);
+
+    status = NtCreateFile(
+        FileHandle,
+        DesiredAccess | SYNCHRONIZE,
+        &objAttr,
+        &ioStatusBlock,
+        NULL,
+        FILE_ATTRIBUTE_NORMAL,
+        ShareAccess,
+        CreateDisposition,
+        FILE_SYNCHRONOUS_IO_NONALERT | FILE_NON_DIRECTORY_FILE,
+        NULL,
+        0
+    );
+
+    RtlFreeUnicodeString(&ntName);
+    return status;
+}
+
+/**
+  * \brief Appends data to a file opened for synchronous I/O.
+  *
+  * \param[in] FileHandle The file handle with FILE_WRITE_DATA access.
+  * \param[in] Buffer The data.
+  * \param[in] Size The size of the data.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2WriteFile(
+    _In_ HANDLE FileHandle,
+    _In_reads_bytes_(Size) PVOID Buffer,
+    _In_ ULONG Size
+)
+{
+    IO_STATUS_BLOCK ioStatusBlock;
+
+    if (!Size)
+        return STATUS_SUCCESS;
+
+    return NtWriteFile(FileHandle, NULL, NULL, NULL, &ioStatusBlock, Buffer, Size, NULL, NULL);
+}
+
+/**
+  * \brief Maps an entire file into memory for reading.
+  *
+  * \param[in] FileName The Win32 name of the file.
+  * \param[out] View A variable that receives the address of the mapping. The caller must release it via H2UnmapFile.
+  * \param[out] FileSize A variable that receives the size of the file.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2MapFile(
+    _In_ PCWSTR FileName,
+    _Outptr_result_bytebuffer_(*FileSize) PVOID* View,
+    _Out_ PSIZE_T FileSize
+)
+{
+    NTSTATUS status;
+    HANDLE fileHandle;
+    HANDLE sectionHandle = NULL;
+    FILE_STANDARD_INFORMATION fileInfo;
+    IO_STATUS_BLOCK ioStatusBlock;
+    PVOID view = NULL;
+    SIZE_T viewSize = 0;
+
+    status = H2OpenFile(&fileHandle, FileName, FILE_READ_DATA, FILE_SHARE_READ, FILE_OPEN);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    status = NtQueryInformationFile(fileHandle, &ioStatusBlock, &fileInfo, sizeof(fileInfo), FileStandardInformation);
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    // Empty files cannot be mapped
+    if (fileInfo.EndOfFile.QuadPart == 0 || (ULONG64)fileInfo.EndOfFile.QuadPart > MAXSIZE_T)
+    {
+        status = STATUS_FILE_INVALID;
+        goto CLEANUP;
+    }
+
+    status = NtCreateSection(&sectionHandle, SECTION_MAP_READ | SECTION_QUERY, NULL, NULL, PAGE_READONLY, SEC_COMMIT, fileHandle);
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    status = NtMapViewOfSection(sectionHandle, NtCurrentProcess(), &view, 0, 0, NULL, &viewSize, ViewUnmap, 0, PAGE_READONLY);
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    *View = view;
+    *FileSize = (SIZE_T)fileInfo.EndOfFile.QuadPart;
+
+CLEANUP:
+    if (sectionHandle)
+        NtClose(sectionHandle);
+
+    NtClose(fileHandle);
+    return status;
+}
+
+/**
+  * \brief Releases a file mapping.
+  *
+  * \param[in] View The address of the mapping from H2MapFile.
+  */
+VOID H2UnmapFile(
+    _In_ PVOID View
+)
+{
+    NtUnmapViewOfSection(NtCurrentProcess(), View);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _FILE_HELPERS_H
+#define _FILE_HELPERS_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+
+NTSTATUS
+NTAPI
+H2OpenFile(
+    _Out_ PHANDLE FileHandle,
+    _In_ PCWSTR FileName,
+    _In_ ACCESS_MASK DesiredAccess,
+    _In_ ULONG ShareAccess,
+    _In_ ULONG CreateDisposition
+);
+
+NTSTATUS
+NTAPI
+H2WriteFile(
+    _In_ HANDLE FileHandle,
+    _In_reads_bytes_(Size) PVOID Buffer,
+    _In_ ULONG Size
+);
+
+NTSTATUS
+NTAPI
+H2MapFile(
+    _In_ PCWSTR FileName,
+    _Outptr_result_bytebuffer_(*FileSize) PVOID* View,
+    _Out_ PSIZE_T FileSize
+);
+
+VOID
+NTAPI
+H2UnmapFile(
+    _In_ PVOID View
+);
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+//
+// h2cl-dump prints columnar files written by AfdSocketView --format columnar on systems
+// other than Windows. It only uses the portable reader, so its output can be compared against
+// the tool's own --analyze to check both implementations of the format.
+//
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "columnar_reader.h"
+
+// The difference between the Windows epoch (1601) and the Unix epoch (1970), in seconds
+#define H2_UNIX_EPOCH_OFFSET 11644473600LL
+
+/**
+  * \brief Names an encoding for the column listing.
+  *
+  * \return The name of the encoding.
+  */
+const char* H2DumpEncodingName(
+    _In_ H2_COLUMNAR_ENCODING Encoding
+)
+{
+    switch (Encoding)
+    {
+    case H2ColumnarPlain32:
+        return "plain32";
+    case H2ColumnarPlain64:
+        return "plain64";
+    case H2ColumnarDeltaVarint:
+        return "delta";
+    case H2ColumnarDictionary:
+        return "dictionary";
+    case H2ColumnarBlobDictionary:
+        return "blob";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+  * \brief Prints a dictionary string with tabs, line breaks, and control characters escaped.
+  */
+void H2DumpString(
+    _In_reads_bytes_(Length) const H2_UCHAR* String,
+    _In_ H2_ULONG Length
+)
+{
+    for (H2_ULONG i = 0; i < Length; i++)
+    {
+        if (String[i] == '\\')
+            fputs("\\\\", stdout);
+        else if (String[i] == '\t')
+            fputs("\\t", stdout);
+        else if (String[i] == '\n')
+            fputs("\\n", stdout);
+        else if (String[i] == '\r')
+            fputs("\\r", stdout);
+        else if (String[i] < 0x20 || String[i] == 0x7F)
+            printf("\\x%02x", String[i]);
+        else
+            putchar(String[i]);
+    }
+}
+
+/**
+  * \brief Prints the value of a column in the current row.
+  *
+  * \return Successful or errant status.
+  */
+H2_STATUS H2DumpValue(
+    _In_ PH2_COLUMNAR_READER Reader,
+    _In_ PH2_COLUMNAR_READER_COLUMN Column
+)
+{
+    H2_STATUS status;
+    const H2_UCHAR* entry;
+    H2_ULONG length;
+    H2_ULONG64 value;
+
+    switch (Column->Encoding)
+    {
+    case H2ColumnarPlain32:
+    case H2ColumnarPlain64:
+    case H2ColumnarDeltaVarint:
+        value = H2ColumnarGetValue(Reader, Column);
+
+        // Statuses are easier to look up in hex
+        if (Column->NameLength > sizeof("status.") - 1 && memcmp(Column->Name, "status.", sizeof("status.") - 1) == 0)
+            printf("0x%08X", (unsigned int)value);
+        else
+            printf("%llu", (unsigned long long)value);
+
+        return H2_STATUS_SUCCESS;
+
+    case H2ColumnarDictionary:
+    case H2ColumnarBlobDictionary:
+        status = H2ColumnarGetEntry(Reader, Column, &entry, &length);
+
+        // Rows without a value stay empty
+        if (!H2_SUCCESS(status) || !entry)
+            return status;
+
+        if (Column->Encoding == H2ColumnarDictionary)
+        {
+            H2DumpString(entry, length);
+        }
+        else
+        {
+            for (H2_ULONG i = 0; i < length; i++)
+                printf("%02x", entry[i]);
+        }
+
+        return H2_STATUS_SUCCESS;
+
+    default:
+        // Encodings from newer versions
+        return H2_STATUS_SUCCESS;
+    }
+}
+
+/**
+  * \brief Prints the columns of the file.
+  */
+void H2DumpColumns(
+    _In_ PH2_COLUMNAR_READER Reader
+)
+{
+    for (H2_ULONG i = 0; i < Reader->NumberOfColumns; i++)
+    {
+        PH2_COLUMNAR_READER_COLUMN column = &Reader->Columns[i];
+
+        printf(
+            "%.*s\t%s\t%llu\t%s\n",
+            (int)column->NameLength,
+            column->Name,
+            H2DumpEncodingName(column->Encoding),
+            (unsigned long long)column->DataSize,
+            column->Column == H2_COLUMNAR_NO_ENTRY ? "unknown" : "known"
+        );
+    }
+}
+
+/**
+  * \brief Prints all rows of the file as tab-separated values.
+  *
+  * \return Successful or errant status.
+  */
+H2_STATUS H2DumpRows(
+    _In_ PH2_COLUMNAR_READER Reader
+)
+{
+    H2_STATUS status;
+    const char* processName;
+    H2_ULONG processNameLength;
+    H2_ULONG64 processId;
+    H2_ULONG64 handleValue;
+
+    for (H2_ULONG i = 0; i < Reader->NumberOfColumns; i++)
+        printf("%s%.*s", i ? "\t" : "", (int)Reader->Columns[i].NameLength, Reader->Columns[i].Name);
+
+    putchar('\n');
+
+    while (H2_SUCCESS(status = H2ColumnarReadRow(Reader, &processName, &processNameLength, &processId, &handleValue)))
+    {
+        for (H2_ULONG i = 0; i < Reader->NumberOfColumns && H2_SUCCESS(status); i++)
+        {
+            if (i)
+                putchar('\t');
+
+            status = H2DumpValue(Reader, &Reader->Columns[i]);
+        }
+
+        if (!H2_SUCCESS(status))
+            break;
+
+        putchar('\n');
+    }
+
+    if (status == H2_STATUS_NO_MORE_ENTRIES)
+        status = H2_STATUS_SUCCESS;
+
+    return status;
+}
+
+int main(
+    _In_ int argc,
+    _In_ char* argv[]
+)
+{
+    H2_STATUS status;
+    H2_COLUMNAR_READER reader;
+    const char* fileName = NULL;
+    int listColumns = FALSE;
+    struct stat fileInfo;
+    void* view;
+    time_t seconds;
+    struct tm takenAt;
+    int fd;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-c") == 0)
+            listColumns = TRUE;
+        else if (!fileName)
+            fileName = argv[i];
+        else
+        {
+            // Only one file at a time
+            fileName = NULL;
+            break;
+        }
+    }
+
+    if (!fileName)
+    {
+        fprintf(stderr,
+            "Usage: h2cl-dump [-c] File\n"
+            "   -c: list the columns instead of the rows\n"
+            "Prints a columnar file as tab-separated values.\n"
+        );
+        return 2;
+    }
+
+    fd = open(fileName, O_RDONLY);
+
+    if (fd < 0)
+    {
+        perror(fileName);
+        return 1;
+    }
+
+    if (fstat(fd, &fileInfo) != 0)
+    {
+        perror(fileName);
+        close(fd);
+        return 1;
+    }
+
+    // Empty files cannot be mapped but are still not columnar files
+    view = fileInfo.st_size ? mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+
+    if (view == MAP_FAILED)
+    {
+        perror(fileName);
+        return 1;
+    }
+
+    status = H2ColumnarOpenView(view ? view : "", (size_t)fileInfo.st_size, &reader);
+
+    if (!H2_SUCCESS(status))
+    {
+        fprintf(stderr, "%s: cannot read the file: 0x%08X\n", fileName, (unsigned int)status);
+        goto CLEANUP;
+    }
+
+    seconds = (time_t)(reader.Timestamp / 10000000 - H2_UNIX_EPOCH_OFFSET);
+
+    if (gmtime_r(&seconds, &takenAt))
+        fprintf(stderr, "%s: %llu rows taken at %04d-%02d-%02d %02d:%02d:%02d UTC\n", fileName,
+            (unsigned long long)reader.NumberOfRows, takenAt.tm_year + 1900, takenAt.tm_mon + 1, takenAt.tm_mday,
+            takenAt.tm_hour, takenAt.tm_min, takenAt.tm_sec);
+
+    if (listColumns)
+    {
+        H2DumpColumns(&reader);
+    }
+    else
+    {
+        status = H2DumpRows(&reader);
+
+        if (!H2_SUCCESS(status))
+            fprintf(stderr, "%s: cannot read row %llu: 0x%08X\n", fileName, (unsigned long long)reader.Row, (unsigned int)status);
+    }
+
+    H2ColumnarCloseView(&reader);
+
+CLEANUP:
+    if (view)
+        munmap(view, (size_t)fileInfo.st_size);
+
+    return H2_SUCCESS(status) ? 0 : 1;
+}
@@ -17,6 +17,15 @@
 #include "printsocket.h"
 #include "string_helpers.h"
 #include "nativesocket.h"
+#include "backend.h"
+#include "simulated_backend.h"
+#include "trace_backend.h"
+#include "stats_backend.h"
+#include "timeline.h"
+#include "socket_summary.h"
+#include "columnar_output.h"
+#include "snapshot_analysis.h"
+#include "socket_watch.h"
 
 NTSTATUS wmain(
     _In_ LONG argc,
@@ -29,50 +38,190 @@ NTSTATUS wmain(
     ULONG fileHandleTypeIndex;
     PSYSTEM_PROCESS_INFORMATION processSnapshot = NULL;
     PSYSTEM_HANDLE_INFORMATION_EX handleSnapshot = NULL;
+    H2_HANDLE_INDEX handleIndex = { 0 };
     HANDLE processHandle = NULL;
     HANDLE socketHandle = NULL;
 
-    wprintf_s(L"AfdSocketView - a tool for inspecting AFD socket handles by Hunt & Hackett.\r\n\r\n");
+    status = H2ParseArguments(argc, argv, &parsedArguments);
 
-    if (!NT_SUCCESS(status = H2ParseArguments(argc, argv, &parsedArguments)))
+    // Keep machine-readable output free from decorations
+    if (!NT_SUCCESS(status) || parsedArguments.Format == H2OutputText)
+        H2Print(L"AfdSocketView - a tool for inspecting AFD socket handles by Hunt & Hackett.\r\n\r\n");
+
+    if (!NT_SUCCESS(status))
     {
-        wprintf_s(
-            L"Usage: AfdSocketView [-p [*|PID|Image name]] [-h [Handle value]] [-v]\r\n"
+        H2Print(
+            L"Usage: AfdSocketView [-p [*|PID|Image name]] [-h [Handle value]] [-v] [-j [Thread count]] [-s [Socket count]]\r\n"
+            L"                     [--exhaustive] [--stats] [--trace [File]] [--output [File]] [--format [text|jsonl|columnar]]\r\n"
+            L"                     [--cache [File]] [--record [File]] [--replay [File]] [--replay-fast [File]]\r\n"
+            L"                     [--analyze [File]] [--watch [Interval in ms]] [--rates]\r\n"
             L"   -p: selects which process(es) to inspect\r\n"
             L"   -h: show all properties for a specific handle\r\n"
             L"   -v: enable verbose output mode\r\n"
+            L"   -j: inspect processes on multiple threads\r\n"
+            L"   -s: inspect simulated sockets instead of the live system\r\n"
+            L"   --exhaustive: query all options for a specific handle, including those that cannot apply to it\r\n"
+            L"   --stats: print call counts and latency percentiles at the end of the run\r\n"
+            L"   --trace: save a timeline of the phases of the run in the Chrome trace-event format\r\n"
+            L"   --output: write the results into a UTF-8 file instead of the console\r\n"
+            L"   --format: print one JSON object per socket with all properties (jsonl) or save them into a binary\r\n"
+            L"             file with one column per property (columnar) instead of text\r\n"
+            L"   --cache: remember files that are not sockets to skip them on the next run\r\n"
+            L"   --record: save all driver requests and responses into a trace file\r\n"
+            L"   --replay: answer all requests from a trace file, reproducing the recorded latency\r\n"
+            L"   --replay-fast: answer all requests from a trace file as fast as possible\r\n"
+            L"   --analyze: print sockets from a columnar snapshot instead of the system (can be repeated)\r\n"
+            L"   --watch: rescan periodically and print opened (+), closed (-), and changed (~) sockets until Ctrl+C\r\n"
+            L"            (with -h, print the properties of the handle that changed)\r\n"
+            L"   --rates: with --watch, print the throughput, retransmissions, and limiting factors of active TCP connections\r\n"
             L"\r\n"
             L"Examples:\r\n"
             L"  AfdSocketView -p * \r\n"
             L"  AfdSocketView -p chrome.exe\r\n"
             L"  AfdSocketView -p 4812 -h 0x2c8 -v\r\n"
+            L"  AfdSocketView -p * -j 16 --cache sockets.cache\r\n"
+            L"  AfdSocketView -s 100000 -p *\r\n"
+            L"  AfdSocketView -p * --record system.trace\r\n"
+            L"  AfdSocketView -p * --replay-fast system.trace\r\n"
+            L"  AfdSocketView -p * -j 16 --stats\r\n"
+            L"  AfdSocketView -p * -j 16 --trace timeline.json\r\n"
+            L"  AfdSocketView -p * --output sockets.txt\r\n"
+            L"  AfdSocketView -p * -j 16 --format jsonl --output sockets.jsonl\r\n"
+            L"  AfdSocketView -p * -j 16 --format columnar --output sockets.h2cl\r\n"
+            L"  AfdSocketView -p chrome.exe -j 4 --analyze monday.h2cl --analyze tuesday.h2cl\r\n"
+            L"  AfdSocketView -p * -j 8 --watch 1000\r\n"
+            L"  AfdSocketView -p 4812 -h 0x2c8 --watch 1000\r\n"
+            L"  AfdSocketView -p chrome.exe -j 4 --watch 1000 --rates\r\n"
         );
+        H2FlushOutput();
         return status;
     }
 
+    // Write the results into a file if requested; columnar files are written separately
+    if (parsedArguments.OutputFileName && parsedArguments.Format != H2OutputColumnar)
+    {
+        status = H2OpenOutputFile(parsedArguments.OutputFileName);
+
+        if (!NT_SUCCESS(status))
+        {
+            H2Print(L"Unable to open the output file: ");
+            H2PrintStatusWithDescription(status);
+            H2Print(L"\r\n");
+            H2FlushOutput();
+            return status;
+        }
+    }
+
+    // Record the phases of the run if requested
+    if (parsedArguments.TimelineFileName)
+        H2TimelineStart();
+
+    // Answer all requests from a simulated driver if requested
+    if (parsedArguments.SimulatedSockets)
+    {
+        status = H2SimInitialize(parsedArguments.SimulatedSockets);
+
+        if (!NT_SUCCESS(status))
+        {
+            H2Print(L"Unable to prepare the simulation: ");
+            H2PrintStatusWithDescription(status);
+            H2Print(L"\r\n");
+            H2FlushOutput();
+            return status;
+        }
+    }
+
+    // Wrap the current backend for recording or replace it for replaying
+    if (parsedArguments.RecordFileName || parsedArguments.ReplayFileName)
+    {
+        if (parsedArguments.RecordFileName)
+            status = H2TraceStartRecording(parsedArguments.RecordFileName);
+        else
+            status = H2TraceStartReplay(parsedArguments.ReplayFileName, !parsedArguments.ReplayWithoutDelays);
+
+        if (!NT_SUCCESS(status))
+        {
+            H2Print(L"Unable to open the trace file: ");
+            H2PrintStatusWithDescription(status);
+            H2Print(L"\r\n");
+            H2FlushOutput();
+            return status;
+        }
+    }
+
+    // Measure requests to whichever backend answers them
+    if (parsedArguments.Stats)
+    {
+        status = H2StatsStart();
+
+        if (!NT_SUCCESS(status))
+        {
+            H2Print(L"Unable to collect statistics: ");
+            H2PrintStatusWithDescription(status);
+            H2Print(L"\r\n");
+            goto CLEANUP;
+        }
+    }
+
     // Try to enable the debug privilege to help accessing processes
     if (!NT_SUCCESS(status = H2EnableDebugPrivilege()) && parsedArguments.Verbose)
     {
-        wprintf_s(L"Cannot enable the debug privilege: ");
+        H2Print(L"Cannot enable the debug privilege: ");
         H2PrintStatusWithDescription(status);
-        wprintf_s(L"\r\n\r\n");
+        H2Print(L"\r\n\r\n");
     }
 
-    // Enumerate processes unless we were given a PID
-    if (!parsedArguments.ProcessId)
+    // Enumerate processes unless we were given a PID, work offline, or rescan them on every iteration
+    if (!parsedArguments.ProcessId && !parsedArguments.NumberOfSnapshots && !parsedArguments.WatchInterval)
     {
-        status = H2SnapshotProcesses(&processSnapshot);
+        H2_TIMELINE_BEGIN("Snapshot processes", 0);
+        status = H2Backend->SnapshotProcesses(&processSnapshot);
+        H2_TIMELINE_END("Snapshot processes");
 
         if (!NT_SUCCESS(status))
         {
-            wprintf_s(L"Failed to enumerate processes: ");
+            H2Print(L"Failed to enumerate processes: ");
             H2PrintStatusWithDescription(status);
-            wprintf_s(L"\r\n");
-            return status;
+            H2Print(L"\r\n");
+            goto CLEANUP;
+        }
+    }
+
+    if (parsedArguments.NumberOfSnapshots)
+    {
+        //
+        // Printing sockets from saved snapshots
+        //
+
+        H2_TIMELINE_BEGIN("Analyze snapshots", 0);
+        status = H2AnalyzeSnapshots(&parsedArguments);
+        H2_TIMELINE_END("Analyze snapshots");
+
+        if (!NT_SUCCESS(status))
+        {
+            H2Print(L"Unable to analyze snapshots: ");
+            H2PrintStatusWithDescription(status);
+            H2Print(L"\r\n");
+            goto CLEANUP;
         }
     }
+    else if (parsedArguments.WatchInterval)
+    {
+        //
+        // Printing changes to sockets over time
+        //
 
-    if (parsedArguments.HandleValue)
+        status = H2WatchSockets(&parsedArguments);
+
+        if (!NT_SUCCESS(status))
+        {
+            H2Print(L"Unable to watch sockets: ");
+            H2PrintStatusWithDescription(status);
+            H2Print(L"\r\n");
+            goto CLEANUP;
+        }
+    }
+    else if (parsedArguments.HandleValue)
     {
         PSYSTEM_PROCESS_INFORMATION process = NULL;
 
@@ -92,11 +241,11 @@ NTSTATUS wmain(
                 {
                     if (process)
                     {
-                        wprintf_s(L"Cannot inspect the handle: the filter matches more than one process.\r\n");
+                        H2Print(L"Cannot inspect the handle: the filter matches more than one process.\r\n");
 
                         if (parsedArguments.Verbose)
                         {
-                            wprintf_s(L"Matching at least %wZ [%zu] and %wZ [%zu].\r\n",
+                            H2Print(L"Matching at least %wZ [%zu] and %wZ [%zu].\r\n",
                                 &process->ImageName,
                                 (ULONG_PTR)process->UniqueProcessId,
                                 &cursor->ImageName,
@@ -114,7 +263,7 @@ NTSTATUS wmain(
 
             if (!process)
             {
-                wprintf_s(L"No matching processes found.\r\n");
+                H2Print(L"No matching processes found.\r\n");
                 status = STATUS_NOT_FOUND;
                 goto CLEANUP;
             }
@@ -124,59 +273,100 @@ NTSTATUS wmain(
         }
 
         // Open the target
-        status = H2OpenProcess(&processHandle, parsedArguments.ProcessId, PROCESS_DUP_HANDLE);
+        H2_TIMELINE_BEGIN("Open process", parsedArguments.ProcessId);
+        status = H2Backend->OpenProcess(&processHandle, parsedArguments.ProcessId, PROCESS_DUP_HANDLE);
+        H2_TIMELINE_END("Open process");
 
-        wprintf_s(
-            L"Handle 0x%0.4zX of %wZ [%zu]:\r\n",
-            (ULONG_PTR)parsedArguments.HandleValue,
-            process ? &process->ImageName : &parsedArguments.ProcessFilter,
-            (ULONG_PTR)parsedArguments.ProcessId
-        );
+        if (parsedArguments.Format == H2OutputText)
+        {
+            H2Print(
+                L"Handle 0x%0.4zX of %wZ [%zu]:\r\n",
+                (ULONG_PTR)parsedArguments.HandleValue,
+                process ? &process->ImageName : &parsedArguments.ProcessFilter,
+                (ULONG_PTR)parsedArguments.ProcessId
+            );
+        }
 
         if (!NT_SUCCESS(status))
         {
-            wprintf_s(L"Unable to open the process: ");
+            H2Print(L"Unable to open the process: ");
             H2PrintStatusWithDescription(status);
-            wprintf_s(L"\r\n");
+            H2Print(L"\r\n");
             goto CLEANUP;
         }
 
         // Duplicate the handle from it
-        status = NtDuplicateObject(
+        H2_TIMELINE_BEGIN("Duplicate handle", parsedArguments.HandleValue);
+        status = H2Backend->DuplicateHandle(
             processHandle,
             parsedArguments.HandleValue,
-            NtCurrentProcess(),
-            &socketHandle,
-            0,
-            0,
-            DUPLICATE_SAME_ACCESS
+            &socketHandle
         );
+        H2_TIMELINE_END("Duplicate handle");
 
-        NtClose(processHandle);
+        H2Backend->Close(processHandle);
         processHandle = NULL;
 
         if (!NT_SUCCESS(status))
         {
-            wprintf_s(L"Unable to duplicate the handle: ");
+            H2Print(L"Unable to duplicate the handle: ");
             H2PrintStatusWithDescription(status);
-            wprintf_s(L"\r\n");
+            H2Print(L"\r\n");
             goto CLEANUP;
         }
 
         // Verify it's an AFD socket
+        H2_TIMELINE_BEGIN("Check AFD handle", parsedArguments.HandleValue);
         status = H2AfdIsSocketHandle(socketHandle);
+        H2_TIMELINE_END("Check AFD handle");
 
         if (!NT_SUCCESS(status))
         {
-            wprintf_s(L"The handle is not an Ancillary Function Driver socket: ");
+            H2Print(L"The handle is not an Ancillary Function Driver socket: ");
             H2PrintStatusWithDescription(status);
-            wprintf_s(L"\r\n");
+            H2Print(L"\r\n");
             goto CLEANUP;
         }
 
         // Print all of its properties
-        H2AfdQueryPrintDetailsSocket(socketHandle, parsedArguments.Verbose);
-        wprintf_s(L"\r\n");
+        if (parsedArguments.Format == H2OutputColumnar)
+        {
+            status = H2ColumnarSaveSocket(
+                parsedArguments.OutputFileName,
+                process ? &process->ImageName : &parsedArguments.ProcessFilter,
+                parsedArguments.ProcessId,
+                parsedArguments.HandleValue,
+                socketHandle,
+                parsedArguments.Exhaustive ? H2_AFD_QUERY_EXHAUSTIVE : 0
+            );
+
+            if (!NT_SUCCESS(status))
+            {
+                H2Print(L"Unable to save the columnar file: ");
+                H2PrintStatusWithDescription(status);
+                H2Print(L"\r\n");
+                goto CLEANUP;
+            }
+        }
+        else if (parsedArguments.Format == H2OutputJsonLines)
+        {
+            H2AfdPrintJsonHeader(
+                process ? &process->ImageName : &parsedArguments.ProcessFilter,
+                parsedArguments.ProcessId,
+                parsedArguments.HandleValue
+            );
+            H2AfdQueryPrintJsonSocket(socketHandle, parsedArguments.Exhaustive ? H2_AFD_QUERY_EXHAUSTIVE : 0);
+            H2Print(L"}\r\n");
+        }
+        else
+        {
+            H2AfdQueryPrintDetailsSocket(
+                socketHandle,
+                parsedArguments.Exhaustive ? H2_AFD_QUERY_EXHAUSTIVE : 0,
+                parsedArguments.Verbose
+            );
+            H2Print(L"\r\n");
+        }
     }
     else
     {
@@ -185,149 +375,128 @@ NTSTATUS wmain(
         //
 
         // Identify the type index for sockets (file handles)
-        status = H2FindKernelTypeIndex(&fileHandleTypeName, &fileHandleTypeIndex);
+        H2_TIMELINE_BEGIN("Find type index", 0);
+        status = H2Backend->FindKernelTypeIndex(&fileHandleTypeName, &fileHandleTypeIndex);
+        H2_TIMELINE_END("Find type index");
 
         if (!NT_SUCCESS(status))
         {
-            wprintf_s(L"Unable to identify file type index: ");
+            H2Print(L"Unable to identify file type index: ");
             H2PrintStatusWithDescription(status);
-            wprintf_s(L"\r\n");
+            H2Print(L"\r\n");
             goto CLEANUP;
         }
 
         // Enumerate handles from all processes
-        status = H2SnapshotHandles(&handleSnapshot);
+        H2_TIMELINE_BEGIN("Snapshot handles", 0);
+        status = H2Backend->SnapshotHandles(&handleSnapshot);
+        H2_TIMELINE_END("Snapshot handles");
 
         if (!NT_SUCCESS(status))
         {
-            wprintf_s(L"Unable to enumerate handles on the system: ");
+            H2Print(L"Unable to enumerate handles on the system: ");
             H2PrintStatusWithDescription(status);
-            wprintf_s(L"\r\n");
+            H2Print(L"\r\n");
             goto CLEANUP;
         }
 
-        ULONG processesFound = 0;
-        PSYSTEM_PROCESS_INFORMATION process = processSnapshot;
+        // Group file handles by process so we don't need to rescan the snapshot for each one
+        H2_TIMELINE_BEGIN("Index handles", 0);
+        status = H2BuildHandleIndex(handleSnapshot, fileHandleTypeIndex, &handleIndex);
+        H2_TIMELINE_END("Index handles");
 
-        do
+        if (!NT_SUCCESS(status))
         {
-            // Either inspect one given PID or all processes with the image names matching the filter
-            if (parsedArguments.ProcessId || 
-                RtlIsNameInExpression(&parsedArguments.ProcessFilter, &process->ImageName, TRUE, NULL))
-            {
-                HANDLE pid = parsedArguments.ProcessId ? parsedArguments.ProcessId : process->UniqueProcessId;
-                ULONG handlesFound = 0;
+            H2Print(L"Unable to index handles on the system: ");
+            H2PrintStatusWithDescription(status);
+            H2Print(L"\r\n");
+            goto CLEANUP;
+        }
 
-                // Try to open the process for inspection
-                status = H2OpenProcess(&processHandle, pid, PROCESS_DUP_HANDLE);
+        // Inspect the handles and print the sockets
+        H2_TIMELINE_BEGIN("Inspect sockets", 0);
+        status = H2PrintSocketSummary(&parsedArguments, processSnapshot, handleSnapshot, &handleIndex);
+        H2_TIMELINE_END("Inspect sockets");
 
-                if (NT_SUCCESS(status) || parsedArguments.Verbose || parsedArguments.ProcessId)
-                {
-                    wprintf_s(L"%wZ [%zu]\r\n", 
-                        parsedArguments.ProcessId ? &parsedArguments.ProcessFilter: &process->ImageName, 
-                        (ULONG_PTR)pid
-                    );
-                    processesFound++;
-                }
+        if (!NT_SUCCESS(status))
+        {
+            H2Print(L"Unable to inspect handles: ");
+            H2PrintStatusWithDescription(status);
+            H2Print(L"\r\n");
+            goto CLEANUP;
+        }
+    }
 
-                if (!NT_SUCCESS(status) && (parsedArguments.Verbose || parsedArguments.ProcessId))
-                {
-                    wprintf_s(L"Unable to open the process: ");
-                    H2PrintStatusWithDescription(status);
-                    wprintf_s(L"\r\n\r\n");
-                }
+    if (parsedArguments.Format == H2OutputText)
+        H2Print(L"Complete.\r\n");
 
-                if (!NT_SUCCESS(status))
-                    continue;
+CLEANUP:
+    if (processSnapshot)
+        H2Free(processSnapshot);
 
-                // Find AFD handle candidates in the process
-                for (ULONG i = 0; i < handleSnapshot->NumberOfHandles; i++)
-                {
-                    if (handleSnapshot->Handles[i].UniqueProcessId == (HANDLE)(ULONG_PTR)pid &&
-                        handleSnapshot->Handles[i].ObjectTypeIndex == fileHandleTypeIndex)
-                    {
-                        PCWSTR failureSite = NULL;
-
-                        // Duplicate the handle from the process
-                        status = NtDuplicateObject(
-                            processHandle,
-                            handleSnapshot->Handles[i].HandleValue,
-                            NtCurrentProcess(),
-                            &socketHandle,
-                            0,
-                            0,
-                            DUPLICATE_SAME_ACCESS
-                        );
-
-                        if (NT_SUCCESS(status))
-                        {
-                            // Verify the handle belongs to AFD
-                            status = H2AfdIsSocketHandle(socketHandle);
-
-                            if (NT_SUCCESS(status))
-                            {
-                                // Print the socket overview
-                                wprintf_s(L"[0x%0.4zX] ", (ULONG_PTR)handleSnapshot->Handles[i].HandleValue);
-                                H2AfdQueryPrintSummarySocket(socketHandle);
-                                wprintf_s(L"\r\n");
-                                handlesFound++;
-                            }
-                            else if (status == STATUS_NOT_SAME_DEVICE)
-                            {
-                                // Skip non-AFD files
-                                status = STATUS_SUCCESS;
-                            }
-                            else
-                            {
-                                failureSite = L"check the file device";
-                            }
-                        }
-                        else
-                        {
-                            failureSite = L"duplicate the handle";
-                        }
+    H2FreeHandleIndex(&handleIndex);
 
-                        if (!NT_SUCCESS(status) && parsedArguments.Verbose)
-                        {
-                            wprintf_s(L"[0x%0.4zX] <Unable to %s>: ", (ULONG_PTR)handleSnapshot->Handles[i].HandleValue, failureSite);
-                            H2PrintStatusWithDescription(status);
-                            wprintf_s(L"\r\n");
-                        }
+    if (handleSnapshot)
+        H2Free(handleSnapshot);
 
-                        if (socketHandle)
-                        {
-                            NtClose(socketHandle);
-                            socketHandle = NULL;
-                        }
-                    }
-                }
+    if (processHandle)
+        H2Backend->Close(processHandle);
 
-                if (handlesFound == 0)
-                    wprintf_s(L"No sockets to display.\r\n");
+    if (socketHandle)
+        H2Backend->Close(socketHandle);
 
-                wprintf_s(L"\r\n");
-            }
-        } while (!parsedArguments.ProcessId && (process = H2NextProcess(process)));
+    // Report where the time went
+    if (H2StatsActive)
+    {
+        H2StatsStop();
+        H2PrintStats();
 
-        if (!parsedArguments.ProcessId && processesFound == 0)
-            wprintf_s(L"No matching processes found.\r\n");
+        // The simulation knows how many IOCTLs it answered, which keeps batches from being counted twice
+        if (parsedArguments.SimulatedSockets && !H2StatsCheckIoctlCount(H2SimIoctlsServed) && NT_SUCCESS(status))
+            status = STATUS_INTERNAL_ERROR;
     }
 
-    wprintf_s(L"Complete.\r\n");
+    // Save the rest of the trace
+    if (parsedArguments.RecordFileName || parsedArguments.ReplayFileName)
+    {
+        NTSTATUS traceStatus = H2TraceStop();
 
-CLEANUP:
-    if (processSnapshot)
-        H2Free(processSnapshot);
+        if (!NT_SUCCESS(traceStatus))
+        {
+            H2Print(L"Unable to save the trace file: ");
+            H2PrintStatusWithDescription(traceStatus);
+            H2Print(L"\r\n");
+        }
+    }
 
-    if (handleSnapshot)
-        H2Free(handleSnapshot);
+    // Save the timeline now that worker threads have exited
+    if (parsedArguments.TimelineFileName)
+    {
+        NTSTATUS timelineStatus = H2TimelineSave(parsedArguments.TimelineFileName);
 
-    if (processHandle)
-        NtClose(processHandle);
+        if (!NT_SUCCESS(timelineStatus))
+        {
+            H2Print(L"Unable to save the timeline: ");
+            H2PrintStatusWithDescription(timelineStatus);
+            H2Print(L"\r\n");
+        }
+    }
 
-    if (socketHandle)
-        NtClose(socketHandle);
+    // Write the rest of the output
+    if (parsedArguments.OutputFileName && parsedArguments.Format != H2OutputColumnar)
+    {
+        NTSTATUS outputStatus = H2CloseOutputFile();
+
+        if (!NT_SUCCESS(outputStatus))
+        {
+            H2Print(L"Unable to write the output file: ");
+            H2PrintStatusWithDescription(outputStatus);
+            H2Print(L"\r\n");
+        }
+    }
 
+    H2FlushOutput();
+    H2NativeReleaseThreadEvents();
     H2FreeArguments(&parsedArguments);
 
     return status;
@@ -41,7 +41,6 @@ NTSTATUS H2AfdIsSocketHandle(
 {
     static UNICODE_STRING afdDeviceName = RTL_CONSTANT_STRING(AFD_DEVICE_NAME);
     NTSTATUS status;
-    IO_STATUS_BLOCK ioStatusBlock;
 
     union {
         FILE_VOLUME_NAME_INFORMATION VolumeName;
@@ -49,12 +48,10 @@ NTSTATUS H2AfdIsSocketHandle(
     } Buffer = { 0 };
 
     // Query the backing device name
-    status = NtQueryInformationFile(
+    status = H2Backend->QueryVolumeName(
         Handle,
-        &ioStatusBlock,
-        &Buffer,
-        sizeof(Buffer),
-        FileVolumeNameInformation
+        &Buffer.VolumeName,
+        sizeof(Buffer)
     );
 
     // If the name does not fit into the buffer, it's not AFD
@@ -97,51 +94,15 @@ NTSTATUS H2AfdDeviceIoControl(
     _Out_opt_ PULONG BytesReturned
 )
 {
-    NTSTATUS status;
-    HANDLE eventHandle;
-    IO_STATUS_BLOCK ioStatusBlock;
-
-    // We cannot wait on the file handle because it might not grant SYNCHRONIZE access.
-    // Always use an event instead.
-
-    status = NtCreateEvent(
-        &eventHandle,
-        EVENT_ALL_ACCESS,
-        NULL,
-        SynchronizationEvent,
-        FALSE
-    );
-
-    if (!NT_SUCCESS(status))
-        return status;
-
-    status = NtDeviceIoControlFile(
+    return H2Backend->DeviceIoControl(
         SocketHandle,
-        eventHandle,
-        NULL,
-        NULL,
-        &ioStatusBlock,
         IoControlCode,
         InBuffer,
         InBufferSize,
         OutputBuffer,
-        OutputBufferSize
+        OutputBufferSize,
+        BytesReturned
     );
-
-    if (status == STATUS_PENDING)
-    {
-        NtWaitForSingleObject(eventHandle, FALSE, NULL);
-        status = ioStatusBlock.Status;
-    }
-
-    NtClose(eventHandle);
-
-    if (BytesReturned)
-    {
-        *BytesReturned = (ULONG)ioStatusBlock.Information;
-    }
-
-    return status;
 }
 
 /**
@@ -243,6 +204,74 @@ NTSTATUS H2AfdQueryOption(
     );
 }
 
+/**
+  * \brief Retrieves several ULONG-sized socket options for an AFD socket at once.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[in] NumberOfOptions The number of options to query.
+  * \param[in] Options The levels and identifiers of the options.
+  * \param[out] OptionValues A buffer that receives the option values.
+  * \param[out] Statuses A buffer that receives the result of querying each option.
+  */
+VOID H2AfdQueryOptions(
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG NumberOfOptions,
+    _In_reads_(NumberOfOptions) PCH2_AFD_OPTION_ID Options,
+    _Out_writes_(NumberOfOptions) PULONG OptionValues,
+    _Out_writes_(NumberOfOptions) PNTSTATUS Statuses
+)
+{
+    PAFD_TL_IO_CONTROL_INFO controlInfo;
+    PH2_IOCTL_REQUEST requests;
+
+    controlInfo = RtlAllocateHeap(
+        RtlProcessHeap(),
+        HEAP_ZERO_MEMORY,
+        NumberOfOptions * (sizeof(AFD_TL_IO_CONTROL_INFO) + sizeof(H2_IOCTL_REQUEST))
+    );
+
+    if (!controlInfo)
+    {
+        // Query the options one by one instead
+        for (ULONG i = 0; i < NumberOfOptions; i++)
+            Statuses[i] = H2AfdQueryOption(SocketHandle, Options[i].Level, Options[i].OptionName, &OptionValues[i]);
+
+        return;
+    }
+
+    requests = (PH2_IOCTL_REQUEST)&controlInfo[NumberOfOptions];
+
+    for (ULONG i = 0; i < NumberOfOptions; i++)
+    {
+        controlInfo[i].Type = TlGetSockOptIoControlType;
+        controlInfo[i].EndpointIoctl = TRUE;
+        controlInfo[i].Level = Options[i].Level;
+        controlInfo[i].IoControlCode = Options[i].OptionName;
+        OptionValues[i] = 0;
+
+        requests[i].IoControlCode = IOCTL_AFD_TRANSPORT_IOCTL;
+        requests[i].InBuffer = &controlInfo[i];
+        requests[i].InBufferSize = sizeof(AFD_TL_IO_CONTROL_INFO);
+        requests[i].OutputBuffer = &OptionValues[i];
+        requests[i].OutputBufferSize = sizeof(ULONG);
+        requests[i].Status = STATUS_PENDING; // Not issued yet
+    }
+
+    // The options are independent, so the backend may have all of them in flight at once
+    H2Backend->DeviceIoControlBatch(SocketHandle, requests, NumberOfOptions);
+
+    for (ULONG i = 0; i < NumberOfOptions; i++)
+    {
+        // A batch that fails before issuing requests leaves them untouched
+        if (requests[i].Status == STATUS_PENDING)
+            Statuses[i] = H2AfdQueryOption(SocketHandle, Options[i].Level, Options[i].OptionName, &OptionValues[i]);
+        else
+            Statuses[i] = requests[i].Status;
+    }
+
+    RtlFreeHeap(RtlProcessHeap(), 0, controlInfo);
+}
+
 /**
   * \brief Retrieves the latest supported TCP_INFO for an AFD socket.
   *
@@ -261,7 +290,7 @@ NTSTATUS H2AfdQueryTcpInfo(
     NTSTATUS status;
     AFD_TL_IO_CONTROL_INFO controlInfo = { 0 };
 
-    if (TcpInfoVersion > 2)
+    if (TcpInfoVersion > H2_AFD_TCP_INFO_MAX_VERSION)
         return STATUS_INVALID_PARAMETER;
 
     static const ULONG tcpInfoSize[] =
@@ -292,6 +321,75 @@ NTSTATUS H2AfdQueryTcpInfo(
     return status;
 }
 
+// The newest TCP_INFO version worth trying; lowered once the system proves not to support newer ones
+volatile LONG H2AfdTcpInfoStartVersion = H2_AFD_TCP_INFO_MAX_VERSION;
+
+/**
+  * \brief Determines if a failed TCP_INFO query might succeed with an older version of the structure.
+  *  STATUS_INVALID_PARAMETER is not one of them: transports also use it to reject sockets in the wrong state.
+  *
+  * \param[in] Status The status of the query.
+  *
+  * \return Whether the error is specific to the requested version.
+  */
+BOOLEAN H2AfdIsTcpInfoVersionStatus(
+    _In_ NTSTATUS Status
+)
+{
+    switch (Status)
+    {
+        case STATUS_NOT_SUPPORTED:
+        case STATUS_INVALID_BUFFER_SIZE:
+        case STATUS_BUFFER_TOO_SMALL:
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
+/**
+  * \brief Retrieves TCP_INFO for an AFD socket using the newest version the system supports.
+  *  The supported version is learned once per process, so later calls issue a single query.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[out] TcpInfo A buffer that receives the TCP information.
+  * \param[out] TcpInfoVersion The version of the structure that was last tried; on success, the version of the returned data.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2AfdQueryTcpInfoBest(
+    _In_ HANDLE SocketHandle,
+    _Out_ PTCP_INFO_v2 TcpInfo,
+    _Out_ PULONG TcpInfoVersion
+)
+{
+    NTSTATUS status;
+    LONG startVersion = ReadNoFence(&H2AfdTcpInfoStartVersion);
+    LONG version = startVersion;
+
+    do
+    {
+        status = H2AfdQueryTcpInfo(SocketHandle, (ULONG)version, TcpInfo);
+
+        // Errors unrelated to the version (such as the connection state) repeat on older versions
+        if (NT_SUCCESS(status) || !H2AfdIsTcpInfoVersionStatus(status))
+            break;
+
+    } while (--version >= 0);
+
+    if (version < 0)
+        version = 0;
+
+    // Start later queries at the version that worked, but only learn from sockets where every
+    // version should work; a fallback on a socket in another state says nothing about the system
+    if (NT_SUCCESS(status) && version < startVersion && TcpInfo->State == TCPSTATE_ESTABLISHED)
+        InterlockedCompareExchange(&H2AfdTcpInfoStartVersion, version, startVersion);
+
+    *TcpInfoVersion = (ULONG)version;
+    return status;
+}
+
 /**
   * \brief Opens an address or a connection handle to the underlying device for a TDI socket.
   *
@@ -15,6 +15,19 @@
 #include <phnt.h>
 #include "ntafd.h"
 #include <mstcpip.h>
+#include "backend.h"
+
+// The newest version of SIO_TCP_INFO we know how to query
+#define H2_AFD_TCP_INFO_MAX_VERSION 2
+
+// Identifies a socket option
+typedef struct _H2_AFD_OPTION_ID
+{
+    ULONG Level;
+    ULONG OptionName;
+} H2_AFD_OPTION_ID, *PH2_AFD_OPTION_ID;
+
+typedef const H2_AFD_OPTION_ID *PCH2_AFD_OPTION_ID;
 
 BOOLEAN
 NTAPI
@@ -64,6 +77,16 @@ H2AfdQueryOption(
     _Out_ PULONG OptionValue
 );
 
+VOID
+NTAPI
+H2AfdQueryOptions(
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG NumberOfOptions,
+    _In_reads_(NumberOfOptions) PCH2_AFD_OPTION_ID Options,
+    _Out_writes_(NumberOfOptions) PULONG OptionValues,
+    _Out_writes_(NumberOfOptions) PNTSTATUS Statuses
+);
+
 NTSTATUS
 NTAPI
 H2AfdQueryTcpInfo(
@@ -72,6 +95,14 @@ H2AfdQueryTcpInfo(
     _Out_ PTCP_INFO_v2 TcpInfo
 );
 
+NTSTATUS
+NTAPI
+H2AfdQueryTcpInfoBest(
+    _In_ HANDLE SocketHandle,
+    _Out_ PTCP_INFO_v2 TcpInfo,
+    _Out_ PULONG TcpInfoVersion
+);
+
 NTSTATUS
 NTAPI
 H2AfdQueryTdiHandle(
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "negative_cache.h"
+#include "file_helpers.h"
+
+#define H2_NEGATIVE_CACHE_BITS(Header) ((volatile LONG64*)((PH2_NEGATIVE_CACHE_HEADER)(Header) + 1))
+#define H2_NEGATIVE_CACHE_SIZE(BitsShift) (sizeof(H2_NEGATIVE_CACHE_HEADER) + ((SIZE_T)1 << (BitsShift)) / 8)
+
+/**
+  * \brief Mixes the bits of a 64-bit value.
+  */
+FORCEINLINE
+ULONG64 H2MixBits(
+    _In_ ULONG64 Value
+)
+{
+    Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+    return Value ^ (Value >> 31);
+}
+
+/**
+  * \brief Computes the key of a handle for the filter.
+  */
+FORCEINLINE
+ULONG64 H2HashNegativeCacheKey(
+    _In_ PVOID Object,
+    _In_ LONG64 ProcessCreateTime,
+    _In_ HANDLE HandleValue
+)
+{
+    ULONG64 hash = H2MixBits((ULONG_PTR)Object);
+
+    hash = H2MixBits(hash ^ (ULONG64)ProcessCreateTime);
+    return H2MixBits(hash ^ (ULONG_PTR)HandleValue);
+}
+
+/**
+  * \brief Derives the probe positions of a key from the salt of a filter.
+  */
+FORCEINLINE
+ULONG64 H2SaltNegativeCacheKey(
+    _In_ PH2_NEGATIVE_CACHE_HEADER Header,
+    _In_ ULONG64 Key
+)
+{
+    return H2MixBits(Key ^ H2MixBits(Header->Generation));
+}
+
+/**
+  * \brief Loads the filter saved by the previous scan and prepares an empty one for this scan.
+  *
+  * \param[in] FileName The Win32 name of the cache file. The string must remain valid until the cache is released.
+  * \param[in] ExpectedEntries The maximum number of entries this scan can add.
+  * \param[out] Cache The cache to initialize. The caller must release it via H2FreeNegativeCache.
+  *
+  * \return Successful or errant status. A missing or invalid file is not an error.
+  */
+NTSTATUS H2LoadNegativeCache(
+    _In_ PCWSTR FileName,
+    _In_ ULONG ExpectedEntries,
+    _Out_ PH2_NEGATIVE_CACHE Cache
+)
+{
+    PVOID view;
+    SIZE_T viewSize;
+    ULONG bitsShift = H2_NEGATIVE_CACHE_MIN_BITS_SHIFT;
+
+    memset(Cache, 0, sizeof(H2_NEGATIVE_CACHE));
+    Cache->FileName = FileName;
+
+    // Size the new filter for this scan, within limits
+    while (bitsShift < H2_NEGATIVE_CACHE_MAX_BITS_SHIFT &&
+        ((ULONG64)1 << bitsShift) < (ULONG64)ExpectedEntries * H2_NEGATIVE_CACHE_BITS_PER_ENTRY)
+        bitsShift++;
+
+    Cache->Current = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, H2_NEGATIVE_CACHE_SIZE(bitsShift));
+
+    if (!Cache->Current)
+        return STATUS_NO_MEMORY;
+
+    Cache->Current->Magic = H2_NEGATIVE_CACHE_MAGIC;
+    Cache->Current->Version = H2_NEGATIVE_CACHE_VERSION;
+    Cache->Current->NumberOfHashes = H2_NEGATIVE_CACHE_NUMBER_OF_HASHES;
+    Cache->Current->BitsShift = bitsShift;
+    Cache->CurrentMask = (ULONG)(((ULONG64)1 << bitsShift) - 1);
+
+    // Start without answers if the previous filter is missing or unusable
+    if (!NT_SUCCESS(H2MapFile(FileName, &view, &viewSize)))
+        return STATUS_SUCCESS;
+
+    Cache->Previous = view;
+
+    if (viewSize < sizeof(H2_NEGATIVE_CACHE_HEADER) ||
+        Cache->Previous->Magic != H2_NEGATIVE_CACHE_MAGIC ||
+        Cache->Previous->Version != H2_NEGATIVE_CACHE_VERSION ||
+        Cache->Previous->NumberOfHashes == 0 ||
+        Cache->Previous->BitsShift < H2_NEGATIVE_CACHE_MIN_BITS_SHIFT ||
+        Cache->Previous->BitsShift > H2_NEGATIVE_CACHE_MAX_BITS_SHIFT ||
+        viewSize != H2_NEGATIVE_CACHE_SIZE(Cache->Previous->BitsShift))
+    {
+        H2UnmapFile(view);
+        Cache->Previous = NULL;
+        return STATUS_SUCCESS;
+    }
+
+    Cache->PreviousMask = (ULONG)(((ULONG64)1 << Cache->Previous->BitsShift) - 1);
+
+    // Probe different bits than the previous scan, so its false positives don't repeat
+    Cache->Current->Generation = Cache->Previous->Generation + 1;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Determines whether the previous scan found a handle not to be a socket. The function is thread-safe.
+  *
+  * \param[in] Cache The negative cache.
+  * \param[in] Object The address of the file object.
+  * \param[in] ProcessCreateTime The creation time of the process that owns the handle.
+  * \param[in] HandleValue The value of the handle in the process.
+  *
+  * \return Whether the handle is (with a small false positive rate) known not to be a socket.
+  */
+BOOLEAN H2CheckNegativeCache(
+    _In_ PH2_NEGATIVE_CACHE Cache,
+    _In_ PVOID Object,
+    _In_ LONG64 ProcessCreateTime,
+    _In_ HANDLE HandleValue
+)
+{
+    ULONG64 hash;
+    ULONG h1;
+    ULONG h2;
+
+    if (!Cache->Previous)
+        return FALSE;
+
+    hash = H2SaltNegativeCacheKey(Cache->Previous, H2HashNegativeCacheKey(Object, ProcessCreateTime, HandleValue));
+    h1 = (ULONG)hash;
+    h2 = (ULONG)(hash >> 32) | 1;
+
+    for (ULONG i = 0; i < Cache->Previous->NumberOfHashes; i++)
+    {
+        ULONG bit = (h1 + i * h2) & Cache->PreviousMask;
+
+        if (!(H2_NEGATIVE_CACHE_BITS(Cache->Previous)[bit / 64] & (1ll << (bit % 64))))
+            return FALSE;
+    }
+
+    InterlockedIncrement(&Cache->NumberOfHits);
+    return TRUE;
+}
+
+/**
+  * \brief Remembers that a handle verified during this scan is not a socket. The function is thread-safe.
+  *
+  * \param[in] Cache The negative cache.
+  * \param[in] Object The address of the file object.
+  * \param[in] ProcessCreateTime The creation time of the process that owns the handle.
+  * \param[in] HandleValue The value of the handle in the process.
+  */
+VOID H2AddNegativeCache(
+    _In_ PH2_NEGATIVE_CACHE Cache,
+    _In_ PVOID Object,
+    _In_ LONG64 ProcessCreateTime,
+    _In_ HANDLE HandleValue
+)
+{
+    ULONG64 hash = H2SaltNegativeCacheKey(Cache->Current, H2HashNegativeCacheKey(Object, ProcessCreateTime, HandleValue));
+    ULONG h1 = (ULONG)hash;
+    ULONG h2 = (ULONG)(hash >> 32) | 1;
+
+    for (ULONG i = 0; i < Cache->Current->NumberOfHashes; i++)
+    {
+        ULONG bit = (h1 + i * h2) & Cache->CurrentMask;
+
+        InterlockedOr64(&H2_NEGATIVE_CACHE_BITS(Cache->Current)[bit / 64], 1ll << (bit % 64));
+    }
+
+    InterlockedIncrement(&Cache->NumberOfEntries);
+}
+
+/**
+  * \brief Replaces the cache file with the filter built by this scan.
+  *
+  * \param[in,out] Cache The negative cache.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SaveNegativeCache(
+    _Inout_ PH2_NEGATIVE_CACHE Cache
+)
+{
+    NTSTATUS status;
+    HANDLE fileHandle;
+
+    // Mapped files cannot be overwritten
+    if (Cache->Previous)
+    {
+        H2UnmapFile(Cache->Previous);
+        Cache->Previous = NULL;
+    }
+
+    status = H2OpenFile(&fileHandle, Cache->FileName, FILE_WRITE_DATA, FILE_SHARE_READ, FILE_OVERWRITE_IF);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    Cache->Current->NumberOfEntries = Cache->NumberOfEntries;
+    status = H2WriteFile(fileHandle, Cache->Current, (ULONG)H2_NEGATIVE_CACHE_SIZE(Cache->Current->BitsShift));
+
+    NtClose(fileHandle);
+    return status;
+}
+
+/**
+  * \brief Releases the negative cache without saving it.
+  *
+  * \param[in,out] Cache The negative cache.
+  */
+VOID H2FreeNegativeCache(
+    _Inout_ PH2_NEGATIVE_CACHE Cache
+)
+{
+    if (Cache->Previous)
+        H2UnmapFile(Cache->Previous);
+
+    if (Cache->Current)
+        RtlFreeHeap(RtlProcessHeap(), 0, Cache->Current);
+
+    memset(Cache, 0, sizeof(H2_NEGATIVE_CACHE));
+}
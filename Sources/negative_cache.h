@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _NEGATIVE_CACHE_H
+#define _NEGATIVE_CACHE_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+
+//
+// The negative cache is a Bloom filter of file handles known not to be AFD sockets. Each
+// scan answers lookups from the filter saved by the previous scan and builds a new one from
+// the verdicts it observes, so handles that no longer exist drop out on the next save.
+// Only handles verified during a scan enter its filter, so every verdict is used by exactly
+// one later scan, and each scan salts the filter differently, so false positives don't repeat.
+//
+
+#define H2_NEGATIVE_CACHE_MAGIC 0x434E3248 // "H2NC"
+#define H2_NEGATIVE_CACHE_VERSION 2
+
+// The number of filter bits per expected entry and the number of probes; about 0.05% false positives
+#define H2_NEGATIVE_CACHE_BITS_PER_ENTRY 16
+#define H2_NEGATIVE_CACHE_NUMBER_OF_HASHES 11
+
+// The filter size limits, as powers of two in bits (8 KiB to 64 MiB)
+#define H2_NEGATIVE_CACHE_MIN_BITS_SHIFT 16
+#define H2_NEGATIVE_CACHE_MAX_BITS_SHIFT 29
+
+typedef struct _H2_NEGATIVE_CACHE_HEADER
+{
+    ULONG Magic;
+    USHORT Version;
+    USHORT NumberOfHashes;
+    ULONG BitsShift;
+    ULONG NumberOfEntries;
+    ULONG64 Generation; // Salts the hashes
+    // ULONG64 Bits[(1 << BitsShift) / 64];
+} H2_NEGATIVE_CACHE_HEADER, *PH2_NEGATIVE_CACHE_HEADER;
+
+typedef struct _H2_NEGATIVE_CACHE
+{
+    PCWSTR FileName;
+    PH2_NEGATIVE_CACHE_HEADER Previous; // The mapped file from the last scan, if any
+    ULONG PreviousMask;
+    PH2_NEGATIVE_CACHE_HEADER Current; // The filter for this scan
+    ULONG CurrentMask;
+    volatile LONG NumberOfEntries;
+    volatile LONG NumberOfHits; // Handles skipped during this scan
+} H2_NEGATIVE_CACHE, *PH2_NEGATIVE_CACHE;
+
+NTSTATUS
+NTAPI
+H2LoadNegativeCache(
+    _In_ PCWSTR FileName,
+    _In_ ULONG ExpectedEntries,
+    _Out_ PH2_NEGATIVE_CACHE Cache
+);
+
+BOOLEAN
+NTAPI
+H2CheckNegativeCache(
+    _In_ PH2_NEGATIVE_CACHE Cache,
+    _In_ PVOID Object,
+    _In_ LONG64 ProcessCreateTime,
+    _In_ HANDLE HandleValue
+);
+
+VOID
+NTAPI
+H2AddNegativeCache(
+    _In_ PH2_NEGATIVE_CACHE Cache,
+    _In_ PVOID Object,
+    _In_ LONG64 ProcessCreateTime,
+    _In_ HANDLE HandleValue
+);
+
+NTSTATUS
+NTAPI
+H2SaveNegativeCache(
+    _Inout_ PH2_NEGATIVE_CACHE Cache
+);
+
+VOID
+NTAPI
+H2FreeNegativeCache(
+    _Inout_ PH2_NEGATIVE_CACHE Cache
+);
+
+#endif
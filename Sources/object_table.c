@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "object_table.h"
+
+// An object of a selected process while counting its handles
+typedef struct _H2_OBJECT_CANDIDATE
+{
+    PVOID Object;
+    ULONG NumberOfHandles;
+} H2_OBJECT_CANDIDATE, *PH2_OBJECT_CANDIDATE;
+
+/**
+  * \brief Determines the number of buckets that keeps a table at most half full.
+  *
+  * \param[in] NumberOfObjects The number of objects to store; at most MAXULONG / 4.
+  *
+  * \return A power of two.
+  */
+ULONG H2ObjectTableSize(
+    _In_ ULONG NumberOfObjects
+)
+{
+    ULONG numberOfBuckets = 1;
+
+    while (numberOfBuckets < NumberOfObjects * 2)
+        numberOfBuckets *= 2;
+
+    return numberOfBuckets;
+}
+
+/**
+  * \brief Finds the candidate for an object or the empty bucket where it belongs.
+  *
+  * \param[in] Candidates The buckets of candidates.
+  * \param[in] BucketMask The number of buckets minus one.
+  * \param[in] Object The address of the object.
+  *
+  * \return The bucket.
+  */
+PH2_OBJECT_CANDIDATE H2ObjectTableFindCandidate(
+    _In_ PH2_OBJECT_CANDIDATE Candidates,
+    _In_ ULONG BucketMask,
+    _In_ PVOID Object
+)
+{
+    ULONG bucket = H2HashObject(Object, BucketMask);
+
+    while (Candidates[bucket].Object && Candidates[bucket].Object != Object)
+        bucket = (bucket + 1) & BucketMask;
+
+    return &Candidates[bucket];
+}
+
+/**
+  * \brief Finds the entry for an object or the empty bucket where it belongs.
+  *
+  * \param[in] Table An object table.
+  * \param[in] Object The address of the object.
+  *
+  * \return The bucket.
+  */
+PH2_OBJECT_ENTRY H2ObjectTableFind(
+    _In_ PH2_OBJECT_TABLE Table,
+    _In_ PVOID Object
+)
+{
+    ULONG bucket = H2HashObject(Object, Table->BucketMask);
+
+    while (Table->Buckets[bucket].Object && Table->Buckets[bucket].Object != Object)
+        bucket = (bucket + 1) & Table->BucketMask;
+
+    return &Table->Buckets[bucket];
+}
+
+/**
+  * \brief Groups indexed handles by the address of the kernel object they point to.
+  *  Only objects of the selected processes that have more than one handle get an entry;
+  *  the handles that share them can belong to any process in the index.
+  *
+  * \param[in] Index A handle index.
+  * \param[in] ProcessIds The IDs of the selected processes.
+  * \param[in] NumberOfProcesses The number of selected processes.
+  * \param[out] Table The table to initialize. The caller must release it via H2FreeObjectTable.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2BuildObjectTable(
+    _In_ PH2_HANDLE_INDEX Index,
+    _In_reads_(NumberOfProcesses) PHANDLE ProcessIds,
+    _In_ ULONG NumberOfProcesses,
+    _Out_ PH2_OBJECT_TABLE Table
+)
+{
+    ULONG numberOfEntries = Index->BucketStarts[Index->NumberOfBuckets];
+    ULONG numberOfSelected = 0;
+    ULONG numberOfShared = 0;
+    ULONG numberOfLinks = 0;
+    ULONG candidateMask;
+    PH2_OBJECT_CANDIDATE candidates;
+    PH2_OBJECT_CANDIDATE candidate;
+    PH2_OBJECT_ENTRY entry;
+    PULONG entries;
+    ULONG count;
+    PVOID object;
+
+    memset(Table, 0, sizeof(H2_OBJECT_TABLE));
+    Table->Index = Index;
+
+    for (ULONG i = 0; i < NumberOfProcesses; i++)
+        numberOfSelected += H2LookupHandleIndex(Index, ProcessIds[i], &entries);
+
+    if (numberOfSelected > MAXULONG / 4)
+        return STATUS_INTEGER_OVERFLOW;
+
+    // Collect objects of the selected processes
+    candidateMask = H2ObjectTableSize(numberOfSelected) - 1;
+    candidates = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, (candidateMask + 1) * sizeof(H2_OBJECT_CANDIDATE));
+
+    if (!candidates)
+        return STATUS_NO_MEMORY;
+
+    for (ULONG i = 0; i < NumberOfProcesses; i++)
+    {
+        count = H2LookupHandleIndex(Index, ProcessIds[i], &entries);
+
+        for (ULONG j = 0; j < count; j++)
+        {
+            // Without object addresses, handles cannot be matched
+            if (object = Index->Snapshot->Handles[entries[j]].Object)
+                H2ObjectTableFindCandidate(candidates, candidateMask, object)->Object = object;
+        }
+    }
+
+    // Count their handles in all processes
+    for (ULONG position = 0; position < numberOfEntries; position++)
+    {
+        if (!(object = Index->Snapshot->Handles[Index->Entries[position]].Object))
+            continue;
+
+        candidate = H2ObjectTableFindCandidate(candidates, candidateMask, object);
+
+        if (candidate->Object)
+            candidate->NumberOfHandles++;
+    }
+
+    for (ULONG i = 0; i <= candidateMask; i++)
+    {
+        if (candidates[i].NumberOfHandles > 1)
+        {
+            numberOfShared++;
+            numberOfLinks += candidates[i].NumberOfHandles;
+        }
+    }
+
+    // Objects with a single handle are inspected directly and need no entry
+    Table->BucketMask = H2ObjectTableSize(numberOfShared) - 1;
+    Table->Buckets = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, (Table->BucketMask + 1) * sizeof(H2_OBJECT_ENTRY));
+    Table->Links = RtlAllocateHeap(RtlProcessHeap(), 0, max(numberOfLinks, 1) * sizeof(H2_OBJECT_LINK));
+
+    if (!Table->Buckets || !Table->Links)
+    {
+        RtlFreeHeap(RtlProcessHeap(), 0, candidates);
+        H2FreeObjectTable(Table);
+        return STATUS_NO_MEMORY;
+    }
+
+    for (ULONG i = 0; i <= candidateMask; i++)
+    {
+        if (candidates[i].NumberOfHandles > 1)
+        {
+            entry = H2ObjectTableFind(Table, candidates[i].Object);
+            entry->Object = candidates[i].Object;
+            entry->FirstLink = H2_OBJECT_TABLE_NO_POSITION;
+            RtlRunOnceInitialize(&entry->QueryOnce);
+        }
+    }
+
+    RtlFreeHeap(RtlProcessHeap(), 0, candidates);
+    numberOfLinks = 0;
+
+    // Chain handles of shared objects in the index order
+    for (ULONG position = 0; position < numberOfEntries; position++)
+    {
+        if (!(object = Index->Snapshot->Handles[Index->Entries[position]].Object))
+            continue;
+
+        entry = H2ObjectTableFind(Table, object);
+
+        if (!entry->Object)
+            continue;
+
+        Table->Links[numberOfLinks].Position = position;
+        Table->Links[numberOfLinks].Next = H2_OBJECT_TABLE_NO_POSITION;
+
+        if (entry->NumberOfHandles)
+            Table->Links[entry->LastLink].Next = numberOfLinks;
+        else
+            entry->FirstLink = numberOfLinks;
+
+        entry->LastLink = numberOfLinks++;
+        entry->NumberOfHandles++;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Finds the group of handles that point to an object.
+  *
+  * \param[in] Table An object table.
+  * \param[in] Object The address of the object.
+  *
+  * \return The entry for the object or NULL if the object has no other handles or is unknown.
+  */
+PH2_OBJECT_ENTRY H2LookupObjectTable(
+    _In_ PH2_OBJECT_TABLE Table,
+    _In_opt_ PVOID Object
+)
+{
+    PH2_OBJECT_ENTRY entry;
+
+    if (!Object || !Table->Buckets)
+        return NULL;
+
+    entry = H2ObjectTableFind(Table, Object);
+
+    return entry->Object ? entry : NULL;
+}
+
+/**
+  * \brief Releases an object table.
+  *
+  * \param[in,out] Table An object table.
+  */
+VOID H2FreeObjectTable(
+    _Inout_ PH2_OBJECT_TABLE Table
+)
+{
+    if (Table->Buckets)
+    {
+        for (ULONG i = 0; i <= Table->BucketMask; i++)
+        {
+            H2FreeOutputBuffer(&Table->Buckets[i].Summary);
+
+            if (Table->Buckets[i].Record)
+                RtlFreeHeap(RtlProcessHeap(), 0, Table->Buckets[i].Record);
+        }
+
+        RtlFreeHeap(RtlProcessHeap(), 0, Table->Buckets);
+    }
+
+    if (Table->Links)
+        RtlFreeHeap(RtlProcessHeap(), 0, Table->Links);
+
+    memset(Table, 0, sizeof(H2_OBJECT_TABLE));
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _OBJECT_TABLE_H
+#define _OBJECT_TABLE_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "snapshot_helpers.h"
+#include "string_helpers.h"
+#include "socket_record.h"
+
+// The sentinel for the end of a chain of handles
+#define H2_OBJECT_TABLE_NO_POSITION MAXULONG
+
+// Handles that point to the same kernel object
+typedef struct _H2_OBJECT_ENTRY
+{
+    PVOID Object;
+    ULONG NumberOfHandles;
+    ULONG FirstLink; // In the links of the table; the rest follow via Next
+    ULONG LastLink;
+    RTL_RUN_ONCE QueryOnce;
+    NTSTATUS Status; // The result of inspecting the object via the first handle
+    PCWSTR FailureSite;
+    H2_OUTPUT_BUFFER Summary;
+    PH2_AFD_SOCKET_RECORD Record; // For columnar output
+} H2_OBJECT_ENTRY, *PH2_OBJECT_ENTRY;
+
+// One handle in the chain of an object
+typedef struct _H2_OBJECT_LINK
+{
+    ULONG Position; // In the handle index
+    ULONG Next;
+} H2_OBJECT_LINK, *PH2_OBJECT_LINK;
+
+// An open-addressed table that groups indexed handles by object address. It only has
+// objects of selected processes that have more than one handle anywhere in the index.
+typedef struct _H2_OBJECT_TABLE
+{
+    PH2_HANDLE_INDEX Index;
+    ULONG BucketMask;
+    PH2_OBJECT_ENTRY Buckets;
+    PH2_OBJECT_LINK Links; // Chain handles of the same object in the index order
+} H2_OBJECT_TABLE, *PH2_OBJECT_TABLE;
+
+/**
+  * \brief Determines the first bucket to probe for an object.
+  */
+FORCEINLINE
+ULONG H2HashObject(
+    _In_ PVOID Object,
+    _In_ ULONG BucketMask
+)
+{
+    // Objects are at least 16-byte aligned; mix the rest of the bits
+    return (ULONG)((((ULONG64)(ULONG_PTR)Object >> 4) * 0x9E3779B97F4A7C15ull) >> 32) & BucketMask;
+}
+
+NTSTATUS
+NTAPI
+H2BuildObjectTable(
+    _In_ PH2_HANDLE_INDEX Index,
+    _In_reads_(NumberOfProcesses) PHANDLE ProcessIds,
+    _In_ ULONG NumberOfProcesses,
+    _Out_ PH2_OBJECT_TABLE Table
+);
+
+_Must_inspect_result_
+_Maybenull_
+PH2_OBJECT_ENTRY
+NTAPI
+H2LookupObjectTable(
+    _In_ PH2_OBJECT_TABLE Table,
+    _In_opt_ PVOID Object
+);
+
+VOID
+NTAPI
+H2FreeObjectTable(
+    _Inout_ PH2_OBJECT_TABLE Table
+);
+
+#endif
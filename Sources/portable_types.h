@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _PORTABLE_TYPES_H
+#define _PORTABLE_TYPES_H
+
+//
+// Types for code that also builds outside of Windows (such as the columnar reader and the
+// record formatters) and therefore cannot include phnt. On Windows, the types are identical
+// to their NT counterparts, so records and statuses pass between both sides without casts.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <sal.h>
+
+typedef unsigned long H2_ULONG;
+typedef long H2_LONG;
+typedef wchar_t H2_WCHAR;
+#else
+typedef uint32_t H2_ULONG;
+typedef int32_t H2_LONG;
+typedef uint16_t H2_WCHAR; // UTF-16, same as on Windows
+#endif
+
+// Characters of formatted text: UTF-16 on Windows, where it goes to the console as is, and UTF-8 elsewhere
+#ifdef _WIN32
+typedef wchar_t H2_CHAR;
+#define H2_T(Text) L"" Text
+#define H2_NEWLINE L"\r\n"
+#else
+typedef char H2_CHAR;
+#define H2_T(Text) Text
+#define H2_NEWLINE "\n"
+#endif
+
+typedef uint8_t H2_UCHAR;
+typedef uint16_t H2_USHORT;
+typedef uint64_t H2_ULONG64;
+typedef int64_t H2_LONG64;
+typedef H2_UCHAR H2_BOOLEAN;
+
+// Same as GUID
+typedef struct _H2_GUID
+{
+    H2_ULONG Data1;
+    H2_USHORT Data2;
+    H2_USHORT Data3;
+    H2_UCHAR Data4[8];
+} H2_GUID, *PH2_GUID;
+
+// NTSTATUS values
+typedef H2_LONG H2_STATUS;
+
+#define H2_SUCCESS(Status) (((H2_STATUS)(Status)) >= 0)
+
+#define H2_STATUS_SUCCESS ((H2_STATUS)0x00000000L)
+#define H2_STATUS_NO_MORE_ENTRIES ((H2_STATUS)0x8000001AL)
+#define H2_STATUS_NO_DATA_DETECTED ((H2_STATUS)0x80000022L)
+#define H2_STATUS_NO_MEMORY ((H2_STATUS)0xC0000017L)
+#define H2_STATUS_UNKNOWN_REVISION ((H2_STATUS)0xC0000058L)
+#define H2_STATUS_REVISION_MISMATCH ((H2_STATUS)0xC0000059L)
+#define H2_STATUS_FILE_INVALID ((H2_STATUS)0xC0000098L)
+#define H2_STATUS_FILE_CORRUPT_ERROR ((H2_STATUS)0xC0000102L)
+#define H2_STATUS_BUFFER_TOO_SMALL ((H2_STATUS)0xC0000023L)
+
+// Same as ARRAYSIZE
+#define H2_NUMBER_OF(Array) (sizeof(Array) / sizeof((Array)[0]))
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+// Annotations are only checked by the Microsoft compiler
+#ifndef _In_
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _Out_opt_
+#define _Inout_
+#define _In_reads_(Count)
+#define _In_reads_bytes_(Size)
+#define _In_reads_bytes_opt_(Size)
+#define _Out_writes_(Count)
+#define _Out_writes_z_(Count)
+#define _Outptr_result_bytebuffer_maybenull_(Size)
+#define _Outptr_result_bytebuffer_(Size)
+#define _Check_return_
+#define _Maybenull_
+#endif
+
+#endif
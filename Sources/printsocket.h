@@ -10,17 +10,54 @@
 
 #include <phnt_windows.h>
 #include <phnt.h>
+#include "socket_record.h"
 
 #ifndef _PRINTSOCKET_H
 #define _PRINTSOCKET_H
 
+VOID
+NTAPI
+H2AfdPrintSocketRecord(
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _In_ BOOLEAN VerboseMode
+);
+
 VOID
 NTAPI
 H2AfdQueryPrintDetailsSocket(
     _In_ HANDLE SocketHandle,
+    _In_ ULONG QueryFlags,
     _In_ BOOLEAN VerboseMode
 );
 
+VOID
+NTAPI
+H2AfdPrintJsonHeader(
+    _In_ PCUNICODE_STRING ProcessName,
+    _In_ HANDLE ProcessId,
+    _In_opt_ HANDLE HandleValue
+);
+
+VOID
+NTAPI
+H2AfdPrintJsonFailure(
+    _In_ PCWSTR FailureSite,
+    _In_ NTSTATUS Status
+);
+
+VOID
+NTAPI
+H2AfdQueryPrintJsonSocket(
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG QueryFlags
+);
+
+VOID
+NTAPI
+H2AfdPrintSummaryRecord(
+    _In_ PH2_AFD_SUMMARY_RECORD Record
+);
+
 VOID
 NTAPI
 H2AfdQueryPrintSummarySocket(
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "record_cache.h"
+#include "object_table.h"
+
+// The initial number of buckets; must be a power of two
+#define H2_RECORD_CACHE_INITIAL_SIZE 64
+
+// What stays the same for the life of a socket, for noticing reused object addresses
+typedef struct _H2_RECORD_CACHE_IDENTITY
+{
+    NTSTATUS SharedInfoStatus;
+    LONG AddressFamily;
+    LONG SocketType;
+    LONG Protocol;
+    ULONG CatalogEntryId;
+    H2_GUID ProviderId;
+    NTSTATUS TcpInfoStatus;
+    ULONG64 ConnectionTimeMs;
+} H2_RECORD_CACHE_IDENTITY, *PH2_RECORD_CACHE_IDENTITY;
+
+/**
+  * \brief Prepares an empty record cache.
+  *
+  * \param[out] Cache The cache to initialize. The caller must release it via H2FreeRecordCache.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2InitializeRecordCache(
+    _Out_ PH2_RECORD_CACHE Cache
+)
+{
+    memset(Cache, 0, sizeof(H2_RECORD_CACHE));
+    Cache->Buckets = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, H2_RECORD_CACHE_INITIAL_SIZE * sizeof(H2_RECORD_CACHE_ENTRY));
+
+    if (!Cache->Buckets)
+        return STATUS_NO_MEMORY;
+
+    Cache->BucketMask = H2_RECORD_CACHE_INITIAL_SIZE - 1;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Finds the bucket of an object or the empty bucket where it belongs.
+  *
+  * \param[in] Buckets The buckets of a cache.
+  * \param[in] BucketMask The number of buckets minus one.
+  * \param[in] Object The address of the socket object.
+  *
+  * \return The bucket.
+  */
+PH2_RECORD_CACHE_ENTRY H2RecordCacheFind(
+    _In_ PH2_RECORD_CACHE_ENTRY Buckets,
+    _In_ ULONG BucketMask,
+    _In_ PVOID Object
+)
+{
+    ULONG bucket = H2HashObject(Object, BucketMask);
+
+    while (Buckets[bucket].Object && Buckets[bucket].Object != Object)
+        bucket = (bucket + 1) & BucketMask;
+
+    return &Buckets[bucket];
+}
+
+/**
+  * \brief Moves entries of a cache to a new array of buckets.
+  *
+  * \param[in,out] Cache The cache.
+  * \param[in] NumberOfBuckets The new number of buckets; must be a power of two that fits the entries.
+  * \param[in] Generation Entries last sampled before this generation are released instead of moved.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2RecordCacheRehash(
+    _Inout_ PH2_RECORD_CACHE Cache,
+    _In_ ULONG NumberOfBuckets,
+    _In_ ULONG Generation
+)
+{
+    PH2_RECORD_CACHE_ENTRY buckets;
+    PH2_RECORD_CACHE_ENTRY entry;
+
+    buckets = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, NumberOfBuckets * sizeof(H2_RECORD_CACHE_ENTRY));
+
+    if (!buckets)
+        return STATUS_NO_MEMORY;
+
+    Cache->NumberOfEntries = 0;
+
+    for (ULONG i = 0; i <= Cache->BucketMask; i++)
+    {
+        entry = &Cache->Buckets[i];
+
+        if (!entry->Object)
+            continue;
+
+        if (entry->Generation < Generation)
+        {
+            RtlFreeHeap(RtlProcessHeap(), 0, entry->Record);
+            continue;
+        }
+
+        *H2RecordCacheFind(buckets, NumberOfBuckets - 1, entry->Object) = *entry;
+        Cache->NumberOfEntries++;
+    }
+
+    RtlFreeHeap(RtlProcessHeap(), 0, Cache->Buckets);
+    Cache->Buckets = buckets;
+    Cache->BucketMask = NumberOfBuckets - 1;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Captures what a socket record should keep across samples of the same socket.
+  *
+  * \param[in] Record A socket record.
+  * \param[out] Identity The identity of the socket.
+  */
+VOID H2RecordCacheGetIdentity(
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _Out_ PH2_RECORD_CACHE_IDENTITY Identity
+)
+{
+    Identity->SharedInfoStatus = Record->Status[H2_AFD_FIELD_SHARED_INFO];
+    Identity->AddressFamily = Record->SharedInfo.AddressFamily;
+    Identity->SocketType = Record->SharedInfo.SocketType;
+    Identity->Protocol = Record->SharedInfo.Protocol;
+    Identity->CatalogEntryId = Record->SharedInfo.CatalogEntryId;
+    Identity->ProviderId = Record->SharedInfo.ProviderId;
+    Identity->TcpInfoStatus = Record->Status[H2_AFD_FIELD_TCP_INFO_V0];
+    Identity->ConnectionTimeMs = Record->TcpInfo.ConnectionTimeMs;
+}
+
+/**
+  * \brief Determines whether a refreshed record still describes the socket it was queried for.
+  *  The kernel can reuse the address of a closed socket for a new one between samples.
+  *
+  * \param[in] Previous The identity of the socket before refreshing.
+  * \param[in] Record The refreshed record.
+  *
+  * \return Whether the static fields of the record are still valid.
+  */
+BOOLEAN H2RecordCacheIsSameSocket(
+    _In_ PH2_RECORD_CACHE_IDENTITY Previous,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_RECORD_CACHE_IDENTITY current;
+
+    H2RecordCacheGetIdentity(Record, &current);
+
+    // Connections only grow older
+    if (NT_SUCCESS(Previous->TcpInfoStatus) && NT_SUCCESS(current.TcpInfoStatus) &&
+        current.ConnectionTimeMs < Previous->ConnectionTimeMs)
+        return FALSE;
+
+    // The provider of a socket never changes
+    if (NT_SUCCESS(Previous->SharedInfoStatus) && NT_SUCCESS(current.SharedInfoStatus) &&
+        (current.AddressFamily != Previous->AddressFamily ||
+         current.SocketType != Previous->SocketType ||
+         current.Protocol != Previous->Protocol ||
+         current.CatalogEntryId != Previous->CatalogEntryId ||
+         memcmp(&current.ProviderId, &Previous->ProviderId, sizeof(H2_GUID)) != 0))
+        return FALSE;
+
+    return TRUE;
+}
+
+/**
+  * \brief Samples a socket, querying only what could have changed since the previous sample.
+  *
+  * \param[in,out] Cache The cache.
+  * \param[in] Object The address of the socket object.
+  * \param[in] SocketHandle An AFD socket handle for the object.
+  * \param[in] QueryFlags A combination of H2_AFD_QUERY_* flags.
+  * \param[out] Record A variable that receives the up-to-date record. It remains valid until the next prune.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SampleRecordCache(
+    _Inout_ PH2_RECORD_CACHE Cache,
+    _In_ PVOID Object,
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG QueryFlags,
+    _Out_ PH2_AFD_SOCKET_RECORD* Record
+)
+{
+    NTSTATUS status;
+    PH2_RECORD_CACHE_ENTRY entry;
+    H2_RECORD_CACHE_IDENTITY identity;
+    H2_AFD_VOLATILITY volatility;
+
+    if (!Object)
+        return STATUS_INVALID_PARAMETER;
+
+    // Keep the table at most half full
+    if ((Cache->NumberOfEntries + 1) * 2 > Cache->BucketMask + 1)
+    {
+        status = H2RecordCacheRehash(Cache, (Cache->BucketMask + 1) * 2, 0);
+
+        if (!NT_SUCCESS(status))
+            return status;
+    }
+
+    entry = H2RecordCacheFind(Cache->Buckets, Cache->BucketMask, Object);
+
+    if (!entry->Object)
+    {
+        entry->Record = RtlAllocateHeap(RtlProcessHeap(), 0, sizeof(H2_AFD_SOCKET_RECORD));
+
+        if (!entry->Record)
+            return STATUS_NO_MEMORY;
+
+        entry->Object = Object;
+        entry->Invalid = TRUE;
+        Cache->NumberOfEntries++;
+    }
+
+    if (!entry->Invalid)
+    {
+        // Semi-static fields include the addresses and the options, so they still need a look from time to time
+        volatility = ++entry->Samples >= H2_RECORD_CACHE_SEMI_STATIC_PERIOD ? H2AfdSemiStatic : H2AfdVolatile;
+
+        H2RecordCacheGetIdentity(entry->Record, &identity);
+        H2AfdRefreshSocketRecord(SocketHandle, QueryFlags, volatility, entry->Record);
+
+        if (volatility == H2AfdSemiStatic)
+            entry->Samples = 0;
+
+        entry->Invalid = !H2RecordCacheIsSameSocket(&identity, entry->Record);
+    }
+
+    if (entry->Invalid)
+    {
+        H2AfdQuerySocketRecord(SocketHandle, QueryFlags, entry->Record);
+        entry->Samples = 0;
+        entry->Invalid = FALSE;
+    }
+
+    entry->Generation = Cache->Generation;
+    *Record = entry->Record;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Makes the next sample of an object query everything, for when it might be a different socket.
+  *
+  * \param[in,out] Cache The cache.
+  * \param[in] Object The address of the socket object.
+  */
+VOID H2InvalidateRecordCache(
+    _Inout_ PH2_RECORD_CACHE Cache,
+    _In_ PVOID Object
+)
+{
+    PH2_RECORD_CACHE_ENTRY entry;
+
+    if (!Object)
+        return;
+
+    entry = H2RecordCacheFind(Cache->Buckets, Cache->BucketMask, Object);
+
+    if (entry->Object)
+        entry->Invalid = TRUE;
+}
+
+/**
+  * \brief Releases records of sockets that were not sampled since the previous prune.
+  *
+  * \param[in,out] Cache The cache.
+  */
+VOID H2PruneRecordCache(
+    _Inout_ PH2_RECORD_CACHE Cache
+)
+{
+    ULONG numberOfBuckets = H2_RECORD_CACHE_INITIAL_SIZE;
+    ULONG numberOfSampled = 0;
+
+    for (ULONG i = 0; i <= Cache->BucketMask; i++)
+    {
+        if (Cache->Buckets[i].Object && Cache->Buckets[i].Generation == Cache->Generation)
+            numberOfSampled++;
+    }
+
+    // Shrink after many sockets close, but keep room to grow back
+    while (numberOfBuckets < numberOfSampled * 4)
+        numberOfBuckets *= 2;
+
+    // Without memory for new buckets, keep everything until the next prune
+    if (NT_SUCCESS(H2RecordCacheRehash(Cache, numberOfBuckets, Cache->Generation)))
+        Cache->Generation++;
+}
+
+/**
+  * \brief Releases a record cache.
+  *
+  * \param[in,out] Cache The cache.
+  */
+VOID H2FreeRecordCache(
+    _Inout_ PH2_RECORD_CACHE Cache
+)
+{
+    if (Cache->Buckets)
+    {
+        for (ULONG i = 0; i <= Cache->BucketMask; i++)
+        {
+            if (Cache->Buckets[i].Record)
+                RtlFreeHeap(RtlProcessHeap(), 0, Cache->Buckets[i].Record);
+        }
+
+        RtlFreeHeap(RtlProcessHeap(), 0, Cache->Buckets);
+    }
+
+    memset(Cache, 0, sizeof(H2_RECORD_CACHE));
+}
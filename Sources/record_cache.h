@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _RECORD_CACHE_H
+#define _RECORD_CACHE_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "socket_record.h"
+
+//
+// The record cache keeps socket records between samples of the same sockets, keyed by the
+// address of the socket object, so handles that share a socket share its record. The first
+// sample queries everything; later ones re-query only volatile fields, plus semi-static ones
+// every H2_RECORD_CACHE_SEMI_STATIC_PERIOD samples. Static fields are never queried again
+// unless the object turns out to belong to a different socket.
+//
+
+// The number of samples between re-querying semi-static fields
+#define H2_RECORD_CACHE_SEMI_STATIC_PERIOD 10
+
+typedef struct _H2_RECORD_CACHE_ENTRY
+{
+    PVOID Object;
+    ULONG Generation; // Of the last sample
+    ULONG Samples; // Since the last query of semi-static fields
+    BOOLEAN Invalid; // The next sample queries everything
+    PH2_AFD_SOCKET_RECORD Record;
+} H2_RECORD_CACHE_ENTRY, *PH2_RECORD_CACHE_ENTRY;
+
+// An open-addressed table of socket records; not thread-safe
+typedef struct _H2_RECORD_CACHE
+{
+    ULONG BucketMask;
+    ULONG NumberOfEntries;
+    ULONG Generation; // Advanced by pruning
+    PH2_RECORD_CACHE_ENTRY Buckets;
+} H2_RECORD_CACHE, *PH2_RECORD_CACHE;
+
+NTSTATUS
+NTAPI
+H2InitializeRecordCache(
+    _Out_ PH2_RECORD_CACHE Cache
+);
+
+NTSTATUS
+NTAPI
+H2SampleRecordCache(
+    _Inout_ PH2_RECORD_CACHE Cache,
+    _In_ PVOID Object,
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG QueryFlags,
+    _Out_ PH2_AFD_SOCKET_RECORD* Record
+);
+
+VOID
+NTAPI
+H2InvalidateRecordCache(
+    _Inout_ PH2_RECORD_CACHE Cache,
+    _In_ PVOID Object
+);
+
+VOID
+NTAPI
+H2PruneRecordCache(
+    _Inout_ PH2_RECORD_CACHE Cache
+);
+
+VOID
+NTAPI
+H2FreeRecordCache(
+    _Inout_ PH2_RECORD_CACHE Cache
+);
+
+#endif
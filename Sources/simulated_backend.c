@@ -0,0 +1,1000 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "simulated_backend.h"
+#include "ntafd.h"
+#include <mstcpip.h>
+#include <ws2ipdef.h>
+#include <ws2tcpip.h>
+#include <hvsocket.h>
+#include <stdio.h>
+
+// Simulated handles keep a tag in the upper bits and an index in the rest
+#define H2_SIM_HANDLE_PAYLOAD_MASK 0x0FFFFFFF
+#define H2_SIM_PROCESS_HANDLE_TAG 0x50000000
+#define H2_SIM_FILE_HANDLE_TAG 0x60000000
+#define H2_SIM_MAKE_HANDLE(Tag, Index) ((HANDLE)((ULONG_PTR)(Tag) | ((ULONG_PTR)(Index) << 2)))
+#define H2_SIM_HANDLE_TAG(Handle) ((ULONG_PTR)(Handle) & ~(ULONG_PTR)H2_SIM_HANDLE_PAYLOAD_MASK)
+#define H2_SIM_HANDLE_INDEX(Handle) ((ULONG)(((ULONG_PTR)(Handle) & H2_SIM_HANDLE_PAYLOAD_MASK) >> 2))
+
+// Every fifth file handle in a simulated process refers to a regular file instead of a socket
+#define H2_SIM_FILES_PER_PROCESS (H2_SIM_SOCKETS_PER_PROCESS + H2_SIM_SOCKETS_PER_PROCESS / 4)
+#define H2_SIM_IS_SOCKET_FILE(FileIndex) ((FileIndex) % 5 != 4)
+
+// The file index must fit into the payload of a simulated handle
+#define H2_SIM_MAX_SOCKETS 50000000
+
+#define H2_SIM_IMAGE_NAME_LENGTH 16
+#define H2_SIM_OBJECT_ADDRESS(FileId) ((PVOID)((ULONG_PTR)0x80000000 | ((ULONG_PTR)(FileId) << 4)))
+
+ULONG H2SimNumberOfSockets;
+ULONG H2SimNumberOfProcesses;
+volatile LONG64 H2SimIoctlsServed;
+
+// The complete state of a simulated socket
+typedef struct _H2_SIM_SOCKET
+{
+    SOCK_SHARED_INFO SharedInfo;
+    SOCKADDR_STORAGE LocalAddress;
+    SOCKADDR_STORAGE RemoteAddress;
+    ULONG Seed;
+} H2_SIM_SOCKET, *PH2_SIM_SOCKET;
+
+/**
+  * \brief Determines how many file handles a simulated process has.
+  *
+  * \param[in] ProcessIndex A zero-based index of the simulated process.
+  *
+  * \return The number of socket and non-socket file handles.
+  */
+ULONG H2SimFilesInProcess(
+    _In_ ULONG ProcessIndex
+)
+{
+    ULONG sockets = H2SimNumberOfSockets - ProcessIndex * H2_SIM_SOCKETS_PER_PROCESS;
+
+    if (sockets > H2_SIM_SOCKETS_PER_PROCESS)
+        sockets = H2_SIM_SOCKETS_PER_PROCESS;
+
+    return sockets + sockets / 4;
+}
+
+/**
+  * \brief Prepares an IPv4 or IPv6 socket address.
+  *
+  * \param[out] Address A buffer for the address.
+  * \param[in] AddressFamily Either AF_INET or AF_INET6.
+  * \param[in] Network The upper byte of an IPv4 or the first two bytes of an IPv6 address.
+  * \param[in] Host The lower bytes of the address.
+  * \param[in] Port The port number in host byte order.
+  *
+  * \return The size of the address structure.
+  */
+LONG H2SimFillAddress(
+    _Out_ PSOCKADDR_STORAGE Address,
+    _In_ LONG AddressFamily,
+    _In_ ULONG Network,
+    _In_ ULONG Host,
+    _In_ USHORT Port
+)
+{
+    RtlZeroMemory(Address, sizeof(SOCKADDR_STORAGE));
+
+    if (AddressFamily == AF_INET)
+    {
+        PSOCKADDR_IN address = (PSOCKADDR_IN)Address;
+
+        address->sin_family = AF_INET;
+        address->sin_port = RtlUshortByteSwap(Port);
+        address->sin_addr.s_addr = Network || Host ? RtlUlongByteSwap((Network << 24) | (Host & 0xFFFFFF)) : 0;
+        return sizeof(SOCKADDR_IN);
+    }
+    else
+    {
+        PSOCKADDR_IN6 address = (PSOCKADDR_IN6)Address;
+
+        address->sin6_family = AF_INET6;
+        address->sin6_port = RtlUshortByteSwap(Port);
+
+        if (Network || Host)
+        {
+            *(PUSHORT)&address->sin6_addr.u.Byte[0] = RtlUshortByteSwap((USHORT)Network);
+            *(PULONG)&address->sin6_addr.u.Byte[12] = RtlUlongByteSwap(Host);
+        }
+
+        return sizeof(SOCKADDR_IN6);
+    }
+}
+
+/**
+  * \brief Generates the deterministic state of a simulated socket.
+  *
+  * \param[in] SocketIndex A zero-based index of the socket in the scenario.
+  * \param[out] Socket A buffer that receives the socket state.
+  */
+VOID H2SimDescribeSocket(
+    _In_ ULONG SocketIndex,
+    _Out_ PH2_SIM_SOCKET Socket
+)
+{
+    PSOCK_SHARED_INFO shared = &Socket->SharedInfo;
+    ULONG seed = SocketIndex * 2654435761u;
+    USHORT port = (USHORT)(49152 + (seed >> 16) % 16384);
+
+    RtlZeroMemory(Socket, sizeof(H2_SIM_SOCKET));
+    Socket->Seed = seed;
+
+    shared->fIsTLI = TRUE;
+    shared->NonBlocking = (seed >> 3) & 1;
+    shared->CreationFlags = WSA_FLAG_OVERLAPPED | WSA_FLAG_NO_HANDLE_INHERIT;
+    shared->ReceiveBufferSize = 0x10000;
+    shared->SendBufferSize = 0x10000;
+    shared->LastError = ERROR_SUCCESS;
+
+    // Mix socket kinds in proportions that roughly resemble a busy host
+    switch (SocketIndex % 16)
+    {
+    case 0: case 1: case 2: case 3: case 4: case 5:
+    case 6: case 7: case 8:
+        shared->AddressFamily = SocketIndex % 16 <= 5 ? AF_INET : AF_INET6;
+        shared->SocketType = SOCK_STREAM;
+        shared->Protocol = IPPROTO_TCP;
+        shared->ServiceFlags1 = XP1_GUARANTEED_DELIVERY | XP1_GUARANTEED_ORDER | XP1_GRACEFUL_CLOSE | XP1_EXPEDITED_DATA | XP1_IFS_HANDLES;
+        shared->CatalogEntryId = shared->AddressFamily == AF_INET ? 1001 : 1004;
+
+        if ((seed >> 8) % 4 == 0)
+        {
+            // A listening socket on a wildcard address
+            shared->State = SocketStateBound;
+            shared->Listening = TRUE;
+            H2SimFillAddress(&Socket->LocalAddress, shared->AddressFamily, 0, 0, (USHORT)(1024 + seed % 8192));
+        }
+        else
+        {
+            // An outgoing connection
+            shared->State = SocketStateConnected;
+            H2SimFillAddress(&Socket->LocalAddress, shared->AddressFamily, 10, seed, port);
+            H2SimFillAddress(&Socket->RemoteAddress, shared->AddressFamily, 192, 0x000200 | (seed & 0xFF), 443);
+        }
+        break;
+
+    case 9: case 10: case 11: case 12: case 13:
+        shared->AddressFamily = SocketIndex % 16 <= 11 ? AF_INET : AF_INET6;
+        shared->SocketType = SOCK_DGRAM;
+        shared->Protocol = IPPROTO_UDP;
+        shared->ServiceFlags1 = XP1_CONNECTIONLESS | XP1_MESSAGE_ORIENTED | XP1_SUPPORT_BROADCAST | XP1_SUPPORT_MULTIPOINT | XP1_IFS_HANDLES;
+        shared->CatalogEntryId = shared->AddressFamily == AF_INET ? 1002 : 1005;
+        shared->State = SocketStateBound;
+        H2SimFillAddress(&Socket->LocalAddress, shared->AddressFamily, 0, 0, port);
+        break;
+
+    case 14:
+        // A socket that was never bound
+        shared->AddressFamily = AF_INET;
+        shared->SocketType = SOCK_STREAM;
+        shared->Protocol = IPPROTO_TCP;
+        shared->ServiceFlags1 = XP1_GUARANTEED_DELIVERY | XP1_GUARANTEED_ORDER | XP1_GRACEFUL_CLOSE | XP1_EXPEDITED_DATA | XP1_IFS_HANDLES;
+        shared->CatalogEntryId = 1001;
+        shared->State = SocketStateOpen;
+        Socket->LocalAddress.ss_family = AF_INET;
+        break;
+
+    default:
+    {
+        PSOCKADDR_HV localAddress = (PSOCKADDR_HV)&Socket->LocalAddress;
+        PSOCKADDR_HV remoteAddress = (PSOCKADDR_HV)&Socket->RemoteAddress;
+
+        // A connected Hyper-V socket
+        shared->AddressFamily = AF_HYPERV;
+        shared->SocketType = SOCK_STREAM;
+        shared->Protocol = HV_PROTOCOL_RAW;
+        shared->ServiceFlags1 = XP1_GUARANTEED_DELIVERY | XP1_GUARANTEED_ORDER | XP1_GRACEFUL_CLOSE | XP1_IFS_HANDLES;
+        shared->CatalogEntryId = 1010;
+        shared->State = SocketStateConnected;
+
+        localAddress->Family = AF_HYPERV;
+        localAddress->ServiceId.Data1 = seed;
+        remoteAddress->Family = AF_HYPERV;
+        remoteAddress->VmId.Data1 = seed ^ 0x5A5A5A5A;
+        remoteAddress->ServiceId.Data1 = seed;
+        break;
+    }
+    }
+
+    if (shared->AddressFamily == AF_HYPERV)
+        shared->LocalAddressLength = sizeof(SOCKADDR_HV);
+    else if (shared->AddressFamily == AF_INET6)
+        shared->LocalAddressLength = sizeof(SOCKADDR_IN6);
+    else
+        shared->LocalAddressLength = sizeof(SOCKADDR_IN);
+
+    shared->RemoteAddressLength = shared->LocalAddressLength;
+}
+
+/**
+  * \brief Locates a simulated file by its handle.
+  *
+  * \param[in] FileHandle A simulated file handle.
+  * \param[out] ProcessIndex A variable that receives the index of the owning process.
+  * \param[out] FileIndex A variable that receives the index of the file within the process.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimLookupFile(
+    _In_ HANDLE FileHandle,
+    _Out_ PULONG ProcessIndex,
+    _Out_ PULONG FileIndex
+)
+{
+    ULONG fileId;
+
+    if (H2_SIM_HANDLE_TAG(FileHandle) == H2_SIM_PROCESS_HANDLE_TAG)
+        return STATUS_OBJECT_TYPE_MISMATCH;
+
+    if (H2_SIM_HANDLE_TAG(FileHandle) != H2_SIM_FILE_HANDLE_TAG)
+        return STATUS_INVALID_HANDLE;
+
+    fileId = H2_SIM_HANDLE_INDEX(FileHandle);
+    *ProcessIndex = fileId / H2_SIM_FILES_PER_PROCESS;
+    *FileIndex = fileId % H2_SIM_FILES_PER_PROCESS;
+
+    if (*ProcessIndex >= H2SimNumberOfProcesses || *FileIndex >= H2SimFilesInProcess(*ProcessIndex))
+        return STATUS_INVALID_HANDLE;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Retrieves the state of a simulated socket by its handle.
+  *
+  * \param[in] SocketHandle A simulated file handle.
+  * \param[out] Socket A buffer that receives the socket state.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimLookupSocket(
+    _In_ HANDLE SocketHandle,
+    _Out_ PH2_SIM_SOCKET Socket
+)
+{
+    NTSTATUS status;
+    ULONG processIndex;
+    ULONG fileIndex;
+
+    status = H2SimLookupFile(SocketHandle, &processIndex, &fileIndex);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    // Regular files don't understand AFD IOCTLs
+    if (!H2_SIM_IS_SOCKET_FILE(fileIndex))
+        return STATUS_INVALID_DEVICE_REQUEST;
+
+    H2SimDescribeSocket(processIndex * H2_SIM_SOCKETS_PER_PROCESS + fileIndex - fileIndex / 5, Socket);
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Enumerates simulated processes.
+  *
+  * \param[out] Snapshot A process snapshot buffer. The caller becomes responsible for releasing the buffer via H2Free.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimSnapshotProcesses(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+)
+{
+    ULONG entrySize = (ULONG)ALIGN_UP(sizeof(SYSTEM_PROCESS_INFORMATION) + H2_SIM_IMAGE_NAME_LENGTH * sizeof(WCHAR), ULONGLONG);
+    PSYSTEM_PROCESS_INFORMATION buffer;
+
+    buffer = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, (SIZE_T)entrySize * H2SimNumberOfProcesses);
+
+    if (!buffer)
+        return STATUS_NO_MEMORY;
+
+    for (ULONG i = 0; i < H2SimNumberOfProcesses; i++)
+    {
+        PSYSTEM_PROCESS_INFORMATION entry = (PSYSTEM_PROCESS_INFORMATION)RtlOffsetToPointer(buffer, (SIZE_T)entrySize * i);
+
+        // Store the image name right after the entry
+        entry->ImageName.Buffer = (PWSTR)(entry + 1);
+        entry->ImageName.MaximumLength = H2_SIM_IMAGE_NAME_LENGTH * sizeof(WCHAR);
+        entry->ImageName.Length = (USHORT)(swprintf_s(entry->ImageName.Buffer, H2_SIM_IMAGE_NAME_LENGTH, L"sim%u.exe", i) * sizeof(WCHAR));
+
+        entry->NextEntryOffset = i + 1 < H2SimNumberOfProcesses ? entrySize : 0;
+        entry->UniqueProcessId = (HANDLE)(ULONG_PTR)(H2_SIM_FIRST_PROCESS_ID + i * 4);
+        entry->HandleCount = H2SimFilesInProcess(i);
+    }
+
+    *Snapshot = buffer;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Enumerates handles of simulated processes.
+  *
+  * \param[out] Snapshot A handle snapshot buffer. The caller becomes responsible for releasing the buffer via H2Free.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimSnapshotHandles(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+)
+{
+    PSYSTEM_HANDLE_INFORMATION_EX buffer;
+    ULONG numberOfHandles = 0;
+    ULONG k = 0;
+
+    for (ULONG i = 0; i < H2SimNumberOfProcesses; i++)
+        numberOfHandles += H2SimFilesInProcess(i);
+
+    buffer = RtlAllocateHeap(
+        RtlProcessHeap(),
+        HEAP_ZERO_MEMORY,
+        FIELD_OFFSET(SYSTEM_HANDLE_INFORMATION_EX, Handles) + (SIZE_T)numberOfHandles * sizeof(SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX)
+    );
+
+    if (!buffer)
+        return STATUS_NO_MEMORY;
+
+    buffer->NumberOfHandles = numberOfHandles;
+
+    for (ULONG i = 0; i < H2SimNumberOfProcesses; i++)
+    {
+        ULONG files = H2SimFilesInProcess(i);
+
+        for (ULONG j = 0; j < files; j++, k++)
+        {
+            buffer->Handles[k].Object = H2_SIM_OBJECT_ADDRESS(i * H2_SIM_FILES_PER_PROCESS + j);
+            buffer->Handles[k].UniqueProcessId = (HANDLE)(ULONG_PTR)(H2_SIM_FIRST_PROCESS_ID + i * 4);
+            buffer->Handles[k].HandleValue = (HANDLE)(ULONG_PTR)((j + 1) * 4);
+            buffer->Handles[k].GrantedAccess = FILE_GENERIC_READ | FILE_GENERIC_WRITE;
+            buffer->Handles[k].ObjectTypeIndex = H2_SIM_FILE_TYPE_INDEX;
+        }
+    }
+
+    *Snapshot = buffer;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Finds a type index of a simulated kernel type by name.
+  *
+  * \param[in] TypeName The name of the kernel type.
+  * \param[out] Index The type's index in the handle snapshot.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimFindKernelTypeIndex(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+)
+{
+    UNICODE_STRING fileTypeName = RTL_CONSTANT_STRING(L"File");
+
+    if (!RtlEqualUnicodeString(TypeName, &fileTypeName, TRUE))
+        return STATUS_NOT_FOUND;
+
+    *Index = H2_SIM_FILE_TYPE_INDEX;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Opens a simulated process.
+  *
+  * \param[out] ProcessHandle A variable that receives the handle.
+  * \param[in] ProcessId The unique ID of the process to open.
+  * \param[in] DesiredAccess An access mask to request.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimOpenProcess(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+)
+{
+    ULONG_PTR processId = (ULONG_PTR)ProcessId;
+
+    UNREFERENCED_PARAMETER(DesiredAccess);
+
+    if (processId < H2_SIM_FIRST_PROCESS_ID ||
+        (processId - H2_SIM_FIRST_PROCESS_ID) % 4 != 0 ||
+        (processId - H2_SIM_FIRST_PROCESS_ID) / 4 >= H2SimNumberOfProcesses)
+        return STATUS_INVALID_CID;
+
+    *ProcessHandle = H2_SIM_MAKE_HANDLE(H2_SIM_PROCESS_HANDLE_TAG, (processId - H2_SIM_FIRST_PROCESS_ID) / 4);
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Duplicates a handle from a simulated process.
+  *
+  * \param[in] ProcessHandle A simulated process handle.
+  * \param[in] SourceHandle A handle value in the simulated process.
+  * \param[out] TargetHandle A variable that receives a simulated file handle.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+)
+{
+    ULONG processIndex;
+    ULONG_PTR handleValue = (ULONG_PTR)SourceHandle;
+
+    if (H2_SIM_HANDLE_TAG(ProcessHandle) != H2_SIM_PROCESS_HANDLE_TAG)
+        return STATUS_INVALID_HANDLE;
+
+    processIndex = H2_SIM_HANDLE_INDEX(ProcessHandle);
+
+    if (processIndex >= H2SimNumberOfProcesses ||
+        handleValue == 0 ||
+        handleValue % 4 != 0 ||
+        handleValue / 4 > H2SimFilesInProcess(processIndex))
+        return STATUS_INVALID_HANDLE;
+
+    *TargetHandle = H2_SIM_MAKE_HANDLE(H2_SIM_FILE_HANDLE_TAG, processIndex * H2_SIM_FILES_PER_PROCESS + handleValue / 4 - 1);
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Determines the name of the device backing a simulated file.
+  *
+  * \param[in] FileHandle A simulated file handle.
+  * \param[out] Buffer A buffer that receives the volume name information.
+  * \param[in] BufferSize The size of the buffer in bytes.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+)
+{
+    NTSTATUS status;
+    ULONG processIndex;
+    ULONG fileIndex;
+    UNICODE_STRING deviceName;
+    ULONG copySize;
+
+    status = H2SimLookupFile(FileHandle, &processIndex, &fileIndex);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    if (BufferSize < sizeof(FILE_VOLUME_NAME_INFORMATION))
+        return STATUS_INFO_LENGTH_MISMATCH;
+
+    if (H2_SIM_IS_SOCKET_FILE(fileIndex))
+        RtlInitUnicodeString(&deviceName, AFD_DEVICE_NAME);
+    else
+        RtlInitUnicodeString(&deviceName, L"\\Device\\HarddiskVolume3");
+
+    // Copy as much of the name as fits, like the I/O manager does
+    copySize = BufferSize - FIELD_OFFSET(FILE_VOLUME_NAME_INFORMATION, DeviceName);
+
+    if (copySize > deviceName.Length)
+        copySize = deviceName.Length;
+
+    Buffer->DeviceNameLength = deviceName.Length;
+    RtlCopyMemory(Buffer->DeviceName, deviceName.Buffer, copySize);
+
+    return copySize < deviceName.Length ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+}
+
+/**
+  * \brief Answers a simulated getsockopt request.
+  *
+  * \param[in] Socket The state of the socket.
+  * \param[in] Level A level for the option.
+  * \param[in] OptionName An option identifier within the level.
+  * \param[out] OptionValue A variable that receives the option value.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimQueryOption(
+    _In_ PH2_SIM_SOCKET Socket,
+    _In_ ULONG Level,
+    _In_ ULONG OptionName,
+    _Out_ PULONG OptionValue
+)
+{
+    PSOCK_SHARED_INFO shared = &Socket->SharedInfo;
+    BOOLEAN isIp = shared->AddressFamily == AF_INET || shared->AddressFamily == AF_INET6;
+
+    *OptionValue = 0;
+
+    switch (Level)
+    {
+    case SOL_SOCKET:
+        switch (OptionName)
+        {
+        case SO_KEEPALIVE:
+            *OptionValue = shared->SocketType == SOCK_STREAM && (Socket->Seed >> 5) & 1;
+            break;
+        case SO_RCVBUF:
+            *OptionValue = shared->ReceiveBufferSize;
+            break;
+        case SO_MAX_MSG_SIZE:
+            if (shared->SocketType != SOCK_DGRAM)
+                return STATUS_NOT_SUPPORTED;
+
+            *OptionValue = shared->AddressFamily == AF_INET ? 65507 : 65527;
+            break;
+        case SO_COMPARTMENT_ID:
+            *OptionValue = 1;
+            break;
+        }
+        return STATUS_SUCCESS;
+
+    case IPPROTO_IP:
+        if (!isIp)
+            return STATUS_NOT_SUPPORTED;
+
+        switch (OptionName)
+        {
+        case IP_TTL:
+            *OptionValue = 128;
+            break;
+        case IP_MULTICAST_TTL:
+        case IP_MULTICAST_LOOP:
+            *OptionValue = 1;
+            break;
+        case IP_MTU:
+            if (shared->State != SocketStateConnected)
+                return STATUS_INVALID_CONNECTION;
+
+            *OptionValue = 1500;
+            break;
+        }
+        return STATUS_SUCCESS;
+
+    case IPPROTO_IPV6:
+        if (shared->AddressFamily != AF_INET6)
+            return STATUS_NOT_SUPPORTED;
+
+        switch (OptionName)
+        {
+        case IPV6_UNICAST_HOPS:
+            *OptionValue = 128;
+            break;
+        case IPV6_MULTICAST_HOPS:
+        case IPV6_MULTICAST_LOOP:
+            *OptionValue = 1;
+            break;
+        case IPV6_V6ONLY:
+            *OptionValue = (Socket->Seed >> 6) & 1;
+            break;
+        case IPV6_MTU:
+            if (shared->State != SocketStateConnected)
+                return STATUS_INVALID_CONNECTION;
+
+            *OptionValue = 1500;
+            break;
+        }
+        return STATUS_SUCCESS;
+
+    case IPPROTO_TCP:
+        if (shared->Protocol != IPPROTO_TCP || !isIp)
+            return STATUS_NOT_SUPPORTED;
+
+        switch (OptionName)
+        {
+        case TCP_NODELAY:
+            *OptionValue = (Socket->Seed >> 7) & 1;
+            break;
+        case TCP_KEEPALIVE:
+            *OptionValue = 7200;
+            break;
+        case TCP_KEEPCNT:
+            *OptionValue = 10;
+            break;
+        case TCP_KEEPINTVL:
+            *OptionValue = 1;
+            break;
+        }
+        return STATUS_SUCCESS;
+
+    case IPPROTO_UDP:
+        if (shared->Protocol != IPPROTO_UDP || !isIp)
+            return STATUS_NOT_SUPPORTED;
+
+        return STATUS_SUCCESS;
+
+    case HV_PROTOCOL_RAW:
+        if (shared->AddressFamily != AF_HYPERV)
+            return STATUS_NOT_SUPPORTED;
+
+        if (OptionName == HVSOCKET_CONNECT_TIMEOUT)
+            *OptionValue = 90000;
+
+        return STATUS_SUCCESS;
+
+    default:
+        return STATUS_NOT_SUPPORTED;
+    }
+}
+
+/**
+  * \brief Answers a simulated SIO_TCP_INFO request.
+  *
+  * \param[in] Socket The state of the socket.
+  * \param[in] TcpInfoVersion The requested version of the structure.
+  * \param[out] OutputBuffer Output buffer.
+  * \param[in] OutputBufferSize Output buffer size.
+  * \param[out] BytesReturned A variable that receives the number of bytes written.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimQueryTcpInfo(
+    _In_ PH2_SIM_SOCKET Socket,
+    _In_ ULONG TcpInfoVersion,
+    _Out_writes_bytes_(OutputBufferSize) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_ PULONG BytesReturned
+)
+{
+    TCP_INFO_v2 tcpInfo = { 0 };
+    ULONG seed = Socket->Seed;
+
+    static const ULONG tcpInfoSize[] =
+    {
+        sizeof(TCP_INFO_v0),
+        sizeof(TCP_INFO_v1),
+        sizeof(TCP_INFO_v2)
+    };
+
+    if (Socket->SharedInfo.Protocol != IPPROTO_TCP)
+        return STATUS_NOT_SUPPORTED;
+
+    if (TcpInfoVersion > 2)
+        return STATUS_INVALID_PARAMETER;
+
+    if (OutputBufferSize < tcpInfoSize[TcpInfoVersion])
+        return STATUS_BUFFER_TOO_SMALL;
+
+    if (Socket->SharedInfo.State == SocketStateConnected)
+    {
+        tcpInfo.State = TCPSTATE_ESTABLISHED;
+        tcpInfo.Mss = 1460;
+        tcpInfo.ConnectionTimeMs = seed % 3600000;
+        tcpInfo.TimestampsEnabled = seed & 1;
+        tcpInfo.RttUs = 200 + seed % 50000;
+        tcpInfo.MinRttUs = tcpInfo.RttUs / 2;
+        tcpInfo.Cwnd = 10 * 1460;
+        tcpInfo.SndWnd = 0x10000;
+        tcpInfo.RcvWnd = 0x10000;
+        tcpInfo.RcvBuf = 0x10000;
+        tcpInfo.BytesOut = (ULONG64)seed * 37;
+        tcpInfo.BytesIn = (ULONG64)seed * 53;
+        tcpInfo.BytesRetrans = (ULONG)(tcpInfo.BytesOut / 1000);
+        tcpInfo.FastRetrans = seed % 7;
+        tcpInfo.DupAcksIn = seed % 11;
+        tcpInfo.TimeoutEpisodes = seed % 3;
+        tcpInfo.SndLimTransCwnd = seed % 5;
+        tcpInfo.SndLimTimeCwnd = seed % 1000;
+        tcpInfo.SndLimBytesCwnd = tcpInfo.BytesOut / 4;
+        tcpInfo.SndLimTransSnd = seed % 3;
+        tcpInfo.SndLimTimeSnd = seed % 10000;
+        tcpInfo.SndLimBytesSnd = tcpInfo.BytesOut - tcpInfo.SndLimBytesCwnd;
+        tcpInfo.OutOfOrderPktsIn = seed % 13;
+        tcpInfo.PtoEpisodes = seed % 2;
+    }
+    else
+    {
+        tcpInfo.State = Socket->SharedInfo.Listening ? TCPSTATE_LISTEN : TCPSTATE_CLOSED;
+    }
+
+    RtlCopyMemory(OutputBuffer, &tcpInfo, tcpInfoSize[TcpInfoVersion]);
+    *BytesReturned = tcpInfoSize[TcpInfoVersion];
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Answers a simulated IOCTL_AFD_TRANSPORT_IOCTL request.
+  *
+  * \param[in] Socket The state of the socket.
+  * \param[in] ControlInfo The transport request.
+  * \param[out] OutputBuffer Output buffer.
+  * \param[in] OutputBufferSize Output buffer size.
+  * \param[out] BytesReturned A variable that receives the number of bytes written.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimTransportIoctl(
+    _In_ PH2_SIM_SOCKET Socket,
+    _In_ PAFD_TL_IO_CONTROL_INFO ControlInfo,
+    _Out_writes_bytes_(OutputBufferSize) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_ PULONG BytesReturned
+)
+{
+    NTSTATUS status;
+    ULONG value;
+
+    if (!ControlInfo->EndpointIoctl)
+        return STATUS_INVALID_PARAMETER;
+
+    // Reproduce the hvsocket.sys bug that makes connected sockets accept any request
+    if (Socket->SharedInfo.AddressFamily == AF_HYPERV && Socket->SharedInfo.State == SocketStateConnected)
+    {
+        if (OutputBuffer)
+            RtlZeroMemory(OutputBuffer, OutputBufferSize);
+
+        *BytesReturned = OutputBufferSize;
+        return STATUS_SUCCESS;
+    }
+
+    switch (ControlInfo->Type)
+    {
+    case TlGetSockOptIoControlType:
+        if (OutputBufferSize < sizeof(ULONG))
+            return STATUS_BUFFER_TOO_SMALL;
+
+        status = H2SimQueryOption(Socket, ControlInfo->Level, ControlInfo->IoControlCode, &value);
+
+        if (NT_SUCCESS(status))
+        {
+            *(PULONG)OutputBuffer = value;
+            *BytesReturned = sizeof(ULONG);
+        }
+
+        return status;
+
+    case TlSocketIoControlType:
+        if (ControlInfo->IoControlCode != SIO_TCP_INFO)
+            return STATUS_NOT_SUPPORTED;
+
+        if (!ControlInfo->InputBuffer || ControlInfo->InputBufferLength < sizeof(ULONG))
+            return STATUS_INVALID_PARAMETER;
+
+        return H2SimQueryTcpInfo(Socket, *(PULONG)ControlInfo->InputBuffer, OutputBuffer, OutputBufferSize, BytesReturned);
+
+    default:
+        return STATUS_NOT_SUPPORTED;
+    }
+}
+
+/**
+  * \brief Answers a simulated IOCTL_AFD_GET_INFORMATION request.
+  *
+  * \param[in] Socket The state of the socket.
+  * \param[in] InformationType The type of information to query.
+  * \param[out] Information A buffer that receives the information.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimQuerySimpleInfo(
+    _In_ PH2_SIM_SOCKET Socket,
+    _In_ ULONG InformationType,
+    _Out_ PAFD_INFORMATION Information
+)
+{
+    BOOLEAN connected = Socket->SharedInfo.State == SocketStateConnected;
+
+    RtlZeroMemory(Information, sizeof(AFD_INFORMATION));
+    Information->InformationType = InformationType;
+
+    switch (InformationType)
+    {
+    case AFD_MAX_SEND_SIZE:
+        Information->Information.Ulong = Socket->SharedInfo.SocketType == SOCK_DGRAM ? 65507 : 0;
+        break;
+    case AFD_SENDS_PENDING:
+        break;
+    case AFD_MAX_PATH_SEND_SIZE:
+        Information->Information.Ulong = connected ? 1460 : 0;
+        break;
+    case AFD_RECEIVE_WINDOW_SIZE:
+    case AFD_SEND_WINDOW_SIZE:
+        Information->Information.Ulong = 0x10000;
+        break;
+    case AFD_CONNECT_TIME:
+        Information->Information.Ulong = connected ? Socket->Seed % 3600 : MAXULONG;
+        break;
+    case AFD_GROUP_ID_AND_TYPE:
+        Information->Information.GroupInfo.GroupType = GroupTypeNeither;
+        break;
+    default:
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Copies a simulated socket address into an IOCTL output buffer.
+  *
+  * \param[in] Address The socket address.
+  * \param[in] AddressLength The size of the socket address.
+  * \param[out] OutputBuffer Output buffer.
+  * \param[in] OutputBufferSize Output buffer size.
+  * \param[out] BytesReturned A variable that receives the number of bytes written.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimCopyAddress(
+    _In_ PSOCKADDR_STORAGE Address,
+    _In_ LONG AddressLength,
+    _Out_writes_bytes_(OutputBufferSize) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_ PULONG BytesReturned
+)
+{
+    if (OutputBufferSize < (ULONG)AddressLength)
+        return STATUS_BUFFER_TOO_SMALL;
+
+    RtlCopyMemory(OutputBuffer, Address, AddressLength);
+    *BytesReturned = AddressLength;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Issues a simulated IOCTL on a simulated AFD handle.
+  *
+  * \param[in] FileHandle A simulated file handle.
+  * \param[in] IoControlCode I/O control code
+  * \param[in] InBuffer Input buffer.
+  * \param[in] InBufferSize Input buffer size.
+  * \param[out] OutputBuffer Output Buffer.
+  * \param[in] OutputBufferSize Output buffer size.
+  * \param[out] BytesReturned Optionally set to the number of bytes returned.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+)
+{
+    NTSTATUS status;
+    H2_SIM_SOCKET socket;
+    ULONG returned = 0;
+
+    InterlockedIncrement64(&H2SimIoctlsServed);
+    status = H2SimLookupSocket(FileHandle, &socket);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    switch (IoControlCode)
+    {
+    case IOCTL_AFD_GET_CONTEXT:
+        // Return as much of the shared info as fits
+        returned = min(OutputBufferSize, sizeof(SOCK_SHARED_INFO));
+        RtlCopyMemory(OutputBuffer, &socket.SharedInfo, returned);
+        status = returned < sizeof(SOCK_SHARED_INFO) ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+        break;
+
+    case IOCTL_AFD_GET_ADDRESS:
+        if (socket.SharedInfo.State == SocketStateOpen)
+            status = STATUS_INVALID_PARAMETER;
+        else
+            status = H2SimCopyAddress(&socket.LocalAddress, socket.SharedInfo.LocalAddressLength, OutputBuffer, OutputBufferSize, &returned);
+        break;
+
+    case IOCTL_AFD_GET_REMOTE_ADDRESS:
+        if (socket.SharedInfo.State != SocketStateConnected)
+            status = STATUS_INVALID_CONNECTION;
+        else
+            status = H2SimCopyAddress(&socket.RemoteAddress, socket.SharedInfo.RemoteAddressLength, OutputBuffer, OutputBufferSize, &returned);
+        break;
+
+    case IOCTL_AFD_GET_INFORMATION:
+        if (InBufferSize < sizeof(AFD_INFORMATION))
+            status = STATUS_INVALID_PARAMETER;
+        else if (OutputBufferSize < sizeof(AFD_INFORMATION))
+            status = STATUS_BUFFER_TOO_SMALL;
+        else if (NT_SUCCESS(status = H2SimQuerySimpleInfo(&socket, ((PAFD_INFORMATION)InBuffer)->InformationType, OutputBuffer)))
+            returned = sizeof(AFD_INFORMATION);
+        break;
+
+    case IOCTL_AFD_QUERY_HANDLES:
+        if (InBufferSize < sizeof(ULONG))
+            status = STATUS_INVALID_PARAMETER;
+        else if (OutputBufferSize < sizeof(AFD_HANDLE_INFO))
+            status = STATUS_BUFFER_TOO_SMALL;
+        else
+        {
+            // All simulated sockets are TLI
+            ((PAFD_HANDLE_INFO)OutputBuffer)->TdiAddressHandle = INVALID_HANDLE_VALUE;
+            ((PAFD_HANDLE_INFO)OutputBuffer)->TdiConnectionHandle = INVALID_HANDLE_VALUE;
+            returned = sizeof(AFD_HANDLE_INFO);
+        }
+        break;
+
+    case IOCTL_AFD_TRANSPORT_IOCTL:
+        if (InBufferSize < sizeof(AFD_TL_IO_CONTROL_INFO))
+            status = STATUS_INVALID_PARAMETER;
+        else
+            status = H2SimTransportIoctl(&socket, InBuffer, OutputBuffer, OutputBufferSize, &returned);
+        break;
+
+    default:
+        status = STATUS_INVALID_DEVICE_REQUEST;
+    }
+
+    if (BytesReturned)
+        *BytesReturned = returned;
+
+    return status;
+}
+
+/**
+  * \brief Closes a simulated handle.
+  *
+  * \param[in] Handle A simulated process or file handle.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimClose(
+    _In_ HANDLE Handle
+)
+{
+    ULONG_PTR tag = H2_SIM_HANDLE_TAG(Handle);
+
+    return tag == H2_SIM_PROCESS_HANDLE_TAG || tag == H2_SIM_FILE_HANDLE_TAG ? STATUS_SUCCESS : STATUS_INVALID_HANDLE;
+}
+
+/**
+  * \brief Issues independent IOCTLs on a simulated socket one after another.
+  */
+NTSTATUS H2SimDeviceIoControlBatch(
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+)
+{
+    return H2SequentialDeviceIoControlBatch(H2SimDeviceIoControl, FileHandle, Requests, NumberOfRequests);
+}
+
+const H2_BACKEND H2SimulatedBackend =
+{
+    L"Simulated",
+    H2SimSnapshotProcesses,
+    H2SimSnapshotHandles,
+    H2SimFindKernelTypeIndex,
+    H2SimOpenProcess,
+    H2SimDuplicateHandle,
+    H2SimQueryVolumeName,
+    H2SimDeviceIoControl,
+    H2SimDeviceIoControlBatch,
+    H2SimClose
+};
+
+/**
+  * \brief Prepares a simulated scenario and makes it the active backend.
+  *
+  * \param[in] NumberOfSockets The number of sockets to simulate. They are spread across processes of H2_SIM_SOCKETS_PER_PROCESS each.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2SimInitialize(
+    _In_ ULONG NumberOfSockets
+)
+{
+    if (NumberOfSockets == 0 || NumberOfSockets > H2_SIM_MAX_SOCKETS)
+        return STATUS_INVALID_PARAMETER;
+
+    H2SimNumberOfSockets = NumberOfSockets;
+    H2SimNumberOfProcesses = (NumberOfSockets + H2_SIM_SOCKETS_PER_PROCESS - 1) / H2_SIM_SOCKETS_PER_PROCESS;
+    H2Backend = &H2SimulatedBackend;
+    return STATUS_SUCCESS;
+}
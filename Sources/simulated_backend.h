@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SIMULATED_BACKEND_H
+#define _SIMULATED_BACKEND_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "backend.h"
+
+// The number of simulated sockets that share one simulated process
+#define H2_SIM_SOCKETS_PER_PROCESS 1000
+
+// The first simulated process ID; the rest follow in increments of four
+#define H2_SIM_FIRST_PROCESS_ID 0x1000
+
+// The type index simulated file handles use
+#define H2_SIM_FILE_TYPE_INDEX 37
+
+// A backend that answers requests from an in-memory model of the AFD driver
+extern const H2_BACKEND H2SimulatedBackend;
+
+// The number of IOCTLs the simulated driver received, batched or not
+extern volatile LONG64 H2SimIoctlsServed;
+
+NTSTATUS
+NTAPI
+H2SimSnapshotProcesses(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+);
+
+NTSTATUS
+NTAPI
+H2SimSnapshotHandles(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+);
+
+NTSTATUS
+NTAPI
+H2SimFindKernelTypeIndex(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+);
+
+NTSTATUS
+NTAPI
+H2SimOpenProcess(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+);
+
+NTSTATUS
+NTAPI
+H2SimDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+);
+
+NTSTATUS
+NTAPI
+H2SimQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+);
+
+NTSTATUS
+NTAPI
+H2SimDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+);
+
+NTSTATUS
+NTAPI
+H2SimClose(
+    _In_ HANDLE Handle
+);
+
+NTSTATUS
+NTAPI
+H2SimInitialize(
+    _In_ ULONG NumberOfSockets
+);
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "snapshot_analysis.h"
+#include "worker_pool.h"
+#include "columnar_output.h"
+#include "snapshot_report.h"
+#include "string_helpers.h"
+#include "timeline.h"
+
+typedef struct _H2_ANALYSIS_FILE
+{
+    PCWSTR FileName;
+    H2_OUTPUT_BUFFER Output;
+    BOOLEAN Direct; // Writes straight to the console
+} H2_ANALYSIS_FILE, *PH2_ANALYSIS_FILE;
+
+typedef struct _H2_ANALYSIS_CONTEXT
+{
+    PH2_ARGUMENTS Arguments;
+    PH2_ANALYSIS_FILE Files;
+    volatile LONG NextToPrint; // The index of the file that owns the console
+} H2_ANALYSIS_CONTEXT, *PH2_ANALYSIS_CONTEXT;
+
+typedef struct _H2_ANALYSIS_TURN
+{
+    PH2_ANALYSIS_CONTEXT Context;
+    ULONG ItemIndex;
+} H2_ANALYSIS_TURN, *PH2_ANALYSIS_TURN;
+
+/**
+  * \brief Switches a file to the console once all files before it are printed.
+  *
+  * \param[in] Context The analysis context.
+  * \param[in] ItemIndex The index of the file.
+  */
+VOID H2AnalysisTakeTurn(
+    _In_ PH2_ANALYSIS_CONTEXT Context,
+    _In_ ULONG ItemIndex
+)
+{
+    PH2_ANALYSIS_FILE file = &Context->Files[ItemIndex];
+
+    if (file->Direct || (ULONG)ReadAcquire(&Context->NextToPrint) != ItemIndex)
+        return;
+
+    // Print what the file collected while waiting and continue without buffering
+    H2SetThreadOutput(NULL);
+    H2FlushOutputBuffer(&file->Output);
+    H2FreeOutputBuffer(&file->Output);
+    file->Direct = TRUE;
+}
+
+/**
+  * \brief Stops buffering the output of a file as soon as the previous files are printed.
+  *
+  * \param[in] Context The analysis context and the index of the file.
+  */
+VOID H2AnalysisOnRow(
+    _In_ PVOID Context
+)
+{
+    PH2_ANALYSIS_TURN turn = Context;
+
+    H2AnalysisTakeTurn(turn->Context, turn->ItemIndex);
+}
+
+/**
+  * \brief Matches a process image name against the filter from the command line.
+  *
+  * \param[in] Context The upcased filter expression.
+  * \param[in] Name The image name.
+  * \param[in] Length The number of characters in the name.
+  *
+  * \return Whether the name matches.
+  */
+BOOLEAN H2AnalysisMatchName(
+    _In_ PVOID Context,
+    _In_reads_(Length) const H2_CHAR* Name,
+    _In_ size_t Length
+)
+{
+    UNICODE_STRING name;
+
+    name.Buffer = (PWCH)Name;
+    name.Length = (USHORT)(Length * sizeof(WCHAR));
+    name.MaximumLength = name.Length;
+
+    return RtlIsNameInExpression((PUNICODE_STRING)Context, &name, TRUE, NULL);
+}
+
+/**
+  * \brief Maps one snapshot and formats its sockets on a worker thread.
+  *
+  * \param[in] Context The analysis context.
+  * \param[in] ItemIndex The index of the file.
+  */
+VOID NTAPI H2AnalyzeFile(
+    _In_ PVOID Context,
+    _In_ ULONG ItemIndex
+)
+{
+    NTSTATUS status;
+    PH2_ANALYSIS_CONTEXT context = Context;
+    PH2_ANALYSIS_FILE file = &context->Files[ItemIndex];
+    H2_COLUMNAR_READER reader;
+    PH2_AFD_SOCKET_RECORD record;
+    H2_ANALYSIS_TURN turn = { context, ItemIndex };
+    H2_REPORT_FILTER filter = { 0 };
+    H2_PRINTER printer;
+
+    // Collect the output to print it in order later, unless the file is already next
+    H2_TIMELINE_BEGIN("Analyze snapshot", ItemIndex);
+    H2SetThreadOutput(&file->Output);
+    H2AnalysisTakeTurn(context, ItemIndex);
+
+    status = H2ColumnarOpen(file->FileName, &reader);
+
+    if (!NT_SUCCESS(status))
+    {
+        H2Print(L"Unable to open the snapshot %s: ", file->FileName);
+        H2PrintStatusWithDescription(status);
+        H2Print(L"\r\n\r\n");
+        goto CLEANUP;
+    }
+
+    // Elapsed times count from the moment of the snapshot
+    H2InitializeConsolePrinter(&printer, context->Arguments->Verbose, FALSE);
+    printer.SystemTime = reader.Timestamp;
+    H2ReportSnapshotHeader(&printer, file->FileName, &reader);
+
+    // Either select one PID or all processes with the image names matching the filter
+    filter.ProcessId = (ULONG_PTR)context->Arguments->ProcessId;
+    filter.MatchName = H2AnalysisMatchName;
+    filter.MatchContext = &context->Arguments->ProcessFilter;
+    filter.HandleValue = (ULONG_PTR)context->Arguments->HandleValue;
+    filter.OnRow = H2AnalysisOnRow;
+    filter.RowContext = &turn;
+
+    // The record is too large for the stack of a worker
+    record = RtlAllocateHeap(RtlProcessHeap(), 0, sizeof(H2_AFD_SOCKET_RECORD));
+
+    if (record)
+    {
+        status = H2ReportSnapshot(&printer, &filter, &reader, record);
+        RtlFreeHeap(RtlProcessHeap(), 0, record);
+    }
+    else
+    {
+        status = STATUS_NO_MEMORY;
+    }
+
+    if (!NT_SUCCESS(status))
+    {
+        H2Print(L"Unable to read the snapshot: ");
+        H2PrintStatusWithDescription(status);
+        H2Print(L"\r\n\r\n");
+    }
+
+    H2ColumnarClose(&reader);
+
+CLEANUP:
+    H2SetThreadOutput(NULL);
+
+    // Console text must reach the output before the next file takes over
+    if (file->Direct)
+        H2FlushOutput();
+
+    H2_TIMELINE_END("Analyze snapshot");
+}
+
+/**
+  * \brief Prints sockets from saved columnar snapshots in the same format as the live system.
+  *
+  * \param[in] Arguments The parsed arguments with the snapshot files, the filters, and the number of worker threads.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2AnalyzeSnapshots(
+    _In_ PH2_ARGUMENTS Arguments
+)
+{
+    NTSTATUS status;
+    H2_ANALYSIS_CONTEXT context = { 0 };
+    H2_WORK_POOL pool;
+
+    context.Arguments = Arguments;
+    context.Files = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, Arguments->NumberOfSnapshots * sizeof(H2_ANALYSIS_FILE));
+
+    if (!context.Files)
+        return STATUS_NO_MEMORY;
+
+    for (ULONG i = 0; i < Arguments->NumberOfSnapshots; i++)
+        context.Files[i].FileName = Arguments->SnapshotFileNames[i];
+
+    // The first file writes to the console right away, after anything printed before
+    H2FlushOutput();
+
+    // Each file is a work item; without extra threads, they run on demand from the wait below
+    status = H2StartWorkPool(
+        &pool,
+        Arguments->NumberOfThreads > 1 ? min(Arguments->NumberOfThreads, Arguments->NumberOfSnapshots) : 0,
+        Arguments->NumberOfSnapshots,
+        H2AnalyzeFile,
+        &context
+    );
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    // Print files in the command-line order; the file at the head writes to the console itself
+    for (ULONG i = 0; i < Arguments->NumberOfSnapshots; i++)
+    {
+        H2WaitForWorkItem(&pool, i);
+
+        if (!context.Files[i].Direct)
+        {
+            // The file completed before its turn
+            H2FlushOutputBuffer(&context.Files[i].Output);
+            H2FreeOutputBuffer(&context.Files[i].Output);
+            H2FlushOutput();
+        }
+
+        InterlockedExchange(&context.NextToPrint, i + 1);
+    }
+
+    H2StopWorkPool(&pool);
+
+CLEANUP:
+    for (ULONG i = 0; i < Arguments->NumberOfSnapshots; i++)
+        H2FreeOutputBuffer(&context.Files[i].Output);
+
+    RtlFreeHeap(RtlProcessHeap(), 0, context.Files);
+    return status;
+}
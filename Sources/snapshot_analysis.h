@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SNAPSHOT_ANALYSIS_H
+#define _SNAPSHOT_ANALYSIS_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "argument_parsing.h"
+
+NTSTATUS
+NTAPI
+H2AnalyzeSnapshots(
+    _In_ PH2_ARGUMENTS Arguments
+);
+
+#endif
@@ -133,6 +133,109 @@ NTSTATUS H2SnapshotHandles(
     return H2QuerySystemInformation(SystemExtendedHandleInformation, Snapshot);
 }
 
+/**
+  * \brief Groups handles of a specific type from a snapshot by their owning process.
+  *
+  * \param[in] Snapshot A handle snapshot. The index references it and does not take ownership.
+  * \param[in] TypeIndex The kernel type index of handles to include.
+  * \param[out] Index A handle index. The caller is responsible for releasing it via H2FreeHandleIndex.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2BuildHandleIndex(
+    _In_ PSYSTEM_HANDLE_INFORMATION_EX Snapshot,
+    _In_ ULONG TypeIndex,
+    _Out_ PH2_HANDLE_INDEX Index
+)
+{
+    ULONG_PTR maxBucket = 0;
+    ULONG numberOfEntries = 0;
+    PULONG bucketStarts;
+    PULONG entries;
+
+    if (Snapshot->NumberOfHandles > MAXULONG)
+        return STATUS_INTEGER_OVERFLOW;
+
+    // First pass: determine the range of buckets
+    for (ULONG i = 0; i < Snapshot->NumberOfHandles; i++)
+    {
+        if (Snapshot->Handles[i].ObjectTypeIndex == TypeIndex)
+        {
+            ULONG_PTR bucket = H2_HANDLE_INDEX_BUCKET(Snapshot->Handles[i].UniqueProcessId);
+
+            if (bucket > maxBucket)
+                maxBucket = bucket;
+
+            numberOfEntries++;
+        }
+    }
+
+    if (maxBucket >= MAXULONG - 1)
+        return STATUS_INTEGER_OVERFLOW;
+
+    // Allocate the counters with one extra slot for the prefix sum
+    bucketStarts = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, (maxBucket + 2) * sizeof(ULONG));
+
+    if (!bucketStarts)
+        return STATUS_NO_MEMORY;
+
+    entries = RtlAllocateHeap(RtlProcessHeap(), 0, max(numberOfEntries, 1) * sizeof(ULONG));
+
+    if (!entries)
+    {
+        RtlFreeHeap(RtlProcessHeap(), 0, bucketStarts);
+        return STATUS_NO_MEMORY;
+    }
+
+    // Second pass: count handles per process
+    for (ULONG i = 0; i < Snapshot->NumberOfHandles; i++)
+    {
+        if (Snapshot->Handles[i].ObjectTypeIndex == TypeIndex)
+            bucketStarts[H2_HANDLE_INDEX_BUCKET(Snapshot->Handles[i].UniqueProcessId) + 1]++;
+    }
+
+    // Convert the counts into starting offsets
+    for (ULONG_PTR bucket = 1; bucket <= maxBucket + 1; bucket++)
+        bucketStarts[bucket] += bucketStarts[bucket - 1];
+
+    // Third pass: scatter handles into their buckets, preserving the snapshot order. Using the
+    // starting offsets as cursors leaves each one pointing to the next bucket; shift them back after.
+    for (ULONG i = 0; i < Snapshot->NumberOfHandles; i++)
+    {
+        if (Snapshot->Handles[i].ObjectTypeIndex == TypeIndex)
+            entries[bucketStarts[H2_HANDLE_INDEX_BUCKET(Snapshot->Handles[i].UniqueProcessId)]++] = i;
+    }
+
+    for (ULONG_PTR bucket = maxBucket + 1; bucket > 0; bucket--)
+        bucketStarts[bucket] = bucketStarts[bucket - 1];
+
+    bucketStarts[0] = 0;
+
+    Index->Snapshot = Snapshot;
+    Index->NumberOfBuckets = (ULONG)(maxBucket + 1);
+    Index->BucketStarts = bucketStarts;
+    Index->Entries = entries;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Releases a previously built handle index.
+  *
+  * \param[in] Index A handle index.
+  */
+VOID H2FreeHandleIndex(
+    _Inout_ PH2_HANDLE_INDEX Index
+)
+{
+    if (Index->BucketStarts)
+        RtlFreeHeap(RtlProcessHeap(), 0, Index->BucketStarts);
+
+    if (Index->Entries)
+        RtlFreeHeap(RtlProcessHeap(), 0, Index->Entries);
+
+    memset(Index, 0, sizeof(H2_HANDLE_INDEX));
+}
+
 #define OB_TYPE_INDEX_TABLE_TYPE_OFFSET 2
 
 /**
@@ -66,6 +66,59 @@ H2SnapshotHandles(
     _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
 );
 
+typedef struct _H2_HANDLE_INDEX
+{
+    PSYSTEM_HANDLE_INFORMATION_EX Snapshot;
+    ULONG NumberOfBuckets;
+    PULONG BucketStarts; // NumberOfBuckets + 1 entries
+    PULONG Entries; // Indexes in Snapshot->Handles, grouped by process
+} H2_HANDLE_INDEX, *PH2_HANDLE_INDEX;
+
+NTSTATUS
+NTAPI
+H2BuildHandleIndex(
+    _In_ PSYSTEM_HANDLE_INFORMATION_EX Snapshot,
+    _In_ ULONG TypeIndex,
+    _Out_ PH2_HANDLE_INDEX Index
+);
+
+VOID
+NTAPI
+H2FreeHandleIndex(
+    _Inout_ PH2_HANDLE_INDEX Index
+);
+
+// Process IDs are multiples of four; use them as bucket numbers without the lower bits
+#define H2_HANDLE_INDEX_BUCKET(ProcessId) ((ULONG_PTR)(ProcessId) >> 2)
+
+/**
+  * \brief Locates handles that belong to a specific process in a handle index.
+  *
+  * \param[in] Index A handle index.
+  * \param[in] ProcessId The unique ID of the process.
+  * \param[out] Entries A pointer to a variable that receives the first index of the process's handle in the snapshot.
+  *
+  * \return The number of handles of the process in the index.
+  */
+FORCEINLINE
+ULONG H2LookupHandleIndex(
+    _In_ PH2_HANDLE_INDEX Index,
+    _In_ HANDLE ProcessId,
+    _Outptr_result_maybenull_ PULONG* Entries
+)
+{
+    ULONG_PTR bucket = H2_HANDLE_INDEX_BUCKET(ProcessId);
+
+    if (bucket >= Index->NumberOfBuckets)
+    {
+        *Entries = NULL;
+        return 0;
+    }
+
+    *Entries = &Index->Entries[Index->BucketStarts[bucket]];
+    return Index->BucketStarts[bucket + 1] - Index->BucketStarts[bucket];
+}
+
 NTSTATUS
 NTAPI
 H2FindKernelTypeIndex(
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "snapshot_report.h"
+#include "socket_format.h"
+
+/**
+  * \brief Prints the name and the time of a snapshot.
+  *
+  * \param[in] Printer The printer with the time zone bias.
+  * \param[in] FileName The name of the snapshot file.
+  * \param[in] Reader The reader with the opened snapshot.
+  */
+void H2ReportSnapshotHeader(
+    _In_ PH2_PRINTER Printer,
+    _In_ const H2_CHAR* FileName,
+    _In_ PH2_COLUMNAR_READER Reader
+)
+{
+    H2WriteString(Printer, H2_T("Snapshot "));
+    H2WriteString(Printer, FileName);
+    H2WriteString(Printer, H2_T(" from "));
+    H2WriteTimeStamp(Printer, Reader->Timestamp);
+    H2WriteString(Printer, H2_T(":") H2_NEWLINE H2_NEWLINE);
+}
+
+/**
+  * \brief Converts a process name from a snapshot to formatted text.
+  *
+  * \param[out] Buffer A buffer for H2_REPORT_MAX_NAME characters.
+  * \param[in] Name The UTF-8 name.
+  * \param[in] Length The length of the name in bytes.
+  *
+  * \return The number of characters in the converted name.
+  */
+size_t H2ReportConvertName(
+    _Out_writes_(H2_REPORT_MAX_NAME) H2_CHAR* Buffer,
+    _In_reads_bytes_(Length) const char* Name,
+    _In_ H2_ULONG Length
+)
+{
+#ifdef _WIN32
+    return H2ColumnarConvertUtf8(Buffer, H2_REPORT_MAX_NAME, (const H2_UCHAR*)Name, Length);
+#else
+    if (Length > H2_REPORT_MAX_NAME)
+        Length = H2_REPORT_MAX_NAME;
+
+    for (H2_ULONG i = 0; i < Length; i++)
+        Buffer[i] = Name[i];
+
+    return Length;
+#endif
+}
+
+/**
+  * \brief Prints the sockets of a snapshot that match the filter.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Filter The process and handle filters.
+  * \param[in] Reader The reader with the opened snapshot.
+  * \param[out] Record A buffer for restoring records.
+  *
+  * \return Successful or errant status.
+  */
+H2_STATUS H2ReportSnapshot(
+    _In_ PH2_PRINTER Printer,
+    _In_ const H2_REPORT_FILTER* Filter,
+    _Inout_ PH2_COLUMNAR_READER Reader,
+    _Out_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_STATUS status;
+    H2_AFD_SUMMARY_RECORD summary;
+    const char* processNameUtf8;
+    H2_ULONG processNameUtf8Length;
+    H2_CHAR processName[H2_REPORT_MAX_NAME];
+    size_t processNameLength = 0;
+    H2_ULONG processNameIndex = H2_COLUMNAR_NO_ENTRY;
+    H2_ULONG64 processId;
+    H2_ULONG64 handleValue;
+    H2_ULONG64 previousProcessId = 0;
+    H2_ULONG previousNameIndex = H2_COLUMNAR_NO_ENTRY;
+    H2_ULONG processesFound = 0;
+
+    while (H2_SUCCESS(status = H2ColumnarReadRow(Reader, &processNameUtf8, &processNameUtf8Length, &processId, &handleValue)))
+    {
+        // Only convert the name when the process changes
+        if (Reader->ProcessNameIndex != processNameIndex)
+        {
+            processNameLength = H2ReportConvertName(processName, processNameUtf8, processNameUtf8Length);
+            processNameIndex = Reader->ProcessNameIndex;
+        }
+
+        if (Filter->OnRow)
+            Filter->OnRow(Filter->RowContext);
+
+        // Either select one PID or all processes with the image names matching the filter
+        if (Filter->ProcessId ? processId != Filter->ProcessId :
+            !Filter->MatchName(Filter->MatchContext, processName, processNameLength))
+            continue;
+
+        if (Filter->HandleValue && handleValue != Filter->HandleValue)
+            continue;
+
+        // Only restore records of matching rows
+        status = H2ColumnarGetRecord(Reader, Record);
+
+        if (!H2_SUCCESS(status))
+            break;
+
+        if (Filter->HandleValue)
+        {
+            // Same as inspecting a specific handle
+            H2WriteString(Printer, H2_T("Handle 0x"));
+            H2WriteHexadecimal(Printer, handleValue, 4);
+            H2WriteString(Printer, H2_T(" of "));
+            H2WriteText(Printer, processName, processNameLength);
+            H2WriteString(Printer, H2_T(" ["));
+            H2WriteUnsigned(Printer, processId);
+            H2WriteString(Printer, H2_T("]:") H2_NEWLINE);
+            H2AfdWriteSocketRecord(Printer, Record);
+            H2WriteString(Printer, H2_NEWLINE);
+            processesFound++;
+            continue;
+        }
+
+        // Rows of a process are adjacent, so group them the same way as the summary
+        if (processId != previousProcessId || Reader->ProcessNameIndex != previousNameIndex)
+        {
+            if (processesFound++)
+                H2WriteString(Printer, H2_NEWLINE);
+
+            H2WriteText(Printer, processName, processNameLength);
+            H2WriteString(Printer, H2_T(" ["));
+            H2WriteUnsigned(Printer, processId);
+            H2WriteString(Printer, H2_T("]") H2_NEWLINE);
+            previousProcessId = processId;
+            previousNameIndex = Reader->ProcessNameIndex;
+        }
+
+        H2AfdGetSummaryRecord(Record, &summary);
+        H2WriteString(Printer, H2_T("[0x"));
+        H2WriteHexadecimal(Printer, handleValue, 4);
+        H2WriteString(Printer, H2_T("] "));
+        H2AfdWriteSummaryRecord(Printer, &summary);
+        H2WriteString(Printer, H2_NEWLINE);
+    }
+
+    if (status == H2_STATUS_NO_MORE_ENTRIES)
+        status = H2_STATUS_SUCCESS;
+
+    if (H2_SUCCESS(status) && processesFound == 0)
+        H2WriteString(Printer, Filter->HandleValue ? H2_T("No matching handles found.") H2_NEWLINE : H2_T("No matching processes found.") H2_NEWLINE);
+
+    if (!Filter->HandleValue)
+        H2WriteString(Printer, H2_NEWLINE);
+
+    return status;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SNAPSHOT_REPORT_H
+#define _SNAPSHOT_REPORT_H
+
+//
+// Printing of saved snapshots in the same format as the live system. The filters and the
+// output are supplied by the caller, so both --analyze and afdview-analyze share this code.
+//
+
+#include "columnar_reader.h"
+#include "text_format.h"
+
+// The size of a buffer for process names, in characters
+#define H2_REPORT_MAX_NAME 260
+
+// Decides whether a process image name matches the filter
+typedef H2_BOOLEAN (*PH2_REPORT_MATCH_NAME)(
+    _In_ void* Context,
+    _In_reads_(Length) const H2_CHAR* Name,
+    _In_ size_t Length
+    );
+
+// Runs before each row, such as for switching the output
+typedef void (*PH2_REPORT_ON_ROW)(
+    _In_ void* Context
+    );
+
+typedef struct _H2_REPORT_FILTER
+{
+    H2_ULONG64 ProcessId; // Zero to match processes by name
+    PH2_REPORT_MATCH_NAME MatchName;
+    void* MatchContext;
+    H2_ULONG64 HandleValue; // Zero for all handles
+    PH2_REPORT_ON_ROW OnRow; // Optional
+    void* RowContext;
+} H2_REPORT_FILTER, *PH2_REPORT_FILTER;
+
+void
+H2ReportSnapshotHeader(
+    _In_ PH2_PRINTER Printer,
+    _In_ const H2_CHAR* FileName,
+    _In_ PH2_COLUMNAR_READER Reader
+);
+
+H2_STATUS
+H2ReportSnapshot(
+    _In_ PH2_PRINTER Printer,
+    _In_ const H2_REPORT_FILTER* Filter,
+    _Inout_ PH2_COLUMNAR_READER Reader,
+    _Out_ PH2_AFD_SOCKET_RECORD Record
+);
+
+#endif
@@ -0,0 +1,1385 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "socket_format.h"
+#include "socket_strings.h"
+
+typedef struct _H2_AFD_PROPERTY_NAME_PAIR
+{
+    const H2_CHAR* FriendlyName;
+    const H2_CHAR* RawName;
+    const H2_CHAR* Key; // For JSON output
+} H2_AFD_PROPERTY_NAME_PAIR;
+
+#define H2_AFD_PROPERTY_NAMES(Property, Volatility, FriendlyName, RawName) { H2_T(FriendlyName), H2_T(RawName), H2_T(#Property) },
+#define H2_AFD_OPTION_NAMES(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName) { H2_T(FriendlyName), H2_T(RawName), H2_T(#Option) },
+#define H2_AFD_MERGED_NAMES(Property, Ipv4Option, Ipv6Option, Kind, Volatility, FriendlyName, RawName) { H2_T(FriendlyName), H2_T(RawName), H2_T(#Property) },
+
+const H2_AFD_PROPERTY_NAME_PAIR H2AfdPropertyNames[H2_AFD_PROPERTY_MAX] = {
+    H2_AFD_PROPERTIES(H2_AFD_PROPERTY_NAMES, H2_AFD_OPTION_NAMES, H2_AFD_MERGED_NAMES)
+};
+
+#undef H2_AFD_PROPERTY_NAMES
+#undef H2_AFD_OPTION_NAMES
+#undef H2_AFD_MERGED_NAMES
+
+/**
+  * \brief Looks up a name for a socket property.
+  *
+  * \param[in] Printer The printer that selects the kind of name.
+  * \param[in] Property An index of the property.
+  *
+  * \return A property name string.
+  */
+const H2_CHAR* H2AfdGetPropertyName(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property
+)
+{
+    if (Property < 0 || Property >= H2_AFD_PROPERTY_MAX)
+        return H2_T("");
+
+    if (Printer->Json)
+        return H2AfdPropertyNames[Property].Key;
+
+    return Printer->Raw ? H2AfdPropertyNames[Property].RawName : H2AfdPropertyNames[Property].FriendlyName;
+}
+
+/* Property printing */
+
+/**
+  * \brief Starts printing a property value: the name in text mode or the key in JSON mode.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  */
+void H2AfdWriteBeginProperty(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property
+)
+{
+    if (Printer->Json)
+    {
+        H2WriteText(Printer, H2_T(",\""), 2);
+        H2WriteString(Printer, H2AfdGetPropertyName(Printer, Property));
+        H2WriteString(Printer, H2_T("\":{\"text\":\""));
+    }
+    else
+    {
+        H2WriteString(Printer, H2AfdGetPropertyName(Printer, Property));
+        H2WriteText(Printer, H2_T(": "), 2);
+    }
+}
+
+/**
+  * \brief Starts printing a property value that has a numeric representation.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value The raw value to include in JSON mode.
+  * \param[in] Signed Whether to interpret the value as signed.
+  */
+void H2AfdWriteBeginNumericProperty(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG64 Value,
+    _In_ H2_BOOLEAN Signed
+)
+{
+    if (Printer->Json)
+    {
+        H2WriteText(Printer, H2_T(",\""), 2);
+        H2WriteString(Printer, H2AfdGetPropertyName(Printer, Property));
+        H2WriteString(Printer, H2_T("\":{\"value\":"));
+
+        if (Signed)
+            H2WriteSigned(Printer, (H2_LONG64)Value);
+        else
+            H2WriteUnsigned(Printer, Value);
+
+        H2WriteString(Printer, H2_T(",\"text\":\""));
+    }
+    else
+    {
+        H2WriteString(Printer, H2AfdGetPropertyName(Printer, Property));
+        H2WriteText(Printer, H2_T(": "), 2);
+    }
+}
+
+/**
+  * \brief Prints a string as a part of a property value, escaping it in JSON mode.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Text The text.
+  * \param[in] Length The number of characters in the text.
+  */
+void H2AfdWritePropertyText(
+    _In_ PH2_PRINTER Printer,
+    _In_reads_(Length) const H2_CHAR* Text,
+    _In_ size_t Length
+)
+{
+    if (Printer->Json)
+        H2WriteJsonEscaped(Printer, Text, Length);
+    else
+        H2WriteText(Printer, Text, Length);
+}
+
+/**
+  * \brief Completes printing a property value.
+  *
+  * \param[in] Printer The printer.
+  */
+void H2AfdWriteEndProperty(
+    _In_ PH2_PRINTER Printer
+)
+{
+    if (Printer->Json)
+        H2WriteText(Printer, H2_T("\"}"), 2);
+    else
+        H2WriteString(Printer, H2_NEWLINE);
+}
+
+/**
+  * \brief Prints a property value as a string.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  * \param[in] Length The number of characters in the value.
+  */
+void H2AfdWritePropertyString(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_reads_(Length) const H2_CHAR* Value,
+    _In_ size_t Length
+)
+{
+    H2AfdWriteBeginProperty(Printer, Property);
+    H2AfdWritePropertyText(Printer, Value, Length);
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints a property value as a boolean.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyBoolean(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG Value
+)
+{
+    H2AfdWriteBeginNumericProperty(Printer, Property, Value, FALSE);
+
+    if (Printer->Raw)
+    {
+        H2WriteText(Printer, H2_T("0x"), 2);
+        H2WriteHexadecimal(Printer, Value, 0);
+    }
+    else
+    {
+        H2WriteString(Printer, Value ? H2_T("True") : H2_T("False"));
+    }
+
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints a property value as a decimal number.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyDecimal(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG Value
+)
+{
+    H2AfdWriteBeginNumericProperty(Printer, Property, (H2_LONG)Value, TRUE);
+    H2WriteSigned(Printer, (H2_LONG)Value);
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints a property value as a hexadecimal number.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyHexadecimal(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG64 Value
+)
+{
+    H2AfdWriteBeginNumericProperty(Printer, Property, Value, FALSE);
+    H2WriteText(Printer, H2_T("0x"), 2);
+    H2WriteHexadecimal(Printer, Value, 0);
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints a property value as a number of bytes.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyBytes(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG64 Value
+)
+{
+    H2AfdWriteBeginNumericProperty(Printer, Property, Value, FALSE);
+
+    if (Printer->Raw)
+    {
+        H2WriteUnsigned(Printer, Value);
+        H2WriteString(Printer, H2_T(" bytes"));
+    }
+    else
+    {
+        H2WriteByteSize(Printer, Value);
+    }
+
+    H2AfdWriteEndProperty(Printer);
+}
+
+typedef enum _H2_TIME_UNIT
+{
+    H2_TIME_UNIT_US,
+    H2_TIME_UNIT_MS,
+    H2_TIME_UNIT_SEC,
+} H2_TIME_UNIT;
+
+/**
+  * \brief Prints a property value as time duration or time ago.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A time duration.
+  * \param[in] Units A type of units for the Value parameter.
+  * \param[in] PrintAsTimeAgo Treats the duration as elapsed in the past from the system time of the printer.
+  * \param[in] MaxValueComment An optional string to use in place of 0xFFFFFFFF values.
+  */
+void H2AfdWritePropertyTime(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG64 Value,
+    _In_ H2_TIME_UNIT Units,
+    _In_ H2_BOOLEAN PrintAsTimeAgo,
+    _In_opt_ const H2_CHAR* MaxValueComment
+)
+{
+    const H2_CHAR* units;
+    H2_ULONG64 multiplier;
+
+    switch (Units)
+    {
+    case H2_TIME_UNIT_US:
+        multiplier = TICKS_PER_US;
+        units = H2_T("us");
+        break;
+    case H2_TIME_UNIT_MS:
+        multiplier = TICKS_PER_MS;
+        units = H2_T("ms");
+        break;
+    case H2_TIME_UNIT_SEC:
+        multiplier = TICKS_PER_SEC;
+        units = H2_T("sec");
+        break;
+    default:
+        multiplier = 1;
+        units = H2_T("ticks");
+    }
+
+    H2AfdWriteBeginNumericProperty(Printer, Property, Value, FALSE);
+
+    if (Printer->Raw)
+    {
+        H2WriteUnsigned(Printer, Value);
+        H2WriteText(Printer, H2_T(" "), 1);
+        H2WriteString(Printer, units);
+    }
+    else if (Value == 0xFFFFFFFF)
+    {
+        H2WriteString(Printer, MaxValueComment ? MaxValueComment : H2_T("Unlimited"));
+    }
+    else
+    {
+        H2WriteTimeSpan(Printer, Value * multiplier);
+
+        if (PrintAsTimeAgo)
+        {
+            H2WriteString(Printer, H2_T(" ago ("));
+            H2WriteTimeStamp(Printer, Printer->SystemTime - (H2_LONG64)(Value * multiplier));
+            H2WriteText(Printer, H2_T(")"), 1);
+        }
+    }
+
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints a property value as a GUID.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyGuid(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ const H2_GUID* Value
+)
+{
+    H2AfdWriteBeginProperty(Printer, Property);
+    H2WriteGuid(Printer, Value);
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints an error associated with querying a property.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Status An NTSTATUS error.
+  */
+void H2AfdWritePropertyStatus(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_STATUS Status
+)
+{
+    if (Printer->Json)
+    {
+        H2WriteText(Printer, H2_T(",\""), 2);
+        H2WriteString(Printer, H2AfdGetPropertyName(Printer, Property));
+        H2WriteString(Printer, H2_T("\":{\"status\":\"0x"));
+        H2WriteHexadecimal(Printer, (H2_ULONG)Status, 8);
+        H2WriteText(Printer, H2_T("\"}"), 2);
+        return;
+    }
+
+    H2AfdWriteBeginProperty(Printer, Property);
+
+    if (Printer->Raw)
+    {
+        H2WriteString(Printer, H2_T("(query failed: 0x"));
+        H2WriteHexadecimal(Printer, (H2_ULONG)Status, 8);
+        H2WriteText(Printer, H2_T(")"), 1);
+    }
+
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints a numerical property value that might have an associated string representation.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A numeric value.
+  * \param[in] ValueString An optional string representation of the value.
+  */
+void H2AfdWritePropertyKnownValue(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG Value,
+    _In_opt_ const H2_CHAR* ValueString
+)
+{
+    H2AfdWriteBeginNumericProperty(Printer, Property, (H2_LONG)Value, TRUE);
+    H2WriteString(Printer, ValueString ? ValueString : H2_T("<unrecognized>"));
+
+    if (!ValueString || Printer->Raw)
+    {
+        H2WriteText(Printer, H2_T(" ("), 2);
+        H2WriteSigned(Printer, (H2_LONG)Value);
+        H2WriteText(Printer, H2_T(")"), 1);
+    }
+
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints a property value as a socket state.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertySocketState(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_LONG Value
+)
+{
+    H2AfdWritePropertyKnownValue(Printer, Property, Value, H2AfdGetSocketStateString(Value, Printer->Raw));
+}
+
+/**
+  * \brief Prints a property value as a socket type.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertySocketType(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_LONG Value
+)
+{
+    H2AfdWritePropertyKnownValue(Printer, Property, Value, H2AfdGetSocketTypeString(Value, Printer->Raw));
+}
+
+/**
+  * \brief Prints a property value as an address family.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyAddressFamily(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_LONG Value
+)
+{
+    H2AfdWritePropertyKnownValue(Printer, Property, Value, H2AfdGetAddressFamilyString(Value, Printer->Raw));
+}
+
+/**
+  * \brief Prints a property value as a protocol.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] AddressFamily An address family for the protocol.
+  * \param[in] Value A protocol value to print.
+  */
+void H2AfdWritePropertyProtocol(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_LONG AddressFamily,
+    _In_ H2_LONG Value
+)
+{
+    H2AfdWritePropertyKnownValue(Printer, Property, Value, H2AfdGetProtocolString(AddressFamily, Value, Printer->Raw));
+}
+
+/**
+  * \brief Prints a property value as a socket group type.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyGroupType(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_LONG Value
+)
+{
+    H2AfdWritePropertyKnownValue(Printer, Property, Value, H2AfdGetGroupTypeString(Value, Printer->Raw));
+}
+
+/**
+  * \brief Prints a TDI device property.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Device The device information.
+  */
+void H2AfdWritePropertyTdiDevice(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ PH2_AFD_TDI_DEVICE Device
+)
+{
+    H2_CHAR buffer[H2_AFD_DEVICE_NAME_LENGTH * 3];
+    const H2_CHAR* deviceName;
+    size_t length;
+
+    switch (Device->Kind)
+    {
+    case H2AfdTdiNotApplicable:
+        deviceName = Printer->Raw ? H2_T("INVALID_HANDLE_VALUE") : H2_T("N/A (transport is not TDI)");
+        break;
+    case H2AfdTdiNone:
+        deviceName = Printer->Raw ? H2_T("NULL") : H2_T("None");
+        break;
+    default:
+        deviceName = NULL;
+    }
+
+    if (deviceName)
+    {
+        H2AfdWriteBeginProperty(Printer, Property);
+        H2WriteString(Printer, deviceName);
+        H2AfdWriteEndProperty(Printer);
+        return;
+    }
+
+    // Records keep the name in UTF-16
+    length = H2ConvertUtf16(buffer, H2_NUMBER_OF(buffer), Device->Name, Device->NameLength / sizeof(H2_WCHAR));
+    H2AfdWritePropertyString(Printer, Property, buffer, length);
+}
+
+/**
+  * \brief Prints a property value as an interface index (scope ID) or IP.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyInterface(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG Value
+)
+{
+    H2AfdWriteBeginNumericProperty(Printer, Property, Value, FALSE);
+
+    if (Value & 0x000000FF)
+    {
+        // Values with a non-zero first octet identify an interface by IP address (in memory order)
+        for (H2_ULONG i = 0; i < 4; i++)
+        {
+            if (i)
+                H2WriteText(Printer, H2_T("."), 1);
+
+            H2WriteUnsigned(Printer, (Value >> (i * 8)) & 0xFF);
+        }
+    }
+    else if (Value)
+    {
+        // Other values (0.0.0.0/24 addresses) store a big-endian interface index/scope ID
+        H2WriteText(Printer, H2_T("%"), 1);
+        H2WriteSigned(Printer, (H2_LONG)(Value >> 24 | (Value >> 8 & 0xFF00) | (Value << 8 & 0xFF0000) | Value << 24));
+    }
+    else
+    {
+        // The zero interface is special
+        H2WriteString(Printer, H2_T("Default"));
+    }
+
+    if (Printer->Raw)
+    {
+        H2WriteText(Printer, H2_T(" (0x"), 4);
+        H2WriteHexadecimal(Printer, Value, 8);
+        H2WriteText(Printer, H2_T(")"), 1);
+    }
+
+    H2AfdWriteEndProperty(Printer);
+}
+
+/**
+  * \brief Prints a property value as an IPv6 protection level.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyProtectionLevel(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG Value
+)
+{
+    H2AfdWritePropertyKnownValue(Printer, Property, Value, H2AfdGetProtectionLevelString(Value, Printer->Raw));
+}
+
+/**
+  * \brief Prints a property value as an MTU discovery mode.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyMtuDiscover(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_ULONG Value
+)
+{
+    H2AfdWritePropertyKnownValue(Printer, Property, Value, H2AfdGetMtuDiscoveryString(Value, Printer->Raw));
+}
+
+/**
+  * \brief Prints a property value as a TCP state.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyTcpState(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_LONG Value
+)
+{
+    H2AfdWritePropertyKnownValue(Printer, Property, Value, H2AfdGetTcpStateString(Value, Printer->Raw));
+}
+
+/**
+  * \brief Prints an option value according to its kind.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Property A property index.
+  * \param[in] Kind The kind of the value.
+  * \param[in] Value A value to print.
+  */
+void H2AfdWritePropertyOption(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_AFD_PROPERTY Property,
+    _In_ H2_AFD_VALUE_KIND Kind,
+    _In_ H2_ULONG Value
+)
+{
+    switch (Kind)
+    {
+    case H2AfdValueBoolean:
+        H2AfdWritePropertyBoolean(Printer, Property, Value);
+        break;
+    case H2AfdValueBytes:
+        H2AfdWritePropertyBytes(Printer, Property, Value);
+        break;
+    case H2AfdValueSeconds:
+        H2AfdWritePropertyTime(Printer, Property, Value, H2_TIME_UNIT_SEC, FALSE, NULL);
+        break;
+    case H2AfdValueMilliseconds:
+        H2AfdWritePropertyTime(Printer, Property, Value, H2_TIME_UNIT_MS, FALSE, NULL);
+        break;
+    case H2AfdValueInterface:
+        H2AfdWritePropertyInterface(Printer, Property, Value);
+        break;
+    case H2AfdValueProtectionLevel:
+        H2AfdWritePropertyProtectionLevel(Printer, Property, Value);
+        break;
+    case H2AfdValueMtuDiscover:
+        H2AfdWritePropertyMtuDiscover(Printer, Property, Value);
+        break;
+    default:
+        H2AfdWritePropertyDecimal(Printer, Property, Value);
+    }
+}
+
+/* Record printing functions */
+
+/**
+  * \brief Prints a header of a group of properties. JSON output has no headers.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] FriendlyHeader The header to use in the human-readable mode.
+  * \param[in] RawHeader The header to use in the raw mode.
+  */
+void H2AfdWriteSectionHeader(
+    _In_ PH2_PRINTER Printer,
+    _In_opt_ const H2_CHAR* FriendlyHeader,
+    _In_opt_ const H2_CHAR* RawHeader
+)
+{
+    const H2_CHAR* header = Printer->Raw ? RawHeader : FriendlyHeader;
+
+    if (Printer->Json || !header)
+        return;
+
+    H2WriteString(Printer, header);
+    H2WriteString(Printer, H2_NEWLINE);
+}
+
+/**
+  * \brief Completes a group of properties.
+  *
+  * \param[in] Printer The printer.
+  */
+void H2AfdWriteSectionEnd(
+    _In_ PH2_PRINTER Printer
+)
+{
+    if (!Printer->Json)
+        H2WriteString(Printer, H2_NEWLINE);
+}
+
+/**
+  * \brief Print each property from the shared Winsock context of a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordSharedInfo(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_STATUS status;
+    PH2_SOCK_SHARED_INFO SharedInfo = &Record->SharedInfo;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[----- Winsock context -----]"), H2_T("[--------- IOCTL_AFD_GET_CONTEXT ---------]"));
+
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_SHARED_INFO]))
+    {
+        H2AfdWritePropertySocketState(Printer, H2_AFD_PROPERTY_SHARED_STATE, SharedInfo->State);
+        H2AfdWritePropertyAddressFamily(Printer, H2_AFD_PROPERTY_SHARED_ADDRESS_FAMILY, SharedInfo->AddressFamily);
+        H2AfdWritePropertySocketType(Printer, H2_AFD_PROPERTY_SHARED_SOCKET_TYPE, SharedInfo->SocketType);
+        H2AfdWritePropertyProtocol(Printer, H2_AFD_PROPERTY_SHARED_PROTOCOL, SharedInfo->AddressFamily, SharedInfo->Protocol);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_SHARED_LOCAL_ADDRESS_LENGTH, SharedInfo->LocalAddressLength);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_SHARED_REMOTE_ADDRESS_LENGTH, SharedInfo->RemoteAddressLength);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_LINGER_ONOFF, SharedInfo->LingerInfo.l_onoff);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_SHARED_LINGER_TIMEOUT, SharedInfo->LingerInfo.l_linger, H2_TIME_UNIT_SEC, FALSE, NULL);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_SHARED_SEND_TIMEOUT, SharedInfo->SendTimeout, H2_TIME_UNIT_MS, FALSE, NULL);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_SHARED_RECEIVE_TIMEOUT, SharedInfo->ReceiveTimeout, H2_TIME_UNIT_MS, FALSE, NULL);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_SHARED_RECEIVE_BUFFER_SIZE, SharedInfo->ReceiveBufferSize);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_SHARED_SEND_BUFFER_SIZE, SharedInfo->SendBufferSize);
+        H2AfdWritePropertyHexadecimal(Printer, H2_AFD_PROPERTY_SHARED_FLAGS, SharedInfo->Flags);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_LISTENING, SharedInfo->Listening);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_BROADCAST, SharedInfo->Broadcast);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_DEBUG, SharedInfo->Debug);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_OOB_INLINE, SharedInfo->OobInline);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_REUSE_ADDRESSES, SharedInfo->ReuseAddresses);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_EXCLUSIVE_ADDRESS_USE, SharedInfo->ExclusiveAddressUse);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_NON_BLOCKING, SharedInfo->NonBlocking);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_DONT_USE_WILDCARD, SharedInfo->DontUseWildcard);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_RECEIVE_SHUTDOWN, SharedInfo->ReceiveShutdown);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_SEND_SHUTDOWN, SharedInfo->SendShutdown);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_CONDITIONAL_ACCEPT, SharedInfo->ConditionalAccept);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_IS_SANSOCKET, SharedInfo->IsSANSocket);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_IS_TLI, SharedInfo->fIsTLI);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_RIO, SharedInfo->Rio);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_RECEIVE_BUFFER_SIZE_SET, SharedInfo->ReceiveBufferSizeSet);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_SEND_BUFFER_SIZE_SET, SharedInfo->SendBufferSizeSet);
+        H2AfdWritePropertyHexadecimal(Printer, H2_AFD_PROPERTY_SHARED_CREATION_FLAGS, SharedInfo->CreationFlags);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_WSA_FLAG_OVERLAPPED, SharedInfo->CreationFlags & H2_WSA_FLAG_OVERLAPPED);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_WSA_FLAG_MULTIPOINT_C_ROOT, SharedInfo->CreationFlags & H2_WSA_FLAG_MULTIPOINT_C_ROOT);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_WSA_FLAG_MULTIPOINT_C_LEAF, SharedInfo->CreationFlags & H2_WSA_FLAG_MULTIPOINT_C_LEAF);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_WSA_FLAG_MULTIPOINT_D_ROOT, SharedInfo->CreationFlags & H2_WSA_FLAG_MULTIPOINT_D_ROOT);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_WSA_FLAG_MULTIPOINT_D_LEAF, SharedInfo->CreationFlags & H2_WSA_FLAG_MULTIPOINT_D_LEAF);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_WSA_FLAG_ACCESS_SYSTEM_SECURITY, SharedInfo->CreationFlags & H2_WSA_FLAG_ACCESS_SYSTEM_SECURITY);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_WSA_FLAG_NO_HANDLE_INHERIT, SharedInfo->CreationFlags & H2_WSA_FLAG_NO_HANDLE_INHERIT);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_WSA_FLAG_REGISTERED_IO, SharedInfo->CreationFlags & H2_WSA_FLAG_REGISTERED_IO);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_SHARED_CATALOG_ENTRY_ID, SharedInfo->CatalogEntryId);
+        H2AfdWritePropertyHexadecimal(Printer, H2_AFD_PROPERTY_SHARED_SERVICE_FLAGS, SharedInfo->ServiceFlags1);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_CONNECTIONLESS, SharedInfo->ServiceFlags1 & H2_XP1_CONNECTIONLESS);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_GUARANTEED_DELIVERY, SharedInfo->ServiceFlags1 & H2_XP1_GUARANTEED_DELIVERY);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_GUARANTEED_ORDER, SharedInfo->ServiceFlags1 & H2_XP1_GUARANTEED_ORDER);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_MESSAGE_ORIENTED, SharedInfo->ServiceFlags1 & H2_XP1_MESSAGE_ORIENTED);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_PSEUDO_STREAM, SharedInfo->ServiceFlags1 & H2_XP1_PSEUDO_STREAM);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_GRACEFUL_CLOSE, SharedInfo->ServiceFlags1 & H2_XP1_GRACEFUL_CLOSE);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_EXPEDITED_DATA, SharedInfo->ServiceFlags1 & H2_XP1_EXPEDITED_DATA);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_CONNECT_DATA, SharedInfo->ServiceFlags1 & H2_XP1_CONNECT_DATA);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_DISCONNECT_DATA, SharedInfo->ServiceFlags1 & H2_XP1_DISCONNECT_DATA);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_SUPPORT_BROADCAST, SharedInfo->ServiceFlags1 & H2_XP1_SUPPORT_BROADCAST);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_SUPPORT_MULTIPOINT, SharedInfo->ServiceFlags1 & H2_XP1_SUPPORT_MULTIPOINT);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_MULTIPOINT_CONTROL_PLANE, SharedInfo->ServiceFlags1 & H2_XP1_MULTIPOINT_CONTROL_PLANE);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_MULTIPOINT_DATA_PLANE, SharedInfo->ServiceFlags1 & H2_XP1_MULTIPOINT_DATA_PLANE);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_QOS_SUPPORTED, SharedInfo->ServiceFlags1 & H2_XP1_QOS_SUPPORTED);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_INTERRUPT, SharedInfo->ServiceFlags1 & H2_XP1_INTERRUPT);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_UNI_SEND, SharedInfo->ServiceFlags1 & H2_XP1_UNI_SEND);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_UNI_RECV, SharedInfo->ServiceFlags1 & H2_XP1_UNI_RECV);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_IFS_HANDLES, SharedInfo->ServiceFlags1 & H2_XP1_IFS_HANDLES);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_PARTIAL_MESSAGE, SharedInfo->ServiceFlags1 & H2_XP1_PARTIAL_MESSAGE);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_XP1_SAN_SUPPORT_SDP, SharedInfo->ServiceFlags1 & H2_XP1_SAN_SUPPORT_SDP);
+        H2AfdWritePropertyHexadecimal(Printer, H2_AFD_PROPERTY_SHARED_PROVIDER_FLAGS, SharedInfo->ProviderFlags);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_PFL_MULTIPLE_PROTO_ENTRIES, SharedInfo->ProviderFlags & H2_PFL_MULTIPLE_PROTO_ENTRIES);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_PFL_RECOMMENDED_PROTO_ENTRY, SharedInfo->ProviderFlags & H2_PFL_RECOMMENDED_PROTO_ENTRY);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_PFL_HIDDEN, SharedInfo->ProviderFlags & H2_PFL_HIDDEN);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_PFL_MATCHES_PROTOCOL_ZERO, SharedInfo->ProviderFlags & H2_PFL_MATCHES_PROTOCOL_ZERO);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_SHARED_PFL_NETWORKDIRECT_PROVIDER, SharedInfo->ProviderFlags & H2_PFL_NETWORKDIRECT_PROVIDER);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_SHARED_GROUP_ID, SharedInfo->GroupID);
+        H2AfdWritePropertyGroupType(Printer, H2_AFD_PROPERTY_SHARED_GROUP_TYPE, SharedInfo->GroupType);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_SHARED_GROUP_PRIORITY, SharedInfo->GroupPriority);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_SHARED_LAST_ERROR, SharedInfo->LastError);
+        H2AfdWritePropertyHexadecimal(Printer, H2_AFD_PROPERTY_SHARED_ASYNC_SELECT_WND, SharedInfo->AsyncSelectWnd64);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_SHARED_ASYNC_SELECT_SERIAL_NUMBER, SharedInfo->AsyncSelectSerialNumber);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_SHARED_ASYNC_SELECTW_MSG, SharedInfo->AsyncSelectwMsg);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_SHARED_ASYNC_SELECTL_EVENT, SharedInfo->AsyncSelectlEvent);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_SHARED_DISABLED_ASYNC_SELECT_EVENTS, SharedInfo->DisabledAsyncSelectEvents);
+        H2AfdWritePropertyGuid(Printer, H2_AFD_PROPERTY_SHARED_PROVIDER_ID, &SharedInfo->ProviderId);
+    }
+    else
+    {
+        for (H2_ULONG i = H2_AFD_PROPERTY_SHARED_STATE; i <= H2_AFD_PROPERTY_SHARED_PROVIDER_ID; i++)
+            H2AfdWritePropertyStatus(Printer, (H2_AFD_PROPERTY)i, status);
+    }
+
+    H2AfdWriteSectionEnd(Printer);
+}
+
+/**
+  * \brief Formats an address from a socket record into a buffer.
+  *
+  * \param[in] Record A socket record.
+  * \param[in] Remote Whether the function should format the remote or the local address.
+  * \param[out] Buffer A buffer for H2_AFD_ADDRESS_MAX_LENGTH characters that receives the address.
+  * \param[out] Length The number of characters in the address.
+  *
+  * \return Successful or errant status.
+  */
+H2_STATUS H2AfdFormatRecordAddress(
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _In_ H2_BOOLEAN Remote,
+    _Out_writes_(H2_AFD_ADDRESS_MAX_LENGTH) H2_CHAR* Buffer,
+    _Out_ size_t* Length
+)
+{
+    H2_STATUS status = Record->Status[Remote ? H2_AFD_FIELD_REMOTE_ADDRESS : H2_AFD_FIELD_LOCAL_ADDRESS];
+
+    *Length = 0;
+
+    if (!H2_SUCCESS(status))
+        return status;
+
+    return H2AfdFormatAddressToBuffer(Remote ? &Record->RemoteAddress : &Record->LocalAddress, 0, Buffer, H2_AFD_ADDRESS_MAX_LENGTH, Length);
+}
+
+/**
+  * \brief Print addresses from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordAddresses(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_STATUS status;
+    H2_CHAR buffer[H2_AFD_ADDRESS_MAX_LENGTH];
+    size_t length;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[-------- Addresses --------]"), H2_T("[--------------- Addresses ---------------]"));
+
+    // Local address
+    if (H2_SUCCESS(status = H2AfdFormatRecordAddress(Record, FALSE, buffer, &length)))
+        H2AfdWritePropertyString(Printer, H2_AFD_PROPERTY_LOCAL_ADDRESS, buffer, length);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_LOCAL_ADDRESS, status);
+
+    // Remote address
+    if (H2_SUCCESS(status = H2AfdFormatRecordAddress(Record, TRUE, buffer, &length)))
+        H2AfdWritePropertyString(Printer, H2_AFD_PROPERTY_REMOTE_ADDRESS, buffer, length);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_REMOTE_ADDRESS, status);
+
+    H2AfdWriteSectionEnd(Printer);
+}
+
+/**
+  * \brief Print AFD info classes from a socket record as properties.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordSimpleInfo(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_STATUS status;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[---- AFD info classes -----]"), H2_T("[------- IOCTL_AFD_GET_INFORMATION -------]"));
+
+    // Maximum send size
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_MAX_SEND_SIZE]))
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_AFD_MAX_SEND_SIZE, Record->MaxSendSize);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_AFD_MAX_SEND_SIZE, status);
+
+    // Pending sends
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_SENDS_PENDING]))
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_AFD_SENDS_PENDING, Record->SendsPending);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_AFD_SENDS_PENDING, status);
+
+    // Maximum path send size
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_MAX_PATH_SEND_SIZE]))
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_AFD_MAX_PATH_SEND_SIZE, Record->MaxPathSendSize);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_AFD_MAX_PATH_SEND_SIZE, status);
+
+    // Receive window size
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_RECEIVE_WINDOW_SIZE]))
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_AFD_RECEIVE_WINDOW_SIZE, Record->ReceiveWindowSize);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_AFD_RECEIVE_WINDOW_SIZE, status);
+
+    // Send window size
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_SEND_WINDOW_SIZE]))
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_AFD_SEND_WINDOW_SIZE, Record->SendWindowSize);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_AFD_SEND_WINDOW_SIZE, status);
+
+    // Connect time
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_CONNECT_TIME]))
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_AFD_CONNECT_TIME, Record->ConnectTime, H2_TIME_UNIT_SEC, TRUE, H2_T("N/A (not connected)"));
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_AFD_CONNECT_TIME, status);
+
+    // Group ID & group type
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_GROUP_ID_AND_TYPE]))
+    {
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_AFD_GROUP_ID, Record->GroupInfo.GroupID);
+        H2AfdWritePropertyGroupType(Printer, H2_AFD_PROPERTY_AFD_GROUP_TYPE, Record->GroupInfo.GroupType);
+    }
+    else
+    {
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_AFD_GROUP_ID, status);
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_AFD_GROUP_TYPE, status);
+    }
+
+    H2AfdWriteSectionEnd(Printer);
+}
+
+/**
+  * \brief Print TDI devices properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordTDIDevices(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_STATUS status;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[------- TDI devices -------]"), H2_T("[-------- IOCTL_AFD_QUERY_HANDLES --------]"));
+
+    // TDI address device
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_TDI_ADDRESS_DEVICE]))
+        H2AfdWritePropertyTdiDevice(Printer, H2_AFD_PROPERTY_TDI_ADDRESS_DEVICE, &Record->TdiAddressDevice);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_TDI_ADDRESS_DEVICE, status);
+
+    // TDI connection device
+    if (H2_SUCCESS(status = Record->Status[H2_AFD_FIELD_TDI_CONNECTION_DEVICE]))
+        H2AfdWritePropertyTdiDevice(Printer, H2_AFD_PROPERTY_TDI_CONNECTION_DEVICE, &Record->TdiConnectionDevice);
+    else
+        H2AfdWritePropertyStatus(Printer, H2_AFD_PROPERTY_TDI_CONNECTION_DEVICE, status);
+
+    H2AfdWriteSectionEnd(Printer);
+}
+
+/**
+  * \brief Determines whether a socket record has any queried options of a level.
+  *
+  * \param[in] Record A socket record.
+  * \param[in] Level The level of options to check.
+  *
+  * \return Whether there is anything to print for the level.
+  */
+H2_BOOLEAN H2AfdIsRecordLevelQueried(
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _In_ H2_ULONG Level
+)
+{
+    for (H2_ULONG i = 0; i < H2_AFD_OPTION_MAX; i++)
+    {
+        if (H2AfdOptionDescriptors[i].Level == Level &&
+            Record->Status[H2_AFD_OPTION_FIELD(i)] != H2_AFD_STATUS_NOT_QUERIED)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+  * \brief Print the options of one level from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  * \param[in] Level The level of options to print.
+  */
+void H2AfdWriteRecordOptions(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _In_ H2_ULONG Level
+)
+{
+    PCH2_AFD_OPTION_DESCRIPTOR descriptor;
+    H2_STATUS status;
+    H2_ULONG option;
+
+    for (H2_ULONG i = 0; i < H2_AFD_OPTION_MAX; i++)
+    {
+        descriptor = &H2AfdOptionDescriptors[i];
+
+        if (descriptor->Level != Level)
+            continue;
+
+        if (descriptor->Visibility == H2AfdVisibleRawOnly && !Printer->Raw && !Printer->Json)
+            continue;
+
+        // Skip options that do not apply to the socket
+        if (Record->Status[H2_AFD_OPTION_FIELD(i)] == H2_AFD_STATUS_NOT_QUERIED)
+            continue;
+
+        if (H2_SUCCESS(status = H2AfdGetRecordOption(Record, (H2_AFD_OPTION)i, &option)))
+            H2AfdWritePropertyOption(Printer, descriptor->Property, descriptor->Kind, option);
+        else
+            H2AfdWritePropertyStatus(Printer, descriptor->Property, status);
+    }
+}
+
+// An IP-level property that shows whichever of the IPv4 and IPv6 options succeeds
+typedef struct _H2_AFD_MERGED_OPTION_DESCRIPTOR
+{
+    H2_AFD_PROPERTY Property;
+    H2_AFD_OPTION Options[2]; // IPv4 first; H2_AFD_OPTION_NONE if missing
+    H2_AFD_VALUE_KIND Kind;
+} H2_AFD_MERGED_OPTION_DESCRIPTOR, *PH2_AFD_MERGED_OPTION_DESCRIPTOR;
+
+typedef const H2_AFD_MERGED_OPTION_DESCRIPTOR *PCH2_AFD_MERGED_OPTION_DESCRIPTOR;
+
+#define H2_AFD_MERGED_DESCRIPTOR_ENTRY(Property, Ipv4Option, Ipv6Option, Kind, Volatility, FriendlyName, RawName) \
+    { H2_AFD_PROPERTY_##Property, { H2_AFD_OPTION_##Ipv4Option, H2_AFD_OPTION_##Ipv6Option }, Kind },
+
+const H2_AFD_MERGED_OPTION_DESCRIPTOR H2AfdMergedIpOptionDescriptors[] =
+{
+    H2_AFD_MERGED_IP_OPTIONS(H2_AFD_MERGED_DESCRIPTOR_ENTRY)
+};
+
+/**
+  * \brief Print merged IPv4/IPv6 option properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordMergedIpOptions(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    PCH2_AFD_MERGED_OPTION_DESCRIPTOR descriptor;
+    H2_STATUS status;
+    H2_ULONG option;
+
+    for (H2_ULONG i = 0; i < H2_NUMBER_OF(H2AfdMergedIpOptionDescriptors); i++)
+    {
+        descriptor = &H2AfdMergedIpOptionDescriptors[i];
+        status = H2_AFD_STATUS_NOT_QUERIED;
+        option = 0;
+
+        for (H2_ULONG j = 0; j < H2_NUMBER_OF(descriptor->Options); j++)
+        {
+            if (descriptor->Options[j] == H2_AFD_OPTION_NONE ||
+                Record->Status[H2_AFD_OPTION_FIELD(descriptor->Options[j])] == H2_AFD_STATUS_NOT_QUERIED)
+                continue;
+
+            if (H2_SUCCESS(status = H2AfdGetRecordOption(Record, descriptor->Options[j], &option)))
+                break;
+        }
+
+        // Skip properties that do not apply to the socket
+        if (status == H2_AFD_STATUS_NOT_QUERIED)
+            continue;
+
+        if (H2_SUCCESS(status))
+            H2AfdWritePropertyOption(Printer, descriptor->Property, descriptor->Kind, option);
+        else
+            H2AfdWritePropertyStatus(Printer, descriptor->Property, status);
+    }
+}
+
+/**
+  * \brief Print socket-level option properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordPropertiesSol(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    if (!H2AfdIsRecordLevelQueried(Record, H2_AFD_LEVEL_SOL_SOCKET))
+        return;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[--- Socket-level options --]"), H2_T("[-- IOCTL_AFD_TRANSPORT_IOCTL on SOL_SOCKET --]"));
+
+    H2AfdWriteRecordOptions(Printer, Record, H2_AFD_LEVEL_SOL_SOCKET);
+    H2AfdWriteSectionEnd(Printer);
+}
+
+/**
+  * \brief Print IP-level option properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordPropertiesIp(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    // JSON keeps both levels apart so that each value maps to one option
+    if (Printer->Raw || Printer->Json)
+    {
+        if (H2AfdIsRecordLevelQueried(Record, H2_AFD_LEVEL_IPPROTO_IP))
+        {
+            H2AfdWriteSectionHeader(Printer, NULL, H2_T("[-- IOCTL_AFD_TRANSPORT_IOCTL on IPPROTO_IP --]"));
+            H2AfdWriteRecordOptions(Printer, Record, H2_AFD_LEVEL_IPPROTO_IP);
+            H2AfdWriteSectionEnd(Printer);
+        }
+
+        if (H2AfdIsRecordLevelQueried(Record, H2_AFD_LEVEL_IPPROTO_IPV6))
+        {
+            H2AfdWriteSectionHeader(Printer, NULL, H2_T("[-- IOCTL_AFD_TRANSPORT_IOCTL on IPPROTO_IPV6 --]"));
+            H2AfdWriteRecordOptions(Printer, Record, H2_AFD_LEVEL_IPPROTO_IPV6);
+            H2AfdWriteSectionEnd(Printer);
+        }
+    }
+    else if (H2AfdIsRecordLevelQueried(Record, H2_AFD_LEVEL_IPPROTO_IP) || H2AfdIsRecordLevelQueried(Record, H2_AFD_LEVEL_IPPROTO_IPV6))
+    {
+        H2AfdWriteSectionHeader(Printer, H2_T("[----- IP-level options ----]"), NULL);
+        H2AfdWriteRecordMergedIpOptions(Printer, Record);
+        H2AfdWriteSectionEnd(Printer);
+    }
+}
+
+/**
+  * \brief Print TCP-level option properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordPropertiesTcp(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    if (!H2AfdIsRecordLevelQueried(Record, H2_AFD_LEVEL_IPPROTO_TCP))
+        return;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[---- TCP-level options ----]"), H2_T("[-- IOCTL_AFD_TRANSPORT_IOCTL on IPPROTO_TCP --]"));
+
+    H2AfdWriteRecordOptions(Printer, Record, H2_AFD_LEVEL_IPPROTO_TCP);
+    H2AfdWriteSectionEnd(Printer);
+}
+
+/**
+  * \brief Print TCP information properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordPropertiesTcpInfo(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2_STATUS* status = &Record->Status[H2_AFD_FIELD_TCP_INFO_V0];
+    PH2_TCP_INFO tcpInfo = &Record->TcpInfo;
+
+    // Only TCP sockets have TCP information
+    if (status[0] == H2_AFD_STATUS_NOT_QUERIED)
+        return;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[----- TCP information -----]"), H2_T("[-- IOCTL_AFD_TRANSPORT_IOCTL on SIO_TCP_INFO --]"));
+
+    if (H2_SUCCESS(status[0]))
+    {
+        // Print v0
+        H2AfdWritePropertyTcpState(Printer, H2_AFD_PROPERTY_TCP_INFO_STATE, tcpInfo->State);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_MSS, tcpInfo->Mss);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_TCP_INFO_CONNECTION_TIME, tcpInfo->ConnectionTimeMs, H2_TIME_UNIT_MS, TRUE, NULL);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_TCP_INFO_TIMESTAMPS_ENABLED, tcpInfo->TimestampsEnabled);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_TCP_INFO_RTT, tcpInfo->RttUs, H2_TIME_UNIT_US, FALSE, NULL);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_TCP_INFO_MINRTT, tcpInfo->MinRttUs, H2_TIME_UNIT_US, FALSE, NULL);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_BYTES_IN_FLIGHT, tcpInfo->BytesInFlight);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_CONGESTION_WINDOW, tcpInfo->Cwnd);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_SEND_WINDOW, tcpInfo->SndWnd);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_RECEIVE_WINDOW, tcpInfo->RcvWnd);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_RECEIVE_BUFFER, tcpInfo->RcvBuf);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_BYTES_OUT, tcpInfo->BytesOut);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_BYTES_IN, tcpInfo->BytesIn);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_BYTES_REORDERED, tcpInfo->BytesReordered);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_BYTES_RETRANSMITTED, tcpInfo->BytesRetrans);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_FAST_RETRANSMIT, tcpInfo->FastRetrans);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_DUPLICATE_ACKS_IN, tcpInfo->DupAcksIn);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_TIMEOUT_EPISODES, tcpInfo->TimeoutEpisodes);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_SYN_RETRANSMITS, tcpInfo->SynRetrans);
+    }
+    else
+    {
+        // Report failed v0
+        for (H2_ULONG i = H2_AFD_PROPERTY_TCP_INFO_STATE; i <= H2_AFD_PROPERTY_TCP_INFO_SYN_RETRANSMITS; i++)
+            H2AfdWritePropertyStatus(Printer, (H2_AFD_PROPERTY)i, status[0]);
+    }
+
+    if (H2_SUCCESS(status[1]))
+    {
+        // Print v1
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_RECEIVER_LIMITED_TRANSITIONS, tcpInfo->SndLimTransRwin);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_TCP_INFO_RECEIVER_LIMITED_TIME, tcpInfo->SndLimTimeRwin, H2_TIME_UNIT_MS, FALSE, NULL);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_RECEIVER_LIMITED_BYTES, tcpInfo->SndLimBytesRwin);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_CONGESTION_LIMITED_TRANSITIONS, tcpInfo->SndLimTransCwnd);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_TCP_INFO_CONGESTION_LIMITED_TIME, tcpInfo->SndLimTimeCwnd, H2_TIME_UNIT_MS, FALSE, NULL);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_CONGESTION_LIMITED_BYTES, tcpInfo->SndLimBytesCwnd);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_SENDER_LIMITED_TRANSITIONS, tcpInfo->SndLimTransSnd);
+        H2AfdWritePropertyTime(Printer, H2_AFD_PROPERTY_TCP_INFO_SENDER_LIMITED_TIME, tcpInfo->SndLimTimeSnd, H2_TIME_UNIT_MS, FALSE, NULL);
+        H2AfdWritePropertyBytes(Printer, H2_AFD_PROPERTY_TCP_INFO_SENDER_LIMITED_BYTES, tcpInfo->SndLimBytesSnd);
+    }
+    else
+    {
+        // Report failed v1
+        for (H2_ULONG i = H2_AFD_PROPERTY_TCP_INFO_RECEIVER_LIMITED_TRANSITIONS; i <= H2_AFD_PROPERTY_TCP_INFO_SENDER_LIMITED_BYTES; i++)
+            H2AfdWritePropertyStatus(Printer, (H2_AFD_PROPERTY)i, status[1]);
+    }
+
+    if (H2_SUCCESS(status[2]))
+    {
+        // Print v2
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_OUT_OF_ORDER_PACKETS, tcpInfo->OutOfOrderPktsIn);
+        H2AfdWritePropertyBoolean(Printer, H2_AFD_PROPERTY_TCP_INFO_ECN_NEGOTIATED, tcpInfo->EcnNegotiated);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_ECE_ACKS_IN, tcpInfo->EceAcksIn);
+        H2AfdWritePropertyDecimal(Printer, H2_AFD_PROPERTY_TCP_INFO_PTO_EPISODES, tcpInfo->PtoEpisodes);
+    }
+    else
+    {
+        // Report failed v2
+        for (H2_ULONG i = H2_AFD_PROPERTY_TCP_INFO_OUT_OF_ORDER_PACKETS; i <= H2_AFD_PROPERTY_TCP_INFO_PTO_EPISODES; i++)
+            H2AfdWritePropertyStatus(Printer, (H2_AFD_PROPERTY)i, status[2]);
+    }
+
+    H2AfdWriteSectionEnd(Printer);
+}
+
+/**
+  * \brief Print UDP-level option properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordPropertiesUdp(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    if (!H2AfdIsRecordLevelQueried(Record, H2_AFD_LEVEL_IPPROTO_UDP))
+        return;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[---- UDP-level options ----]"), H2_T("[-- IOCTL_AFD_TRANSPORT_IOCTL on IPPROTO_UDP --]"));
+
+    H2AfdWriteRecordOptions(Printer, Record, H2_AFD_LEVEL_IPPROTO_UDP);
+    H2AfdWriteSectionEnd(Printer);
+}
+
+/**
+  * \brief Print Hyper-V-level option properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteRecordPropertiesHv(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    if (!H2AfdIsRecordLevelQueried(Record, H2_AFD_LEVEL_HV_PROTOCOL_RAW))
+        return;
+
+    H2AfdWriteSectionHeader(Printer, H2_T("[-- Hyper-V-level options --]"), H2_T("[-- IOCTL_AFD_TRANSPORT_IOCTL on HV_PROTOCOL_RAW --]"));
+
+    H2AfdWriteRecordOptions(Printer, Record, H2_AFD_LEVEL_HV_PROTOCOL_RAW);
+}
+
+/**
+  * \brief Print all socket properties from a socket record.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A socket record.
+  */
+void H2AfdWriteSocketRecord(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2AfdWriteRecordSharedInfo(Printer, Record);
+    H2AfdWriteRecordAddresses(Printer, Record);
+    H2AfdWriteRecordSimpleInfo(Printer, Record);
+    H2AfdWriteRecordTDIDevices(Printer, Record);
+
+    // Transports that acknowledge any option query have nothing meaningful to show
+    if (!Record->OptionsUnreliable)
+    {
+        H2AfdWriteRecordPropertiesSol(Printer, Record);
+        H2AfdWriteRecordPropertiesIp(Printer, Record);
+        H2AfdWriteRecordPropertiesTcp(Printer, Record);
+        H2AfdWriteRecordPropertiesTcpInfo(Printer, Record);
+        H2AfdWriteRecordPropertiesUdp(Printer, Record);
+        H2AfdWriteRecordPropertiesHv(Printer, Record);
+    }
+}
+
+/**
+  * \brief Print a one-line summary of a socket.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Record A summary record of the socket.
+  */
+void H2AfdWriteSummaryRecord(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SUMMARY_RECORD Record
+)
+{
+    H2_CHAR buffer[H2_AFD_ADDRESS_MAX_LENGTH];
+    size_t length;
+    const H2_CHAR* detail;
+
+    H2WriteString(Printer, H2_T("AFD socket: "));
+
+    if (!H2_SUCCESS(Record->SharedInfoStatus) && !H2_SUCCESS(Record->LocalAddressStatus))
+    {
+        H2WriteString(Printer, H2_T("(no details)"));
+        return;
+    }
+
+    if (H2_SUCCESS(Record->SharedInfoStatus))
+    {
+        // State
+        if (detail = H2AfdGetSocketStateString(Record->SharedInfo.State, FALSE))
+        {
+            H2WriteString(Printer, detail);
+            H2WriteText(Printer, H2_T(" "), 1);
+        }
+
+        // Protocol
+        if (detail = H2AfdGetProtocolSummaryString(Record->SharedInfo.AddressFamily, Record->SharedInfo.Protocol))
+        {
+            H2WriteString(Printer, detail);
+            H2WriteText(Printer, H2_T(" "), 1);
+        }
+    }
+
+    // Local address; the buffer is on the stack since the summary runs for every socket in the system
+    if (H2_SUCCESS(Record->LocalAddressStatus) &&
+        H2_SUCCESS(H2AfdFormatAddressToBuffer(&Record->LocalAddress, H2_AFD_ADDRESS_SIMPLIFY, buffer, H2_NUMBER_OF(buffer), &length)))
+    {
+        H2WriteText(Printer, H2_T("on "), 3);
+        H2WriteText(Printer, buffer, length);
+
+        // Remote address
+        if (H2_SUCCESS(Record->RemoteAddressStatus) &&
+            H2_SUCCESS(H2AfdFormatAddressToBuffer(&Record->RemoteAddress, H2_AFD_ADDRESS_SIMPLIFY, buffer, H2_NUMBER_OF(buffer), &length)))
+        {
+            H2WriteText(Printer, H2_T(" to "), 4);
+            H2WriteText(Printer, buffer, length);
+        }
+    }
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SOCKET_FORMAT_H
+#define _SOCKET_FORMAT_H
+
+//
+// Rendering of socket records in the text and JSON formats of the tool. It only depends on
+// the portable types, so saved snapshots print the same way on any system.
+//
+
+#include "text_format.h"
+#include "socket_layout.h"
+
+void
+H2AfdWriteSocketRecord(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SOCKET_RECORD Record
+);
+
+void
+H2AfdWriteSummaryRecord(
+    _In_ PH2_PRINTER Printer,
+    _In_ PH2_AFD_SUMMARY_RECORD Record
+);
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "socket_layout.h"
+#include <string.h>
+
+/**
+  * \brief Prepares an empty socket record with no fields queried.
+  *
+  * \param[out] Record The record to initialize.
+  */
+void H2AfdInitializeSocketRecord(
+    _Out_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    memset(Record, 0, sizeof(H2_AFD_SOCKET_RECORD));
+
+    for (H2_ULONG i = 0; i < H2_AFD_FIELD_MAX; i++)
+        Record->Status[i] = H2_AFD_STATUS_NOT_QUERIED;
+}
+
+/**
+  * \brief Retrieves a socket option from a record.
+  *
+  * \param[in] Record A socket record.
+  * \param[in] Option The option to retrieve.
+  * \param[out] OptionValue A variable that receives the option value.
+  *
+  * \return The status of querying the option.
+  */
+H2_STATUS H2AfdGetRecordOption(
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _In_ H2_AFD_OPTION Option,
+    _Out_ H2_ULONG* OptionValue
+)
+{
+    *OptionValue = Record->Options[Option];
+    return Record->Status[H2_AFD_OPTION_FIELD(Option)];
+}
+
+/**
+  * \brief Determines if a socket in the specified state might have a remote address.
+  *
+  * \param[in] SharedInfo The shared info of the socket.
+  *
+  * \return Whether querying the remote address can succeed.
+  */
+H2_BOOLEAN H2AfdCanHaveRemoteAddress(
+    _In_ PH2_SOCK_SHARED_INFO SharedInfo
+)
+{
+    // Listening sockets stay bound; only connected (or connected and closing) ones have a peer
+    if (SharedInfo->Listening)
+        return FALSE;
+
+    switch (SharedInfo->State)
+    {
+        case H2_SOCKET_STATE_BOUND_SPECIFIC:
+        case H2_SOCKET_STATE_CONNECTED:
+        case H2_SOCKET_STATE_CLOSING:
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
+/**
+  * \brief Extracts what the one-line summary reports from a full socket record.
+  *
+  * \param[in] Record A socket record.
+  * \param[out] Summary The summary record to fill in.
+  */
+void H2AfdGetSummaryRecord(
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _Out_ PH2_AFD_SUMMARY_RECORD Summary
+)
+{
+    Summary->SharedInfoStatus = Record->Status[H2_AFD_FIELD_SHARED_INFO];
+    Summary->LocalAddressStatus = Record->Status[H2_AFD_FIELD_LOCAL_ADDRESS];
+    Summary->RemoteAddressStatus = Record->Status[H2_AFD_FIELD_REMOTE_ADDRESS];
+    Summary->SharedInfo = Record->SharedInfo;
+    Summary->LocalAddress = Record->LocalAddress;
+    Summary->RemoteAddress = Record->RemoteAddress;
+
+    // Same as when querying the summary directly
+    if (!H2_SUCCESS(Summary->LocalAddressStatus) ||
+        (H2_SUCCESS(Summary->SharedInfoStatus) && !H2AfdCanHaveRemoteAddress(&Summary->SharedInfo)))
+        Summary->RemoteAddressStatus = H2_AFD_STATUS_NOT_QUERIED;
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SOCKET_LAYOUT_H
+#define _SOCKET_LAYOUT_H
+
+//
+// Socket records without Windows headers. The structures mirror the Windows types they hold
+// with the same member names and layout (socket_record.c checks it), so code that reads
+// records works the same on both sides, and the Windows side casts only where it passes
+// a member to an API.
+//
+
+#include "portable_types.h"
+#include "socket_properties.h"
+
+// The status of record fields that were not queried
+#define H2_AFD_STATUS_NOT_QUERIED H2_STATUS_NO_DATA_DETECTED
+
+// The maximum length of a TDI device name stored in a record, in characters
+#define H2_AFD_DEVICE_NAME_LENGTH 128
+
+// Values of H2_SOCK_SHARED_INFO.State, same as SOCKET_STATE
+#define H2_SOCKET_STATE_INITIALIZING (-1)
+#define H2_SOCKET_STATE_OPEN 0
+#define H2_SOCKET_STATE_BOUND 1
+#define H2_SOCKET_STATE_BOUND_SPECIFIC 2
+#define H2_SOCKET_STATE_CONNECTED 3
+#define H2_SOCKET_STATE_CLOSING 4
+
+// Same as LINGER
+typedef struct _H2_LINGER
+{
+    H2_USHORT l_onoff;
+    H2_USHORT l_linger;
+} H2_LINGER, *PH2_LINGER;
+
+// Same as SOCK_SHARED_INFO
+typedef struct _H2_SOCK_SHARED_INFO
+{
+    H2_LONG State; // H2_SOCKET_STATE_*
+    H2_LONG AddressFamily;
+    H2_LONG SocketType;
+    H2_LONG Protocol;
+    H2_LONG LocalAddressLength;
+    H2_LONG RemoteAddressLength;
+    H2_LINGER LingerInfo;
+    H2_ULONG SendTimeout; // in milliseconds
+    H2_ULONG ReceiveTimeout; // in milliseconds
+    H2_ULONG ReceiveBufferSize;
+    H2_ULONG SendBufferSize;
+    union
+    {
+        H2_USHORT Flags;
+        struct
+        {
+            H2_USHORT Listening : 1;
+            H2_USHORT Broadcast : 1;
+            H2_USHORT Debug : 1;
+            H2_USHORT OobInline : 1;
+            H2_USHORT ReuseAddresses : 1;
+            H2_USHORT ExclusiveAddressUse : 1;
+            H2_USHORT NonBlocking : 1;
+            H2_USHORT DontUseWildcard : 1;
+            H2_USHORT ReceiveShutdown : 1;
+            H2_USHORT SendShutdown : 1;
+            H2_USHORT ConditionalAccept : 1;
+            H2_USHORT IsSANSocket : 1;
+            H2_USHORT fIsTLI : 1;
+            H2_USHORT Rio : 1;
+            H2_USHORT ReceiveBufferSizeSet : 1;
+            H2_USHORT SendBufferSizeSet : 1;
+        };
+    };
+    H2_ULONG CreationFlags;
+    H2_ULONG CatalogEntryId;
+    H2_ULONG ServiceFlags1;
+    H2_ULONG ProviderFlags;
+    H2_ULONG GroupID;
+    H2_LONG GroupType;
+    H2_LONG GroupPriority;
+    H2_LONG LastError;
+    H2_ULONG64 AsyncSelectWnd64;
+    H2_ULONG AsyncSelectSerialNumber;
+    H2_ULONG AsyncSelectwMsg;
+    H2_LONG AsyncSelectlEvent;
+    H2_LONG DisabledAsyncSelectEvents;
+    H2_GUID ProviderId;
+} H2_SOCK_SHARED_INFO, *PH2_SOCK_SHARED_INFO;
+
+// Same as SOCKADDR_STORAGE
+typedef struct _H2_SOCKADDR_STORAGE
+{
+    H2_USHORT ss_family;
+    H2_UCHAR __ss_pad1[6];
+    H2_LONG64 __ss_align;
+    H2_UCHAR __ss_pad2[112];
+} H2_SOCKADDR_STORAGE, *PH2_SOCKADDR_STORAGE;
+
+// Same as AFD_GROUP_INFO
+typedef struct _H2_AFD_GROUP_INFO
+{
+    H2_ULONG GroupID;
+    H2_LONG GroupType;
+} H2_AFD_GROUP_INFO, *PH2_AFD_GROUP_INFO;
+
+// Same as TCP_INFO_v2
+typedef struct _H2_TCP_INFO
+{
+    H2_LONG State;
+    H2_ULONG Mss;
+    H2_ULONG64 ConnectionTimeMs;
+    H2_BOOLEAN TimestampsEnabled;
+    H2_ULONG RttUs;
+    H2_ULONG MinRttUs;
+    H2_ULONG BytesInFlight;
+    H2_ULONG Cwnd;
+    H2_ULONG SndWnd;
+    H2_ULONG RcvWnd;
+    H2_ULONG RcvBuf;
+    H2_ULONG64 BytesOut;
+    H2_ULONG64 BytesIn;
+    H2_ULONG BytesReordered;
+    H2_ULONG BytesRetrans;
+    H2_ULONG FastRetrans;
+    H2_ULONG DupAcksIn;
+    H2_ULONG TimeoutEpisodes;
+    H2_UCHAR SynRetrans;
+    H2_ULONG SndLimTransRwin;
+    H2_ULONG SndLimTimeRwin;
+    H2_ULONG64 SndLimBytesRwin;
+    H2_ULONG SndLimTransCwnd;
+    H2_ULONG SndLimTimeCwnd;
+    H2_ULONG64 SndLimBytesCwnd;
+    H2_ULONG SndLimTransSnd;
+    H2_ULONG SndLimTimeSnd;
+    H2_ULONG64 SndLimBytesSnd;
+    H2_ULONG OutOfOrderPktsIn;
+    H2_BOOLEAN EcnNegotiated;
+    H2_ULONG EceAcksIn;
+    H2_ULONG PtoEpisodes;
+} H2_TCP_INFO, *PH2_TCP_INFO;
+
+// Independently queried parts of a record; each has its own status
+typedef enum _H2_AFD_FIELD
+{
+    H2_AFD_FIELD_SHARED_INFO,
+    H2_AFD_FIELD_LOCAL_ADDRESS,
+    H2_AFD_FIELD_REMOTE_ADDRESS,
+    H2_AFD_FIELD_MAX_SEND_SIZE,
+    H2_AFD_FIELD_SENDS_PENDING,
+    H2_AFD_FIELD_MAX_PATH_SEND_SIZE,
+    H2_AFD_FIELD_RECEIVE_WINDOW_SIZE,
+    H2_AFD_FIELD_SEND_WINDOW_SIZE,
+    H2_AFD_FIELD_CONNECT_TIME,
+    H2_AFD_FIELD_GROUP_ID_AND_TYPE,
+    H2_AFD_FIELD_TDI_ADDRESS_DEVICE,
+    H2_AFD_FIELD_TDI_CONNECTION_DEVICE,
+    H2_AFD_FIELD_TCP_INFO_V0,
+    H2_AFD_FIELD_TCP_INFO_V1,
+    H2_AFD_FIELD_TCP_INFO_V2,
+    H2_AFD_FIELD_OPTIONS, // Followed by one field per H2_AFD_OPTION
+    H2_AFD_FIELD_MAX = H2_AFD_FIELD_OPTIONS + H2_AFD_OPTION_MAX
+} H2_AFD_FIELD;
+
+#define H2_AFD_OPTION_FIELD(Option) ((H2_AFD_FIELD)(H2_AFD_FIELD_OPTIONS + (Option)))
+
+typedef enum _H2_AFD_TDI_DEVICE_KIND
+{
+    H2AfdTdiNotApplicable, // The transport is not TDI
+    H2AfdTdiNone, // No device handle
+    H2AfdTdiDevice,
+} H2_AFD_TDI_DEVICE_KIND;
+
+// The device behind a TDI address or connection handle
+typedef struct _H2_AFD_TDI_DEVICE
+{
+    H2_AFD_TDI_DEVICE_KIND Kind;
+    H2_USHORT NameLength; // in bytes
+    H2_WCHAR Name[H2_AFD_DEVICE_NAME_LENGTH];
+} H2_AFD_TDI_DEVICE, *PH2_AFD_TDI_DEVICE;
+
+// Everything the detailed view reports about a socket
+typedef struct _H2_AFD_SOCKET_RECORD
+{
+    H2_STATUS Status[H2_AFD_FIELD_MAX];
+    H2_BOOLEAN OptionsUnreliable; // The transport acknowledges any option query; options and TCP_INFO are not queried
+    H2_SOCK_SHARED_INFO SharedInfo;
+    H2_SOCKADDR_STORAGE LocalAddress;
+    H2_SOCKADDR_STORAGE RemoteAddress;
+    H2_ULONG MaxSendSize;
+    H2_ULONG SendsPending;
+    H2_ULONG MaxPathSendSize;
+    H2_ULONG ReceiveWindowSize;
+    H2_ULONG SendWindowSize;
+    H2_ULONG ConnectTime;
+    H2_AFD_GROUP_INFO GroupInfo;
+    H2_AFD_TDI_DEVICE TdiAddressDevice;
+    H2_AFD_TDI_DEVICE TdiConnectionDevice;
+    H2_TCP_INFO TcpInfo;
+    H2_ULONG Options[H2_AFD_OPTION_MAX];
+} H2_AFD_SOCKET_RECORD, *PH2_AFD_SOCKET_RECORD;
+
+// What the one-line summary reports about a socket
+typedef struct _H2_AFD_SUMMARY_RECORD
+{
+    H2_STATUS SharedInfoStatus;
+    H2_STATUS LocalAddressStatus;
+    H2_STATUS RemoteAddressStatus; // H2_AFD_STATUS_NOT_QUERIED when the state rules out a remote address
+    H2_SOCK_SHARED_INFO SharedInfo;
+    H2_SOCKADDR_STORAGE LocalAddress;
+    H2_SOCKADDR_STORAGE RemoteAddress;
+} H2_AFD_SUMMARY_RECORD, *PH2_AFD_SUMMARY_RECORD;
+
+void
+H2AfdInitializeSocketRecord(
+    _Out_ PH2_AFD_SOCKET_RECORD Record
+);
+
+H2_STATUS
+H2AfdGetRecordOption(
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _In_ H2_AFD_OPTION Option,
+    _Out_ H2_ULONG* OptionValue
+);
+
+H2_BOOLEAN
+H2AfdCanHaveRemoteAddress(
+    _In_ PH2_SOCK_SHARED_INFO SharedInfo
+);
+
+void
+H2AfdGetSummaryRecord(
+    _In_ PH2_AFD_SOCKET_RECORD Record,
+    _Out_ PH2_AFD_SUMMARY_RECORD Summary
+);
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "socket_properties.h"
+
+#define H2_AFD_OPTION_DESCRIPTOR_ENTRY(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName) \
+    { H2_AFD_LEVEL_##Level, H2_AFD_PROPERTY_##Option, Kind, Visibility, Applicability, Volatility },
+
+// Descriptors of options in the H2_AFD_OPTION order
+const H2_AFD_OPTION_DESCRIPTOR H2AfdOptionDescriptors[H2_AFD_OPTION_MAX] =
+{
+    H2_AFD_OPTIONS(H2_AFD_OPTION_DESCRIPTOR_ENTRY)
+};
+
+#undef H2_AFD_OPTION_DESCRIPTOR_ENTRY
+
+#define H2_AFD_PROPERTY_VOLATILITY(Property, Volatility, FriendlyName, RawName) Volatility,
+#define H2_AFD_OPTION_VOLATILITY(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName) Volatility,
+#define H2_AFD_MERGED_VOLATILITY(Property, Ipv4Option, Ipv6Option, Kind, Volatility, FriendlyName, RawName) Volatility,
+
+// The volatility of properties in the H2_AFD_PROPERTY order
+const H2_AFD_VOLATILITY H2AfdPropertyVolatility[H2_AFD_PROPERTY_MAX] =
+{
+    H2_AFD_PROPERTIES(H2_AFD_PROPERTY_VOLATILITY, H2_AFD_OPTION_VOLATILITY, H2_AFD_MERGED_VOLATILITY)
+};
+
+#undef H2_AFD_PROPERTY_VOLATILITY
+#undef H2_AFD_OPTION_VOLATILITY
+#undef H2_AFD_MERGED_VOLATILITY
+
+#define H2_AFD_PROPERTY_KEY(Property, ...) #Property,
+
+// Machine-readable keys of properties in the H2_AFD_PROPERTY order
+const char* const H2AfdPropertyKeys[H2_AFD_PROPERTY_MAX] =
+{
+    H2_AFD_PROPERTIES(H2_AFD_PROPERTY_KEY, H2_AFD_PROPERTY_KEY, H2_AFD_PROPERTY_KEY)
+};
+
+#undef H2_AFD_PROPERTY_KEY
+
+/**
+  * \brief Looks up a machine-readable key for a socket property.
+  *
+  * \param[in] Property An index of the property.
+  *
+  * \return The identifier of the property without the prefix, such as SHARED_STATE.
+  */
+const char* H2AfdGetPropertyKey(
+    _In_ H2_AFD_PROPERTY Property
+)
+{
+    if (Property < 0 || Property >= H2_AFD_PROPERTY_MAX)
+        return "";
+
+    return H2AfdPropertyKeys[Property];
+}
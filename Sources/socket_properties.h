@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SOCKET_PROPERTIES_H
+#define _SOCKET_PROPERTIES_H
+
+#include "portable_types.h"
+
+// How to format the value of an option
+typedef enum _H2_AFD_VALUE_KIND
+{
+    H2AfdValueBoolean,
+    H2AfdValueDecimal,
+    H2AfdValueBytes,
+    H2AfdValueSeconds,
+    H2AfdValueMilliseconds,
+    H2AfdValueInterface,
+    H2AfdValueProtectionLevel,
+    H2AfdValueMtuDiscover,
+} H2_AFD_VALUE_KIND;
+
+// Which print modes show an option
+typedef enum _H2_AFD_VISIBILITY
+{
+    H2AfdVisibleAlways,
+    H2AfdVisibleRawOnly, // Human-readable mode shows a merged property instead
+} H2_AFD_VISIBILITY;
+
+// How often a property changes during the life of a socket
+typedef enum _H2_AFD_VOLATILITY
+{
+    H2AfdStatic, // Fixed when the socket is created
+    H2AfdSemiStatic, // Changes on state transitions and configuration requests
+    H2AfdVolatile, // Changes with traffic or time
+} H2_AFD_VOLATILITY;
+
+// Sockets an option applies to. An option applies when the socket matches
+// one of the listed families and one of the listed protocols; an empty group
+// matches any.
+#define H2_AFD_APPLIES_ANY 0x0000
+#define H2_AFD_APPLIES_INET 0x0001
+#define H2_AFD_APPLIES_INET6 0x0002
+#define H2_AFD_APPLIES_HYPERV 0x0004
+#define H2_AFD_APPLIES_FAMILY_MASK 0x00FF
+#define H2_AFD_APPLIES_TCP 0x0100
+#define H2_AFD_APPLIES_UDP 0x0200
+#define H2_AFD_APPLIES_PROTOCOL_MASK 0xFF00
+#define H2_AFD_APPLIES_IP (H2_AFD_APPLIES_INET | H2_AFD_APPLIES_INET6)
+
+// TCP_INFO comes from the same transport as TCP-level options
+#define H2_AFD_TCP_INFO_APPLICABILITY (H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP)
+
+// Option levels by the names the lists use, with the values of the Windows constants
+#define H2_AFD_LEVEL_SOL_SOCKET 0xFFFF
+#define H2_AFD_LEVEL_IPPROTO_IP 0
+#define H2_AFD_LEVEL_IPPROTO_IPV6 41
+#define H2_AFD_LEVEL_IPPROTO_TCP 6
+#define H2_AFD_LEVEL_IPPROTO_UDP 17
+#define H2_AFD_LEVEL_HV_PROTOCOL_RAW 1
+
+/* Property lists */
+
+// Fields of the shared Winsock context
+// X(Property, Volatility, FriendlyName, RawName)
+#define H2_AFD_SHARED_PROPERTIES(X) \
+    X(SHARED_STATE, H2AfdVolatile, "State                       ", "SOCK_SHARED_INFO.State                    ") \
+    X(SHARED_ADDRESS_FAMILY, H2AfdStatic, "Address family              ", "SOCK_SHARED_INFO.AddressFamily            ") \
+    X(SHARED_SOCKET_TYPE, H2AfdStatic, "Socket type                 ", "SOCK_SHARED_INFO.SocketType               ") \
+    X(SHARED_PROTOCOL, H2AfdStatic, "Protocol                    ", "SOCK_SHARED_INFO.Protocol                 ") \
+    X(SHARED_LOCAL_ADDRESS_LENGTH, H2AfdSemiStatic, "Local address length        ", "SOCK_SHARED_INFO.LocalAddressLength       ") \
+    X(SHARED_REMOTE_ADDRESS_LENGTH, H2AfdSemiStatic, "Remote address length       ", "SOCK_SHARED_INFO.RemoteAddressLength      ") \
+    X(SHARED_LINGER_ONOFF, H2AfdSemiStatic, "Linger                      ", "SOCK_SHARED_INFO.LingerInfo.l_onoff       ") \
+    X(SHARED_LINGER_TIMEOUT, H2AfdSemiStatic, "Linger timeout              ", "SOCK_SHARED_INFO.LingerInfo.l_linger      ") \
+    X(SHARED_SEND_TIMEOUT, H2AfdSemiStatic, "Send timeout                ", "SOCK_SHARED_INFO.LingerInfo.SendTimeout   ") \
+    X(SHARED_RECEIVE_TIMEOUT, H2AfdSemiStatic, "Receive timeout             ", "SOCK_SHARED_INFO.ReceiveTimeout           ") \
+    X(SHARED_RECEIVE_BUFFER_SIZE, H2AfdSemiStatic, "Receive buffer size         ", "SOCK_SHARED_INFO.ReceiveBufferSize        ") \
+    X(SHARED_SEND_BUFFER_SIZE, H2AfdSemiStatic, "Send buffer size            ", "SOCK_SHARED_INFO.SendBufferSize           ") \
+    X(SHARED_FLAGS, H2AfdSemiStatic, "Flags                       ", "SOCK_SHARED_INFO.Flags                    ") \
+    X(SHARED_LISTENING, H2AfdSemiStatic, " - Listening                ", " - Listening                              ") \
+    X(SHARED_BROADCAST, H2AfdSemiStatic, " - Broadcast                ", " - Broadcast                              ") \
+    X(SHARED_DEBUG, H2AfdSemiStatic, " - Debug                    ", " - Debug                                  ") \
+    X(SHARED_OOB_INLINE, H2AfdSemiStatic, " - OOB in line              ", " - OobInline                              ") \
+    X(SHARED_REUSE_ADDRESSES, H2AfdSemiStatic, " - Reuse addresses          ", " - ReuseAddresses                         ") \
+    X(SHARED_EXCLUSIVE_ADDRESS_USE, H2AfdSemiStatic, " - Exclusive address use    ", " - ExclusiveAddressUse                    ") \
+    X(SHARED_NON_BLOCKING, H2AfdSemiStatic, " - Non-blocking             ", " - NonBlocking                            ") \
+    X(SHARED_DONT_USE_WILDCARD, H2AfdSemiStatic, " - Don't use wildcard       ", " - DontUseWildcard                        ") \
+    X(SHARED_RECEIVE_SHUTDOWN, H2AfdSemiStatic, " - Receive shutdown         ", " - ReceiveShutdown                        ") \
+    X(SHARED_SEND_SHUTDOWN, H2AfdSemiStatic, " - Send shutdown            ", " - SendShutdown                           ") \
+    X(SHARED_CONDITIONAL_ACCEPT, H2AfdSemiStatic, " - Conditional accept       ", " - ConditionalAccept                      ") \
+    X(SHARED_IS_SANSOCKET, H2AfdStatic, " - SAN                      ", " - IsSANSocket                            ") \
+    X(SHARED_IS_TLI, H2AfdStatic, " - TLI                      ", " - fIsTLI                                 ") \
+    X(SHARED_RIO, H2AfdStatic, " - RIO                      ", " - Rio                                    ") \
+    X(SHARED_RECEIVE_BUFFER_SIZE_SET, H2AfdSemiStatic, " - Receive suffer size set  ", " - ReceiveBufferSizeSet                   ") \
+    X(SHARED_SEND_BUFFER_SIZE_SET, H2AfdSemiStatic, " - Send suffer size set     ", " - SendBufferSizeSet                      ") \
+    X(SHARED_CREATION_FLAGS, H2AfdStatic, "Creation flags              ", "SOCK_SHARED_INFO.CreationFlags            ") \
+    X(SHARED_WSA_FLAG_OVERLAPPED, H2AfdStatic, " - Overlapped               ", " - WSA_FLAG_OVERLAPPED                    ") \
+    X(SHARED_WSA_FLAG_MULTIPOINT_C_ROOT, H2AfdStatic, " - Multipoint control root  ", " - WSA_FLAG_MULTIPOINT_C_ROOT             ") \
+    X(SHARED_WSA_FLAG_MULTIPOINT_C_LEAF, H2AfdStatic, " - Multipoint control leaf  ", " - WSA_FLAG_MULTIPOINT_C_LEAF             ") \
+    X(SHARED_WSA_FLAG_MULTIPOINT_D_ROOT, H2AfdStatic, " - Multipoint data root     ", " - WSA_FLAG_MULTIPOINT_D_ROOT             ") \
+    X(SHARED_WSA_FLAG_MULTIPOINT_D_LEAF, H2AfdStatic, " - Multipoint data leaf     ", " - WSA_FLAG_MULTIPOINT_D_LEAF             ") \
+    X(SHARED_WSA_FLAG_ACCESS_SYSTEM_SECURITY, H2AfdStatic, " - Access SACL              ", " - WSA_FLAG_ACCESS_SYSTEM_SECURITY        ") \
+    X(SHARED_WSA_FLAG_NO_HANDLE_INHERIT, H2AfdStatic, " - No handle inherit        ", " - WSA_FLAG_NO_HANDLE_INHERIT             ") \
+    X(SHARED_WSA_FLAG_REGISTERED_IO, H2AfdStatic, " - Registered I/O           ", " - WSA_FLAG_REGISTERED_IO                 ") \
+    X(SHARED_CATALOG_ENTRY_ID, H2AfdStatic, "Catalog entry ID            ", "SOCK_SHARED_INFO.CatalogEntryId           ") \
+    X(SHARED_SERVICE_FLAGS, H2AfdStatic, "Service flags               ", "SOCK_SHARED_INFO.ServiceFlags1            ") \
+    X(SHARED_XP1_CONNECTIONLESS, H2AfdStatic, " - Connectionless           ", " - XP1_CONNECTIONLESS                     ") \
+    X(SHARED_XP1_GUARANTEED_DELIVERY, H2AfdStatic, " - Guaranteed delivery      ", " - XP1_GUARANTEED_DELIVERY                ") \
+    X(SHARED_XP1_GUARANTEED_ORDER, H2AfdStatic, " - Guaranteed order         ", " - XP1_GUARANTEED_ORDER                   ") \
+    X(SHARED_XP1_MESSAGE_ORIENTED, H2AfdStatic, " - Message-oriented         ", " - XP1_MESSAGE_ORIENTED                   ") \
+    X(SHARED_XP1_PSEUDO_STREAM, H2AfdStatic, " - Pseudo-stream            ", " - XP1_PSEUDO_STREAM                      ") \
+    X(SHARED_XP1_GRACEFUL_CLOSE, H2AfdStatic, " - Graceful close           ", " - XP1_GRACEFUL_CLOSE                     ") \
+    X(SHARED_XP1_EXPEDITED_DATA, H2AfdStatic, " - Expedited data           ", " - XP1_EXPEDITED_DATA                     ") \
+    X(SHARED_XP1_CONNECT_DATA, H2AfdStatic, " - Connect data             ", " - XP1_CONNECT_DATA                       ") \
+    X(SHARED_XP1_DISCONNECT_DATA, H2AfdStatic, " - Disconnect data          ", " - XP1_DISCONNECT_DATA                    ") \
+    X(SHARED_XP1_SUPPORT_BROADCAST, H2AfdStatic, " - Broadcast                ", " - XP1_SUPPORT_BROADCAST                  ") \
+    X(SHARED_XP1_SUPPORT_MULTIPOINT, H2AfdStatic, " - Support multipoint       ", " - XP1_SUPPORT_MULTIPOINT                 ") \
+    X(SHARED_XP1_MULTIPOINT_CONTROL_PLANE, H2AfdStatic, " - Multipoint control plane ", " - XP1_MULTIPOINT_CONTROL_PLANE           ") \
+    X(SHARED_XP1_MULTIPOINT_DATA_PLANE, H2AfdStatic, " - Multipoint data plane    ", " - XP1_MULTIPOINT_DATA_PLANE              ") \
+    X(SHARED_XP1_QOS_SUPPORTED, H2AfdStatic, " - QoS supported            ", " - XP1_QOS_SUPPORTED:                     ") \
+    X(SHARED_XP1_INTERRUPT, H2AfdStatic, " - Interrupt                ", " - XP1_INTERRUPT                          ") \
+    X(SHARED_XP1_UNI_SEND, H2AfdStatic, " - Unidirectional send      ", " - XP1_UNI_SEND                           ") \
+    X(SHARED_XP1_UNI_RECV, H2AfdStatic, " - Unidirectional receive   ", " - XP1_UNI_RECV                           ") \
+    X(SHARED_XP1_IFS_HANDLES, H2AfdStatic, " - IFS handles              ", " - XP1_IFS_HANDLES                        ") \
+    X(SHARED_XP1_PARTIAL_MESSAGE, H2AfdStatic, " - Partial message          ", " - XP1_PARTIAL_MESSAGE                    ") \
+    X(SHARED_XP1_SAN_SUPPORT_SDP, H2AfdStatic, " - SAN support SDP          ", " - XP1_SAN_SUPPORT_SDP                    ") \
+    X(SHARED_PROVIDER_FLAGS, H2AfdStatic, "Provider flags              ", "SOCK_SHARED_INFO.ProviderFlags            ") \
+    X(SHARED_PFL_MULTIPLE_PROTO_ENTRIES, H2AfdStatic, " - Multiple entries         ", " - PFL_MULTIPLE_PROTO_ENTRIES             ") \
+    X(SHARED_PFL_RECOMMENDED_PROTO_ENTRY, H2AfdStatic, " - Recommended entry        ", " - PFL_RECOMMENDED_PROTO_ENTRY            ") \
+    X(SHARED_PFL_HIDDEN, H2AfdStatic, " - Hidden                   ", " - PFL_HIDDEN                             ") \
+    X(SHARED_PFL_MATCHES_PROTOCOL_ZERO, H2AfdStatic, " - Matches protocol zero    ", " - PFL_MATCHES_PROTOCOL_ZERO              ") \
+    X(SHARED_PFL_NETWORKDIRECT_PROVIDER, H2AfdStatic, " - Network direct           ", " - PFL_NETWORKDIRECT_PROVIDER             ") \
+    X(SHARED_GROUP_ID, H2AfdStatic, "Group ID                    ", "SOCK_SHARED_INFO.GroupID                  ") \
+    X(SHARED_GROUP_TYPE, H2AfdStatic, "Group type                  ", "SOCK_SHARED_INFO.GroupType                ") \
+    X(SHARED_GROUP_PRIORITY, H2AfdSemiStatic, "Group priority              ", "SOCK_SHARED_INFO.GroupPriority            ") \
+    X(SHARED_LAST_ERROR, H2AfdSemiStatic, "Last error                  ", "SOCK_SHARED_INFO.LastError                ") \
+    X(SHARED_ASYNC_SELECT_WND, H2AfdSemiStatic, "Async select HWND           ", "SOCK_SHARED_INFO.AsyncSelectWnd64         ") \
+    X(SHARED_ASYNC_SELECT_SERIAL_NUMBER, H2AfdSemiStatic, "Async select serial number  ", "SOCK_SHARED_INFO.AsyncSelectSerialNumber  ") \
+    X(SHARED_ASYNC_SELECTW_MSG, H2AfdSemiStatic, "Async select message        ", "SOCK_SHARED_INFO.AsyncSelectwMsg          ") \
+    X(SHARED_ASYNC_SELECTL_EVENT, H2AfdSemiStatic, "Async select event          ", "SOCK_SHARED_INFO.AsyncSelectlEvent        ") \
+    X(SHARED_DISABLED_ASYNC_SELECT_EVENTS, H2AfdSemiStatic, "Disabled async select events", "SOCK_SHARED_INFO.DisabledAsyncSelectEvents") \
+    X(SHARED_PROVIDER_ID, H2AfdStatic, "Provider ID                 ", "SOCK_SHARED_INFO.ProviderId               ")
+
+// Local and remote addresses
+// X(Property, Volatility, FriendlyName, RawName)
+#define H2_AFD_ADDRESS_PROPERTIES(X) \
+    X(LOCAL_ADDRESS, H2AfdSemiStatic, "Local address               ", "IOCTL_AFD_GET_ADDRESS                     ") \
+    X(REMOTE_ADDRESS, H2AfdSemiStatic, "Remote address              ", "IOCTL_AFD_GET_REMOTE_ADDRESS              ")
+
+// AFD info classes
+// X(Property, Volatility, FriendlyName, RawName)
+#define H2_AFD_INFO_PROPERTIES(X) \
+    X(AFD_MAX_SEND_SIZE, H2AfdSemiStatic, "Maximum send size           ", "AFD_MAX_SEND_SIZE                         ") \
+    X(AFD_SENDS_PENDING, H2AfdVolatile, "Pending sends               ", "AFD_SENDS_PENDING                         ") \
+    X(AFD_MAX_PATH_SEND_SIZE, H2AfdSemiStatic, "Maximum path send size      ", "AFD_MAX_PATH_SEND_SIZE                    ") \
+    X(AFD_RECEIVE_WINDOW_SIZE, H2AfdVolatile, "Receive window size         ", "AFD_RECEIVE_WINDOW_SIZE                   ") \
+    X(AFD_SEND_WINDOW_SIZE, H2AfdVolatile, "Send window size            ", "AFD_SEND_WINDOW_SIZE                      ") \
+    X(AFD_CONNECT_TIME, H2AfdVolatile, "Connect time                ", "AFD_CONNECT_TIME                          ") \
+    X(AFD_GROUP_ID, H2AfdStatic, "Group ID                    ", "AFD_GROUP_ID_AND_TYPE::GroupID            ") \
+    X(AFD_GROUP_TYPE, H2AfdStatic, "Group type                  ", "AFD_GROUP_ID_AND_TYPE::GroupType          ") \
+    X(AFD_DELIVERY_AVAILABLE, H2AfdVolatile, "Delivery available          ", "AFD_DELIVERY_STATUS::DeliveryAvailable    ") \
+    X(AFD_PENDED_RECEIVE_REQUESTS, H2AfdVolatile, "Pending receive requests    ", "AFD_DELIVERY_STATUS::PendedReceiveRequests")
+
+// TDI devices
+// X(Property, Volatility, FriendlyName, RawName)
+#define H2_AFD_TDI_PROPERTIES(X) \
+    X(TDI_ADDRESS_DEVICE, H2AfdSemiStatic, "TDI address device          ", "AFD_HANDLE_INFO.TdiAddressHandle          ") \
+    X(TDI_CONNECTION_DEVICE, H2AfdSemiStatic, "TDI connection device       ", "AFD_HANDLE_INFO.TdiConnectionHandle       ")
+
+// Socket-level options
+// X(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName)
+#define H2_AFD_SOL_OPTIONS(X) \
+    X(SO_REUSEADDR, SOL_SOCKET, SO_REUSEADDR, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Reuse address               ", "SO_REUSEADDR                              ") \
+    X(SO_KEEPALIVE, SOL_SOCKET, SO_KEEPALIVE, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Keep alive                  ", "SO_KEEPALIVE                              ") \
+    X(SO_DONTROUTE, SOL_SOCKET, SO_DONTROUTE, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Don't route                 ", "SO_DONTROUTE                              ") \
+    X(SO_BROADCAST, SOL_SOCKET, SO_BROADCAST, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Broadcast                   ", "SO_BROADCAST                              ") \
+    X(SO_OOBINLINE, SOL_SOCKET, SO_OOBINLINE, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "OOB in line                 ", "SO_OOBINLINE                              ") \
+    X(SO_RCVBUF, SOL_SOCKET, SO_RCVBUF, H2AfdValueBytes, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Receive buffer size         ", "SO_RCVBUF                                 ") \
+    X(SO_MAX_MSG_SIZE, SOL_SOCKET, SO_MAX_MSG_SIZE, H2AfdValueBytes, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Maximum message size        ", "SO_MAX_MSG_SIZE                           ") \
+    X(SO_CONDITIONAL_ACCEPT, SOL_SOCKET, SO_CONDITIONAL_ACCEPT, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Conditional accept          ", "SO_CONDITIONAL_ACCEPT                     ") \
+    X(SO_PAUSE_ACCEPT, SOL_SOCKET, SO_PAUSE_ACCEPT, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Pause accept                ", "SO_PAUSE_ACCEPT                           ") \
+    X(SO_COMPARTMENT_ID, SOL_SOCKET, SO_COMPARTMENT_ID, H2AfdValueDecimal, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Compartment ID              ", "SO_COMPARTMENT_ID                         ") \
+    X(SO_RANDOMIZE_PORT, SOL_SOCKET, SO_RANDOMIZE_PORT, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Randomize port              ", "SO_RANDOMIZE_PORT                         ") \
+    X(SO_PORT_SCALABILITY, SOL_SOCKET, SO_PORT_SCALABILITY, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Port scalability            ", "SO_PORT_SCALABILITY                       ") \
+    X(SO_REUSE_UNICASTPORT, SOL_SOCKET, SO_REUSE_UNICASTPORT, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Reuse unicast port          ", "SO_REUSE_UNICASTPORT                      ") \
+    X(SO_EXCLUSIVEADDRUSE, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_ANY, H2AfdSemiStatic, "Exclusive address use       ", "SO_EXCLUSIVEADDRUSE                       ")
+
+// IPv4-level options; human-readable mode shows them merged with IPv6
+// X(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName)
+#define H2_AFD_IP_OPTIONS(X) \
+    X(IP_HDRINCL, IPPROTO_IP, IP_HDRINCL, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_HDRINCL                                ") \
+    X(IP_TOS, IPPROTO_IP, IP_TOS, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_TOS                                    ") \
+    X(IP_TTL, IPPROTO_IP, IP_TTL, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_TTL                                    ") \
+    X(IP_MULTICAST_IF, IPPROTO_IP, IP_MULTICAST_IF, H2AfdValueInterface, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_MULTICAST_IF                           ") \
+    X(IP_MULTICAST_TTL, IPPROTO_IP, IP_MULTICAST_TTL, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_MULTICAST_TTL                          ") \
+    X(IP_MULTICAST_LOOP, IPPROTO_IP, IP_MULTICAST_LOOP, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_MULTICAST_LOOP                         ") \
+    X(IP_DONTFRAGMENT, IPPROTO_IP, IP_DONTFRAGMENT, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_DONTFRAGMENT                           ") \
+    X(IP_PKTINFO, IPPROTO_IP, IP_PKTINFO, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_PKTINFO                                ") \
+    X(IP_RECVTTL, IPPROTO_IP, IP_RECVTTL, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_RECVTTL                                ") \
+    X(IP_RECEIVE_BROADCAST, IPPROTO_IP, IP_RECEIVE_BROADCAST, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_RECEIVE_BROADCAST                      ") \
+    X(IP_RECVIF, IPPROTO_IP, IP_RECVIF, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_RECVIF                                 ") \
+    X(IP_RECVDSTADDR, IPPROTO_IP, IP_RECVDSTADDR, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_RECVDSTADDR                            ") \
+    X(IP_IFLIST, IPPROTO_IP, IP_IFLIST, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_IFLIST                                 ") \
+    X(IP_UNICAST_IF, IPPROTO_IP, IP_UNICAST_IF, H2AfdValueInterface, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_UNICAST_IF                             ") \
+    X(IP_RECVRTHDR, IPPROTO_IP, IP_RECVRTHDR, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_RECVRTHDR                              ") \
+    X(IP_RECVTOS, IPPROTO_IP, IP_RECVTOS, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_RECVTOS                                ") \
+    X(IP_ORIGINAL_ARRIVAL_IF, IPPROTO_IP, IP_ORIGINAL_ARRIVAL_IF, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_ORIGINAL_ARRIVAL_IF                    ") \
+    X(IP_RECVECN, IPPROTO_IP, IP_RECVECN, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_RECVECN                                ") \
+    X(IP_PKTINFO_EX, IPPROTO_IP, IP_PKTINFO_EX, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_PKTINFO_EX                             ") \
+    X(IP_WFP_REDIRECT_RECORDS, IPPROTO_IP, IP_WFP_REDIRECT_RECORDS, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_WFP_REDIRECT_RECORDS                   ") \
+    X(IP_WFP_REDIRECT_CONTEXT, IPPROTO_IP, IP_WFP_REDIRECT_CONTEXT, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_WFP_REDIRECT_CONTEXT                   ") \
+    X(IP_MTU_DISCOVER, IPPROTO_IP, IP_MTU_DISCOVER, H2AfdValueMtuDiscover, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_MTU_DISCOVER                           ") \
+    X(IP_MTU, IPPROTO_IP, IP_MTU, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_MTU                                    ") \
+    X(IP_RECVERR, IPPROTO_IP, IP_RECVERR, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_RECVERR                                ") \
+    X(IP_USER_MTU, IPPROTO_IP, IP_USER_MTU, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IP_USER_MTU                               ")
+
+// IPv6-level options; human-readable mode shows them merged with IPv4
+// X(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName)
+#define H2_AFD_IPV6_OPTIONS(X) \
+    X(IPV6_HDRINCL, IPPROTO_IPV6, IPV6_HDRINCL, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_HDRINCL                              ") \
+    X(IPV6_UNICAST_HOPS, IPPROTO_IPV6, IPV6_UNICAST_HOPS, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_UNICAST_HOPS                         ") \
+    X(IPV6_MULTICAST_IF, IPPROTO_IPV6, IPV6_MULTICAST_IF, H2AfdValueInterface, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_MULTICAST_IF                         ") \
+    X(IPV6_MULTICAST_HOPS, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_MULTICAST_HOPS                       ") \
+    X(IPV6_MULTICAST_LOOP, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_MULTICAST_LOOP                       ") \
+    X(IPV6_DONTFRAG, IPPROTO_IPV6, IPV6_DONTFRAG, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_DONTFRAG                             ") \
+    X(IPV6_PKTINFO, IPPROTO_IPV6, IPV6_PKTINFO, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_PKTINFO                              ") \
+    X(IPV6_HOPLIMIT, IPPROTO_IPV6, IPV6_HOPLIMIT, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_HOPLIMIT                             ") \
+    X(IPV6_PROTECTION_LEVEL, IPPROTO_IPV6, IPV6_PROTECTION_LEVEL, H2AfdValueProtectionLevel, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_PROTECTION_LEVEL                     ") \
+    X(IPV6_RECVIF, IPPROTO_IPV6, IPV6_RECVIF, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_RECVIF                               ") \
+    X(IPV6_RECVDSTADDR, IPPROTO_IPV6, IPV6_RECVDSTADDR, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_RECVDSTADDR                          ") \
+    X(IPV6_V6ONLY, IPPROTO_IPV6, IPV6_V6ONLY, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_V6ONLY                               ") \
+    X(IPV6_IFLIST, IPPROTO_IPV6, IPV6_IFLIST, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_IFLIST                               ") \
+    X(IPV6_UNICAST_IF, IPPROTO_IPV6, IPV6_UNICAST_IF, H2AfdValueInterface, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_UNICAST_IF                           ") \
+    X(IPV6_RECVRTHDR, IPPROTO_IPV6, IPV6_RECVRTHDR, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_RECVRTHDR                            ") \
+    X(IPV6_RECVTCLASS, IPPROTO_IPV6, IPV6_RECVTCLASS, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_RECVTCLASS                           ") \
+    X(IPV6_RECVECN, IPPROTO_IPV6, IPV6_RECVECN, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_RECVECN                              ") \
+    X(IPV6_PKTINFO_EX, IPPROTO_IPV6, IPV6_PKTINFO_EX, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_PKTINFO_EX                           ") \
+    X(IPV6_WFP_REDIRECT_RECORDS, IPPROTO_IPV6, IPV6_WFP_REDIRECT_RECORDS, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_WFP_REDIRECT_RECORDS                 ") \
+    X(IPV6_WFP_REDIRECT_CONTEXT, IPPROTO_IPV6, IPV6_WFP_REDIRECT_CONTEXT, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_WFP_REDIRECT_CONTEXT                 ") \
+    X(IPV6_MTU_DISCOVER, IPPROTO_IPV6, IPV6_MTU_DISCOVER, H2AfdValueMtuDiscover, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_MTU_DISCOVER                         ") \
+    X(IPV6_MTU, IPPROTO_IPV6, IPV6_MTU, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_MTU                                  ") \
+    X(IPV6_RECVERR, IPPROTO_IPV6, IPV6_RECVERR, H2AfdValueBoolean, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_RECVERR                              ") \
+    X(IPV6_USER_MTU, IPPROTO_IPV6, IPV6_USER_MTU, H2AfdValueDecimal, H2AfdVisibleRawOnly, H2_AFD_APPLIES_IP, H2AfdSemiStatic, "                            ", "IPV6_USER_MTU                             ")
+
+// IP-level options as shown in human-readable mode; the IPv4 option takes precedence
+// X(Property, Ipv4Option, Ipv6Option, Kind, Volatility, FriendlyName, RawName)
+#define H2_AFD_MERGED_IP_OPTIONS(X) \
+    X(IPALL_HDRINCL, IP_HDRINCL, IPV6_HDRINCL, H2AfdValueBoolean, H2AfdSemiStatic, "Header included             ", "                                          ") \
+    X(IPALL_TOS, IP_TOS, NONE, H2AfdValueDecimal, H2AfdSemiStatic, "Type-of-service             ", "                                          ") \
+    X(IPALL_TTL, IP_TTL, IPV6_UNICAST_HOPS, H2AfdValueDecimal, H2AfdSemiStatic, "Unicast TTL                 ", "                                          ") \
+    X(IPALL_MULTICAST_IF, IP_MULTICAST_IF, IPV6_MULTICAST_IF, H2AfdValueInterface, H2AfdSemiStatic, "Multicast interface         ", "                                          ") \
+    X(IPALL_MULTICAST_TTL, IP_MULTICAST_TTL, IPV6_MULTICAST_HOPS, H2AfdValueDecimal, H2AfdSemiStatic, "Multicast TTL               ", "                                          ") \
+    X(IPALL_MULTICAST_LOOP, IP_MULTICAST_LOOP, IPV6_MULTICAST_LOOP, H2AfdValueBoolean, H2AfdSemiStatic, "Multicast loopback          ", "                                          ") \
+    X(IPALL_DONTFRAGMENT, IP_DONTFRAGMENT, IPV6_DONTFRAG, H2AfdValueBoolean, H2AfdSemiStatic, "Don't fragment              ", "                                          ") \
+    X(IPALL_PKTINFO, IP_PKTINFO, IPV6_PKTINFO, H2AfdValueBoolean, H2AfdSemiStatic, "Receive packet info         ", "                                          ") \
+    X(IPALL_RECVTTL, IP_RECVTTL, IPV6_HOPLIMIT, H2AfdValueBoolean, H2AfdSemiStatic, "Receive TTL                 ", "                                          ") \
+    X(IPALL_RECEIVE_BROADCAST, IP_RECEIVE_BROADCAST, NONE, H2AfdValueBoolean, H2AfdSemiStatic, "Broadcast reception         ", "                                          ") \
+    X(IPALL_PROTECTION_LEVEL, NONE, IPV6_PROTECTION_LEVEL, H2AfdValueProtectionLevel, H2AfdSemiStatic, "IPv6 protection level       ", "                                          ") \
+    X(IPALL_RECVIF, IP_RECVIF, IPV6_RECVIF, H2AfdValueBoolean, H2AfdSemiStatic, "Receive arrival interface   ", "                                          ") \
+    X(IPALL_RECVDSTADDR, IP_RECVDSTADDR, IPV6_RECVDSTADDR, H2AfdValueBoolean, H2AfdSemiStatic, "Receive dest. address       ", "                                          ") \
+    X(IPALL_V6ONLY, NONE, IPV6_V6ONLY, H2AfdValueBoolean, H2AfdSemiStatic, "IPv6-only                   ", "                                          ") \
+    X(IPALL_IFLIST, IP_IFLIST, IPV6_IFLIST, H2AfdValueBoolean, H2AfdSemiStatic, "Interface list              ", "                                          ") \
+    X(IPALL_UNICAST_IF, IP_UNICAST_IF, IPV6_UNICAST_IF, H2AfdValueInterface, H2AfdSemiStatic, "Unicast interface           ", "                                          ") \
+    X(IPALL_RECVRTHDR, IP_RECVRTHDR, IPV6_RECVRTHDR, H2AfdValueBoolean, H2AfdSemiStatic, "Receive routing header      ", "                                          ") \
+    X(IPALL_RECVTOS, IP_RECVTOS, IPV6_RECVTCLASS, H2AfdValueBoolean, H2AfdSemiStatic, "Receive type-of-service     ", "                                          ") \
+    X(IPALL_ORIGINAL_ARRIVAL_IF, IP_ORIGINAL_ARRIVAL_IF, NONE, H2AfdValueBoolean, H2AfdSemiStatic, "Original arrival interface  ", "                                          ") \
+    X(IPALL_RECVECN, IP_RECVECN, IPV6_RECVECN, H2AfdValueBoolean, H2AfdSemiStatic, "Receive ECN                 ", "                                          ") \
+    X(IPALL_PKTINFO_EX, IP_PKTINFO_EX, IPV6_PKTINFO_EX, H2AfdValueBoolean, H2AfdSemiStatic, "Recveive ext. packet info   ", "                                          ") \
+    X(IPALL_WFP_REDIRECT_RECORDS, IP_WFP_REDIRECT_RECORDS, IPV6_WFP_REDIRECT_RECORDS, H2AfdValueBoolean, H2AfdSemiStatic, "WFP redirect records        ", "                                          ") \
+    X(IPALL_WFP_REDIRECT_CONTEXT, IP_WFP_REDIRECT_CONTEXT, IPV6_WFP_REDIRECT_CONTEXT, H2AfdValueBoolean, H2AfdSemiStatic, "WFP redirect context        ", "                                          ") \
+    X(IPALL_MTU_DISCOVER, IP_MTU_DISCOVER, IPV6_MTU_DISCOVER, H2AfdValueMtuDiscover, H2AfdSemiStatic, "MTU discovery               ", "                                          ") \
+    X(IPALL_MTU, IP_MTU, IPV6_MTU, H2AfdValueDecimal, H2AfdSemiStatic, "Path MTU                    ", "                                          ") \
+    X(IPALL_RECVERR, IP_RECVERR, IPV6_RECVERR, H2AfdValueBoolean, H2AfdSemiStatic, "Receive ICMP errors         ", "                                          ") \
+    X(IPALL_USER_MTU, IP_USER_MTU, IPV6_USER_MTU, H2AfdValueDecimal, H2AfdSemiStatic, "Upper MTU bound             ", "                                          ")
+
+// TCP-level options
+// X(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName)
+#define H2_AFD_TCP_OPTIONS(X) \
+    X(TCP_NODELAY, IPPROTO_TCP, TCP_NODELAY, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "No delay                    ", "TCP_NODELAY                               ") \
+    X(TCP_EXPEDITED, IPPROTO_TCP, TCP_EXPEDITED_1122, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Expedited data              ", "TCP_EXPEDITED_1122                        ") \
+    X(TCP_KEEPALIVE, IPPROTO_TCP, TCP_KEEPALIVE, H2AfdValueSeconds, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Keep alive                  ", "TCP_KEEPALIVE                             ") \
+    X(TCP_MAXSEG, IPPROTO_TCP, TCP_MAXSEG, H2AfdValueBytes, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Maximum segment size        ", "TCP_MAXSEG                                ") \
+    X(TCP_MAXRT, IPPROTO_TCP, TCP_MAXRT, H2AfdValueSeconds, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Retry timeout               ", "TCP_MAXRT                                 ") \
+    X(TCP_STDURG, IPPROTO_TCP, TCP_STDURG, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "URG interpretation          ", "TCP_STDURG                                ") \
+    X(TCP_NOURG, IPPROTO_TCP, TCP_NOURG, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "No URG                      ", "TCP_NOURG                                 ") \
+    X(TCP_ATMARK, IPPROTO_TCP, TCP_ATMARK, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdVolatile, "At mark                     ", "TCP_ATMARK                                ") \
+    X(TCP_NOSYNRETRIES, IPPROTO_TCP, TCP_NOSYNRETRIES, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "No SYN retries              ", "TCP_NOSYNRETRIES                          ") \
+    X(TCP_TIMESTAMPS, IPPROTO_TCP, TCP_TIMESTAMPS, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Timestamps                  ", "TCP_TIMESTAMPS                            ") \
+    X(TCP_CONGESTION_ALGORITHM, IPPROTO_TCP, TCP_CONGESTION_ALGORITHM, H2AfdValueDecimal, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Congestion algorithm        ", "TCP_CONGESTION_ALGORITHM                  ") \
+    X(TCP_DELAY_FIN_ACK, IPPROTO_TCP, TCP_DELAY_FIN_ACK, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Delay FIN ACK               ", "TCP_DELAY_FIN_ACK                         ") \
+    X(TCP_MAXRTMS, IPPROTO_TCP, TCP_MAXRTMS, H2AfdValueMilliseconds, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Retry timeout (precise)     ", "TCP_MAXRTMS                               ") \
+    X(TCP_FASTOPEN, IPPROTO_TCP, TCP_FASTOPEN, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Fast open                   ", "TCP_FASTOPEN                              ") \
+    X(TCP_KEEPCNT, IPPROTO_TCP, TCP_KEEPCNT, H2AfdValueDecimal, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Keep alive count            ", "TCP_KEEPCNT                               ") \
+    X(TCP_KEEPINTVL, IPPROTO_TCP, TCP_KEEPINTVL, H2AfdValueSeconds, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Keep alive interval         ", "TCP_KEEPINTVL                             ") \
+    X(TCP_FAIL_CONNECT_ON_ICMP_ERROR, IPPROTO_TCP, TCP_FAIL_CONNECT_ON_ICMP_ERROR, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_TCP, H2AfdSemiStatic, "Fail on ICMP error          ", "TCP_FAIL_CONNECT_ON_ICMP_ERROR            ")
+
+// Fields of TCP_INFO_v0 through TCP_INFO_v2
+// X(Property, Volatility, FriendlyName, RawName)
+#define H2_AFD_TCP_INFO_PROPERTIES(X) \
+    X(TCP_INFO_STATE, H2AfdSemiStatic, "TCP state                   ", "TCP_INFO_v0.State                         ") \
+    X(TCP_INFO_MSS, H2AfdSemiStatic, "Maximum segment size        ", "TCP_INFO_v0.Mss                           ") \
+    X(TCP_INFO_CONNECTION_TIME, H2AfdVolatile, "Connection time             ", "TCP_INFO_v0.ConnectionTimeMs              ") \
+    X(TCP_INFO_TIMESTAMPS_ENABLED, H2AfdSemiStatic, "Timestamps enabled          ", "TCP_INFO_v0.TimestampsEnabled             ") \
+    X(TCP_INFO_RTT, H2AfdVolatile, "Estimated round-trip        ", "TCP_INFO_v0.RttUs                         ") \
+    X(TCP_INFO_MINRTT, H2AfdVolatile, "Minimal round-trip          ", "TCP_INFO_v0.MinRttUs                      ") \
+    X(TCP_INFO_BYTES_IN_FLIGHT, H2AfdVolatile, "Bytes in flight             ", "TCP_INFO_v0.BytesInFlight                 ") \
+    X(TCP_INFO_CONGESTION_WINDOW, H2AfdVolatile, "Congestion window           ", "TCP_INFO_v0.Cwnd                          ") \
+    X(TCP_INFO_SEND_WINDOW, H2AfdVolatile, "Send window                 ", "TCP_INFO_v0.SndWnd                        ") \
+    X(TCP_INFO_RECEIVE_WINDOW, H2AfdVolatile, "Receive window              ", "TCP_INFO_v0.RcvWnd                        ") \
+    X(TCP_INFO_RECEIVE_BUFFER, H2AfdVolatile, "Receive buffer              ", "TCP_INFO_v0.RcvBuf                        ") \
+    X(TCP_INFO_BYTES_OUT, H2AfdVolatile, "Bytes sent                  ", "TCP_INFO_v0.BytesOut                      ") \
+    X(TCP_INFO_BYTES_IN, H2AfdVolatile, "Bytes received              ", "TCP_INFO_v0.BytesIn                       ") \
+    X(TCP_INFO_BYTES_REORDERED, H2AfdVolatile, "Bytes reordered             ", "TCP_INFO_v0.BytesReordered                ") \
+    X(TCP_INFO_BYTES_RETRANSMITTED, H2AfdVolatile, "Bytes retransmitted         ", "TCP_INFO_v0.BytesRetrans                  ") \
+    X(TCP_INFO_FAST_RETRANSMIT, H2AfdVolatile, "Fast retransmits            ", "TCP_INFO_v0.FastRetrans                   ") \
+    X(TCP_INFO_DUPLICATE_ACKS_IN, H2AfdVolatile, "Duplicate ACKs              ", "TCP_INFO_v0.DupAcksIn                     ") \
+    X(TCP_INFO_TIMEOUT_EPISODES, H2AfdVolatile, "Timeout episodes            ", "TCP_INFO_v0.TimeoutEpisodes               ") \
+    X(TCP_INFO_SYN_RETRANSMITS, H2AfdVolatile, "SYN retransmits             ", "TCP_INFO_v0.SynRetrans                    ") \
+    X(TCP_INFO_RECEIVER_LIMITED_TRANSITIONS, H2AfdVolatile, "Receiver-limited episodes   ", "TCP_INFO_v1.SndLimTransRwin               ") \
+    X(TCP_INFO_RECEIVER_LIMITED_TIME, H2AfdVolatile, "Receiver-limited time       ", "TCP_INFO_v1.SndLimTimeRwin                ") \
+    X(TCP_INFO_RECEIVER_LIMITED_BYTES, H2AfdVolatile, "Receiver-limited bytes      ", "TCP_INFO_v1.SndLimBytesRwin               ") \
+    X(TCP_INFO_CONGESTION_LIMITED_TRANSITIONS, H2AfdVolatile, "Congestion-limited episodes ", "TCP_INFO_v1.SndLimTransCwnd               ") \
+    X(TCP_INFO_CONGESTION_LIMITED_TIME, H2AfdVolatile, "Congestion-limited time     ", "TCP_INFO_v1.SndLimTimeCwnd                ") \
+    X(TCP_INFO_CONGESTION_LIMITED_BYTES, H2AfdVolatile, "Congestion-limited bytes    ", "TCP_INFO_v1.SndLimBytesCwnd               ") \
+    X(TCP_INFO_SENDER_LIMITED_TRANSITIONS, H2AfdVolatile, "Sender-limited episodes     ", "TCP_INFO_v1.SndLimTransSnd                ") \
+    X(TCP_INFO_SENDER_LIMITED_TIME, H2AfdVolatile, "Sender-limited time         ", "TCP_INFO_v1.SndLimTimeSnd                 ") \
+    X(TCP_INFO_SENDER_LIMITED_BYTES, H2AfdVolatile, "Sender-limited bytes        ", "TCP_INFO_v1.SndLimBytesSnd                ") \
+    X(TCP_INFO_OUT_OF_ORDER_PACKETS, H2AfdVolatile, "Out-of-order packets        ", "TCP_INFO_v2.OutOfOrderPktsIn              ") \
+    X(TCP_INFO_ECN_NEGOTIATED, H2AfdSemiStatic, "ECN negotiated              ", "TCP_INFO_v2.EcnNegotiated                 ") \
+    X(TCP_INFO_ECE_ACKS_IN, H2AfdVolatile, "ECE ACKs                    ", "TCP_INFO_v2.EceAcksIn                     ") \
+    X(TCP_INFO_PTO_EPISODES, H2AfdVolatile, "Probe timeout episodes      ", "TCP_INFO_v2.PtoEpisodes                   ")
+
+// UDP-level options
+// X(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName)
+#define H2_AFD_UDP_OPTIONS(X) \
+    X(UDP_NOCHECKSUM, IPPROTO_UDP, UDP_NOCHECKSUM, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_UDP, H2AfdSemiStatic, "No checksum                 ", "UDP_NOCHECKSUM                            ") \
+    X(UDP_SEND_MSG_SIZE, IPPROTO_UDP, UDP_SEND_MSG_SIZE, H2AfdValueBytes, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_UDP, H2AfdSemiStatic, "Maximum message size        ", "UDP_SEND_MSG_SIZE                         ") \
+    X(UDP_RECV_MAX_COALESCED_SIZE, IPPROTO_UDP, UDP_RECV_MAX_COALESCED_SIZE, H2AfdValueBytes, H2AfdVisibleAlways, H2_AFD_APPLIES_IP | H2_AFD_APPLIES_UDP, H2AfdSemiStatic, "Maximum coalesced size      ", "UDP_RECV_MAX_COALESCED_SIZE               ")
+
+// Hyper-V-level options
+// X(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName)
+#define H2_AFD_HV_OPTIONS(X) \
+    X(HVSOCKET_CONNECT_TIMEOUT, HV_PROTOCOL_RAW, HVSOCKET_CONNECT_TIMEOUT, H2AfdValueMilliseconds, H2AfdVisibleAlways, H2_AFD_APPLIES_HYPERV, H2AfdSemiStatic, "Connect timeout             ", "HVSOCKET_CONNECT_TIMEOUT                  ") \
+    X(HVSOCKET_CONTAINER_PASSTHRU, HV_PROTOCOL_RAW, HVSOCKET_CONTAINER_PASSTHRU, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_HYPERV, H2AfdSemiStatic, "Container passthru          ", "HVSOCKET_CONTAINER_PASSTHRU               ") \
+    X(HVSOCKET_CONNECTED_SUSPEND, HV_PROTOCOL_RAW, HVSOCKET_CONNECTED_SUSPEND, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_HYPERV, H2AfdSemiStatic, "Connected suspend           ", "HVSOCKET_CONNECTED_SUSPEND                ") \
+    X(HVSOCKET_HIGH_VTL, HV_PROTOCOL_RAW, HVSOCKET_HIGH_VTL, H2AfdValueBoolean, H2AfdVisibleAlways, H2_AFD_APPLIES_HYPERV, H2AfdSemiStatic, "High VTL                    ", "HVSOCKET_HIGH_VTL                         ")
+// All options in the order of H2_AFD_OPTION
+#define H2_AFD_OPTIONS(X) \
+    H2_AFD_SOL_OPTIONS(X) \
+    H2_AFD_IP_OPTIONS(X) \
+    H2_AFD_IPV6_OPTIONS(X) \
+    H2_AFD_TCP_OPTIONS(X) \
+    H2_AFD_UDP_OPTIONS(X) \
+    H2_AFD_HV_OPTIONS(X)
+
+// All properties in the order of H2_AFD_PROPERTY, expanding each kind of list with its own macro
+#define H2_AFD_PROPERTIES(X, XOPTION, XMERGED) \
+    H2_AFD_SHARED_PROPERTIES(X) \
+    H2_AFD_ADDRESS_PROPERTIES(X) \
+    H2_AFD_INFO_PROPERTIES(X) \
+    H2_AFD_TDI_PROPERTIES(X) \
+    H2_AFD_SOL_OPTIONS(XOPTION) \
+    H2_AFD_IP_OPTIONS(XOPTION) \
+    H2_AFD_IPV6_OPTIONS(XOPTION) \
+    H2_AFD_MERGED_IP_OPTIONS(XMERGED) \
+    H2_AFD_TCP_OPTIONS(XOPTION) \
+    H2_AFD_TCP_INFO_PROPERTIES(X) \
+    H2_AFD_UDP_OPTIONS(XOPTION) \
+    H2_AFD_HV_OPTIONS(XOPTION)
+
+/* Generated enumerations */
+
+#define H2_AFD_OPTION_ENUM(Option, ...) H2_AFD_OPTION_##Option,
+#define H2_AFD_PROPERTY_ENUM(Property, ...) H2_AFD_PROPERTY_##Property,
+
+// Socket options stored in a record
+typedef enum _H2_AFD_OPTION
+{
+    H2_AFD_OPTIONS(H2_AFD_OPTION_ENUM)
+    H2_AFD_OPTION_MAX
+} H2_AFD_OPTION;
+
+// Marks a missing half of a merged IPv4/IPv6 option
+#define H2_AFD_OPTION_NONE H2_AFD_OPTION_MAX
+
+// Socket properties, as printed
+typedef enum _H2_AFD_PROPERTY
+{
+    H2_AFD_PROPERTIES(H2_AFD_PROPERTY_ENUM, H2_AFD_PROPERTY_ENUM, H2_AFD_PROPERTY_ENUM)
+    H2_AFD_PROPERTY_MAX
+} H2_AFD_PROPERTY;
+
+#undef H2_AFD_OPTION_ENUM
+#undef H2_AFD_PROPERTY_ENUM
+
+// Everything needed to select and print an option; the option names that depend on the
+// Windows headers are in H2AfdOptionIds
+typedef struct _H2_AFD_OPTION_DESCRIPTOR
+{
+    H2_ULONG Level; // H2_AFD_LEVEL_*
+    H2_AFD_PROPERTY Property;
+    H2_AFD_VALUE_KIND Kind;
+    H2_AFD_VISIBILITY Visibility;
+    H2_ULONG Applicability; // H2_AFD_APPLIES_*
+    H2_AFD_VOLATILITY Volatility;
+} H2_AFD_OPTION_DESCRIPTOR, *PH2_AFD_OPTION_DESCRIPTOR;
+
+typedef const H2_AFD_OPTION_DESCRIPTOR *PCH2_AFD_OPTION_DESCRIPTOR;
+
+extern const H2_AFD_OPTION_DESCRIPTOR H2AfdOptionDescriptors[H2_AFD_OPTION_MAX];
+extern const H2_AFD_VOLATILITY H2AfdPropertyVolatility[H2_AFD_PROPERTY_MAX];
+
+const char*
+H2AfdGetPropertyKey(
+    _In_ H2_AFD_PROPERTY Property
+);
+
+#endif
@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "socket_record.h"
+#include "socket_strings.h"
+#include "capability_cache.h"
+#include "backend.h"
+#include <ws2bth.h>
+#include <ws2ipdef.h>
+#include <ws2tcpip.h>
+#include <hvsocket.h>
+
+// Records use portable mirrors of the Windows types; members are copied and cast in place
+C_ASSERT(sizeof(H2_SOCK_SHARED_INFO) == sizeof(SOCK_SHARED_INFO));
+C_ASSERT(FIELD_OFFSET(H2_SOCK_SHARED_INFO, LingerInfo) == FIELD_OFFSET(SOCK_SHARED_INFO, LingerInfo));
+C_ASSERT(FIELD_OFFSET(H2_SOCK_SHARED_INFO, Flags) == FIELD_OFFSET(SOCK_SHARED_INFO, Flags));
+C_ASSERT(FIELD_OFFSET(H2_SOCK_SHARED_INFO, AsyncSelectWnd64) == FIELD_OFFSET(SOCK_SHARED_INFO, AsyncSelectWnd64));
+C_ASSERT(FIELD_OFFSET(H2_SOCK_SHARED_INFO, ProviderId) == FIELD_OFFSET(SOCK_SHARED_INFO, ProviderId));
+C_ASSERT(sizeof(H2_SOCKADDR_STORAGE) == sizeof(SOCKADDR_STORAGE));
+C_ASSERT(TYPE_ALIGNMENT(H2_SOCKADDR_STORAGE) == TYPE_ALIGNMENT(SOCKADDR_STORAGE));
+C_ASSERT(sizeof(H2_AFD_GROUP_INFO) == sizeof(AFD_GROUP_INFO));
+C_ASSERT(sizeof(H2_TCP_INFO) == sizeof(TCP_INFO_v2));
+C_ASSERT(FIELD_OFFSET(H2_TCP_INFO, SynRetrans) == FIELD_OFFSET(TCP_INFO_v2, SynRetrans));
+C_ASSERT(FIELD_OFFSET(H2_TCP_INFO, SndLimBytesSnd) == FIELD_OFFSET(TCP_INFO_v2, SndLimBytesSnd));
+C_ASSERT(FIELD_OFFSET(H2_TCP_INFO, PtoEpisodes) == FIELD_OFFSET(TCP_INFO_v2, PtoEpisodes));
+C_ASSERT(sizeof(H2_GUID) == sizeof(GUID));
+C_ASSERT(H2_AFD_STATUS_NOT_QUERIED == STATUS_NO_DATA_DETECTED);
+C_ASSERT(H2_AFD_LEVEL_SOL_SOCKET == SOL_SOCKET && H2_AFD_LEVEL_IPPROTO_IP == IPPROTO_IP &&
+    H2_AFD_LEVEL_IPPROTO_IPV6 == IPPROTO_IPV6 && H2_AFD_LEVEL_IPPROTO_TCP == IPPROTO_TCP &&
+    H2_AFD_LEVEL_IPPROTO_UDP == IPPROTO_UDP && H2_AFD_LEVEL_HV_PROTOCOL_RAW == HV_PROTOCOL_RAW);
+
+// The portable formatters repeat the values they recognize
+C_ASSERT(H2_SOCK_STREAM == SOCK_STREAM && H2_SOCK_DGRAM == SOCK_DGRAM && H2_SOCK_RAW == SOCK_RAW &&
+    H2_SOCK_RDM == SOCK_RDM && H2_SOCK_SEQPACKET == SOCK_SEQPACKET);
+C_ASSERT(H2_AF_UNSPEC == AF_UNSPEC && H2_AF_INET == AF_INET && H2_AF_INET6 == AF_INET6 &&
+    H2_AF_BTH == AF_BTH && H2_AF_HYPERV == AF_HYPERV);
+C_ASSERT(H2_IPPROTO_ICMP == IPPROTO_ICMP && H2_IPPROTO_IGMP == IPPROTO_IGMP && H2_IPPROTO_TCP == IPPROTO_TCP &&
+    H2_IPPROTO_UDP == IPPROTO_UDP && H2_IPPROTO_RDP == IPPROTO_RDP && H2_IPPROTO_ICMPV6 == IPPROTO_ICMPV6 &&
+    H2_IPPROTO_PGM == IPPROTO_PGM && H2_IPPROTO_L2TP == IPPROTO_L2TP && H2_IPPROTO_SCTP == IPPROTO_SCTP &&
+    H2_IPPROTO_RAW == IPPROTO_RAW && H2_IPPROTO_RESERVED_IPSEC == IPPROTO_RESERVED_IPSEC);
+C_ASSERT(H2_BTHPROTO_RFCOMM == BTHPROTO_RFCOMM && H2_BTHPROTO_L2CAP == BTHPROTO_L2CAP &&
+    H2_HV_PROTOCOL_RAW == HV_PROTOCOL_RAW);
+C_ASSERT(H2_GROUP_TYPE_NEITHER == GroupTypeNeither && H2_GROUP_TYPE_UNCONSTRAINED == GroupTypeUnconstrained &&
+    H2_GROUP_TYPE_CONSTRAINED == GroupTypeConstrained);
+C_ASSERT(H2_PROTECTION_LEVEL_UNRESTRICTED == PROTECTION_LEVEL_UNRESTRICTED &&
+    H2_PROTECTION_LEVEL_EDGERESTRICTED == PROTECTION_LEVEL_EDGERESTRICTED &&
+    H2_PROTECTION_LEVEL_RESTRICTED == PROTECTION_LEVEL_RESTRICTED && H2_PROTECTION_LEVEL_DEFAULT == PROTECTION_LEVEL_DEFAULT);
+C_ASSERT(H2_IP_PMTUDISC_NOT_SET == IP_PMTUDISC_NOT_SET && H2_IP_PMTUDISC_DO == IP_PMTUDISC_DO &&
+    H2_IP_PMTUDISC_DONT == IP_PMTUDISC_DONT && H2_IP_PMTUDISC_PROBE == IP_PMTUDISC_PROBE);
+C_ASSERT(H2_TCPSTATE_CLOSED == TCPSTATE_CLOSED && H2_TCPSTATE_LISTEN == TCPSTATE_LISTEN &&
+    H2_TCPSTATE_SYN_SENT == TCPSTATE_SYN_SENT && H2_TCPSTATE_SYN_RCVD == TCPSTATE_SYN_RCVD &&
+    H2_TCPSTATE_ESTABLISHED == TCPSTATE_ESTABLISHED && H2_TCPSTATE_FIN_WAIT_1 == TCPSTATE_FIN_WAIT_1 &&
+    H2_TCPSTATE_FIN_WAIT_2 == TCPSTATE_FIN_WAIT_2 && H2_TCPSTATE_CLOSE_WAIT == TCPSTATE_CLOSE_WAIT &&
+    H2_TCPSTATE_CLOSING == TCPSTATE_CLOSING && H2_TCPSTATE_LAST_ACK == TCPSTATE_LAST_ACK &&
+    H2_TCPSTATE_TIME_WAIT == TCPSTATE_TIME_WAIT);
+C_ASSERT(H2_WSA_FLAG_OVERLAPPED == WSA_FLAG_OVERLAPPED && H2_WSA_FLAG_MULTIPOINT_C_ROOT == WSA_FLAG_MULTIPOINT_C_ROOT &&
+    H2_WSA_FLAG_MULTIPOINT_C_LEAF == WSA_FLAG_MULTIPOINT_C_LEAF && H2_WSA_FLAG_MULTIPOINT_D_ROOT == WSA_FLAG_MULTIPOINT_D_ROOT &&
+    H2_WSA_FLAG_MULTIPOINT_D_LEAF == WSA_FLAG_MULTIPOINT_D_LEAF &&
+    H2_WSA_FLAG_ACCESS_SYSTEM_SECURITY == WSA_FLAG_ACCESS_SYSTEM_SECURITY &&
+    H2_WSA_FLAG_NO_HANDLE_INHERIT == WSA_FLAG_NO_HANDLE_INHERIT && H2_WSA_FLAG_REGISTERED_IO == WSA_FLAG_REGISTERED_IO);
+C_ASSERT(H2_XP1_CONNECTIONLESS == XP1_CONNECTIONLESS && H2_XP1_GUARANTEED_DELIVERY == XP1_GUARANTEED_DELIVERY &&
+    H2_XP1_GUARANTEED_ORDER == XP1_GUARANTEED_ORDER && H2_XP1_MESSAGE_ORIENTED == XP1_MESSAGE_ORIENTED &&
+    H2_XP1_PSEUDO_STREAM == XP1_PSEUDO_STREAM && H2_XP1_GRACEFUL_CLOSE == XP1_GRACEFUL_CLOSE &&
+    H2_XP1_EXPEDITED_DATA == XP1_EXPEDITED_DATA && H2_XP1_CONNECT_DATA == XP1_CONNECT_DATA &&
+    H2_XP1_DISCONNECT_DATA == XP1_DISCONNECT_DATA && H2_XP1_SUPPORT_BROADCAST == XP1_SUPPORT_BROADCAST &&
+    H2_XP1_SUPPORT_MULTIPOINT == XP1_SUPPORT_MULTIPOINT && H2_XP1_MULTIPOINT_CONTROL_PLANE == XP1_MULTIPOINT_CONTROL_PLANE &&
+    H2_XP1_MULTIPOINT_DATA_PLANE == XP1_MULTIPOINT_DATA_PLANE && H2_XP1_QOS_SUPPORTED == XP1_QOS_SUPPORTED &&
+    H2_XP1_INTERRUPT == XP1_INTERRUPT && H2_XP1_UNI_SEND == XP1_UNI_SEND && H2_XP1_UNI_RECV == XP1_UNI_RECV &&
+    H2_XP1_IFS_HANDLES == XP1_IFS_HANDLES && H2_XP1_PARTIAL_MESSAGE == XP1_PARTIAL_MESSAGE &&
+    H2_XP1_SAN_SUPPORT_SDP == XP1_SAN_SUPPORT_SDP);
+C_ASSERT(H2_PFL_MULTIPLE_PROTO_ENTRIES == PFL_MULTIPLE_PROTO_ENTRIES &&
+    H2_PFL_RECOMMENDED_PROTO_ENTRY == PFL_RECOMMENDED_PROTO_ENTRY && H2_PFL_HIDDEN == PFL_HIDDEN &&
+    H2_PFL_MATCHES_PROTOCOL_ZERO == PFL_MATCHES_PROTOCOL_ZERO &&
+    H2_PFL_NETWORKDIRECT_PROVIDER == PFL_NETWORKDIRECT_PROVIDER);
+
+#define H2_AFD_OPTION_ID_ENTRY(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName) \
+    { Level, OptionName },
+
+// Levels and names of options in the H2_AFD_OPTION order
+const H2_AFD_OPTION_ID H2AfdOptionIds[H2_AFD_OPTION_MAX] =
+{
+    H2_AFD_OPTIONS(H2_AFD_OPTION_ID_ENTRY)
+};
+
+#undef H2_AFD_OPTION_ID_ENTRY
+
+// The volatility of record fields before the options, as of the most volatile property each one holds
+const H2_AFD_VOLATILITY H2AfdFieldVolatility[H2_AFD_FIELD_OPTIONS] =
+{
+    H2AfdVolatile, // H2_AFD_FIELD_SHARED_INFO (the state must keep up with TCP_INFO)
+    H2AfdSemiStatic, // H2_AFD_FIELD_LOCAL_ADDRESS
+    H2AfdSemiStatic, // H2_AFD_FIELD_REMOTE_ADDRESS
+    H2AfdSemiStatic, // H2_AFD_FIELD_MAX_SEND_SIZE
+    H2AfdVolatile, // H2_AFD_FIELD_SENDS_PENDING
+    H2AfdSemiStatic, // H2_AFD_FIELD_MAX_PATH_SEND_SIZE
+    H2AfdVolatile, // H2_AFD_FIELD_RECEIVE_WINDOW_SIZE (follows the traffic)
+    H2AfdVolatile, // H2_AFD_FIELD_SEND_WINDOW_SIZE
+    H2AfdVolatile, // H2_AFD_FIELD_CONNECT_TIME
+    H2AfdStatic, // H2_AFD_FIELD_GROUP_ID_AND_TYPE
+    H2AfdSemiStatic, // H2_AFD_FIELD_TDI_ADDRESS_DEVICE (appears on bind)
+    H2AfdSemiStatic, // H2_AFD_FIELD_TDI_CONNECTION_DEVICE (appears on connect)
+    H2AfdVolatile, // H2_AFD_FIELD_TCP_INFO_V0
+    H2AfdVolatile, // H2_AFD_FIELD_TCP_INFO_V1
+    H2AfdVolatile, // H2_AFD_FIELD_TCP_INFO_V2
+};
+
+// A row of the applicability matrix; H2_AFD_ANY_VALUE matches everything
+typedef struct _H2_AFD_APPLICABILITY_RULE
+{
+    LONG AddressFamily;
+    LONG SocketType;
+    LONG Protocol;
+    ULONG Traits; // H2_AFD_APPLIES_*
+} H2_AFD_APPLICABILITY_RULE, *PH2_AFD_APPLICABILITY_RULE;
+
+typedef const H2_AFD_APPLICABILITY_RULE *PCH2_AFD_APPLICABILITY_RULE;
+
+#define H2_AFD_ANY_VALUE (-1)
+
+// The families and protocols of sockets, for matching against option applicability; the first matching row wins
+const H2_AFD_APPLICABILITY_RULE H2AfdApplicabilityMatrix[] =
+{
+    { AF_INET, SOCK_STREAM, IPPROTO_TCP, H2_AFD_APPLIES_INET | H2_AFD_APPLIES_TCP },
+    { AF_INET, SOCK_STREAM, 0, H2_AFD_APPLIES_INET | H2_AFD_APPLIES_TCP },
+    { AF_INET, SOCK_DGRAM, IPPROTO_UDP, H2_AFD_APPLIES_INET | H2_AFD_APPLIES_UDP },
+    { AF_INET, SOCK_DGRAM, 0, H2_AFD_APPLIES_INET | H2_AFD_APPLIES_UDP },
+    { AF_INET, H2_AFD_ANY_VALUE, H2_AFD_ANY_VALUE, H2_AFD_APPLIES_INET },
+    { AF_INET6, SOCK_STREAM, IPPROTO_TCP, H2_AFD_APPLIES_INET6 | H2_AFD_APPLIES_TCP },
+    { AF_INET6, SOCK_STREAM, 0, H2_AFD_APPLIES_INET6 | H2_AFD_APPLIES_TCP },
+    { AF_INET6, SOCK_DGRAM, IPPROTO_UDP, H2_AFD_APPLIES_INET6 | H2_AFD_APPLIES_UDP },
+    { AF_INET6, SOCK_DGRAM, 0, H2_AFD_APPLIES_INET6 | H2_AFD_APPLIES_UDP },
+    { AF_INET6, H2_AFD_ANY_VALUE, H2_AFD_ANY_VALUE, H2_AFD_APPLIES_INET6 },
+    { AF_HYPERV, H2_AFD_ANY_VALUE, H2_AFD_ANY_VALUE, H2_AFD_APPLIES_HYPERV },
+    { H2_AFD_ANY_VALUE, H2_AFD_ANY_VALUE, H2_AFD_ANY_VALUE, H2_AFD_APPLIES_ANY },
+};
+
+/**
+  * \brief Looks up the families and protocols of a socket in the applicability matrix.
+  *
+  * \param[in] SharedInfo The shared Winsock context of the socket.
+  *
+  * \return A combination of H2_AFD_APPLIES_* flags.
+  */
+ULONG H2AfdGetSocketTraits(
+    _In_ PH2_SOCK_SHARED_INFO SharedInfo
+)
+{
+    PCH2_AFD_APPLICABILITY_RULE rule;
+
+    for (ULONG i = 0; i < RTL_NUMBER_OF(H2AfdApplicabilityMatrix); i++)
+    {
+        rule = &H2AfdApplicabilityMatrix[i];
+
+        if ((rule->AddressFamily == H2_AFD_ANY_VALUE || rule->AddressFamily == SharedInfo->AddressFamily) &&
+            (rule->SocketType == H2_AFD_ANY_VALUE || rule->SocketType == SharedInfo->SocketType) &&
+            (rule->Protocol == H2_AFD_ANY_VALUE || rule->Protocol == SharedInfo->Protocol))
+            return rule->Traits;
+    }
+
+    return H2_AFD_APPLIES_ANY;
+}
+
+/**
+  * \brief Determines whether an option can apply to a socket.
+  *
+  * \param[in] Applicability The H2_AFD_APPLIES_* flags of the option.
+  * \param[in] SocketTraits The H2_AFD_APPLIES_* flags of the socket.
+  *
+  * \return Whether the option is worth querying.
+  */
+BOOLEAN H2AfdIsApplicable(
+    _In_ ULONG Applicability,
+    _In_ ULONG SocketTraits
+)
+{
+    if ((Applicability & H2_AFD_APPLIES_FAMILY_MASK) && !(Applicability & SocketTraits & H2_AFD_APPLIES_FAMILY_MASK))
+        return FALSE;
+
+    if ((Applicability & H2_AFD_APPLIES_PROTOCOL_MASK) && !(Applicability & SocketTraits & H2_AFD_APPLIES_PROTOCOL_MASK))
+        return FALSE;
+
+    return TRUE;
+}
+
+/**
+  * \brief Queries a ULONG-sized AFD info class into a record field.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[in] InformationType The type of information to query.
+  * \param[out] Value A variable that receives the value.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2AfdQueryRecordSimpleInfo(
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG InformationType,
+    _Out_ PULONG Value
+)
+{
+    NTSTATUS status;
+    AFD_INFORMATION info;
+
+    status = H2AfdQuerySimpleInfo(SocketHandle, InformationType, &info);
+    *Value = NT_SUCCESS(status) ? info.Information.Ulong : 0;
+
+    return status;
+}
+
+/**
+  * \brief Determines the name of the device associated with a file handle.
+  *
+  * \param[in] FileHandle A handle to a file on the given device.
+  * \param[out] DeviceName A pointer to a UNICODE_STRING that receives the device string. The caller becomes
+  *            responsible for freeing the string via RtlFreeUnicodeString.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2AfdFormatDeviceName(
+    _In_ HANDLE FileHandle,
+    _Out_ PUNICODE_STRING DeviceName
+)
+{
+    NTSTATUS status;
+
+    union {
+        FILE_VOLUME_NAME_INFORMATION VolumeName;
+        UCHAR Raw[0x200];
+    } buffer;
+
+    // Query the underlying device name
+    status = H2Backend->QueryVolumeName(
+        FileHandle,
+        &buffer.VolumeName,
+        sizeof(buffer)
+    );
+
+    if (NT_SUCCESS(status))
+    {
+        UNICODE_STRING localString;
+
+        localString.Buffer = buffer.VolumeName.DeviceName;
+        localString.Length = (USHORT)buffer.VolumeName.DeviceNameLength;
+        localString.MaximumLength = localString.Length;
+
+        return RtlDuplicateUnicodeString(0, &localString, DeviceName);
+    }
+
+    return status;
+}
+
+/**
+  * \brief Determines the device behind a TDI address or connection handle of a socket.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[in] SharedInfo The shared info of the socket, if known.
+  * \param[in] QueryMode Either AFD_QUERY_ADDRESS_HANDLE or AFD_QUERY_CONNECTION_HANDLE.
+  * \param[out] Device The record field that receives the device information.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2AfdQueryRecordTdiDevice(
+    _In_ HANDLE SocketHandle,
+    _In_opt_ PH2_SOCK_SHARED_INFO SharedInfo,
+    _In_ ULONG QueryMode,
+    _Out_ PH2_AFD_TDI_DEVICE Device
+)
+{
+    NTSTATUS status;
+    HANDLE tdiHandle;
+    UNICODE_STRING deviceName;
+    BOOLEAN cached;
+
+    // TLI sockets have no TDI handles; AFD would only confirm that
+    if (SharedInfo && SharedInfo->fIsTLI)
+    {
+        Device->Kind = H2AfdTdiNotApplicable;
+        return STATUS_SUCCESS;
+    }
+
+    status = H2AfdQueryTdiHandle(SocketHandle, QueryMode, &tdiHandle);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    if (tdiHandle == INVALID_HANDLE_VALUE)
+    {
+        Device->Kind = H2AfdTdiNotApplicable;
+        return STATUS_SUCCESS;
+    }
+
+    if (tdiHandle == NULL)
+    {
+        Device->Kind = H2AfdTdiNone;
+        return STATUS_SUCCESS;
+    }
+
+    Device->Kind = H2AfdTdiDevice;
+
+    // Sockets of the same kind share the transport device, so name it once
+    cached = SharedInfo && H2CheckTdiDeviceCache(SharedInfo->AddressFamily, SharedInfo->Protocol, QueryMode, &deviceName);
+
+    if (!cached)
+        status = H2AfdFormatDeviceName(tdiHandle, &deviceName);
+
+    H2Backend->Close(tdiHandle);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    Device->NameLength = (USHORT)min(deviceName.Length, sizeof(Device->Name));
+    memcpy(Device->Name, deviceName.Buffer, Device->NameLength);
+
+    if (!cached)
+    {
+        if (SharedInfo)
+            H2AddTdiDeviceCache(SharedInfo->AddressFamily, SharedInfo->Protocol, QueryMode, &deviceName);
+
+        RtlFreeUnicodeString(&deviceName);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Queries the newest supported version of TCP_INFO into a record.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[in,out] Record The record to fill in.
+  */
+VOID H2AfdQueryRecordTcpInfo(
+    _In_ HANDLE SocketHandle,
+    _Inout_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    NTSTATUS status;
+    ULONG version;
+
+    status = H2AfdQueryTcpInfoBest(SocketHandle, (PTCP_INFO_v2)&Record->TcpInfo, &version);
+
+    for (ULONG i = 0; i <= H2_AFD_TCP_INFO_MAX_VERSION; i++)
+    {
+        // Success implies success for older versions; newer ones are not supported by the system
+        if (NT_SUCCESS(status) && i > version)
+            Record->Status[H2_AFD_FIELD_TCP_INFO_V0 + i] = STATUS_NOT_SUPPORTED;
+        else
+            Record->Status[H2_AFD_FIELD_TCP_INFO_V0 + i] = status;
+    }
+}
+
+/**
+  * \brief Determines if a socket acknowledges any option query, making option values meaningless.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[in] SharedInfo The shared info of the socket, if known.
+  *
+  * \return Whether option queries on the socket cannot be trusted.
+  */
+BOOLEAN H2AfdAreOptionsUnreliable(
+    _In_ HANDLE SocketHandle,
+    _In_opt_ PH2_SOCK_SHARED_INFO SharedInfo
+)
+{
+    H2_OPTIONS_VERDICT verdict;
+    BOOLEAN connected = FALSE;
+    BOOLEAN unreliable;
+    ULONG option;
+
+    if (SharedInfo)
+    {
+        // Only hvsocket.sys is known to have the bug
+        if (SharedInfo->AddressFamily != AF_HYPERV)
+            return FALSE;
+
+        verdict = H2CheckOptionsVerdict(SharedInfo->AddressFamily, SharedInfo->Protocol);
+        connected = SharedInfo->State == SocketStateConnected;
+
+        // The transport answered the probe correctly on a connected socket before
+        if (verdict == H2OptionsVerdictReliable)
+            return FALSE;
+
+        // The bug affects connected sockets of the transport
+        if (verdict == H2OptionsVerdictUnreliable && connected)
+            return TRUE;
+    }
+
+    // HACK: hvsocket.sys has a bug that makes connected Hyper-V sockets return
+    // STATUS_SUCCESS for all option-querying request. We detect it by issuing a
+    // deliberately invalid query. If it succeeds, we know we've hit the bug and
+    // cannot collect any meaningful option information about the socket.
+
+    unreliable = NT_SUCCESS(H2AfdQueryOption(SocketHandle, 0xDEAD, 0xDEAD, &option));
+
+    // Only a connected socket can prove the transport doesn't have the bug
+    if (SharedInfo && (unreliable || connected))
+        H2SetOptionsVerdict(
+            SharedInfo->AddressFamily,
+            SharedInfo->Protocol,
+            unreliable ? H2OptionsVerdictUnreliable : H2OptionsVerdictReliable
+        );
+
+    return unreliable;
+}
+
+/**
+  * \brief Queries one of the record fields that precede TCP_INFO and options.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[in] Field The field to query.
+  * \param[in,out] Record The record to fill in.
+  */
+VOID H2AfdQueryRecordField(
+    _In_ HANDLE SocketHandle,
+    _In_ H2_AFD_FIELD Field,
+    _Inout_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    AFD_INFORMATION info;
+    PH2_SOCK_SHARED_INFO sharedInfo;
+    NTSTATUS status;
+
+    sharedInfo = NT_SUCCESS(Record->Status[H2_AFD_FIELD_SHARED_INFO]) ? &Record->SharedInfo : NULL;
+
+    switch (Field)
+    {
+        case H2_AFD_FIELD_SHARED_INFO:
+            status = H2AfdQuerySharedInfo(SocketHandle, (PSOCK_SHARED_INFO)&Record->SharedInfo);
+            break;
+
+        case H2_AFD_FIELD_LOCAL_ADDRESS:
+            status = H2AfdQueryAddress(SocketHandle, FALSE, (PSOCKADDR_STORAGE)&Record->LocalAddress);
+            break;
+
+        case H2_AFD_FIELD_REMOTE_ADDRESS:
+            status = H2AfdQueryAddress(SocketHandle, TRUE, (PSOCKADDR_STORAGE)&Record->RemoteAddress);
+            break;
+
+        case H2_AFD_FIELD_MAX_SEND_SIZE:
+            status = H2AfdQueryRecordSimpleInfo(SocketHandle, AFD_MAX_SEND_SIZE, &Record->MaxSendSize);
+            break;
+
+        case H2_AFD_FIELD_SENDS_PENDING:
+            status = H2AfdQueryRecordSimpleInfo(SocketHandle, AFD_SENDS_PENDING, &Record->SendsPending);
+            break;
+
+        case H2_AFD_FIELD_MAX_PATH_SEND_SIZE:
+            status = H2AfdQueryRecordSimpleInfo(SocketHandle, AFD_MAX_PATH_SEND_SIZE, &Record->MaxPathSendSize);
+            break;
+
+        case H2_AFD_FIELD_RECEIVE_WINDOW_SIZE:
+            status = H2AfdQueryRecordSimpleInfo(SocketHandle, AFD_RECEIVE_WINDOW_SIZE, &Record->ReceiveWindowSize);
+            break;
+
+        case H2_AFD_FIELD_SEND_WINDOW_SIZE:
+            status = H2AfdQueryRecordSimpleInfo(SocketHandle, AFD_SEND_WINDOW_SIZE, &Record->SendWindowSize);
+            break;
+
+        case H2_AFD_FIELD_CONNECT_TIME:
+            status = H2AfdQueryRecordSimpleInfo(SocketHandle, AFD_CONNECT_TIME, &Record->ConnectTime);
+            break;
+
+        case H2_AFD_FIELD_GROUP_ID_AND_TYPE:
+            status = H2AfdQuerySimpleInfo(SocketHandle, AFD_GROUP_ID_AND_TYPE, &info);
+
+            if (NT_SUCCESS(status))
+            {
+                Record->GroupInfo.GroupID = info.Information.GroupInfo.GroupID;
+                Record->GroupInfo.GroupType = info.Information.GroupInfo.GroupType;
+            }
+
+            break;
+
+        case H2_AFD_FIELD_TDI_ADDRESS_DEVICE:
+            status = H2AfdQueryRecordTdiDevice(SocketHandle, sharedInfo, AFD_QUERY_ADDRESS_HANDLE, &Record->TdiAddressDevice);
+            break;
+
+        case H2_AFD_FIELD_TDI_CONNECTION_DEVICE:
+            status = H2AfdQueryRecordTdiDevice(SocketHandle, sharedInfo, AFD_QUERY_CONNECTION_HANDLE, &Record->TdiConnectionDevice);
+            break;
+
+        default:
+            return;
+    }
+
+    Record->Status[Field] = status;
+}
+
+/**
+  * \brief Queries everything the detailed view reports about a socket.
+  *  Each field records its own status; the function never fails as a whole.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[in] Flags A combination of H2_AFD_QUERY_* flags.
+  * \param[out] Record The record to fill in.
+  */
+VOID H2AfdQuerySocketRecord(
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG Flags,
+    _Out_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    H2AfdInitializeSocketRecord(Record);
+    H2AfdRefreshSocketRecord(SocketHandle, Flags, H2AfdStatic, Record);
+}
+
+/**
+  * \brief Re-queries the fields of a socket record that are at least as volatile as specified.
+  *  Less volatile fields keep their values; H2AfdStatic queries everything.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[in] Flags A combination of H2_AFD_QUERY_* flags.
+  * \param[in] Volatility The least volatile fields to query.
+  * \param[in,out] Record A record previously filled in by H2AfdQuerySocketRecord for the same socket.
+  */
+VOID H2AfdRefreshSocketRecord(
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG Flags,
+    _In_ H2_AFD_VOLATILITY Volatility,
+    _Inout_ PH2_AFD_SOCKET_RECORD Record
+)
+{
+    PH2_SOCK_SHARED_INFO sharedInfo;
+    ULONG socketTraits;
+    BOOLEAN useCapabilities;
+    NTSTATUS cachedStatus;
+    ULONG numberOfOptions;
+    H2_AFD_OPTION optionIndexes[H2_AFD_OPTION_MAX];
+    H2_AFD_OPTION_ID optionIds[H2_AFD_OPTION_MAX];
+    ULONG optionValues[H2_AFD_OPTION_MAX];
+    NTSTATUS optionStatuses[H2_AFD_OPTION_MAX];
+
+    for (ULONG i = 0; i < H2_AFD_FIELD_TCP_INFO_V0; i++)
+    {
+        if (H2AfdFieldVolatility[i] >= Volatility)
+            H2AfdQueryRecordField(SocketHandle, (H2_AFD_FIELD)i, Record);
+    }
+
+    sharedInfo = NT_SUCCESS(Record->Status[H2_AFD_FIELD_SHARED_INFO]) ? &Record->SharedInfo : NULL;
+
+    // Connecting can make a transport start acknowledging any option query
+    if (Volatility <= H2AfdSemiStatic)
+        Record->OptionsUnreliable = H2AfdAreOptionsUnreliable(SocketHandle, sharedInfo);
+
+    if (Record->OptionsUnreliable)
+    {
+        // Don't keep values from before the transport became unreliable
+        for (ULONG i = H2_AFD_FIELD_TCP_INFO_V0; i < H2_AFD_FIELD_MAX; i++)
+            Record->Status[i] = H2_AFD_STATUS_NOT_QUERIED;
+
+        return;
+    }
+
+    // Without the shared info, we cannot tell what applies, so query everything
+    if ((Flags & H2_AFD_QUERY_EXHAUSTIVE) || !sharedInfo)
+        socketTraits = MAXULONG;
+    else
+        socketTraits = H2AfdGetSocketTraits(&Record->SharedInfo);
+
+    // Options the system doesn't implement fail the same way for all sockets of a kind
+    useCapabilities = !(Flags & H2_AFD_QUERY_EXHAUSTIVE) && sharedInfo;
+
+    // Skip options that cannot apply; their fields remain not queried
+    numberOfOptions = 0;
+
+    for (ULONG i = 0; i < H2_AFD_OPTION_MAX; i++)
+    {
+        if (H2AfdOptionDescriptors[i].Volatility < Volatility ||
+            !H2AfdIsApplicable(H2AfdOptionDescriptors[i].Applicability, socketTraits))
+            continue;
+
+        // Reuse the status from an earlier socket of the same kind
+        if (useCapabilities && H2CheckCapabilityCache(
+            Record->SharedInfo.AddressFamily,
+            Record->SharedInfo.Protocol,
+            (H2_AFD_OPTION)i,
+            &cachedStatus))
+        {
+            Record->Status[H2_AFD_OPTION_FIELD(i)] = cachedStatus;
+            continue;
+        }
+
+        optionIndexes[numberOfOptions] = (H2_AFD_OPTION)i;
+        optionIds[numberOfOptions] = H2AfdOptionIds[i];
+        numberOfOptions++;
+    }
+
+    if (numberOfOptions)
+        H2AfdQueryOptions(SocketHandle, numberOfOptions, optionIds, optionValues, optionStatuses);
+
+    for (ULONG i = 0; i < numberOfOptions; i++)
+    {
+        Record->Options[optionIndexes[i]] = optionValues[i];
+        Record->Status[H2_AFD_OPTION_FIELD(optionIndexes[i])] = optionStatuses[i];
+
+        if (useCapabilities)
+            H2AddCapabilityCache(
+                Record->SharedInfo.AddressFamily,
+                Record->SharedInfo.Protocol,
+                optionIndexes[i],
+                optionStatuses[i]
+            );
+    }
+
+    if (H2AfdFieldVolatility[H2_AFD_FIELD_TCP_INFO_V0] >= Volatility &&
+        H2AfdIsApplicable(H2_AFD_TCP_INFO_APPLICABILITY, socketTraits))
+        H2AfdQueryRecordTcpInfo(SocketHandle, Record);
+}
+
+/**
+  * \brief Queries what the one-line summary reports about a socket.
+  *  Skips the remote address (and its probe) when the state of the socket rules it out.
+  *
+  * \param[in] SocketHandle An AFD socket handle.
+  * \param[out] Record The record to fill in.
+  */
+VOID H2AfdQuerySummaryRecord(
+    _In_ HANDLE SocketHandle,
+    _Out_ PH2_AFD_SUMMARY_RECORD Record
+)
+{
+    Record->SharedInfoStatus = H2AfdQuerySharedInfo(SocketHandle, (PSOCK_SHARED_INFO)&Record->SharedInfo);
+    Record->LocalAddressStatus = H2AfdQueryAddress(SocketHandle, FALSE, (PSOCKADDR_STORAGE)&Record->LocalAddress);
+
+    // The summary only shows the remote address next to the local one
+    if (!NT_SUCCESS(Record->LocalAddressStatus) ||
+        (NT_SUCCESS(Record->SharedInfoStatus) && !H2AfdCanHaveRemoteAddress(&Record->SharedInfo)))
+    {
+        Record->RemoteAddressStatus = H2_AFD_STATUS_NOT_QUERIED;
+        return;
+    }
+
+    Record->RemoteAddressStatus = H2AfdQueryAddress(SocketHandle, TRUE, (PSOCKADDR_STORAGE)&Record->RemoteAddress);
+}
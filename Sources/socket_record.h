@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SOCKET_RECORD_H
+#define _SOCKET_RECORD_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "nativesocket.h"
+#include "socket_layout.h"
+
+// Query all options, including those that cannot apply to the socket
+#define H2_AFD_QUERY_EXHAUSTIVE 0x0001
+
+// Levels and names of options in the H2_AFD_OPTION order
+extern const H2_AFD_OPTION_ID H2AfdOptionIds[H2_AFD_OPTION_MAX];
+
+VOID
+NTAPI
+H2AfdQuerySocketRecord(
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG Flags,
+    _Out_ PH2_AFD_SOCKET_RECORD Record
+);
+
+VOID
+NTAPI
+H2AfdRefreshSocketRecord(
+    _In_ HANDLE SocketHandle,
+    _In_ ULONG Flags,
+    _In_ H2_AFD_VOLATILITY Volatility,
+    _Inout_ PH2_AFD_SOCKET_RECORD Record
+);
+
+BOOLEAN
+NTAPI
+H2AfdAreOptionsUnreliable(
+    _In_ HANDLE SocketHandle,
+    _In_opt_ PH2_SOCK_SHARED_INFO SharedInfo
+);
+
+VOID
+NTAPI
+H2AfdQuerySummaryRecord(
+    _In_ HANDLE SocketHandle,
+    _Out_ PH2_AFD_SUMMARY_RECORD Record
+);
+
+#endif
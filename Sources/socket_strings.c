@@ -9,7 +9,7 @@
  */
 
 #include "socket_strings.h"
-#include <stdio.h>
+#include <string.h>
 
 /**
   * \brief Looks up a name for a known socket state.
@@ -21,25 +21,25 @@
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetSocketStateString(
-    _In_ SOCKET_STATE State,
-    _In_ BOOLEAN RawName
+const H2_CHAR* H2AfdGetSocketStateString(
+    _In_ H2_LONG State,
+    _In_ H2_BOOLEAN RawName
 )
 {
     switch (State)
     {
-    case SocketStateInitializing:
-        return RawName ? L"SocketStateInitializing" : L"Initializing";
-    case SocketStateOpen:
-        return RawName ? L"SocketStateOpen" : L"Open";
-    case SocketStateBound:
-        return RawName ? L"SocketStateBound" : L"Bound";
-    case SocketStateBoundSpecific:
-        return RawName ? L"SocketStateBoundSpecific" : L"Bound Specific";
-    case SocketStateConnected:
-        return RawName ? L"SocketStateConnected" : L"Connected";
-    case SocketStateClosing:
-        return RawName ? L"SocketStateClosing" : L"Closing";
+    case H2_SOCKET_STATE_INITIALIZING:
+        return RawName ? H2_T("SocketStateInitializing") : H2_T("Initializing");
+    case H2_SOCKET_STATE_OPEN:
+        return RawName ? H2_T("SocketStateOpen") : H2_T("Open");
+    case H2_SOCKET_STATE_BOUND:
+        return RawName ? H2_T("SocketStateBound") : H2_T("Bound");
+    case H2_SOCKET_STATE_BOUND_SPECIFIC:
+        return RawName ? H2_T("SocketStateBoundSpecific") : H2_T("Bound Specific");
+    case H2_SOCKET_STATE_CONNECTED:
+        return RawName ? H2_T("SocketStateConnected") : H2_T("Connected");
+    case H2_SOCKET_STATE_CLOSING:
+        return RawName ? H2_T("SocketStateClosing") : H2_T("Closing");
     default:
         return NULL;
     }
@@ -55,23 +55,23 @@ PCWSTR H2AfdGetSocketStateString(
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetSocketTypeString(
-    _In_ LONG SocketType,
-    _In_ BOOLEAN RawName
+const H2_CHAR* H2AfdGetSocketTypeString(
+    _In_ H2_LONG SocketType,
+    _In_ H2_BOOLEAN RawName
 )
 {
     switch (SocketType)
     {
-    case SOCK_STREAM:
-        return RawName ? L"SOCK_STREAM" : L"Stream";
-    case SOCK_DGRAM:
-        return RawName ? L"SOCK_DGRAM" : L"Datagram";
-    case SOCK_RAW:
-        return RawName ? L"SOCK_RAW" : L"Raw";
-    case SOCK_RDM:
-        return RawName ? L"SOCK_RDM" : L"Reliably-delivered message";
-    case SOCK_SEQPACKET:
-        return RawName ? L"SOCK_SEQPACKET" : L"Pseudo-stream";
+    case H2_SOCK_STREAM:
+        return RawName ? H2_T("SOCK_STREAM") : H2_T("Stream");
+    case H2_SOCK_DGRAM:
+        return RawName ? H2_T("SOCK_DGRAM") : H2_T("Datagram");
+    case H2_SOCK_RAW:
+        return RawName ? H2_T("SOCK_RAW") : H2_T("Raw");
+    case H2_SOCK_RDM:
+        return RawName ? H2_T("SOCK_RDM") : H2_T("Reliably-delivered message");
+    case H2_SOCK_SEQPACKET:
+        return RawName ? H2_T("SOCK_SEQPACKET") : H2_T("Pseudo-stream");
     default:
         return NULL;
     }
@@ -87,23 +87,23 @@ PCWSTR H2AfdGetSocketTypeString(
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetAddressFamilyString(
-    _In_ LONG AddressFamily,
-    _In_ BOOLEAN RawName
+const H2_CHAR* H2AfdGetAddressFamilyString(
+    _In_ H2_LONG AddressFamily,
+    _In_ H2_BOOLEAN RawName
 )
 {
     switch (AddressFamily)
     {
-    case AF_UNSPEC:
-        return RawName ? L"AF_UNSPEC" : L"Unspecified";
-    case AF_INET:
-        return RawName ? L"AF_INET" : L"Internet";
-    case AF_INET6:
-        return RawName ? L"AF_INET6" : L"Internet v6";
-    case AF_BTH:
-        return RawName ? L"AF_BTH" : L"Bluetooth";
-    case AF_HYPERV:
-        return RawName ? L"AF_HYPERV" : L"Hyper-V";
+    case H2_AF_UNSPEC:
+        return RawName ? H2_T("AF_UNSPEC") : H2_T("Unspecified");
+    case H2_AF_INET:
+        return RawName ? H2_T("AF_INET") : H2_T("Internet");
+    case H2_AF_INET6:
+        return RawName ? H2_T("AF_INET6") : H2_T("Internet v6");
+    case H2_AF_BTH:
+        return RawName ? H2_T("AF_BTH") : H2_T("Bluetooth");
+    case H2_AF_HYPERV:
+        return RawName ? H2_T("AF_HYPERV") : H2_T("Hyper-V");
     default:
         return NULL;
     }
@@ -120,54 +120,56 @@ PCWSTR H2AfdGetAddressFamilyString(
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetProtocolString(
-    _In_ LONG AddressFamily,
-    _In_ LONG Protocol,
-    _In_ BOOLEAN RawName
+const H2_CHAR* H2AfdGetProtocolString(
+    _In_ H2_LONG AddressFamily,
+    _In_ H2_LONG Protocol,
+    _In_ H2_BOOLEAN RawName
 )
 {
     switch (AddressFamily)
     {
-    case AF_INET:
-    case AF_INET6:
+    case H2_AF_INET:
+    case H2_AF_INET6:
         switch (Protocol)
         {
-        case IPPROTO_ICMP:
-            return RawName ? L"IPPROTO_ICMP" : L"ICMP";
-        case IPPROTO_IGMP:
-            return RawName ? L"IPPROTO_IGMP" : L"IGMP";
-        case IPPROTO_TCP:
-            return RawName ? L"IPPROTO_TCP" : L"TCP";
-        case IPPROTO_UDP:
-            return RawName ? L"IPPROTO_UDP" : L"UDP";
-        case IPPROTO_RDP:
-            return RawName ? L"IPPROTO_RDP" : L"RDP";
-        case IPPROTO_ICMPV6:
-            return RawName ? L"IPPROTO_ICMPV6" : L"ICMPv6";
-        case IPPROTO_PGM:
-            return RawName ? L"IPPROTO_PGM" : L"PGM";
-        case IPPROTO_L2TP:
-            return RawName ? L"IPPROTO_L2TP" : L"L2TP";
-        case IPPROTO_SCTP:
-            return RawName ? L"IPPROTO_SCTP" : L"SCTP";
-        case IPPROTO_RAW:
-            return RawName ? L"IPPROTO_RAW" : L"RAW";
-        case IPPROTO_RESERVED_IPSEC:
-            return RawName ? L"IPPROTO_RESERVED_IPSEC" : L"IPSec";
+        case H2_IPPROTO_ICMP:
+            return RawName ? H2_T("IPPROTO_ICMP") : H2_T("ICMP");
+        case H2_IPPROTO_IGMP:
+            return RawName ? H2_T("IPPROTO_IGMP") : H2_T("IGMP");
+        case H2_IPPROTO_TCP:
+            return RawName ? H2_T("IPPROTO_TCP") : H2_T("TCP");
+        case H2_IPPROTO_UDP:
+            return RawName ? H2_T("IPPROTO_UDP") : H2_T("UDP");
+        case H2_IPPROTO_RDP:
+            return RawName ? H2_T("IPPROTO_RDP") : H2_T("RDP");
+        case H2_IPPROTO_ICMPV6:
+            return RawName ? H2_T("IPPROTO_ICMPV6") : H2_T("ICMPv6");
+        case H2_IPPROTO_PGM:
+            return RawName ? H2_T("IPPROTO_PGM") : H2_T("PGM");
+        case H2_IPPROTO_L2TP:
+            return RawName ? H2_T("IPPROTO_L2TP") : H2_T("L2TP");
+        case H2_IPPROTO_SCTP:
+            return RawName ? H2_T("IPPROTO_SCTP") : H2_T("SCTP");
+        case H2_IPPROTO_RAW:
+            return RawName ? H2_T("IPPROTO_RAW") : H2_T("RAW");
+        case H2_IPPROTO_RESERVED_IPSEC:
+            return RawName ? H2_T("IPPROTO_RESERVED_IPSEC") : H2_T("IPSec");
         }
-    case AF_BTH:
+        break;
+    case H2_AF_BTH:
         switch (Protocol)
         {
-        case BTHPROTO_RFCOMM:
-            return RawName ? L"BTHPROTO_RFCOMM" : L"RFCOMM";
-        case BTHPROTO_L2CAP:
-            return RawName ? L"BTHPROTO_L2CAP" : L"L2CAP";
+        case H2_BTHPROTO_RFCOMM:
+            return RawName ? H2_T("BTHPROTO_RFCOMM") : H2_T("RFCOMM");
+        case H2_BTHPROTO_L2CAP:
+            return RawName ? H2_T("BTHPROTO_L2CAP") : H2_T("L2CAP");
         }
-    case AF_HYPERV:
+        break;
+    case H2_AF_HYPERV:
         switch (Protocol)
         {
-        case HV_PROTOCOL_RAW:
-            return RawName ? L"HV_PROTOCOL_RAW" : L"RAW";
+        case H2_HV_PROTOCOL_RAW:
+            return RawName ? H2_T("HV_PROTOCOL_RAW") : H2_T("RAW");
         }
     }
 
@@ -184,50 +186,53 @@ PCWSTR H2AfdGetProtocolString(
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetProtocolSummaryString(
-    _In_ LONG AddressFamily,
-    _In_ LONG Protocol
+const H2_CHAR* H2AfdGetProtocolSummaryString(
+    _In_ H2_LONG AddressFamily,
+    _In_ H2_LONG Protocol
 )
 {
     switch (AddressFamily)
     {
-    case AF_INET:
+    case H2_AF_INET:
         switch (Protocol)
         {
-        case IPPROTO_ICMP:
-            return L"ICMP";
-        case IPPROTO_TCP:
-            return L"TCP";
-        case IPPROTO_UDP:
-            return L"UDP";
-        case IPPROTO_RAW:
-            return L"RAW/IPv4";
+        case H2_IPPROTO_ICMP:
+            return H2_T("ICMP");
+        case H2_IPPROTO_TCP:
+            return H2_T("TCP");
+        case H2_IPPROTO_UDP:
+            return H2_T("UDP");
+        case H2_IPPROTO_RAW:
+            return H2_T("RAW/IPv4");
         }
-    case AF_INET6:
+        break;
+    case H2_AF_INET6:
         switch (Protocol)
         {
-        case IPPROTO_ICMPV6:
-            return L"ICMP6";
-        case IPPROTO_TCP:
-            return L"TCP6";
-        case IPPROTO_UDP:
-            return L"UDP6";
-        case IPPROTO_RAW:
-            return L"RAW/IPv6";
+        case H2_IPPROTO_ICMPV6:
+            return H2_T("ICMP6");
+        case H2_IPPROTO_TCP:
+            return H2_T("TCP6");
+        case H2_IPPROTO_UDP:
+            return H2_T("UDP6");
+        case H2_IPPROTO_RAW:
+            return H2_T("RAW/IPv6");
         }
-    case AF_BTH:
+        break;
+    case H2_AF_BTH:
         switch (Protocol)
         {
-        case BTHPROTO_RFCOMM:
-            return L"RFCOMM [Bluetooth]";
-        case BTHPROTO_L2CAP:
-            return L"L2CAP [Bluetooth]";
+        case H2_BTHPROTO_RFCOMM:
+            return H2_T("RFCOMM [Bluetooth]");
+        case H2_BTHPROTO_L2CAP:
+            return H2_T("L2CAP [Bluetooth]");
         }
-    case AF_HYPERV:
+        break;
+    case H2_AF_HYPERV:
         switch (Protocol)
         {
-        case HV_PROTOCOL_RAW:
-            return L"Hyper-V RAW";
+        case H2_HV_PROTOCOL_RAW:
+            return H2_T("Hyper-V RAW");
         }
     }
 
@@ -244,19 +249,19 @@ PCWSTR H2AfdGetProtocolSummaryString(
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetGroupTypeString(
-    _In_ AFD_GROUP_TYPE GroupType,
-    _In_ BOOLEAN RawName
+const H2_CHAR* H2AfdGetGroupTypeString(
+    _In_ H2_LONG GroupType,
+    _In_ H2_BOOLEAN RawName
 )
 {
     switch (GroupType)
     {
-    case GroupTypeNeither:
-        return RawName ? L"GroupTypeNeither" : L"Neither";
-    case GroupTypeUnconstrained:
-        return RawName ? L"GroupTypeUnconstrained" : L"Unconstrained";
-    case GroupTypeConstrained:
-        return RawName ? L"GroupTypeConstrained" : L"Constrained";
+    case H2_GROUP_TYPE_NEITHER:
+        return RawName ? H2_T("GroupTypeNeither") : H2_T("Neither");
+    case H2_GROUP_TYPE_UNCONSTRAINED:
+        return RawName ? H2_T("GroupTypeUnconstrained") : H2_T("Unconstrained");
+    case H2_GROUP_TYPE_CONSTRAINED:
+        return RawName ? H2_T("GroupTypeConstrained") : H2_T("Constrained");
     default:
         return NULL;
     }
@@ -272,21 +277,21 @@ PCWSTR H2AfdGetGroupTypeString(
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetProtectionLevelString(
-    _In_ ULONG ProtectionLevel,
-    _In_ BOOLEAN RawName
+const H2_CHAR* H2AfdGetProtectionLevelString(
+    _In_ H2_ULONG ProtectionLevel,
+    _In_ H2_BOOLEAN RawName
 )
 {
     switch (ProtectionLevel)
     {
-    case PROTECTION_LEVEL_UNRESTRICTED:
-        return RawName ? L"PROTECTION_LEVEL_UNRESTRICTED" : L"Unrestricted";
-    case PROTECTION_LEVEL_EDGERESTRICTED:
-        return RawName ? L"PROTECTION_LEVEL_EDGERESTRICTED" : L"Edge-restricted";
-    case PROTECTION_LEVEL_RESTRICTED:
-        return RawName ? L"PROTECTION_LEVEL_RESTRICTED" : L"Restricted";
-    case PROTECTION_LEVEL_DEFAULT:
-        return RawName ? L"PROTECTION_LEVEL_DEFAULT" : L"Default";
+    case H2_PROTECTION_LEVEL_UNRESTRICTED:
+        return RawName ? H2_T("PROTECTION_LEVEL_UNRESTRICTED") : H2_T("Unrestricted");
+    case H2_PROTECTION_LEVEL_EDGERESTRICTED:
+        return RawName ? H2_T("PROTECTION_LEVEL_EDGERESTRICTED") : H2_T("Edge-restricted");
+    case H2_PROTECTION_LEVEL_RESTRICTED:
+        return RawName ? H2_T("PROTECTION_LEVEL_RESTRICTED") : H2_T("Restricted");
+    case H2_PROTECTION_LEVEL_DEFAULT:
+        return RawName ? H2_T("PROTECTION_LEVEL_DEFAULT") : H2_T("Default");
     default:
         return NULL;
     }
@@ -302,21 +307,21 @@ PCWSTR H2AfdGetProtectionLevelString(
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetMtuDiscoveryString(
-    _In_ ULONG MtuDiscover,
-    _In_ BOOLEAN RawName
+const H2_CHAR* H2AfdGetMtuDiscoveryString(
+    _In_ H2_ULONG MtuDiscover,
+    _In_ H2_BOOLEAN RawName
 )
 {
     switch (MtuDiscover)
     {
-    case IP_PMTUDISC_NOT_SET:
-        return RawName ? L"IP_PMTUDISC_NOT_SET" : L"Not set";
-    case IP_PMTUDISC_DO:
-        return RawName ? L"IP_PMTUDISC_DO" : L"Perform";
-    case IP_PMTUDISC_DONT:
-        return RawName ? L"IP_PMTUDISC_DONT" : L"Don't perform";
-    case IP_PMTUDISC_PROBE:
-        return RawName ? L"IP_PMTUDISC_PROBE" : L"Probe";
+    case H2_IP_PMTUDISC_NOT_SET:
+        return RawName ? H2_T("IP_PMTUDISC_NOT_SET") : H2_T("Not set");
+    case H2_IP_PMTUDISC_DO:
+        return RawName ? H2_T("IP_PMTUDISC_DO") : H2_T("Perform");
+    case H2_IP_PMTUDISC_DONT:
+        return RawName ? H2_T("IP_PMTUDISC_DONT") : H2_T("Don't perform");
+    case H2_IP_PMTUDISC_PROBE:
+        return RawName ? H2_T("IP_PMTUDISC_PROBE") : H2_T("Probe");
     default:
         return NULL;
     }
@@ -332,233 +337,384 @@ PCWSTR H2AfdGetMtuDiscoveryString(
   */
 _Check_return_
 _Maybenull_
-PCWSTR H2AfdGetTcpStateString(
-    _In_ TCPSTATE TcpState,
-    _In_ BOOLEAN RawName
+const H2_CHAR* H2AfdGetTcpStateString(
+    _In_ H2_LONG TcpState,
+    _In_ H2_BOOLEAN RawName
 )
 {
     switch (TcpState)
     {
-    case TCPSTATE_CLOSED:
-        return RawName ? L"TCPSTATE_CLOSED" : L"Closed";
-    case TCPSTATE_LISTEN:
-        return RawName ? L"TCPSTATE_LISTEN" : L"Listen";
-    case TCPSTATE_SYN_SENT:
-        return RawName ? L"TCPSTATE_SYN_SENT" : L"SYN sent";
-    case TCPSTATE_SYN_RCVD:
-        return RawName ? L"TCPSTATE_SYN_RCVD" : L"SYN received";
-    case TCPSTATE_ESTABLISHED:
-        return RawName ? L"TCPSTATE_ESTABLISHED" : L"Established";
-    case TCPSTATE_FIN_WAIT_1:
-        return RawName ? L"TCPSTATE_FIN_WAIT_1" : L"FIN wait 1";
-    case TCPSTATE_FIN_WAIT_2:
-        return RawName ? L"TCPSTATE_FIN_WAIT_2" : L"FIN wait 2";
-    case TCPSTATE_CLOSE_WAIT:
-        return RawName ? L"TCPSTATE_CLOSE_WAIT" : L"Close wait";
-    case TCPSTATE_CLOSING:
-        return RawName ? L"TCPSTATE_CLOSING" : L"Closing";
-    case TCPSTATE_LAST_ACK:
-        return RawName ? L"TCPSTATE_LAST_ACK" : L"Last ACK";
-    case TCPSTATE_TIME_WAIT:
-        return RawName ? L"TCPSTATE_TIME_WAIT" : L"Time wait";
+    case H2_TCPSTATE_CLOSED:
+        return RawName ? H2_T("TCPSTATE_CLOSED") : H2_T("Closed");
+    case H2_TCPSTATE_LISTEN:
+        return RawName ? H2_T("TCPSTATE_LISTEN") : H2_T("Listen");
+    case H2_TCPSTATE_SYN_SENT:
+        return RawName ? H2_T("TCPSTATE_SYN_SENT") : H2_T("SYN sent");
+    case H2_TCPSTATE_SYN_RCVD:
+        return RawName ? H2_T("TCPSTATE_SYN_RCVD") : H2_T("SYN received");
+    case H2_TCPSTATE_ESTABLISHED:
+        return RawName ? H2_T("TCPSTATE_ESTABLISHED") : H2_T("Established");
+    case H2_TCPSTATE_FIN_WAIT_1:
+        return RawName ? H2_T("TCPSTATE_FIN_WAIT_1") : H2_T("FIN wait 1");
+    case H2_TCPSTATE_FIN_WAIT_2:
+        return RawName ? H2_T("TCPSTATE_FIN_WAIT_2") : H2_T("FIN wait 2");
+    case H2_TCPSTATE_CLOSE_WAIT:
+        return RawName ? H2_T("TCPSTATE_CLOSE_WAIT") : H2_T("Close wait");
+    case H2_TCPSTATE_CLOSING:
+        return RawName ? H2_T("TCPSTATE_CLOSING") : H2_T("Closing");
+    case H2_TCPSTATE_LAST_ACK:
+        return RawName ? H2_T("TCPSTATE_LAST_ACK") : H2_T("Last ACK");
+    case H2_TCPSTATE_TIME_WAIT:
+        return RawName ? H2_T("TCPSTATE_TIME_WAIT") : H2_T("Time wait");
     default:
         return NULL;
     }
 }
 
+// A caller-provided buffer that collects a formatted address
+typedef struct _H2_AFD_ADDRESS_TEXT
+{
+    H2_CHAR* Buffer;
+    size_t Capacity; // in characters
+    size_t Length; // in characters
+    H2_BOOLEAN Overflow;
+} H2_AFD_ADDRESS_TEXT, *PH2_AFD_ADDRESS_TEXT;
+
 /**
-  * \brief Determines the name of the device associated with a file handle.
+  * \brief Appends a zero-terminated string to an address.
   *
-  * \param[in] FileHandle A handle to a file on the given device.
-  * \param[out] DeviceName A pointer to a UNICODE_STRING that receives the device string. The caller becomes
-  *            responsible for freeing the string via RtlFreeUnicodeString.
+  * \param[in,out] Text The address text.
+  * \param[in] String The string to append.
+  */
+void H2AfdAppendAddressString(
+    _Inout_ PH2_AFD_ADDRESS_TEXT Text,
+    _In_ const H2_CHAR* String
+)
+{
+    for (; *String; String++)
+    {
+        if (Text->Length >= Text->Capacity)
+        {
+            Text->Overflow = TRUE;
+            return;
+        }
+
+        Text->Buffer[Text->Length++] = *String;
+    }
+}
+
+/**
+  * \brief Appends a number to an address.
   *
-  * \return Successful or errant status.
+  * \param[in,out] Text The address text.
+  * \param[in] Value The number.
+  * \param[in] Base 10 for decimal or 16 for hexadecimal numbers.
+  * \param[in] MinimumDigits The number of digits to pad to with zeros.
+  * \param[in] Uppercase Whether hexadecimal digits should be uppercase.
   */
-NTSTATUS H2AfdFormatDeviceName(
-    _In_ HANDLE FileHandle,
-    _Out_ PUNICODE_STRING DeviceName
+void H2AfdAppendAddressNumber(
+    _Inout_ PH2_AFD_ADDRESS_TEXT Text,
+    _In_ H2_ULONG64 Value,
+    _In_ H2_ULONG Base,
+    _In_ H2_ULONG MinimumDigits,
+    _In_ H2_BOOLEAN Uppercase
 )
 {
-    NTSTATUS status;
-    IO_STATUS_BLOCK ioStatusBlock;
-
-    union {
-        FILE_VOLUME_NAME_INFORMATION VolumeName;
-        UCHAR Raw[0x200];
-    } buffer;
-
-    // Query the underlying device name
-    status = NtQueryInformationFile(
-        FileHandle,
-        &ioStatusBlock,
-        &buffer,
-        sizeof(buffer),
-        FileVolumeNameInformation
-    );
-
-    if (NT_SUCCESS(status))
+    const char* digits = Uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+    H2_CHAR buffer[21];
+    H2_CHAR* cursor = buffer + 20;
+
+    *cursor = 0;
+
+    do
     {
-        UNICODE_STRING localString;
+        *--cursor = digits[Value % Base];
+        Value /= Base;
+    } while (Value || (H2_ULONG)(buffer + 20 - cursor) < MinimumDigits);
 
-        localString.Buffer = buffer.VolumeName.DeviceName;
-        localString.Length = (USHORT)buffer.VolumeName.DeviceNameLength;
-        localString.MaximumLength = localString.Length;
+    H2AfdAppendAddressString(Text, cursor);
+}
 
-        return RtlDuplicateUnicodeString(0, &localString, DeviceName);
+/**
+  * \brief Appends an IPv4 address in the dotted form.
+  *
+  * \param[in,out] Text The address text.
+  * \param[in] Bytes The four bytes of the address in network order.
+  */
+void H2AfdAppendIpv4Address(
+    _Inout_ PH2_AFD_ADDRESS_TEXT Text,
+    _In_reads_(4) const H2_UCHAR* Bytes
+)
+{
+    for (H2_ULONG i = 0; i < 4; i++)
+    {
+        if (i)
+            H2AfdAppendAddressString(Text, H2_T("."));
+
+        H2AfdAppendAddressNumber(Text, Bytes[i], 10, 0, FALSE);
     }
+}
 
-    return status;
+/**
+  * \brief Appends an IPv6 address in the same form as RtlIpv6AddressToString.
+  *
+  * \param[in,out] Text The address text.
+  * \param[in] Bytes The sixteen bytes of the address in network order.
+  */
+void H2AfdAppendIpv6Address(
+    _Inout_ PH2_AFD_ADDRESS_TEXT Text,
+    _In_reads_(16) const H2_UCHAR* Bytes
+)
+{
+    H2_USHORT words[8];
+    H2_ULONG parts = 8;
+    H2_ULONG runStart = 0;
+    H2_ULONG runLength = 0;
+    H2_ULONG bestStart = 0;
+    H2_ULONG bestLength = 0;
+
+    for (H2_ULONG i = 0; i < 8; i++)
+        words[i] = (H2_USHORT)(Bytes[i * 2] << 8 | Bytes[i * 2 + 1]);
+
+    // IPv4-compatible, IPv4-mapped, and IPv4-translated addresses end with a dotted IPv4 address
+    if (!words[0] && !words[1] && !words[2] && !words[3] && words[6])
+    {
+        const H2_CHAR* prefix = NULL;
+
+        if (words[4] == 0xFFFF && !words[5])
+            prefix = H2_T("::ffff:0:");
+        else if (!words[4] && words[5] == 0xFFFF)
+            prefix = H2_T("::ffff:");
+        else if (!words[4] && !words[5])
+            prefix = H2_T("::");
+
+        if (prefix)
+        {
+            H2AfdAppendAddressString(Text, prefix);
+            H2AfdAppendIpv4Address(Text, Bytes + 12);
+            return;
+        }
+    }
+
+    // ISATAP addresses also end with an IPv4 address
+    if ((words[4] & 0xFDFF) == 0 && words[5] == 0x5EFE)
+        parts = 6;
+
+    // Find the first longest run of zero words; single zeros are not compressed
+    for (H2_ULONG i = 0; i < parts; i++)
+    {
+        if (words[i])
+        {
+            runLength = 0;
+            continue;
+        }
+
+        if (!runLength++)
+            runStart = i;
+
+        if (runLength > bestLength)
+        {
+            bestStart = runStart;
+            bestLength = runLength;
+        }
+    }
+
+    if (bestLength < 2)
+        bestLength = 0;
+
+    for (H2_ULONG i = 0; i < parts; i++)
+    {
+        if (bestLength && i == bestStart)
+        {
+            H2AfdAppendAddressString(Text, H2_T("::"));
+            i += bestLength - 1;
+            continue;
+        }
+
+        if (i && !(bestLength && i == bestStart + bestLength))
+            H2AfdAppendAddressString(Text, H2_T(":"));
+
+        H2AfdAppendAddressNumber(Text, words[i], 16, 0, FALSE);
+    }
+
+    if (parts == 6)
+    {
+        if (!(bestLength && bestStart + bestLength == 6))
+            H2AfdAppendAddressString(Text, H2_T(":"));
+
+        H2AfdAppendIpv4Address(Text, Bytes + 12);
+    }
 }
 
+/**
+  * \brief Appends a GUID in braces with uppercase digits.
+  *
+  * \param[in,out] Text The address text.
+  * \param[in] Guid The GUID.
+  */
+void H2AfdAppendAddressGuid(
+    _Inout_ PH2_AFD_ADDRESS_TEXT Text,
+    _In_ const H2_GUID* Guid
+)
+{
+    H2AfdAppendAddressString(Text, H2_T("{"));
+    H2AfdAppendAddressNumber(Text, Guid->Data1, 16, 8, TRUE);
+    H2AfdAppendAddressString(Text, H2_T("-"));
+    H2AfdAppendAddressNumber(Text, Guid->Data2, 16, 4, TRUE);
+    H2AfdAppendAddressString(Text, H2_T("-"));
+    H2AfdAppendAddressNumber(Text, Guid->Data3, 16, 4, TRUE);
+    H2AfdAppendAddressString(Text, H2_T("-"));
+
+    for (H2_ULONG i = 0; i < sizeof(Guid->Data4); i++)
+    {
+        if (i == 2)
+            H2AfdAppendAddressString(Text, H2_T("-"));
+
+        H2AfdAppendAddressNumber(Text, Guid->Data4[i], 16, 2, TRUE);
+    }
+
+    H2AfdAppendAddressString(Text, H2_T("}"));
+}
+
+// Placeholder VmId values of Hyper-V addresses, same as HV_GUID_*
+const H2_GUID H2AfdHvGuidWildcard = { 0x00000000, 0x0000, 0x0000, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } };
+const H2_GUID H2AfdHvGuidBroadcast = { 0xFFFFFFFF, 0xFFFF, 0xFFFF, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } };
+const H2_GUID H2AfdHvGuidChildren = { 0x90DB8B89, 0x0D35, 0x4F79, { 0x8C, 0xE9, 0x49, 0xEA, 0x0A, 0xC8, 0xB7, 0xCD } };
+const H2_GUID H2AfdHvGuidLoopback = { 0xE0E16197, 0xDD56, 0x4A10, { 0x91, 0x95, 0x5E, 0xE7, 0xA1, 0x55, 0xA8, 0x38 } };
+const H2_GUID H2AfdHvGuidParent = { 0xA42E7CDA, 0xD03F, 0x480C, { 0x9C, 0xC2, 0xA4, 0xDE, 0x20, 0xAB, 0xB8, 0x78 } };
+const H2_GUID H2AfdHvGuidSiloHost = { 0x36BD0C5C, 0x7276, 0x4223, { 0x88, 0xBA, 0x7D, 0x03, 0xB6, 0x54, 0xC5, 0x68 } };
 
 /**
-  * \brief Formats a socket address to a string.
+  * \brief Formats a socket address into a caller-provided buffer.
   *
   * \param[in] Address The socket address buffer.
   * \param[in] Flags A bit masks of flags that control the function's behavior, such as H2_AFD_ADDRESS_SIMPLIFY.
-  * \param[out] AddressString A pointer to a UNICODE_STRING that receives the address string. The caller becomes
-  *            responsible for freeing the string via RtlFreeUnicodeString.
+  * \param[out] Buffer A buffer that receives the address without a terminator. H2_AFD_ADDRESS_MAX_LENGTH characters fit any address.
+  * \param[in] BufferLength The size of the buffer in characters.
+  * \param[out] Length The number of characters in the address.
   *
   * \return Successful or errant status.
   */
-NTSTATUS H2AfdFormatAddress(
-    _In_ PSOCKADDR_STORAGE Address,
-    _In_ ULONG Flags,
-    _Out_ PUNICODE_STRING AddressString
+H2_STATUS H2AfdFormatAddressToBuffer(
+    _In_ const H2_SOCKADDR_STORAGE* Address,
+    _In_ H2_ULONG Flags,
+    _Out_writes_(BufferLength) H2_CHAR* Buffer,
+    _In_ size_t BufferLength,
+    _Out_ size_t* Length
 )
 {
-    NTSTATUS status;
-    WCHAR buffer[80] = { 0 };
-    ULONG characters = RTL_NUMBER_OF(buffer);
+    const H2_UCHAR* bytes = (const H2_UCHAR*)Address;
+    H2_AFD_ADDRESS_TEXT text = { Buffer, BufferLength, 0, FALSE };
+    H2_ULONG port;
 
-    if (Address->ss_family == AF_INET)
-    {
-        PSOCKADDR_IN address = (PSOCKADDR_IN)Address;
-
-        // Format an IPv4 address
-        status = RtlIpv4AddressToStringExW(
-            &address->sin_addr,
-            address->sin_port,
-            buffer,
-            &characters
-        );
-
-        if (!NT_SUCCESS(status))
-            return status;
-
-        // Don't count the terminating zero
-        if (characters > 0)
-            characters--;
-    }
-    else if (Address->ss_family == AF_INET6)
-    {
-        PSOCKADDR_IN6 address = (PSOCKADDR_IN6)Address;
-
-        // Format an IPv6 address
-        status = RtlIpv6AddressToStringExW(
-            &address->sin6_addr,
-            address->sin6_scope_id,
-            address->sin6_port,
-            buffer,
-            &characters
-        );
-
-        if (!NT_SUCCESS(status))
-            return status;
-
-        // Don't count the terminating zero
-        if (characters > 0)
-            characters--;
-    }
-    else if (Address->ss_family == AF_BTH)
+    *Length = 0;
+
+    if (Address->ss_family == H2_AF_INET)
     {
-        PSOCKADDR_BTH address = (PSOCKADDR_BTH)Address;
+        // Same as RtlIpv4AddressToStringEx: sin_port at 2 and sin_addr at 4
+        port = bytes[2] << 8 | bytes[3];
+        H2AfdAppendIpv4Address(&text, bytes + 4);
 
-        // Format a Bluetooth address
-        characters = swprintf_s(buffer, characters,
-            L"(%02X:%02X:%02X:%02X:%02X:%02X):%d",
-            (UCHAR)(address->btAddr >> 40),
-            (UCHAR)(address->btAddr >> 32),
-            (UCHAR)(address->btAddr >> 24),
-            (UCHAR)(address->btAddr >> 16),
-            (UCHAR)(address->btAddr >> 8),
-            (UCHAR)(address->btAddr),
-            address->port
-        );
-
-        if (characters == ULONG_MAX)
-            return STATUS_INSUFFICIENT_RESOURCES;
+        if (port)
+        {
+            H2AfdAppendAddressString(&text, H2_T(":"));
+            H2AfdAppendAddressNumber(&text, port, 10, 0, FALSE);
+        }
     }
-    else if (Address->ss_family == AF_HYPERV)
+    else if (Address->ss_family == H2_AF_INET6)
     {
-        PSOCKADDR_HV address = (PSOCKADDR_HV)Address;
-        PCWSTR knownVmId = NULL;
-        UNICODE_STRING vmIdPart;
-        UNICODE_STRING serviceIdPart;
+        H2_ULONG scopeId;
 
-        // Format a Hyper-V address
+        // Same as RtlIpv6AddressToStringEx: sin6_port at 2, sin6_addr at 8, and sin6_scope_id at 24
+        port = bytes[2] << 8 | bytes[3];
+        memcpy(&scopeId, bytes + 24, sizeof(scopeId));
 
-        if (Flags & H2_AFD_ADDRESS_SIMPLIFY)
+        if (port)
+            H2AfdAppendAddressString(&text, H2_T("["));
+
+        H2AfdAppendIpv6Address(&text, bytes + 8);
+
+        if (scopeId)
         {
-            // Recognize placeholder VmId values
-            if (IsEqualGUID(&address->VmId, &HV_GUID_WILDCARD))
-                knownVmId = L"{Wildcard}";
-            else if (IsEqualGUID(&address->VmId, &HV_GUID_BROADCAST))
-                knownVmId = L"{Broadcast}";
-            else if (IsEqualGUID(&address->VmId, &HV_GUID_CHILDREN))
-                knownVmId = L"{Children}";
-            else if (IsEqualGUID(&address->VmId, &HV_GUID_LOOPBACK))
-                knownVmId = L"{Loopback}";
-            else if (IsEqualGUID(&address->VmId, &HV_GUID_PARENT))
-                knownVmId = L"{Parent}";
-            else if (IsEqualGUID(&address->VmId, &HV_GUID_SILOHOST))
-                knownVmId = L"{Silo host}";
+            H2AfdAppendAddressString(&text, H2_T("%"));
+            H2AfdAppendAddressNumber(&text, scopeId, 10, 0, FALSE);
         }
 
-        // Prepare the ServiceId part
-        status = RtlStringFromGUID(&address->ServiceId, &serviceIdPart);
+        if (port)
+        {
+            H2AfdAppendAddressString(&text, H2_T("]:"));
+            H2AfdAppendAddressNumber(&text, port, 10, 0, FALSE);
+        }
+    }
+    else if (Address->ss_family == H2_AF_BTH)
+    {
+        H2_ULONG64 btAddr;
+        H2_LONG btPort;
 
-        if (!NT_SUCCESS(status))
-            return status;
+        // SOCKADDR_BTH is packed: btAddr at 2 and port at 26
+        memcpy(&btAddr, bytes + 2, sizeof(btAddr));
+        memcpy(&btPort, bytes + 26, sizeof(btPort));
 
-        // Prepare the VmId part
-        if (!knownVmId)
+        // Format a Bluetooth address
+        H2AfdAppendAddressString(&text, H2_T("("));
+
+        for (H2_ULONG i = 0; i < 6; i++)
         {
-            status = RtlStringFromGUID(&address->VmId, &vmIdPart);
+            if (i)
+                H2AfdAppendAddressString(&text, H2_T(":"));
 
-            if (!NT_SUCCESS(status))
-            {
-                RtlFreeUnicodeString(&serviceIdPart);
-                return status;
-            }
+            H2AfdAppendAddressNumber(&text, (H2_UCHAR)(btAddr >> (40 - i * 8)), 16, 2, TRUE);
         }
-        else
+
+        H2AfdAppendAddressString(&text, btPort < 0 ? H2_T("):-") : H2_T("):"));
+        H2AfdAppendAddressNumber(&text, btPort < 0 ? 0 - (H2_ULONG64)btPort : (H2_ULONG64)btPort, 10, 0, FALSE);
+    }
+    else if (Address->ss_family == H2_AF_HYPERV)
+    {
+        H2_GUID vmId;
+        H2_GUID serviceId;
+        const H2_CHAR* knownVmId = NULL;
+
+        // SOCKADDR_HV: VmId at 4 and ServiceId at 20
+        memcpy(&vmId, bytes + 4, sizeof(vmId));
+        memcpy(&serviceId, bytes + 20, sizeof(serviceId));
+
+        // Format a Hyper-V address
+
+        if (Flags & H2_AFD_ADDRESS_SIMPLIFY)
         {
-            RtlInitUnicodeString(&vmIdPart, knownVmId);
+            // Recognize placeholder VmId values
+            if (memcmp(&vmId, &H2AfdHvGuidWildcard, sizeof(H2_GUID)) == 0)
+                knownVmId = H2_T("{Wildcard}");
+            else if (memcmp(&vmId, &H2AfdHvGuidBroadcast, sizeof(H2_GUID)) == 0)
+                knownVmId = H2_T("{Broadcast}");
+            else if (memcmp(&vmId, &H2AfdHvGuidChildren, sizeof(H2_GUID)) == 0)
+                knownVmId = H2_T("{Children}");
+            else if (memcmp(&vmId, &H2AfdHvGuidLoopback, sizeof(H2_GUID)) == 0)
+                knownVmId = H2_T("{Loopback}");
+            else if (memcmp(&vmId, &H2AfdHvGuidParent, sizeof(H2_GUID)) == 0)
+                knownVmId = H2_T("{Parent}");
+            else if (memcmp(&vmId, &H2AfdHvGuidSiloHost, sizeof(H2_GUID)) == 0)
+                knownVmId = H2_T("{Silo host}");
         }
 
         // Combine into {VmId}:{ServiceId}
-        characters = swprintf_s(buffer, characters, L"%wZ:%wZ", &vmIdPart, &serviceIdPart);
-
-        RtlFreeUnicodeString(&serviceIdPart);
-
-        if (!knownVmId)
-            RtlFreeUnicodeString(&vmIdPart);
+        if (knownVmId)
+            H2AfdAppendAddressString(&text, knownVmId);
+        else
+            H2AfdAppendAddressGuid(&text, &vmId);
 
-        if (characters == ULONG_MAX)
-            return STATUS_INSUFFICIENT_RESOURCES;
+        H2AfdAppendAddressString(&text, H2_T(":"));
+        H2AfdAppendAddressGuid(&text, &serviceId);
     }
     else
     {
-        return STATUS_UNKNOWN_REVISION;
+        return H2_STATUS_UNKNOWN_REVISION;
     }
 
-    UNICODE_STRING localString;
-    localString.Buffer = buffer;
-    localString.Length = (USHORT)(characters * sizeof(WCHAR));
-    localString.MaximumLength = sizeof(buffer);
+    if (text.Overflow)
+        return H2_STATUS_BUFFER_TOO_SMALL;
 
-    // Make a copy of the string for the caller
-    return RtlDuplicateUnicodeString(0, &localString, AddressString);
+    *Length = text.Length;
+    return H2_STATUS_SUCCESS;
 }
@@ -11,112 +11,200 @@
 #ifndef _SOCKET_STRINGS_H
 #define _SOCKET_STRINGS_H
 
-#include <phnt_windows.h>
-#include <phnt.h>
-#include "ntafd.h"
-#include <mstcpip.h>
-#include <ws2bth.h>
-#include <hvsocket.h>
-#include <ws2ipdef.h>
+//
+// Names of socket values and address formatting without Windows headers. The constants below
+// repeat the Winsock values that the lookups recognize; socket_record.c checks them against
+// the SDK.
+//
+
+#include "portable_types.h"
+#include "socket_layout.h"
+
+// Socket types
+#define H2_SOCK_STREAM 1
+#define H2_SOCK_DGRAM 2
+#define H2_SOCK_RAW 3
+#define H2_SOCK_RDM 4
+#define H2_SOCK_SEQPACKET 5
+
+// Address families
+#define H2_AF_UNSPEC 0
+#define H2_AF_INET 2
+#define H2_AF_INET6 23
+#define H2_AF_BTH 32
+#define H2_AF_HYPERV 34
+
+// Protocols
+#define H2_IPPROTO_ICMP 1
+#define H2_IPPROTO_IGMP 2
+#define H2_IPPROTO_TCP 6
+#define H2_IPPROTO_UDP 17
+#define H2_IPPROTO_RDP 27
+#define H2_IPPROTO_ICMPV6 58
+#define H2_IPPROTO_PGM 113
+#define H2_IPPROTO_L2TP 115
+#define H2_IPPROTO_SCTP 132
+#define H2_IPPROTO_RAW 255
+#define H2_IPPROTO_RESERVED_IPSEC 258
+#define H2_BTHPROTO_RFCOMM 0x0003
+#define H2_BTHPROTO_L2CAP 0x0100
+#define H2_HV_PROTOCOL_RAW 1
+
+// Socket group types, same as AFD_GROUP_TYPE
+#define H2_GROUP_TYPE_NEITHER 0
+#define H2_GROUP_TYPE_UNCONSTRAINED 1
+#define H2_GROUP_TYPE_CONSTRAINED 2
+
+// IPv6 protection levels
+#define H2_PROTECTION_LEVEL_UNRESTRICTED 10
+#define H2_PROTECTION_LEVEL_EDGERESTRICTED 20
+#define H2_PROTECTION_LEVEL_RESTRICTED 30
+#define H2_PROTECTION_LEVEL_DEFAULT ((H2_ULONG)-1)
+
+// MTU discovery modes
+#define H2_IP_PMTUDISC_NOT_SET 0
+#define H2_IP_PMTUDISC_DO 1
+#define H2_IP_PMTUDISC_DONT 2
+#define H2_IP_PMTUDISC_PROBE 3
+
+// TCP states, same as TCPSTATE
+#define H2_TCPSTATE_CLOSED 0
+#define H2_TCPSTATE_LISTEN 1
+#define H2_TCPSTATE_SYN_SENT 2
+#define H2_TCPSTATE_SYN_RCVD 3
+#define H2_TCPSTATE_ESTABLISHED 4
+#define H2_TCPSTATE_FIN_WAIT_1 5
+#define H2_TCPSTATE_FIN_WAIT_2 6
+#define H2_TCPSTATE_CLOSE_WAIT 7
+#define H2_TCPSTATE_CLOSING 8
+#define H2_TCPSTATE_LAST_ACK 9
+#define H2_TCPSTATE_TIME_WAIT 10
+
+// Socket creation flags
+#define H2_WSA_FLAG_OVERLAPPED 0x01
+#define H2_WSA_FLAG_MULTIPOINT_C_ROOT 0x02
+#define H2_WSA_FLAG_MULTIPOINT_C_LEAF 0x04
+#define H2_WSA_FLAG_MULTIPOINT_D_ROOT 0x08
+#define H2_WSA_FLAG_MULTIPOINT_D_LEAF 0x10
+#define H2_WSA_FLAG_ACCESS_SYSTEM_SECURITY 0x40
+#define H2_WSA_FLAG_NO_HANDLE_INHERIT 0x80
+#define H2_WSA_FLAG_REGISTERED_IO 0x100
+
+// Service flags of protocols
+#define H2_XP1_CONNECTIONLESS 0x00000001
+#define H2_XP1_GUARANTEED_DELIVERY 0x00000002
+#define H2_XP1_GUARANTEED_ORDER 0x00000004
+#define H2_XP1_MESSAGE_ORIENTED 0x00000008
+#define H2_XP1_PSEUDO_STREAM 0x00000010
+#define H2_XP1_GRACEFUL_CLOSE 0x00000020
+#define H2_XP1_EXPEDITED_DATA 0x00000040
+#define H2_XP1_CONNECT_DATA 0x00000080
+#define H2_XP1_DISCONNECT_DATA 0x00000100
+#define H2_XP1_SUPPORT_BROADCAST 0x00000200
+#define H2_XP1_SUPPORT_MULTIPOINT 0x00000400
+#define H2_XP1_MULTIPOINT_CONTROL_PLANE 0x00000800
+#define H2_XP1_MULTIPOINT_DATA_PLANE 0x00001000
+#define H2_XP1_QOS_SUPPORTED 0x00002000
+#define H2_XP1_INTERRUPT 0x00004000
+#define H2_XP1_UNI_SEND 0x00008000
+#define H2_XP1_UNI_RECV 0x00010000
+#define H2_XP1_IFS_HANDLES 0x00020000
+#define H2_XP1_PARTIAL_MESSAGE 0x00040000
+#define H2_XP1_SAN_SUPPORT_SDP 0x00080000
+
+// Provider flags
+#define H2_PFL_MULTIPLE_PROTO_ENTRIES 0x00000001
+#define H2_PFL_RECOMMENDED_PROTO_ENTRY 0x00000002
+#define H2_PFL_HIDDEN 0x00000004
+#define H2_PFL_MATCHES_PROTOCOL_ZERO 0x00000008
+#define H2_PFL_NETWORKDIRECT_PROVIDER 0x00000010
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetSocketStateString(
-    _In_ SOCKET_STATE State,
-    _In_ BOOLEAN UseRawNames
+    _In_ H2_LONG State,
+    _In_ H2_BOOLEAN UseRawNames
 );
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetSocketTypeString(
-    _In_ LONG SocketType,
-    _In_ BOOLEAN UseRawNames
+    _In_ H2_LONG SocketType,
+    _In_ H2_BOOLEAN UseRawNames
 );
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetAddressFamilyString(
-    _In_ LONG AddressFamily,
-    _In_ BOOLEAN UseRawNames
+    _In_ H2_LONG AddressFamily,
+    _In_ H2_BOOLEAN UseRawNames
 );
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetProtocolString(
-    _In_ LONG AddressFamily,
-    _In_ LONG Protocol,
-    _In_ BOOLEAN UseRawNames
+    _In_ H2_LONG AddressFamily,
+    _In_ H2_LONG Protocol,
+    _In_ H2_BOOLEAN UseRawNames
 );
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetProtocolSummaryString(
-    _In_ LONG AddressFamily,
-    _In_ LONG Protocol
+    _In_ H2_LONG AddressFamily,
+    _In_ H2_LONG Protocol
 );
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetGroupTypeString(
-    _In_ AFD_GROUP_TYPE GroupType,
-    _In_ BOOLEAN UseRawNames
+    _In_ H2_LONG GroupType,
+    _In_ H2_BOOLEAN UseRawNames
 );
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetProtectionLevelString(
-    _In_ ULONG ProtectionLevel,
-    _In_ BOOLEAN UseRawNames
+    _In_ H2_ULONG ProtectionLevel,
+    _In_ H2_BOOLEAN UseRawNames
 );
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetMtuDiscoveryString(
-    _In_ ULONG MtuDiscover,
-    _In_ BOOLEAN UseRawNames
+    _In_ H2_ULONG MtuDiscover,
+    _In_ H2_BOOLEAN UseRawNames
 );
 
 _Check_return_
 _Maybenull_
-PCWSTR
-NTAPI
+const H2_CHAR*
 H2AfdGetTcpStateString(
-    _In_ TCPSTATE TcpState,
-    _In_ BOOLEAN UseRawNames
-);
-
-NTSTATUS
-NTAPI
-H2AfdFormatDeviceName(
-    _In_ HANDLE FileHandle,
-    _Out_ PUNICODE_STRING DeviceName
+    _In_ H2_LONG TcpState,
+    _In_ H2_BOOLEAN UseRawNames
 );
 
 // Simplify parts of the address to make it more human-readable
 #define H2_AFD_ADDRESS_SIMPLIFY    0x1
 
-NTSTATUS
-NTAPI
-H2AfdFormatAddress(
-    _In_ PSOCKADDR_STORAGE Address,
-    _In_ ULONG Flags,
-    _Out_ PUNICODE_STRING AddressString
+// The size of a buffer that fits any formatted address, in characters
+#define H2_AFD_ADDRESS_MAX_LENGTH 80
+
+H2_STATUS
+H2AfdFormatAddressToBuffer(
+    _In_ const H2_SOCKADDR_STORAGE* Address,
+    _In_ H2_ULONG Flags,
+    _Out_writes_(BufferLength) H2_CHAR* Buffer,
+    _In_ size_t BufferLength,
+    _Out_ size_t* Length
 );
 
 #endif
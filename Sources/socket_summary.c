@@ -0,0 +1,707 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "socket_summary.h"
+#include "worker_pool.h"
+#include "object_table.h"
+#include "negative_cache.h"
+#include "printsocket.h"
+#include "nativesocket.h"
+#include "string_helpers.h"
+#include "backend.h"
+#include "timeline.h"
+#include "columnar_output.h"
+
+typedef struct _H2_SUMMARY_PROCESS
+{
+    PCUNICODE_STRING ImageName;
+    HANDLE ProcessId;
+    LONG64 CreateTime; // Zero when unknown
+    PULONG Entries;
+    ULONG EntryCount;
+    ULONG FirstChunk;
+    ULONG NumberOfChunks;
+    RTL_RUN_ONCE OpenOnce;
+    NTSTATUS OpenStatus;
+    HANDLE ProcessHandle;
+    volatile LONG RemainingChunks;
+} H2_SUMMARY_PROCESS, *PH2_SUMMARY_PROCESS;
+
+// A socket found by a worker for columnar output
+typedef struct _H2_SUMMARY_ROW
+{
+    HANDLE HandleValue;
+    PH2_AFD_SOCKET_RECORD Record;
+    BOOLEAN OwnsRecord; // Otherwise, the object table entry owns it
+} H2_SUMMARY_ROW, *PH2_SUMMARY_ROW;
+
+typedef struct _H2_SUMMARY_CHUNK
+{
+    ULONG ProcessIndex;
+    ULONG FirstEntry;
+    ULONG EntryCount;
+    ULONG HandlesFound;
+    H2_OUTPUT_BUFFER Output;
+    PH2_SUMMARY_ROW Rows; // Only for columnar output
+    ULONG NumberOfRows;
+    ULONG RowCapacity;
+} H2_SUMMARY_CHUNK, *PH2_SUMMARY_CHUNK;
+
+typedef struct _H2_SUMMARY_CONTEXT
+{
+    PH2_ARGUMENTS Arguments;
+    PSYSTEM_HANDLE_INFORMATION_EX HandleSnapshot;
+    H2_OBJECT_TABLE Objects;
+    H2_NEGATIVE_CACHE NegativeCache; // Unused without a cache file
+    PH2_SUMMARY_PROCESS Processes;
+    ULONG NumberOfProcesses;
+    PH2_SUMMARY_CHUNK Chunks;
+    ULONG NumberOfChunks;
+    H2_COLUMNAR_WRITER Columnar; // Unused without columnar output
+} H2_SUMMARY_CONTEXT, *PH2_SUMMARY_CONTEXT;
+
+/**
+  * \brief Determines whether a handle is a socket and formats its summary.
+  *
+  * \param[in] Arguments The parsed arguments that select the output format.
+  * \param[in] ProcessHandle A handle to the process with PROCESS_DUP_HANDLE access.
+  * \param[in] HandleValue The value of the handle in the process.
+  * \param[in,out] Summary The buffer that receives the summary text (or JSON members) for sockets.
+  * \param[out] Record Receives the full record of the socket for columnar output. The caller must free it.
+  * \param[out] FailureSite The name of the failed operation, if any.
+  *
+  * \return Successful status for sockets, STATUS_NOT_SAME_DEVICE for other files, or errant status.
+  */
+NTSTATUS H2QuerySocketSummary(
+    _In_ PH2_ARGUMENTS Arguments,
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE HandleValue,
+    _Inout_ PH2_OUTPUT_BUFFER Summary,
+    _Outptr_result_maybenull_ PH2_AFD_SOCKET_RECORD* Record,
+    _Out_ PCWSTR* FailureSite
+)
+{
+    NTSTATUS status;
+    HANDLE socketHandle;
+    PH2_OUTPUT_BUFFER previousOutput;
+
+    *Record = NULL;
+    *FailureSite = NULL;
+
+    // Duplicate the handle from the process
+    H2_TIMELINE_BEGIN("Duplicate handle", HandleValue);
+    status = H2Backend->DuplicateHandle(
+        ProcessHandle,
+        HandleValue,
+        &socketHandle
+    );
+    H2_TIMELINE_END("Duplicate handle");
+
+    if (!NT_SUCCESS(status))
+    {
+        *FailureSite = L"duplicate the handle";
+        return status;
+    }
+
+    // Verify the handle belongs to AFD
+    H2_TIMELINE_BEGIN("Check AFD handle", HandleValue);
+    status = H2AfdIsSocketHandle(socketHandle);
+    H2_TIMELINE_END("Check AFD handle");
+
+    if (NT_SUCCESS(status) && Arguments->Format == H2OutputColumnar)
+    {
+        *Record = RtlAllocateHeap(RtlProcessHeap(), 0, sizeof(H2_AFD_SOCKET_RECORD));
+
+        if (*Record)
+        {
+            H2_TIMELINE_BEGIN("Query socket record", socketHandle);
+            H2AfdQuerySocketRecord(socketHandle, Arguments->Exhaustive ? H2_AFD_QUERY_EXHAUSTIVE : 0, *Record);
+            H2_TIMELINE_END("Query socket record");
+        }
+        else
+        {
+            status = STATUS_NO_MEMORY;
+            *FailureSite = L"allocate the record";
+        }
+    }
+    else if (NT_SUCCESS(status))
+    {
+        previousOutput = H2SetThreadOutput(Summary);
+
+        if (Arguments->Format == H2OutputJsonLines)
+            H2AfdQueryPrintJsonSocket(socketHandle, Arguments->Exhaustive ? H2_AFD_QUERY_EXHAUSTIVE : 0);
+        else
+            H2AfdQueryPrintSummarySocket(socketHandle);
+
+        H2SetThreadOutput(previousOutput);
+    }
+    else if (status != STATUS_NOT_SAME_DEVICE)
+    {
+        *FailureSite = L"check the file device";
+    }
+
+    H2Backend->Close(socketHandle);
+    return status;
+}
+
+/**
+  * \brief Prints IDs of other processes that have handles to the same object.
+  *
+  * \param[in] Objects The object table.
+  * \param[in] Entry The entry for the object.
+  * \param[in] ProcessId The ID of the process to exclude.
+  */
+VOID H2PrintSharingProcesses(
+    _In_ PH2_OBJECT_TABLE Objects,
+    _In_ PH2_OBJECT_ENTRY Entry,
+    _In_ HANDLE ProcessId
+)
+{
+    HANDLE previousId = NULL;
+    ULONG printed = 0;
+
+    // Handles are chained in the index order, i.e., grouped by process
+    for (ULONG link = Entry->FirstLink; link != H2_OBJECT_TABLE_NO_POSITION; link = Objects->Links[link].Next)
+    {
+        HANDLE pid = Objects->Index->Snapshot->Handles[Objects->Index->Entries[Objects->Links[link].Position]].UniqueProcessId;
+
+        if (pid == ProcessId || pid == previousId)
+            continue;
+
+        if (printed == H2_SUMMARY_MAX_SHARING_PROCESSES)
+        {
+            H2Print(L", ...");
+            break;
+        }
+
+        H2Print(printed ? L", %zu" : L" (shared with PIDs %zu", (ULONG_PTR)pid);
+        previousId = pid;
+        printed++;
+    }
+
+    if (printed)
+        H2Print(L")");
+}
+
+/**
+  * \brief Inspects one handle of a process and prints a summary line if it's a socket.
+  *
+  * \param[in] Context The summary context.
+  * \param[in] Process The opened process.
+  * \param[in,out] Chunk The work item that collects rows for columnar output.
+  * \param[in] Handle The handle snapshot entry.
+  *
+  * \return Whether the handle is a socket.
+  */
+BOOLEAN H2SummarizeHandle(
+    _In_ PH2_SUMMARY_CONTEXT Context,
+    _In_ PH2_SUMMARY_PROCESS Process,
+    _Inout_ PH2_SUMMARY_CHUNK Chunk,
+    _In_ PSYSTEM_HANDLE_TABLE_ENTRY_INFO_EX Handle
+)
+{
+    NTSTATUS status = STATUS_PENDING;
+    H2_OUTPUT_BUFFER localSummary = { 0 };
+    PH2_OUTPUT_BUFFER summary = &localSummary;
+    PH2_AFD_SOCKET_RECORD localRecord = NULL;
+    PH2_AFD_SOCKET_RECORD record = NULL;
+    PH2_OBJECT_ENTRY entry = H2LookupObjectTable(&Context->Objects, Handle->Object);
+    PCWSTR failureSite = NULL;
+    BOOLEAN found = FALSE;
+    BOOLEAN useNegativeCache = Context->NegativeCache.Current && Process->CreateTime && Handle->Object;
+    PVOID unused;
+
+    // Skip files the previous scan found not to be sockets; the next scan checks them again
+    if (useNegativeCache && H2CheckNegativeCache(&Context->NegativeCache, Handle->Object, Process->CreateTime, Handle->HandleValue))
+        return FALSE;
+
+    if (entry && entry->NumberOfHandles > 1)
+    {
+        // Only the first handle to the object reaches the driver
+        if (RtlRunOnceBeginInitialize(&entry->QueryOnce, 0, &unused) == STATUS_PENDING)
+        {
+            entry->Status = H2QuerySocketSummary(Context->Arguments, Process->ProcessHandle, Handle->HandleValue, &entry->Summary, &entry->Record, &entry->FailureSite);
+            RtlRunOnceComplete(&entry->QueryOnce, 0, NULL);
+            status = entry->Status;
+            failureSite = entry->FailureSite;
+        }
+        else if (NT_SUCCESS(entry->Status) || entry->Status == STATUS_NOT_SAME_DEVICE)
+        {
+            // Reuse the verdict; other failures can be specific to the process, so retry those
+            status = entry->Status;
+        }
+
+        summary = &entry->Summary;
+        record = entry->Record;
+    }
+
+    if (status == STATUS_PENDING)
+    {
+        summary = &localSummary;
+        status = H2QuerySocketSummary(Context->Arguments, Process->ProcessHandle, Handle->HandleValue, summary, &localRecord, &failureSite);
+        record = localRecord;
+    }
+
+    // Keep the record until the main thread adds it to the file in order
+    if (NT_SUCCESS(status) && Context->Arguments->Format == H2OutputColumnar)
+    {
+        if (Chunk->NumberOfRows == Chunk->RowCapacity)
+        {
+            ULONG capacity = max(Chunk->RowCapacity * 2, 16);
+            PH2_SUMMARY_ROW rows;
+
+            if (Chunk->Rows)
+                rows = RtlReAllocateHeap(RtlProcessHeap(), 0, Chunk->Rows, capacity * sizeof(H2_SUMMARY_ROW));
+            else
+                rows = RtlAllocateHeap(RtlProcessHeap(), 0, capacity * sizeof(H2_SUMMARY_ROW));
+
+            if (rows)
+            {
+                Chunk->Rows = rows;
+                Chunk->RowCapacity = capacity;
+            }
+            else
+            {
+                status = STATUS_NO_MEMORY;
+                failureSite = L"allocate the record";
+            }
+        }
+
+        if (NT_SUCCESS(status))
+        {
+            Chunk->Rows[Chunk->NumberOfRows].HandleValue = Handle->HandleValue;
+            Chunk->Rows[Chunk->NumberOfRows].Record = record;
+            Chunk->Rows[Chunk->NumberOfRows].OwnsRecord = record == localRecord;
+            Chunk->NumberOfRows++;
+            found = TRUE;
+
+            // The row owns the record now
+            if (record == localRecord)
+                localRecord = NULL;
+        }
+    }
+
+    if (NT_SUCCESS(status) && Context->Arguments->Format == H2OutputColumnar)
+    {
+        // Columnar rows were collected above
+    }
+    else if (NT_SUCCESS(status) && Context->Arguments->Format == H2OutputJsonLines)
+    {
+        // Print the socket as one JSON line
+        H2AfdPrintJsonHeader(Process->ImageName, Process->ProcessId, Handle->HandleValue);
+
+        if (summary->Buffer)
+            H2PrintText(summary->Buffer, summary->Length);
+
+        H2PrintText(L"}\r\n", 3);
+        found = TRUE;
+    }
+    else if (NT_SUCCESS(status))
+    {
+        // Print the socket overview
+        H2Print(L"[0x%0.4zX] %s", (ULONG_PTR)Handle->HandleValue, summary->Buffer ? summary->Buffer : L"");
+
+        if (Context->Arguments->Verbose && entry && entry->NumberOfHandles > 1)
+            H2PrintSharingProcesses(&Context->Objects, entry, Handle->UniqueProcessId);
+
+        H2Print(L"\r\n");
+        found = TRUE;
+    }
+    else if (status == STATUS_NOT_SAME_DEVICE)
+    {
+        // Only a verdict from the driver query enters the cache
+        if (useNegativeCache)
+            H2AddNegativeCache(&Context->NegativeCache, Handle->Object, Process->CreateTime, Handle->HandleValue);
+    }
+    else if (Context->Arguments->Verbose && Context->Arguments->Format == H2OutputJsonLines)
+    {
+        H2AfdPrintJsonHeader(Process->ImageName, Process->ProcessId, Handle->HandleValue);
+        H2AfdPrintJsonFailure(failureSite, status);
+        H2PrintText(L"}\r\n", 3);
+    }
+    else if (Context->Arguments->Verbose && Context->Arguments->Format == H2OutputColumnar)
+    {
+        // The file only has sockets, so report failures as text
+        H2Print(L"%wZ [%zu] [0x%0.4zX] <Unable to %s>: ", Process->ImageName, (ULONG_PTR)Process->ProcessId, (ULONG_PTR)Handle->HandleValue, failureSite);
+        H2PrintStatusWithDescription(status);
+        H2Print(L"\r\n");
+    }
+    else if (Context->Arguments->Verbose)
+    {
+        H2Print(L"[0x%0.4zX] <Unable to %s>: ", (ULONG_PTR)Handle->HandleValue, failureSite);
+        H2PrintStatusWithDescription(status);
+        H2Print(L"\r\n");
+    }
+
+    H2FreeOutputBuffer(&localSummary);
+
+    if (localRecord)
+        RtlFreeHeap(RtlProcessHeap(), 0, localRecord);
+
+    return found;
+}
+
+/**
+  * \brief Inspects a range of handles of one process. Called by the work pool.
+  */
+VOID NTAPI H2SummarizeChunk(
+    _In_ PVOID Context,
+    _In_ ULONG ItemIndex
+)
+{
+    PH2_SUMMARY_CONTEXT context = Context;
+    PH2_SUMMARY_CHUNK chunk = &context->Chunks[ItemIndex];
+    PH2_SUMMARY_PROCESS process = &context->Processes[chunk->ProcessIndex];
+    PVOID unused;
+
+    // The first chunk of the process to run opens it for the rest
+    if (RtlRunOnceBeginInitialize(&process->OpenOnce, 0, &unused) == STATUS_PENDING)
+    {
+        H2_TIMELINE_BEGIN("Open process", process->ProcessId);
+        process->OpenStatus = H2Backend->OpenProcess(&process->ProcessHandle, process->ProcessId, PROCESS_DUP_HANDLE);
+        H2_TIMELINE_END("Open process");
+        RtlRunOnceComplete(&process->OpenOnce, 0, NULL);
+    }
+
+    if (NT_SUCCESS(process->OpenStatus))
+    {
+        // Collect the output to print it in order later
+        H2_TIMELINE_BEGIN("Inspect handles", process->ProcessId);
+        H2SetThreadOutput(&chunk->Output);
+
+        for (ULONG i = chunk->FirstEntry; i < chunk->FirstEntry + chunk->EntryCount; i++)
+        {
+            if (H2SummarizeHandle(context, process, chunk, &context->HandleSnapshot->Handles[process->Entries[i]]))
+                chunk->HandlesFound++;
+        }
+
+        H2SetThreadOutput(NULL);
+        H2_TIMELINE_END("Inspect handles");
+    }
+
+    // The last chunk to finish closes the process
+    if (InterlockedDecrement(&process->RemainingChunks) == 0 && process->ProcessHandle)
+    {
+        H2Backend->Close(process->ProcessHandle);
+        process->ProcessHandle = NULL;
+    }
+}
+
+/**
+  * \brief Prints the results of one process once all of its chunks complete.
+  *
+  * \return Whether the process was displayed.
+  */
+BOOLEAN H2PrintSummaryProcess(
+    _In_ PH2_SUMMARY_CONTEXT Context,
+    _In_ PH2_WORK_POOL Pool,
+    _In_ ULONG ProcessIndex
+)
+{
+    PH2_SUMMARY_PROCESS process = &Context->Processes[ProcessIndex];
+    PH2_ARGUMENTS arguments = Context->Arguments;
+    ULONG handlesFound = 0;
+    BOOLEAN displayed = FALSE;
+
+    for (ULONG i = process->FirstChunk; i < process->FirstChunk + process->NumberOfChunks; i++)
+        H2WaitForWorkItem(Pool, i);
+
+    if (NT_SUCCESS(process->OpenStatus) || arguments->Verbose || arguments->ProcessId)
+    {
+        if (arguments->Format == H2OutputText)
+            H2Print(L"%wZ [%zu]\r\n", process->ImageName, (ULONG_PTR)process->ProcessId);
+
+        displayed = TRUE;
+    }
+
+    if (!NT_SUCCESS(process->OpenStatus) && arguments->Format == H2OutputJsonLines)
+    {
+        if (arguments->Verbose || arguments->ProcessId)
+        {
+            H2AfdPrintJsonHeader(process->ImageName, process->ProcessId, NULL);
+            H2AfdPrintJsonFailure(L"open the process", process->OpenStatus);
+            H2PrintText(L"}\r\n", 3);
+        }
+
+        return displayed;
+    }
+
+    if (!NT_SUCCESS(process->OpenStatus) && arguments->Format == H2OutputColumnar)
+    {
+        if (arguments->Verbose || arguments->ProcessId)
+        {
+            H2Print(L"%wZ [%zu] <Unable to open the process>: ", process->ImageName, (ULONG_PTR)process->ProcessId);
+            H2PrintStatusWithDescription(process->OpenStatus);
+            H2Print(L"\r\n");
+        }
+
+        return displayed;
+    }
+
+    if (!NT_SUCCESS(process->OpenStatus))
+    {
+        if (arguments->Verbose || arguments->ProcessId)
+        {
+            H2Print(L"Unable to open the process: ");
+            H2PrintStatusWithDescription(process->OpenStatus);
+            H2Print(L"\r\n\r\n");
+        }
+
+        return displayed;
+    }
+
+    H2_TIMELINE_BEGIN("Print process", process->ProcessId);
+
+    for (ULONG i = process->FirstChunk; i < process->FirstChunk + process->NumberOfChunks; i++)
+    {
+        H2FlushOutputBuffer(&Context->Chunks[i].Output);
+        H2FreeOutputBuffer(&Context->Chunks[i].Output);
+        handlesFound += Context->Chunks[i].HandlesFound;
+
+        // Add the rows in the same order as text output
+        for (ULONG j = 0; j < Context->Chunks[i].NumberOfRows; j++)
+        {
+            PH2_SUMMARY_ROW row = &Context->Chunks[i].Rows[j];
+
+            H2ColumnarAppend(&Context->Columnar, process->ImageName, process->ProcessId, row->HandleValue, row->Record);
+
+            if (row->OwnsRecord)
+                RtlFreeHeap(RtlProcessHeap(), 0, row->Record);
+        }
+
+        if (Context->Chunks[i].Rows)
+            RtlFreeHeap(RtlProcessHeap(), 0, Context->Chunks[i].Rows);
+
+        Context->Chunks[i].Rows = NULL;
+        Context->Chunks[i].NumberOfRows = 0;
+    }
+
+    // JSON lines and columnar files carry the process on each socket
+    if (arguments->Format == H2OutputText)
+    {
+        if (handlesFound == 0)
+            H2Print(L"No sockets to display.\r\n");
+
+        H2Print(L"\r\n");
+    }
+
+    H2_TIMELINE_END("Print process");
+    return displayed;
+}
+
+/**
+  * \brief Prints a summary of sockets of all processes that match the arguments.
+  *
+  * \param[in] Arguments The parsed arguments with the process filter and the number of worker threads.
+  * \param[in] ProcessSnapshot A process snapshot, unless the arguments specify a PID.
+  * \param[in] HandleSnapshot A handle snapshot.
+  * \param[in] HandleIndex An index of file handles in the snapshot.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2PrintSocketSummary(
+    _In_ PH2_ARGUMENTS Arguments,
+    _In_opt_ PSYSTEM_PROCESS_INFORMATION ProcessSnapshot,
+    _In_ PSYSTEM_HANDLE_INFORMATION_EX HandleSnapshot,
+    _In_ PH2_HANDLE_INDEX HandleIndex
+)
+{
+    NTSTATUS status;
+    H2_SUMMARY_CONTEXT context = { 0 };
+    H2_WORK_POOL pool;
+    PSYSTEM_PROCESS_INFORMATION process;
+    ULONG processesFound = 0;
+    ULONG chunkIndex = 0;
+    PHANDLE processIds;
+
+    context.Arguments = Arguments;
+    context.HandleSnapshot = HandleSnapshot;
+
+    // Collect rows in memory to write them column by column
+    if (Arguments->Format == H2OutputColumnar)
+    {
+        status = H2ColumnarInitialize(&context.Columnar);
+
+        if (!NT_SUCCESS(status))
+            return status;
+    }
+
+    // Count matching processes and their work items, then fill them in
+    for (ULONG pass = 0; pass < 2; pass++)
+    {
+        process = ProcessSnapshot;
+
+        do
+        {
+            // Either inspect one given PID or all processes with the image names matching the filter
+            if (Arguments->ProcessId ||
+                RtlIsNameInExpression(&Arguments->ProcessFilter, &process->ImageName, TRUE, NULL))
+            {
+                HANDLE pid = Arguments->ProcessId ? Arguments->ProcessId : process->UniqueProcessId;
+                PULONG entries;
+                ULONG entryCount = H2LookupHandleIndex(HandleIndex, pid, &entries);
+                ULONG numberOfChunks = max((entryCount + H2_SUMMARY_CHUNK_SIZE - 1) / H2_SUMMARY_CHUNK_SIZE, 1);
+
+                if (pass == 1)
+                {
+                    PH2_SUMMARY_PROCESS entry = &context.Processes[context.NumberOfProcesses];
+
+                    entry->ImageName = Arguments->ProcessId ? &Arguments->ProcessFilter : &process->ImageName;
+                    entry->ProcessId = pid;
+                    entry->CreateTime = Arguments->ProcessId ? 0 : process->CreateTime.QuadPart;
+                    entry->Entries = entries;
+                    entry->EntryCount = entryCount;
+                    entry->FirstChunk = chunkIndex;
+                    entry->NumberOfChunks = numberOfChunks;
+                    entry->RemainingChunks = numberOfChunks;
+                    RtlRunOnceInitialize(&entry->OpenOnce);
+
+                    for (ULONG i = 0; i < numberOfChunks; i++)
+                    {
+                        context.Chunks[chunkIndex + i].ProcessIndex = context.NumberOfProcesses;
+                        context.Chunks[chunkIndex + i].FirstEntry = i * H2_SUMMARY_CHUNK_SIZE;
+                        context.Chunks[chunkIndex + i].EntryCount = min(entryCount - i * H2_SUMMARY_CHUNK_SIZE, H2_SUMMARY_CHUNK_SIZE);
+                    }
+                }
+
+                context.NumberOfProcesses++;
+                chunkIndex += numberOfChunks;
+            }
+        } while (!Arguments->ProcessId && (process = H2NextProcess(process)));
+
+        if (pass == 1)
+            break;
+
+        context.Processes = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, max(context.NumberOfProcesses, 1) * sizeof(H2_SUMMARY_PROCESS));
+        context.Chunks = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, max(chunkIndex, 1) * sizeof(H2_SUMMARY_CHUNK));
+        context.NumberOfChunks = chunkIndex;
+
+        if (!context.Processes || !context.Chunks)
+        {
+            status = STATUS_NO_MEMORY;
+            goto CLEANUP;
+        }
+
+        context.NumberOfProcesses = 0;
+        chunkIndex = 0;
+    }
+
+    // Group handles by object so each socket is inspected once
+    processIds = RtlAllocateHeap(RtlProcessHeap(), 0, max(context.NumberOfProcesses, 1) * sizeof(HANDLE));
+
+    if (!processIds)
+    {
+        status = STATUS_NO_MEMORY;
+        goto CLEANUP;
+    }
+
+    for (ULONG i = 0; i < context.NumberOfProcesses; i++)
+        processIds[i] = context.Processes[i].ProcessId;
+
+    status = H2BuildObjectTable(HandleIndex, processIds, context.NumberOfProcesses, &context.Objects);
+    RtlFreeHeap(RtlProcessHeap(), 0, processIds);
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    // Load verdicts from the previous scan
+    if (Arguments->CacheFileName)
+    {
+        status = H2LoadNegativeCache(Arguments->CacheFileName, HandleIndex->BucketStarts[HandleIndex->NumberOfBuckets], &context.NegativeCache);
+
+        if (!NT_SUCCESS(status))
+            goto CLEANUP;
+    }
+
+    // Without extra threads, chunks run on demand from the wait below
+    status = H2StartWorkPool(
+        &pool,
+        Arguments->NumberOfThreads > 1 ? Arguments->NumberOfThreads : 0,
+        context.NumberOfChunks,
+        H2SummarizeChunk,
+        &context
+    );
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    // Print processes in the snapshot order as their chunks complete
+    for (ULONG i = 0; i < context.NumberOfProcesses; i++)
+    {
+        if (H2PrintSummaryProcess(&context, &pool, i))
+            processesFound++;
+    }
+
+    H2StopWorkPool(&pool);
+
+    // Remember verdicts for the next scan
+    if (Arguments->CacheFileName)
+    {
+        NTSTATUS cacheStatus = H2SaveNegativeCache(&context.NegativeCache);
+
+        if (!NT_SUCCESS(cacheStatus))
+        {
+            H2Print(L"Unable to save the cache file: ");
+            H2PrintStatusWithDescription(cacheStatus);
+            H2Print(L"\r\n\r\n");
+        }
+    }
+
+    if (!Arguments->ProcessId && processesFound == 0 && Arguments->Format == H2OutputText)
+        H2Print(L"No matching processes found.\r\n");
+
+    // Make the handles that were not inspected visible
+    if (Arguments->CacheFileName && Arguments->Format != H2OutputJsonLines)
+        H2Print(L"Skipped %ld file handles known from the cache file not to be sockets.\r\n", context.NegativeCache.NumberOfHits);
+
+    // Write the collected rows
+    if (Arguments->Format == H2OutputColumnar)
+    {
+        NTSTATUS columnarStatus = H2ColumnarSave(&context.Columnar, Arguments->OutputFileName);
+
+        if (!NT_SUCCESS(columnarStatus))
+        {
+            H2Print(L"Unable to save the columnar file: ");
+            H2PrintStatusWithDescription(columnarStatus);
+            H2Print(L"\r\n");
+        }
+    }
+
+CLEANUP:
+    if (context.Chunks)
+    {
+        for (ULONG i = 0; i < context.NumberOfChunks; i++)
+        {
+            H2FreeOutputBuffer(&context.Chunks[i].Output);
+
+            for (ULONG j = 0; j < context.Chunks[i].NumberOfRows; j++)
+            {
+                if (context.Chunks[i].Rows[j].OwnsRecord)
+                    RtlFreeHeap(RtlProcessHeap(), 0, context.Chunks[i].Rows[j].Record);
+            }
+
+            if (context.Chunks[i].Rows)
+                RtlFreeHeap(RtlProcessHeap(), 0, context.Chunks[i].Rows);
+        }
+
+        RtlFreeHeap(RtlProcessHeap(), 0, context.Chunks);
+    }
+
+    if (context.Processes)
+        RtlFreeHeap(RtlProcessHeap(), 0, context.Processes);
+
+    H2FreeObjectTable(&context.Objects);
+    H2FreeNegativeCache(&context.NegativeCache);
+
+    if (Arguments->Format == H2OutputColumnar)
+        H2ColumnarFree(&context.Columnar);
+
+    return status;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SOCKET_SUMMARY_H
+#define _SOCKET_SUMMARY_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "argument_parsing.h"
+#include "snapshot_helpers.h"
+
+// Processes with more file handles than this are split into several work items
+#define H2_SUMMARY_CHUNK_SIZE 256
+
+// The maximum number of other processes to list for shared sockets in verbose mode
+#define H2_SUMMARY_MAX_SHARING_PROCESSES 8
+
+NTSTATUS
+NTAPI
+H2PrintSocketSummary(
+    _In_ PH2_ARGUMENTS Arguments,
+    _In_opt_ PSYSTEM_PROCESS_INFORMATION ProcessSnapshot,
+    _In_ PSYSTEM_HANDLE_INFORMATION_EX HandleSnapshot,
+    _In_ PH2_HANDLE_INDEX HandleIndex
+);
+
+#endif
@@ -0,0 +1,1127 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "socket_watch.h"
+#include "snapshot_helpers.h"
+#include "worker_pool.h"
+#include "printsocket.h"
+#include "nativesocket.h"
+#include "string_helpers.h"
+#include "backend.h"
+#include "timeline.h"
+#include "record_cache.h"
+#include "tcp_rates.h"
+
+typedef enum _H2_WATCH_STATE
+{
+    H2WatchUnknown, // Not inspected yet
+    H2WatchNotSocket,
+    H2WatchInaccessible, // Not retried while the handle stays the same
+    H2WatchSocket,
+} H2_WATCH_STATE;
+
+typedef enum _H2_WATCH_EVENT
+{
+    H2WatchNoEvent,
+    H2WatchOpened,
+    H2WatchChanged,
+} H2_WATCH_EVENT;
+
+typedef struct _H2_WATCH_PROCESS
+{
+    HANDLE ProcessId;
+    LONG64 CreateTime;
+    PCUNICODE_STRING ImageName; // Points into the process snapshot of the scan
+    NTSTATUS OpenStatus;
+    HANDLE ProcessHandle; // Kept between scans while the process exists
+} H2_WATCH_PROCESS, *PH2_WATCH_PROCESS;
+
+typedef struct _H2_WATCH_ENTRY
+{
+    HANDLE ProcessId;
+    LONG64 CreateTime;
+    HANDLE HandleValue;
+    PVOID Object;
+    ULONG ProcessIndex;
+    H2_WATCH_STATE State;
+    H2_WATCH_EVENT Event;
+    PH2_AFD_SUMMARY_RECORD Summary; // Only for sockets
+    H2_OUTPUT_BUFFER Details; // The last printed details, when watching a handle
+    H2_OUTPUT_BUFFER Changes; // Lines of the details that changed in the current scan
+} H2_WATCH_ENTRY, *PH2_WATCH_ENTRY;
+
+// The file handles of matching processes at one point in time
+typedef struct _H2_WATCH_SCAN
+{
+    PSYSTEM_PROCESS_INFORMATION ProcessSnapshot;
+    PH2_WATCH_PROCESS Processes; // Sorted by ID and create time
+    ULONG NumberOfProcesses;
+    PH2_WATCH_ENTRY Entries; // Sorted by process ID, create time, handle value, and object
+    ULONG NumberOfEntries;
+    H2_TCP_SAMPLES Samples; // TCP_INFO counters by entry, when computing rates
+} H2_WATCH_SCAN, *PH2_WATCH_SCAN;
+
+// Signaled on Ctrl+C to finish the current scan and exit
+HANDLE H2WatchStopEvent;
+
+/**
+  * \brief Orders processes by ID and create time.
+  *
+  * \return A negative, zero, or positive value if the first process goes before, matches, or goes after the second.
+  */
+LONG H2WatchCompareProcesses(
+    _In_ PH2_WATCH_PROCESS First,
+    _In_ PH2_WATCH_PROCESS Second
+)
+{
+    if (First->ProcessId != Second->ProcessId)
+        return (ULONG_PTR)First->ProcessId < (ULONG_PTR)Second->ProcessId ? -1 : 1;
+
+    if (First->CreateTime != Second->CreateTime)
+        return First->CreateTime < Second->CreateTime ? -1 : 1;
+
+    return 0;
+}
+
+/**
+  * \brief Orders handles by process ID, create time, handle value, and object.
+  *
+  * \return A negative, zero, or positive value if the first entry goes before, matches, or goes after the second.
+  */
+LONG H2WatchCompareEntries(
+    _In_ PH2_WATCH_ENTRY First,
+    _In_ PH2_WATCH_ENTRY Second
+)
+{
+    if (First->ProcessId != Second->ProcessId)
+        return (ULONG_PTR)First->ProcessId < (ULONG_PTR)Second->ProcessId ? -1 : 1;
+
+    if (First->CreateTime != Second->CreateTime)
+        return First->CreateTime < Second->CreateTime ? -1 : 1;
+
+    if (First->HandleValue != Second->HandleValue)
+        return (ULONG_PTR)First->HandleValue < (ULONG_PTR)Second->HandleValue ? -1 : 1;
+
+    if (First->Object != Second->Object)
+        return (ULONG_PTR)First->Object < (ULONG_PTR)Second->Object ? -1 : 1;
+
+    return 0;
+}
+
+/**
+  * \brief Determines whether two summaries would print the same.
+  */
+BOOLEAN H2WatchSummariesEqual(
+    _In_ PH2_AFD_SUMMARY_RECORD First,
+    _In_ PH2_AFD_SUMMARY_RECORD Second
+)
+{
+    if (First->SharedInfoStatus != Second->SharedInfoStatus ||
+        First->LocalAddressStatus != Second->LocalAddressStatus ||
+        First->RemoteAddressStatus != Second->RemoteAddressStatus)
+        return FALSE;
+
+    if (NT_SUCCESS(First->SharedInfoStatus) &&
+        (First->SharedInfo.State != Second->SharedInfo.State ||
+         First->SharedInfo.AddressFamily != Second->SharedInfo.AddressFamily ||
+         First->SharedInfo.Protocol != Second->SharedInfo.Protocol))
+        return FALSE;
+
+    if (NT_SUCCESS(First->LocalAddressStatus) &&
+        memcmp(&First->LocalAddress, &Second->LocalAddress, sizeof(SOCKADDR_STORAGE)) != 0)
+        return FALSE;
+
+    if (NT_SUCCESS(First->RemoteAddressStatus) &&
+        memcmp(&First->RemoteAddress, &Second->RemoteAddress, sizeof(SOCKADDR_STORAGE)) != 0)
+        return FALSE;
+
+    return TRUE;
+}
+
+/**
+  * \brief Releases a scan, closing the handles it still owns.
+  *
+  * \param[in,out] Scan The scan.
+  */
+VOID H2WatchFreeScan(
+    _Inout_ PH2_WATCH_SCAN Scan
+)
+{
+    for (ULONG i = 0; i < Scan->NumberOfEntries; i++)
+    {
+        if (Scan->Entries[i].Summary)
+            RtlFreeHeap(RtlProcessHeap(), 0, Scan->Entries[i].Summary);
+
+        H2FreeOutputBuffer(&Scan->Entries[i].Details);
+        H2FreeOutputBuffer(&Scan->Entries[i].Changes);
+    }
+
+    for (ULONG i = 0; i < Scan->NumberOfProcesses; i++)
+    {
+        if (Scan->Processes[i].ProcessHandle)
+            H2Backend->Close(Scan->Processes[i].ProcessHandle);
+    }
+
+    if (Scan->Entries)
+        RtlFreeHeap(RtlProcessHeap(), 0, Scan->Entries);
+
+    if (Scan->Processes)
+        RtlFreeHeap(RtlProcessHeap(), 0, Scan->Processes);
+
+    if (Scan->ProcessSnapshot)
+        H2Free(Scan->ProcessSnapshot);
+
+    H2FreeTcpSamples(&Scan->Samples);
+    memset(Scan, 0, sizeof(H2_WATCH_SCAN));
+}
+
+/**
+  * \brief Collects file handles of matching processes in the sorted order.
+  *
+  * \param[in] Arguments The parsed arguments with the process filter and the optional handle value.
+  * \param[in] TypeIndex The type index of file handles.
+  * \param[out] Scan The scan. The caller must release it via H2WatchFreeScan.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2WatchCollect(
+    _In_ PH2_ARGUMENTS Arguments,
+    _In_ ULONG TypeIndex,
+    _Out_ PH2_WATCH_SCAN Scan
+)
+{
+    NTSTATUS status;
+    PSYSTEM_HANDLE_INFORMATION_EX handleSnapshot = NULL;
+    H2_HANDLE_INDEX handleIndex = { 0 };
+    PSYSTEM_PROCESS_INFORMATION* processes = NULL;
+    PSYSTEM_PROCESS_INFORMATION process;
+    ULONG numberOfProcesses = 0;
+
+    memset(Scan, 0, sizeof(H2_WATCH_SCAN));
+
+    H2_TIMELINE_BEGIN("Snapshot processes", 0);
+    status = H2Backend->SnapshotProcesses(&Scan->ProcessSnapshot);
+    H2_TIMELINE_END("Snapshot processes");
+
+    if (!NT_SUCCESS(status))
+    {
+        Scan->ProcessSnapshot = NULL;
+        return status;
+    }
+
+    H2_TIMELINE_BEGIN("Snapshot handles", 0);
+    status = H2Backend->SnapshotHandles(&handleSnapshot);
+    H2_TIMELINE_END("Snapshot handles");
+
+    if (!NT_SUCCESS(status))
+    {
+        handleSnapshot = NULL;
+        goto CLEANUP;
+    }
+
+    // Bucketing by PID also sorts by it
+    H2_TIMELINE_BEGIN("Index handles", 0);
+    status = H2BuildHandleIndex(handleSnapshot, TypeIndex, &handleIndex);
+    H2_TIMELINE_END("Index handles");
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    H2_TIMELINE_BEGIN("Sort handles", 0);
+
+    // Look up processes by the bucket of their PID
+    processes = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, max(handleIndex.NumberOfBuckets, 1) * sizeof(PSYSTEM_PROCESS_INFORMATION));
+    process = Scan->ProcessSnapshot;
+
+    if (!processes)
+    {
+        status = STATUS_NO_MEMORY;
+        goto CLEANUP;
+    }
+
+    do
+    {
+        ULONG_PTR bucket = H2_HANDLE_INDEX_BUCKET(process->UniqueProcessId);
+
+        if (bucket < handleIndex.NumberOfBuckets &&
+            (Arguments->ProcessId ? process->UniqueProcessId == Arguments->ProcessId :
+             RtlIsNameInExpression(&Arguments->ProcessFilter, &process->ImageName, TRUE, NULL)))
+        {
+            processes[bucket] = process;
+            numberOfProcesses++;
+        }
+    } while (process = H2NextProcess(process));
+
+    Scan->Processes = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, max(numberOfProcesses, 1) * sizeof(H2_WATCH_PROCESS));
+    Scan->Entries = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, max(handleIndex.BucketStarts[handleIndex.NumberOfBuckets], 1) * sizeof(H2_WATCH_ENTRY));
+
+    if (!Scan->Processes || !Scan->Entries)
+    {
+        status = STATUS_NO_MEMORY;
+        goto CLEANUP;
+    }
+
+    for (ULONG bucket = 0; bucket < handleIndex.NumberOfBuckets; bucket++)
+    {
+        PH2_WATCH_PROCESS watchProcess;
+        PULONG entries;
+        ULONG count;
+
+        if (!(process = processes[bucket]))
+            continue;
+
+        count = H2LookupHandleIndex(&handleIndex, process->UniqueProcessId, &entries);
+
+        if (count == 0)
+            continue;
+
+        // Handles of a process usually come in order already, which makes insertion sort linear
+        for (ULONG i = 1; i < count; i++)
+        {
+            ULONG entry = entries[i];
+            ULONG position = i;
+
+            while (position > 0 &&
+                (ULONG_PTR)handleSnapshot->Handles[entries[position - 1]].HandleValue >
+                (ULONG_PTR)handleSnapshot->Handles[entry].HandleValue)
+            {
+                entries[position] = entries[position - 1];
+                position--;
+            }
+
+            entries[position] = entry;
+        }
+
+        watchProcess = &Scan->Processes[Scan->NumberOfProcesses];
+        watchProcess->ProcessId = process->UniqueProcessId;
+        watchProcess->CreateTime = process->CreateTime.QuadPart;
+        watchProcess->ImageName = &process->ImageName;
+        watchProcess->OpenStatus = STATUS_PENDING;
+
+        for (ULONG i = 0; i < count; i++)
+        {
+            PH2_WATCH_ENTRY watchEntry;
+
+            if (Arguments->HandleValue && handleSnapshot->Handles[entries[i]].HandleValue != Arguments->HandleValue)
+                continue;
+
+            watchEntry = &Scan->Entries[Scan->NumberOfEntries++];
+            watchEntry->ProcessId = watchProcess->ProcessId;
+            watchEntry->CreateTime = watchProcess->CreateTime;
+            watchEntry->HandleValue = handleSnapshot->Handles[entries[i]].HandleValue;
+            watchEntry->Object = handleSnapshot->Handles[entries[i]].Object;
+            watchEntry->ProcessIndex = Scan->NumberOfProcesses;
+        }
+
+        Scan->NumberOfProcesses++;
+    }
+
+    H2_TIMELINE_END("Sort handles");
+
+CLEANUP:
+    if (processes)
+        RtlFreeHeap(RtlProcessHeap(), 0, processes);
+
+    H2FreeHandleIndex(&handleIndex);
+
+    if (handleSnapshot)
+        H2Free(handleSnapshot);
+
+    if (!NT_SUCCESS(status))
+        H2WatchFreeScan(Scan);
+
+    return status;
+}
+
+/**
+  * \brief Prints an event for a socket.
+  *
+  * \param[in] Symbol "+" for opened, "-" for closed, or "~" for changed sockets.
+  * \param[in] Process The process of the socket.
+  * \param[in] Entry The socket.
+  * \param[in] Time The local time of the scan.
+  */
+VOID H2WatchPrintEvent(
+    _In_ PCWSTR Symbol,
+    _In_ PH2_WATCH_PROCESS Process,
+    _In_ PH2_WATCH_ENTRY Entry,
+    _In_ PTIME_FIELDS Time
+)
+{
+    H2Print(
+        L"[%02hd:%02hd:%02hd] %s %wZ [%zu] [0x%0.4zX] ",
+        Time->Hour,
+        Time->Minute,
+        Time->Second,
+        Symbol,
+        Process->ImageName,
+        (ULONG_PTR)Process->ProcessId,
+        (ULONG_PTR)Entry->HandleValue
+    );
+
+    H2AfdPrintSummaryRecord(Entry->Summary);
+    H2Print(L"\r\n");
+}
+
+/**
+  * \brief Carries state over from the previous scan and reports closed sockets.
+  *
+  * \param[in,out] Previous The previous scan. Process handles and summaries of sockets that still exist move to the current scan.
+  * \param[in,out] Current The current scan.
+  * \param[in] Time The local time of the scan.
+  * \param[out] PreviousIndexes An optional array that receives the index of each current entry in the previous scan or H2_TCP_NO_SAMPLE.
+  *
+  * \return The number of closed sockets.
+  */
+ULONG H2WatchMerge(
+    _Inout_ PH2_WATCH_SCAN Previous,
+    _Inout_ PH2_WATCH_SCAN Current,
+    _In_ PTIME_FIELDS Time,
+    _Out_writes_opt_(Current->NumberOfEntries) PULONG PreviousIndexes
+)
+{
+    ULONG closed = 0;
+    ULONG i = 0;
+    ULONG j = 0;
+    LONG order;
+
+    // Keep process handles of processes that still exist
+    while (i < Previous->NumberOfProcesses && j < Current->NumberOfProcesses)
+    {
+        order = H2WatchCompareProcesses(&Previous->Processes[i], &Current->Processes[j]);
+
+        if (order == 0)
+        {
+            Current->Processes[j].OpenStatus = Previous->Processes[i].OpenStatus;
+            Current->Processes[j].ProcessHandle = Previous->Processes[i].ProcessHandle;
+            Previous->Processes[i].ProcessHandle = NULL;
+        }
+
+        i += order <= 0;
+        j += order >= 0;
+    }
+
+    // Keep the verdicts, summaries, and details of handles that still exist
+    for (i = 0, j = 0; i < Previous->NumberOfEntries || j < Current->NumberOfEntries;)
+    {
+        if (i >= Previous->NumberOfEntries)
+            order = 1;
+        else if (j >= Current->NumberOfEntries)
+            order = -1;
+        else
+            order = H2WatchCompareEntries(&Previous->Entries[i], &Current->Entries[j]);
+
+        if (order == 0)
+        {
+            PH2_WATCH_ENTRY previousEntry = &Previous->Entries[i];
+            PH2_WATCH_ENTRY currentEntry = &Current->Entries[j];
+
+            currentEntry->State = previousEntry->State;
+            currentEntry->Summary = previousEntry->Summary;
+            currentEntry->Details = previousEntry->Details;
+            previousEntry->Summary = NULL;
+            memset(&previousEntry->Details, 0, sizeof(H2_OUTPUT_BUFFER));
+        }
+        else if (order < 0 && Previous->Entries[i].State == H2WatchSocket)
+        {
+            H2WatchPrintEvent(L"-", &Previous->Processes[Previous->Entries[i].ProcessIndex], &Previous->Entries[i], Time);
+            closed++;
+        }
+
+        if (PreviousIndexes && order >= 0)
+            PreviousIndexes[j] = order == 0 ? i : H2_TCP_NO_SAMPLE;
+
+        i += order <= 0;
+        j += order >= 0;
+    }
+
+    return closed;
+}
+
+/**
+  * \brief Finds the end of a line of printed text.
+  *
+  * \param[in] Text The printed text.
+  * \param[in] Length The number of characters in the text.
+  * \param[in] Start The offset of the line.
+  *
+  * \return The offset after the line and its line break.
+  */
+SIZE_T H2WatchNextLine(
+    _In_reads_(Length) PCWCH Text,
+    _In_ SIZE_T Length,
+    _In_ SIZE_T Start
+)
+{
+    while (Start < Length && Text[Start++] != L'\n');
+
+    return Start;
+}
+
+/**
+  * \brief Counts lines of printed text.
+  */
+ULONG H2WatchCountLines(
+    _In_ PH2_OUTPUT_BUFFER Output
+)
+{
+    ULONG count = 0;
+
+    for (SIZE_T offset = 0; offset < Output->Length; count++)
+        offset = H2WatchNextLine(Output->Buffer, Output->Length, offset);
+
+    return count;
+}
+
+/**
+  * \brief Prints lines of the current details that differ from the previous ones.
+  *  Details print properties in a fixed order, so lines at the same position describe the same
+  *  property unless a failure changed the layout, in which case all lines count as changed.
+  *
+  * \param[in] Previous The previously printed details.
+  * \param[in] Current The current details.
+  * \param[in,out] Changes The buffer that receives the changed lines.
+  */
+VOID H2WatchDiffDetails(
+    _In_ PH2_OUTPUT_BUFFER Previous,
+    _In_ PH2_OUTPUT_BUFFER Current,
+    _Inout_ PH2_OUTPUT_BUFFER Changes
+)
+{
+    PH2_OUTPUT_BUFFER previousOutput;
+    BOOLEAN sameLayout;
+    SIZE_T previousStart = 0;
+    SIZE_T previousEnd;
+    SIZE_T currentStart = 0;
+    SIZE_T currentEnd;
+
+    sameLayout = H2WatchCountLines(Previous) == H2WatchCountLines(Current);
+    previousOutput = H2SetThreadOutput(Changes);
+
+    while (currentStart < Current->Length)
+    {
+        previousEnd = H2WatchNextLine(Previous->Buffer, Previous->Length, previousStart);
+        currentEnd = H2WatchNextLine(Current->Buffer, Current->Length, currentStart);
+
+        if (!sameLayout || previousEnd - previousStart != currentEnd - currentStart ||
+            memcmp(&Previous->Buffer[previousStart], &Current->Buffer[currentStart], (currentEnd - currentStart) * sizeof(WCHAR)) != 0)
+            H2PrintText(&Current->Buffer[currentStart], currentEnd - currentStart);
+
+        previousStart = previousEnd;
+        currentStart = currentEnd;
+    }
+
+    H2SetThreadOutput(previousOutput);
+}
+
+/**
+  * \brief Samples TCP_INFO counters of a connected TCP socket for computing rates.
+  *
+  * \param[in,out] Scan The current scan.
+  * \param[in] Entry The socket with an up-to-date summary.
+  * \param[in] SocketHandle A duplicate of the socket handle.
+  */
+VOID H2WatchSampleTcpInfo(
+    _Inout_ PH2_WATCH_SCAN Scan,
+    _In_ PH2_WATCH_ENTRY Entry,
+    _In_ HANDLE SocketHandle
+)
+{
+    TCP_INFO_v2 tcpInfo;
+    ULONG version;
+
+    // Other sockets have no counters, so don't spend a query on them
+    if (!Scan->Samples.Flags || !Entry->Summary || !NT_SUCCESS(Entry->Summary->SharedInfoStatus) ||
+        Entry->Summary->SharedInfo.Protocol != IPPROTO_TCP ||
+        Entry->Summary->SharedInfo.State != SocketStateConnected)
+        return;
+
+    // Workers inspect different entries, so they write different elements of the columns
+    if (NT_SUCCESS(H2AfdQueryTcpInfoBest(SocketHandle, &tcpInfo, &version)))
+        H2SetTcpSample(&Scan->Samples, (ULONG)(Entry - Scan->Entries), H2QueryTcpSampleTime(), &tcpInfo, version);
+}
+
+/**
+  * \brief Samples all properties of a socket via the record cache and notes what changed.
+  *
+  * \param[in,out] Scan The current scan.
+  * \param[in,out] Entry The socket.
+  * \param[in] SocketHandle A duplicate of the socket handle.
+  * \param[in] Arguments The parsed arguments with the query and print modes.
+  * \param[in,out] RecordCache The cache of socket records between scans.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2WatchSampleDetails(
+    _Inout_ PH2_WATCH_SCAN Scan,
+    _Inout_ PH2_WATCH_ENTRY Entry,
+    _In_ HANDLE SocketHandle,
+    _In_ PH2_ARGUMENTS Arguments,
+    _Inout_ PH2_RECORD_CACHE RecordCache
+)
+{
+    NTSTATUS status;
+    ULONG queryFlags = Arguments->Exhaustive ? H2_AFD_QUERY_EXHAUSTIVE : 0;
+    PH2_AFD_SOCKET_RECORD record;
+    PH2_AFD_SOCKET_RECORD uncachedRecord = NULL;
+    PH2_OUTPUT_BUFFER previousOutput;
+    H2_OUTPUT_BUFFER details = { 0 };
+
+    if (!Entry->Summary)
+    {
+        Entry->Summary = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, sizeof(H2_AFD_SUMMARY_RECORD));
+
+        if (!Entry->Summary)
+            return STATUS_NO_MEMORY;
+    }
+
+    if (Entry->Object)
+    {
+        // A new handle might point to a new socket at the address of a closed one
+        if (Entry->State != H2WatchSocket)
+            H2InvalidateRecordCache(RecordCache, Entry->Object);
+
+        status = H2SampleRecordCache(RecordCache, Entry->Object, SocketHandle, queryFlags, &record);
+
+        if (!NT_SUCCESS(status))
+            return status;
+    }
+    else
+    {
+        // Without object addresses, there is nothing to key the cache by
+        uncachedRecord = RtlAllocateHeap(RtlProcessHeap(), 0, sizeof(H2_AFD_SOCKET_RECORD));
+
+        if (!uncachedRecord)
+            return STATUS_NO_MEMORY;
+
+        H2AfdQuerySocketRecord(SocketHandle, queryFlags, uncachedRecord);
+        record = uncachedRecord;
+    }
+
+    H2AfdGetSummaryRecord(record, Entry->Summary);
+
+    // The record already has fresh TCP_INFO, since it's volatile
+    if (Scan->Samples.Flags && NT_SUCCESS(record->Status[H2_AFD_FIELD_TCP_INFO_V0]))
+        H2SetTcpSample(
+            &Scan->Samples,
+            (ULONG)(Entry - Scan->Entries),
+            H2QueryTcpSampleTime(),
+            (PTCP_INFO_v2)&record->TcpInfo,
+            NT_SUCCESS(record->Status[H2_AFD_FIELD_TCP_INFO_V1]) ? 1 : 0
+        );
+
+    previousOutput = H2SetThreadOutput(&details);
+    H2AfdPrintSocketRecord(record, Arguments->Verbose);
+    H2SetThreadOutput(previousOutput);
+
+    if (uncachedRecord)
+        RtlFreeHeap(RtlProcessHeap(), 0, uncachedRecord);
+
+    if (Entry->State == H2WatchSocket)
+    {
+        H2WatchDiffDetails(&Entry->Details, &details, &Entry->Changes);
+
+        if (Entry->Changes.Length)
+            Entry->Event = H2WatchChanged;
+    }
+    else
+    {
+        Entry->State = H2WatchSocket;
+        Entry->Event = H2WatchOpened;
+    }
+
+    H2FreeOutputBuffer(&Entry->Details);
+    Entry->Details = details;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Inspects new handles and refreshes the summary or details of existing sockets.
+  *
+  * \param[in,out] Scan The current scan.
+  * \param[in,out] Entry The handle.
+  * \param[in] Arguments The parsed arguments; required with the record cache.
+  * \param[in,out] RecordCache The cache of socket records for sampling details instead of summaries.
+  */
+VOID H2WatchInspectEntry(
+    _Inout_ PH2_WATCH_SCAN Scan,
+    _Inout_ PH2_WATCH_ENTRY Entry,
+    _In_opt_ PH2_ARGUMENTS Arguments,
+    _Inout_opt_ PH2_RECORD_CACHE RecordCache
+)
+{
+    NTSTATUS status;
+    PH2_WATCH_PROCESS process = &Scan->Processes[Entry->ProcessIndex];
+    H2_AFD_SUMMARY_RECORD summary;
+    HANDLE socketHandle;
+
+    // Verdicts for the same handle and object don't change
+    if (Entry->State == H2WatchNotSocket || Entry->State == H2WatchInaccessible)
+        return;
+
+    if (!NT_SUCCESS(process->OpenStatus))
+    {
+        Entry->State = H2WatchInaccessible;
+        return;
+    }
+
+    // Don't keep duplicates between scans; they would delay closing the sockets
+    status = H2Backend->DuplicateHandle(process->ProcessHandle, Entry->HandleValue, &socketHandle);
+
+    if (!NT_SUCCESS(status))
+    {
+        // The process closed the handle after the snapshot; the next scan reports it
+        if (Entry->State == H2WatchUnknown)
+            Entry->State = H2WatchInaccessible;
+
+        return;
+    }
+
+    if (RecordCache && Entry->State == H2WatchSocket)
+    {
+        // Try again on the next scan if there's no memory
+        H2WatchSampleDetails(Scan, Entry, socketHandle, Arguments, RecordCache);
+        H2Backend->Close(socketHandle);
+        return;
+    }
+
+    if (Entry->State == H2WatchSocket)
+    {
+        // Zero the padding so the addresses compare reliably
+        memset(&summary, 0, sizeof(summary));
+        H2AfdQuerySummaryRecord(socketHandle, &summary);
+
+        if (!H2WatchSummariesEqual(Entry->Summary, &summary))
+        {
+            *Entry->Summary = summary;
+            Entry->Event = H2WatchChanged;
+        }
+
+        H2WatchSampleTcpInfo(Scan, Entry, socketHandle);
+        H2Backend->Close(socketHandle);
+        return;
+    }
+
+    status = H2AfdIsSocketHandle(socketHandle);
+
+    if (!NT_SUCCESS(status))
+    {
+        H2Backend->Close(socketHandle);
+        Entry->State = status == STATUS_NOT_SAME_DEVICE ? H2WatchNotSocket : H2WatchInaccessible;
+        return;
+    }
+
+    if (RecordCache)
+    {
+        H2WatchSampleDetails(Scan, Entry, socketHandle, Arguments, RecordCache);
+        H2Backend->Close(socketHandle);
+        return;
+    }
+
+    // Try again on the next scan if there's no memory
+    Entry->Summary = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, sizeof(H2_AFD_SUMMARY_RECORD));
+
+    if (!Entry->Summary)
+    {
+        H2Backend->Close(socketHandle);
+        return;
+    }
+
+    H2AfdQuerySummaryRecord(socketHandle, Entry->Summary);
+    H2WatchSampleTcpInfo(Scan, Entry, socketHandle);
+    H2Backend->Close(socketHandle);
+    Entry->State = H2WatchSocket;
+    Entry->Event = H2WatchOpened;
+}
+
+/**
+  * \brief Inspects one chunk of handles on a worker thread.
+  *
+  * \param[in] Context The current scan.
+  * \param[in] ItemIndex The index of the chunk.
+  */
+VOID NTAPI H2WatchInspectChunk(
+    _In_ PVOID Context,
+    _In_ ULONG ItemIndex
+)
+{
+    PH2_WATCH_SCAN scan = Context;
+    ULONG first = ItemIndex * H2_WATCH_CHUNK_SIZE;
+    ULONG last = min(first + H2_WATCH_CHUNK_SIZE, scan->NumberOfEntries);
+
+    H2_TIMELINE_BEGIN("Inspect handles", ItemIndex);
+
+    for (ULONG i = first; i < last; i++)
+        H2WatchInspectEntry(scan, &scan->Entries[i], NULL, NULL);
+
+    H2_TIMELINE_END("Inspect handles");
+}
+
+/**
+  * \brief Prints a ratio in basis points as a percentage.
+  */
+VOID H2WatchPrintRatio(
+    _In_ ULONG Ratio
+)
+{
+    H2Print(L"%lu.%02lu%%", Ratio / 100, Ratio % 100);
+}
+
+/**
+  * \brief Prints what a socket did since the previous scan.
+  *
+  * \param[in] Process The process of the socket.
+  * \param[in] Entry The socket.
+  * \param[in] Rates The rates of all entries of the scan.
+  * \param[in] Index The index of the socket.
+  * \param[in] Time The local time of the scan.
+  */
+VOID H2WatchPrintRates(
+    _In_ PH2_WATCH_PROCESS Process,
+    _In_ PH2_WATCH_ENTRY Entry,
+    _In_ PH2_TCP_RATES Rates,
+    _In_ ULONG Index,
+    _In_ PTIME_FIELDS Time
+)
+{
+    H2Print(
+        L"[%02hd:%02hd:%02hd] = %wZ [%zu] [0x%0.4zX] in ",
+        Time->Hour,
+        Time->Minute,
+        Time->Second,
+        Process->ImageName,
+        (ULONG_PTR)Process->ProcessId,
+        (ULONG_PTR)Entry->HandleValue
+    );
+
+    H2PrintByteSize(Rates->ReceiveGoodput[Index]);
+    H2PrintString(L"/s, out ");
+    H2PrintByteSize(Rates->SendGoodput[Index]);
+    H2PrintString(L"/s, retransmitted ");
+    H2WatchPrintRatio(Rates->RetransmitRatio[Index]);
+
+    if (Rates->FastRetrans[Index])
+        H2Print(L", %lu fast retransmits", Rates->FastRetrans[Index]);
+
+    if (Rates->TimeoutEpisodes[Index])
+        H2Print(L", %lu timeouts", Rates->TimeoutEpisodes[Index]);
+
+    if (Rates->Flags[Index] & H2_TCP_SAMPLE_LIMITS)
+    {
+        H2PrintString(L", limited by receiver ");
+        H2WatchPrintRatio(Rates->ReceiverLimited[Index]);
+        H2PrintString(L", congestion ");
+        H2WatchPrintRatio(Rates->CongestionLimited[Index]);
+        H2PrintString(L", sender ");
+        H2WatchPrintRatio(Rates->SenderLimited[Index]);
+    }
+
+    H2Print(L"\r\n");
+}
+
+/**
+  * \brief Computes rates of sockets between the previous scan and the current one.
+  *
+  * \param[in] Previous The previous scan.
+  * \param[in] Current The current scan.
+  * \param[in] PreviousIndexes The index of each current entry in the previous scan or H2_TCP_NO_SAMPLE.
+  * \param[out] Rates The rates by current entry. The caller must release them via H2FreeTcpRates.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2WatchComputeRates(
+    _In_ PH2_WATCH_SCAN Previous,
+    _In_ PH2_WATCH_SCAN Current,
+    _In_reads_(Current->NumberOfEntries) PULONG PreviousIndexes,
+    _Out_ PH2_TCP_RATES Rates
+)
+{
+    NTSTATUS status;
+    H2_TCP_SAMPLES previousSamples;
+
+    // Line up the previous samples with the current entries
+    status = H2AllocateTcpSamples(&previousSamples, Current->NumberOfEntries);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    status = H2AllocateTcpRates(Rates, Current->NumberOfEntries);
+
+    if (NT_SUCCESS(status))
+    {
+        H2GatherTcpSamples(&Previous->Samples, PreviousIndexes, &previousSamples);
+        H2ComputeTcpRates(&previousSamples, &Current->Samples, Rates);
+    }
+
+    H2FreeTcpSamples(&previousSamples);
+    return status;
+}
+
+/**
+  * \brief Takes a new scan, compares it to the previous one, and prints the differences.
+  *
+  * \param[in] Arguments The parsed arguments.
+  * \param[in] TypeIndex The type index of file handles.
+  * \param[in,out] Previous The previous scan (empty on the first iteration). Sockets that still exist move to the current scan.
+  * \param[out] Current The current scan. The caller must release it via H2WatchFreeScan.
+  * \param[in,out] RecordCache The cache of socket records for watching the details of a handle.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2WatchScan(
+    _In_ PH2_ARGUMENTS Arguments,
+    _In_ ULONG TypeIndex,
+    _Inout_ PH2_WATCH_SCAN Previous,
+    _Out_ PH2_WATCH_SCAN Current,
+    _Inout_opt_ PH2_RECORD_CACHE RecordCache
+)
+{
+    NTSTATUS status;
+    H2_WORK_POOL pool;
+    LARGE_INTEGER time;
+    TIME_FIELDS timeFields;
+    ULONG numberOfChunks;
+    ULONG sockets = 0;
+    ULONG opened = 0;
+    ULONG changed = 0;
+    ULONG closed;
+    PULONG previousIndexes = NULL;
+    H2_TCP_RATES rates = { 0 };
+
+    status = H2WatchCollect(Arguments, TypeIndex, Current);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    if (Arguments->Rates)
+    {
+        status = H2AllocateTcpSamples(&Current->Samples, Current->NumberOfEntries);
+
+        if (NT_SUCCESS(status))
+        {
+            previousIndexes = RtlAllocateHeap(RtlProcessHeap(), 0, max(Current->NumberOfEntries, 1) * sizeof(ULONG));
+
+            if (!previousIndexes)
+                status = STATUS_NO_MEMORY;
+        }
+
+        if (!NT_SUCCESS(status))
+        {
+            H2WatchFreeScan(Current);
+            return status;
+        }
+    }
+
+    NtQuerySystemTime(&time);
+    RtlSystemTimeToLocalTime(&time, &time);
+    RtlTimeToTimeFields(&time, &timeFields);
+
+    H2_TIMELINE_BEGIN("Merge scans", 0);
+    closed = H2WatchMerge(Previous, Current, &timeFields, previousIndexes);
+    H2_TIMELINE_END("Merge scans");
+
+    // Open new processes; those that cannot be opened stay that way until they exit
+    for (ULONG i = 0; i < Current->NumberOfProcesses; i++)
+    {
+        PH2_WATCH_PROCESS process = &Current->Processes[i];
+
+        if (process->OpenStatus == STATUS_PENDING)
+        {
+            H2_TIMELINE_BEGIN("Open process", process->ProcessId);
+            process->OpenStatus = H2Backend->OpenProcess(&process->ProcessHandle, process->ProcessId, PROCESS_DUP_HANDLE);
+            H2_TIMELINE_END("Open process");
+
+            if (!NT_SUCCESS(process->OpenStatus))
+                process->ProcessHandle = NULL;
+        }
+    }
+
+    // Without extra threads, chunks run on demand from the wait below
+    numberOfChunks = (Current->NumberOfEntries + H2_WATCH_CHUNK_SIZE - 1) / H2_WATCH_CHUNK_SIZE;
+
+    if (RecordCache)
+    {
+        // The record cache is not thread-safe, and a single handle value selects few handles
+        H2_TIMELINE_BEGIN("Sample details", 0);
+
+        for (ULONG i = 0; i < Current->NumberOfEntries; i++)
+            H2WatchInspectEntry(Current, &Current->Entries[i], Arguments, RecordCache);
+
+        H2_TIMELINE_END("Sample details");
+
+        // Forget sockets that are gone
+        H2PruneRecordCache(RecordCache);
+    }
+    else if (numberOfChunks && NT_SUCCESS(H2StartWorkPool(
+        &pool,
+        Arguments->NumberOfThreads > 1 ? Arguments->NumberOfThreads : 0,
+        numberOfChunks,
+        H2WatchInspectChunk,
+        Current)))
+    {
+        for (ULONG i = 0; i < numberOfChunks; i++)
+            H2WaitForWorkItem(&pool, i);
+
+        H2StopWorkPool(&pool);
+    }
+    else
+    {
+        // The state already moved from the previous scan, so finish without extra threads
+        for (ULONG i = 0; i < numberOfChunks; i++)
+            H2WatchInspectChunk(Current, i);
+    }
+
+    if (previousIndexes)
+    {
+        // Skip rates for this scan if there's no memory; the samples still serve the next one
+        H2_TIMELINE_BEGIN("Compute rates", 0);
+        H2WatchComputeRates(Previous, Current, previousIndexes, &rates);
+        H2_TIMELINE_END("Compute rates");
+
+        RtlFreeHeap(RtlProcessHeap(), 0, previousIndexes);
+    }
+
+    // Report in the sorted order
+    for (ULONG i = 0; i < Current->NumberOfEntries; i++)
+    {
+        PH2_WATCH_ENTRY entry = &Current->Entries[i];
+
+        if (entry->State == H2WatchSocket)
+            sockets++;
+
+        if (entry->Event == H2WatchOpened)
+        {
+            H2WatchPrintEvent(L"+", &Current->Processes[entry->ProcessIndex], entry, &timeFields);
+            H2PrintText(entry->Details.Buffer, entry->Details.Length);
+            opened++;
+        }
+        else if (entry->Event == H2WatchChanged)
+        {
+            H2WatchPrintEvent(L"~", &Current->Processes[entry->ProcessIndex], entry, &timeFields);
+
+            if (entry->Changes.Length)
+            {
+                H2PrintText(entry->Changes.Buffer, entry->Changes.Length);
+                H2PrintText(L"\r\n", 2);
+                H2FreeOutputBuffer(&entry->Changes);
+            }
+
+            changed++;
+        }
+
+        // Only report connections that did something
+        if (rates.Flags && (rates.BytesIn[i] || rates.BytesOut[i] || rates.TimeoutEpisodes[i]))
+            H2WatchPrintRates(&Current->Processes[entry->ProcessIndex], entry, &rates, i, &timeFields);
+    }
+
+    H2FreeTcpRates(&rates);
+
+    if (Arguments->Verbose)
+    {
+        H2Print(
+            L"[%02hd:%02hd:%02hd] %lu file handles, %lu sockets (%lu opened, %lu closed, %lu changed)\r\n",
+            timeFields.Hour,
+            timeFields.Minute,
+            timeFields.Second,
+            Current->NumberOfEntries,
+            sockets,
+            opened,
+            closed,
+            changed
+        );
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Stops watching on Ctrl+C and similar signals.
+  */
+BOOL WINAPI H2WatchConsoleHandler(
+    _In_ DWORD CtrlType
+)
+{
+    NtSetEvent(H2WatchStopEvent, NULL);
+    return TRUE;
+}
+
+/**
+  * \brief Rescans sockets of matching processes periodically and prints opened, closed, and changed ones.
+  *
+  * \param[in] Arguments The parsed arguments with the process filter, the interval, the number of worker threads,
+  *  the optional handle value to watch the details of, and whether to print rates of TCP connections.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2WatchSockets(
+    _In_ PH2_ARGUMENTS Arguments
+)
+{
+    NTSTATUS status;
+    UNICODE_STRING fileHandleTypeName = RTL_CONSTANT_STRING(L"File");
+    ULONG fileHandleTypeIndex;
+    H2_WATCH_SCAN previous = { 0 };
+    H2_WATCH_SCAN current;
+    H2_RECORD_CACHE recordCache = { 0 };
+    LARGE_INTEGER interval;
+
+    // Identify the type index for sockets (file handles)
+    H2_TIMELINE_BEGIN("Find type index", 0);
+    status = H2Backend->FindKernelTypeIndex(&fileHandleTypeName, &fileHandleTypeIndex);
+    H2_TIMELINE_END("Find type index");
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    // Watching a handle samples all of its properties, so keep the ones that don't change
+    if (Arguments->HandleValue)
+    {
+        status = H2InitializeRecordCache(&recordCache);
+
+        if (!NT_SUCCESS(status))
+            return status;
+    }
+
+    status = NtCreateEvent(&H2WatchStopEvent, EVENT_ALL_ACCESS, NULL, NotificationEvent, FALSE);
+
+    if (!NT_SUCCESS(status))
+    {
+        H2FreeRecordCache(&recordCache);
+        return status;
+    }
+
+    // Let the run finish normally to save the output, statistics, and traces
+    SetConsoleCtrlHandler(H2WatchConsoleHandler, TRUE);
+    interval.QuadPart = -(LONG64)Arguments->WatchInterval * 10000;
+
+    do
+    {
+        H2_TIMELINE_BEGIN("Scan sockets", 0);
+        status = H2WatchScan(Arguments, fileHandleTypeIndex, &previous, &current, Arguments->HandleValue ? &recordCache : NULL);
+        H2_TIMELINE_END("Scan sockets");
+
+        if (!NT_SUCCESS(status))
+            break;
+
+        // Whatever didn't move to the current scan belongs to exited processes or closed handles
+        H2WatchFreeScan(&previous);
+        previous = current;
+        H2FlushOutput();
+    } while (NtWaitForSingleObject(H2WatchStopEvent, FALSE, &interval) == STATUS_TIMEOUT);
+
+    SetConsoleCtrlHandler(H2WatchConsoleHandler, FALSE);
+    H2WatchFreeScan(&previous);
+    H2FreeRecordCache(&recordCache);
+    NtClose(H2WatchStopEvent);
+    H2WatchStopEvent = NULL;
+
+    return status;
+}
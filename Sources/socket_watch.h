@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _SOCKET_WATCH_H
+#define _SOCKET_WATCH_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "argument_parsing.h"
+
+// Handles per work item when inspecting new sockets and refreshing existing ones
+#define H2_WATCH_CHUNK_SIZE 256
+
+NTSTATUS
+NTAPI
+H2WatchSockets(
+    _In_ PH2_ARGUMENTS Arguments
+);
+
+#endif
@@ -0,0 +1,612 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "stats_backend.h"
+#include "socket_record.h"
+#include "string_helpers.h"
+#include "ntafd.h"
+#include <wchar.h>
+
+// Occupied slots always have the top bit set, so zero marks a free one
+#define H2_STATS_KEY(Type, Level, Code) \
+    ((LONG64)(0x8000000000000000ull | ((ULONG64)(UCHAR)(Type) << 48) | ((ULONG64)(USHORT)(Level) << 32) | (ULONG)(Code)))
+
+#define H2_STATS_KEY_TYPE(Key) ((H2_STATS_CALL_TYPE)(UCHAR)((ULONG64)(Key) >> 48))
+#define H2_STATS_KEY_LEVEL(Key) ((USHORT)((ULONG64)(Key) >> 32))
+#define H2_STATS_KEY_CODE(Key) ((ULONG)(Key))
+
+// The maximum length of a call name in the report
+#define H2_STATS_NAME_LENGTH 48
+
+typedef struct _H2_STATS_ENTRY
+{
+    volatile LONG64 Key;
+    volatile LONG64 Calls;
+    volatile LONG64 Failures;
+    H2_HISTOGRAM Latency; // In 100ns units
+} H2_STATS_ENTRY, *PH2_STATS_ENTRY;
+
+#define H2_STATS_OPTION_NAME(Option, Level, OptionName, Kind, Visibility, Applicability, Volatility, FriendlyName, RawName) L"" RawName,
+
+// Raw names of options in the H2_AFD_OPTION order
+const PCWSTR H2StatsOptionNames[H2_AFD_OPTION_MAX] =
+{
+    H2_AFD_OPTIONS(H2_STATS_OPTION_NAME)
+};
+
+#undef H2_STATS_OPTION_NAME
+
+PCH2_BACKEND H2StatsInnerBackend;
+LARGE_INTEGER H2StatsFrequency;
+H2_STATS_ENTRY H2StatsTable[H2_STATS_TABLE_SIZE];
+BOOLEAN H2StatsActive;
+volatile LONG64 H2StatsPendingWaits;
+volatile LONG64 H2StatsLostCalls;
+
+/**
+  * \brief Determines which histogram bucket a value belongs to.
+  *
+  * \param[in] Value The value to classify.
+  *
+  * \return The index of the bucket.
+  */
+ULONG H2HistogramBucket(
+    _In_ ULONG64 Value
+)
+{
+    ULONG exponent = 0;
+
+    // Small values get a bucket each
+    if (Value < H2_HISTOGRAM_SUB_BUCKETS)
+        return (ULONG)Value;
+
+    while (exponent < 63 && (Value >> (exponent + 1)))
+        exponent++;
+
+    // The leading bit selects the power of two, the next few bits select the sub-bucket
+    return (exponent - H2_HISTOGRAM_SUB_BUCKET_BITS + 1) * H2_HISTOGRAM_SUB_BUCKETS +
+        (ULONG)(Value >> (exponent - H2_HISTOGRAM_SUB_BUCKET_BITS)) - H2_HISTOGRAM_SUB_BUCKETS;
+}
+
+/**
+  * \brief Determines the largest value that belongs to a histogram bucket.
+  *
+  * \param[in] Bucket The index of the bucket.
+  *
+  * \return The upper bound of the bucket, inclusive.
+  */
+ULONG64 H2HistogramBucketUpperBound(
+    _In_ ULONG Bucket
+)
+{
+    ULONG shift;
+    ULONG64 lowerBound;
+
+    if (Bucket < H2_HISTOGRAM_SUB_BUCKETS)
+        return Bucket;
+
+    shift = Bucket / H2_HISTOGRAM_SUB_BUCKETS - 1;
+    lowerBound = (ULONG64)(H2_HISTOGRAM_SUB_BUCKETS + Bucket % H2_HISTOGRAM_SUB_BUCKETS) << shift;
+
+    return lowerBound + ((1ull << shift) - 1);
+}
+
+/**
+  * \brief Adds a value to a histogram. Safe to call concurrently.
+  *
+  * \param[in,out] Histogram The histogram.
+  * \param[in] Value The value to add.
+  */
+VOID H2RecordHistogram(
+    _Inout_ PH2_HISTOGRAM Histogram,
+    _In_ ULONG64 Value
+)
+{
+    LONG64 max;
+
+    InterlockedIncrement64(&Histogram->Buckets[H2HistogramBucket(Value)]);
+    InterlockedIncrement64(&Histogram->Count);
+
+    do
+    {
+        max = ReadNoFence64(&Histogram->Max);
+
+        if ((ULONG64)max >= Value)
+            break;
+
+    } while (InterlockedCompareExchange64(&Histogram->Max, (LONG64)Value, max) != max);
+}
+
+/**
+  * \brief Estimates a percentile of the values in a histogram.
+  *
+  * \param[in] Histogram The histogram.
+  * \param[in] Percentile The percentile, from 0 to 100.
+  *
+  * \return The upper bound of the bucket that contains the percentile, never above the maximum value.
+  */
+ULONG64 H2HistogramPercentile(
+    _In_ PH2_HISTOGRAM Histogram,
+    _In_ ULONG Percentile
+)
+{
+    ULONG64 count = (ULONG64)Histogram->Count;
+    ULONG64 target;
+    ULONG64 seen = 0;
+
+    if (count == 0)
+        return 0;
+
+    // The rank of the value, rounding up
+    target = max((count * Percentile + 99) / 100, 1);
+
+    for (ULONG i = 0; i < H2_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += (ULONG64)Histogram->Buckets[i];
+
+        if (seen >= target)
+            return min(H2HistogramBucketUpperBound(i), (ULONG64)Histogram->Max);
+    }
+
+    return (ULONG64)Histogram->Max;
+}
+
+/**
+  * \brief Reads a high-resolution timestamp.
+  *
+  * \return The time in 100ns units.
+  */
+ULONG64 H2StatsQueryTime(
+    VOID
+)
+{
+    LARGE_INTEGER counter;
+
+    RtlQueryPerformanceCounter(&counter);
+
+    return (counter.QuadPart / H2StatsFrequency.QuadPart) * 10000000 +
+        (counter.QuadPart % H2StatsFrequency.QuadPart) * 10000000 / H2StatsFrequency.QuadPart;
+}
+
+/**
+  * \brief Finds or creates the entry for a call type.
+  *
+  * \param[in] Key The key of the call type.
+  *
+  * \return The entry or NULL if the table is full.
+  */
+PH2_STATS_ENTRY H2StatsFindEntry(
+    _In_ LONG64 Key
+)
+{
+    ULONG start = (ULONG)(((ULONG64)Key * 0x9E3779B97F4A7C15ull) >> 32);
+    PH2_STATS_ENTRY entry;
+    LONG64 current;
+
+    for (ULONG i = 0; i < H2_STATS_TABLE_SIZE; i++)
+    {
+        entry = &H2StatsTable[(start + i) & (H2_STATS_TABLE_SIZE - 1)];
+        current = ReadAcquire64(&entry->Key);
+
+        if (current == 0)
+            current = InterlockedCompareExchange64(&entry->Key, Key, 0);
+
+        if (current == 0 || current == Key)
+            return entry;
+    }
+
+    return NULL;
+}
+
+/**
+  * \brief Counts a completed call.
+  *
+  * \param[in] Key The key of the call type.
+  * \param[in] Status The status of the call.
+  * \param[in] Timed Whether the duration was measured.
+  * \param[in] Duration The duration of the call in 100ns units.
+  */
+VOID H2StatsRecord(
+    _In_ LONG64 Key,
+    _In_ NTSTATUS Status,
+    _In_ BOOLEAN Timed,
+    _In_ ULONG64 Duration
+)
+{
+    PH2_STATS_ENTRY entry = H2StatsFindEntry(Key);
+
+    // A full table only loses the rarest calls
+    if (!entry)
+    {
+        InterlockedIncrement64(&H2StatsLostCalls);
+        return;
+    }
+
+    InterlockedIncrement64(&entry->Calls);
+
+    if (!NT_SUCCESS(Status))
+        InterlockedIncrement64(&entry->Failures);
+
+    if (Timed)
+        H2RecordHistogram(&entry->Latency, Duration);
+}
+
+/**
+  * \brief Determines the statistics key of an IOCTL, looking inside transport requests.
+  *
+  * \param[in] IoControlCode The IOCTL code.
+  * \param[in] InBuffer The input buffer of the IOCTL.
+  * \param[in] InBufferSize The size of the input buffer.
+  *
+  * \return The key of the call type.
+  */
+LONG64 H2StatsClassifyIoctl(
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize
+)
+{
+    if (IoControlCode == IOCTL_AFD_TRANSPORT_IOCTL && InBuffer && InBufferSize >= sizeof(AFD_TL_IO_CONTROL_INFO))
+    {
+        PAFD_TL_IO_CONTROL_INFO controlInfo = InBuffer;
+
+        if (controlInfo->Type == TlGetSockOptIoControlType)
+            return H2_STATS_KEY(H2StatsCallSocketOption, controlInfo->Level, controlInfo->IoControlCode);
+
+        if (controlInfo->Type == TlSocketIoControlType)
+            return H2_STATS_KEY(H2StatsCallSocketIoControl, 0, controlInfo->IoControlCode);
+    }
+
+    return H2_STATS_KEY(H2StatsCallDeviceIoControl, 0, IoControlCode);
+}
+
+NTSTATUS H2StatsSnapshotProcesses(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+)
+{
+    return H2StatsInnerBackend->SnapshotProcesses(Snapshot);
+}
+
+NTSTATUS H2StatsSnapshotHandles(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+)
+{
+    return H2StatsInnerBackend->SnapshotHandles(Snapshot);
+}
+
+NTSTATUS H2StatsFindKernelTypeIndex(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+)
+{
+    return H2StatsInnerBackend->FindKernelTypeIndex(TypeName, Index);
+}
+
+NTSTATUS H2StatsOpenProcess(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+)
+{
+    NTSTATUS status;
+    ULONG64 start = H2StatsQueryTime();
+
+    status = H2StatsInnerBackend->OpenProcess(ProcessHandle, ProcessId, DesiredAccess);
+    H2StatsRecord(H2_STATS_KEY(H2StatsCallOpenProcess, 0, 0), status, TRUE, H2StatsQueryTime() - start);
+    return status;
+}
+
+NTSTATUS H2StatsDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+)
+{
+    NTSTATUS status;
+    ULONG64 start = H2StatsQueryTime();
+
+    status = H2StatsInnerBackend->DuplicateHandle(ProcessHandle, SourceHandle, TargetHandle);
+    H2StatsRecord(H2_STATS_KEY(H2StatsCallDuplicateHandle, 0, 0), status, TRUE, H2StatsQueryTime() - start);
+    return status;
+}
+
+NTSTATUS H2StatsQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+)
+{
+    NTSTATUS status;
+    ULONG64 start = H2StatsQueryTime();
+
+    status = H2StatsInnerBackend->QueryVolumeName(FileHandle, Buffer, BufferSize);
+    H2StatsRecord(H2_STATS_KEY(H2StatsCallQueryVolumeName, 0, 0), status, TRUE, H2StatsQueryTime() - start);
+    return status;
+}
+
+NTSTATUS H2StatsDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+)
+{
+    NTSTATUS status;
+    LONG64 key;
+    ULONG64 start;
+
+    // Classify before the call since buffers can overlap
+    key = H2StatsClassifyIoctl(IoControlCode, InBuffer, InBufferSize);
+
+    start = H2StatsQueryTime();
+    status = H2StatsInnerBackend->DeviceIoControl(
+        FileHandle,
+        IoControlCode,
+        InBuffer,
+        InBufferSize,
+        OutputBuffer,
+        OutputBufferSize,
+        BytesReturned
+    );
+    H2StatsRecord(key, status, TRUE, H2StatsQueryTime() - start);
+
+    return status;
+}
+
+NTSTATUS H2StatsDeviceIoControlBatch(
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+)
+{
+    NTSTATUS status;
+    ULONG64 start = H2StatsQueryTime();
+
+    // Requests overlap, so only the batch as a whole has a meaningful duration
+    status = H2StatsInnerBackend->DeviceIoControlBatch(FileHandle, Requests, NumberOfRequests);
+    H2StatsRecord(H2_STATS_KEY(H2StatsCallBatch, 0, 0), status, TRUE, H2StatsQueryTime() - start);
+
+    for (ULONG i = 0; i < NumberOfRequests; i++)
+        H2StatsRecord(
+            H2StatsClassifyIoctl(Requests[i].IoControlCode, Requests[i].InBuffer, Requests[i].InBufferSize),
+            Requests[i].Status,
+            FALSE,
+            0
+        );
+
+    return status;
+}
+
+NTSTATUS H2StatsClose(
+    _In_ HANDLE Handle
+)
+{
+    return H2StatsInnerBackend->Close(Handle);
+}
+
+const H2_BACKEND H2StatsBackend =
+{
+    L"Statistics",
+    H2StatsSnapshotProcesses,
+    H2StatsSnapshotHandles,
+    H2StatsFindKernelTypeIndex,
+    H2StatsOpenProcess,
+    H2StatsDuplicateHandle,
+    H2StatsQueryVolumeName,
+    H2StatsDeviceIoControl,
+    H2StatsDeviceIoControlBatch,
+    H2StatsClose
+};
+
+/**
+  * \brief Starts measuring all requests to the current backend.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2StatsStart(
+    VOID
+)
+{
+#ifdef H2_DISABLE_STATS
+    return STATUS_NOT_SUPPORTED;
+#else
+    if (H2StatsActive)
+        return STATUS_INVALID_PARAMETER_MIX;
+
+    RtlQueryPerformanceFrequency(&H2StatsFrequency);
+    H2StatsInnerBackend = H2Backend;
+    H2Backend = &H2StatsBackend;
+    H2StatsActive = TRUE;
+    return STATUS_SUCCESS;
+#endif
+}
+
+/**
+  * \brief Stops measuring requests and restores the previous backend. The statistics remain available.
+  */
+VOID H2StatsStop(
+    VOID
+)
+{
+    if (!H2StatsActive)
+        return;
+
+    H2Backend = H2StatsInnerBackend;
+    H2StatsActive = FALSE;
+}
+
+/**
+  * \brief Formats the name of a call type for the report.
+  *
+  * \param[in] Key The key of the call type.
+  * \param[out] Buffer A buffer that receives the name.
+  */
+VOID H2StatsFormatName(
+    _In_ LONG64 Key,
+    _Out_writes_z_(H2_STATS_NAME_LENGTH) PWSTR Buffer
+)
+{
+    ULONG code = H2_STATS_KEY_CODE(Key);
+    USHORT level = H2_STATS_KEY_LEVEL(Key);
+    PCWSTR name = NULL;
+
+    switch (H2_STATS_KEY_TYPE(Key))
+    {
+    case H2StatsCallOpenProcess:
+        name = L"NtOpenProcess";
+        break;
+    case H2StatsCallDuplicateHandle:
+        name = L"NtDuplicateObject";
+        break;
+    case H2StatsCallQueryVolumeName:
+        name = L"NtQueryInformationFile (volume name)";
+        break;
+    case H2StatsCallBatch:
+        name = L"IOCTL batch";
+        break;
+    case H2StatsCallDeviceIoControl:
+        switch (code)
+        {
+        case IOCTL_AFD_GET_ADDRESS: name = L"IOCTL_AFD_GET_ADDRESS"; break;
+        case IOCTL_AFD_GET_REMOTE_ADDRESS: name = L"IOCTL_AFD_GET_REMOTE_ADDRESS"; break;
+        case IOCTL_AFD_GET_CONTEXT: name = L"IOCTL_AFD_GET_CONTEXT"; break;
+        case IOCTL_AFD_GET_INFORMATION: name = L"IOCTL_AFD_GET_INFORMATION"; break;
+        case IOCTL_AFD_QUERY_HANDLES: name = L"IOCTL_AFD_QUERY_HANDLES"; break;
+        case IOCTL_AFD_TRANSPORT_IOCTL: name = L"IOCTL_AFD_TRANSPORT_IOCTL"; break;
+        }
+
+        if (!name)
+        {
+            swprintf_s(Buffer, H2_STATS_NAME_LENGTH, L"IOCTL 0x%0.5X", code);
+            return;
+        }
+        break;
+    case H2StatsCallSocketIoControl:
+        if (code == SIO_TCP_INFO)
+        {
+            name = L"SIO_TCP_INFO";
+            break;
+        }
+
+        swprintf_s(Buffer, H2_STATS_NAME_LENGTH, L"SIO 0x%0.8X", code);
+        return;
+    case H2StatsCallSocketOption:
+        for (ULONG i = 0; i < H2_AFD_OPTION_MAX; i++)
+        {
+            if ((USHORT)H2AfdOptionIds[i].Level == level && H2AfdOptionIds[i].OptionName == code)
+            {
+                size_t length = wcslen(H2StatsOptionNames[i]);
+
+                // Raw names are padded for alignment
+                while (length > 0 && H2StatsOptionNames[i][length - 1] == L' ')
+                    length--;
+
+                swprintf_s(Buffer, H2_STATS_NAME_LENGTH, L"Option %.*s", (int)length, H2StatsOptionNames[i]);
+                return;
+            }
+        }
+
+        swprintf_s(Buffer, H2_STATS_NAME_LENGTH, L"Option %u:%u", level, code);
+        return;
+    }
+
+    wcscpy_s(Buffer, H2_STATS_NAME_LENGTH, name ? name : L"Unknown");
+}
+
+/**
+  * \brief Prints the collected statistics, grouped by call type.
+  */
+VOID H2PrintStats(
+    VOID
+)
+{
+    ULONG order[H2_STATS_TABLE_SIZE];
+    ULONG count = 0;
+    WCHAR name[H2_STATS_NAME_LENGTH];
+
+    // Sort occupied entries by key, which groups them by type
+    for (ULONG i = 0; i < H2_STATS_TABLE_SIZE; i++)
+    {
+        ULONG position = count;
+
+        if (!H2StatsTable[i].Key)
+            continue;
+
+        while (position > 0 && (ULONG64)H2StatsTable[order[position - 1]].Key > (ULONG64)H2StatsTable[i].Key)
+        {
+            order[position] = order[position - 1];
+            position--;
+        }
+
+        order[position] = i;
+        count++;
+    }
+
+    H2Print(L"Call statistics (latency in microseconds):\r\n");
+    H2Print(L"%-40s %9s %9s %9s %9s %9s %9s\r\n", L"Call", L"Count", L"Failed", L"p50", L"p90", L"p99", L"Max");
+
+    for (ULONG i = 0; i < count; i++)
+    {
+        PH2_STATS_ENTRY entry = &H2StatsTable[order[i]];
+
+        H2StatsFormatName(entry->Key, name);
+        H2Print(L"%-40s %9lld %9lld", name, entry->Calls, entry->Failures);
+
+        // Batched requests overlap and only count
+        if (entry->Latency.Count)
+            H2Print(
+                L" %9.1f %9.1f %9.1f %9.1f\r\n",
+                H2HistogramPercentile(&entry->Latency, 50) / 10.0,
+                H2HistogramPercentile(&entry->Latency, 90) / 10.0,
+                H2HistogramPercentile(&entry->Latency, 99) / 10.0,
+                entry->Latency.Max / 10.0
+            );
+        else
+            H2Print(L" %9s %9s %9s %9s\r\n", L"-", L"-", L"-", L"-");
+    }
+
+    H2Print(L"IOCTLs that returned STATUS_PENDING: %lld\r\n\r\n", H2StatsPendingWaits);
+}
+
+/**
+  * \brief Verifies that the statistics counted each IOCTL the backend received exactly once.
+  *
+  * \param[in] Issued The number of IOCTLs the innermost backend received.
+  *
+  * \return Whether the numbers match. Otherwise, the function reports the mismatch.
+  */
+BOOLEAN H2StatsCheckIoctlCount(
+    _In_ LONG64 Issued
+)
+{
+    LONG64 counted = 0;
+
+    for (ULONG i = 0; i < H2_STATS_TABLE_SIZE; i++)
+    {
+        switch (H2_STATS_KEY_TYPE(H2StatsTable[i].Key))
+        {
+        case H2StatsCallDeviceIoControl:
+        case H2StatsCallSocketOption:
+        case H2StatsCallSocketIoControl:
+            counted += H2StatsTable[i].Calls;
+            break;
+        }
+    }
+
+    // Lost calls might have been IOCTLs; the check cannot be exact then
+    if (counted == Issued || (H2StatsLostCalls && counted < Issued && counted + H2StatsLostCalls >= Issued))
+        return TRUE;
+
+    H2Print(L"Statistics self-check failed: counted %lld IOCTLs, but the backend received %lld.\r\n\r\n", counted, Issued);
+    return FALSE;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _STATS_BACKEND_H
+#define _STATS_BACKEND_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "backend.h"
+
+//
+// The statistics backend forwards requests to the previous backend and counts them per call
+// type, measuring their latency into log-bucketed histograms. Each power of two is split into
+// H2_HISTOGRAM_SUB_BUCKETS linear sub-buckets, which bounds the error of reported percentiles
+// to 1 / H2_HISTOGRAM_SUB_BUCKETS of the value. The histogram functions only do arithmetic on
+// their input and don't depend on how the latency was measured.
+//
+
+#define H2_HISTOGRAM_SUB_BUCKET_BITS 2
+#define H2_HISTOGRAM_SUB_BUCKETS (1 << H2_HISTOGRAM_SUB_BUCKET_BITS)
+#define H2_HISTOGRAM_BUCKETS ((64 - H2_HISTOGRAM_SUB_BUCKET_BITS + 1) * H2_HISTOGRAM_SUB_BUCKETS)
+
+typedef struct _H2_HISTOGRAM
+{
+    volatile LONG64 Count;
+    volatile LONG64 Max;
+    volatile LONG64 Buckets[H2_HISTOGRAM_BUCKETS];
+} H2_HISTOGRAM, *PH2_HISTOGRAM;
+
+ULONG
+NTAPI
+H2HistogramBucket(
+    _In_ ULONG64 Value
+);
+
+ULONG64
+NTAPI
+H2HistogramBucketUpperBound(
+    _In_ ULONG Bucket
+);
+
+VOID
+NTAPI
+H2RecordHistogram(
+    _Inout_ PH2_HISTOGRAM Histogram,
+    _In_ ULONG64 Value
+);
+
+ULONG64
+NTAPI
+H2HistogramPercentile(
+    _In_ PH2_HISTOGRAM Histogram,
+    _In_ ULONG Percentile
+);
+
+// What a statistics entry counts
+typedef enum _H2_STATS_CALL_TYPE
+{
+    H2StatsCallOpenProcess = 1,
+    H2StatsCallDuplicateHandle,
+    H2StatsCallQueryVolumeName,
+    H2StatsCallDeviceIoControl, // Code is the IOCTL
+    H2StatsCallSocketOption, // Level and Code identify the option
+    H2StatsCallSocketIoControl, // Code is the SIO_* transport IOCTL
+    H2StatsCallBatch, // Members are also counted individually, without latency
+} H2_STATS_CALL_TYPE;
+
+// The number of distinct call types and codes the statistics can track; must be a power of two
+#define H2_STATS_TABLE_SIZE 128
+
+// Counters of the native backend; define H2_DISABLE_STATS to compile them out
+#ifdef H2_DISABLE_STATS
+#define H2_STATS_COUNT_PENDING_WAIT()
+#else
+#define H2_STATS_COUNT_PENDING_WAIT() ((VOID)(H2StatsActive && InterlockedIncrement64(&H2StatsPendingWaits)))
+#endif
+
+// Whether the statistics backend is installed
+extern BOOLEAN H2StatsActive;
+
+// The number of IOCTLs that returned STATUS_PENDING and required a wait
+extern volatile LONG64 H2StatsPendingWaits;
+
+// The number of calls that didn't fit into the table
+extern volatile LONG64 H2StatsLostCalls;
+
+// A backend that forwards requests to the previous backend and measures them
+extern const H2_BACKEND H2StatsBackend;
+
+NTSTATUS
+NTAPI
+H2StatsSnapshotProcesses(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+);
+
+NTSTATUS
+NTAPI
+H2StatsSnapshotHandles(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+);
+
+NTSTATUS
+NTAPI
+H2StatsFindKernelTypeIndex(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+);
+
+NTSTATUS
+NTAPI
+H2StatsOpenProcess(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+);
+
+NTSTATUS
+NTAPI
+H2StatsDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+);
+
+NTSTATUS
+NTAPI
+H2StatsQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+);
+
+NTSTATUS
+NTAPI
+H2StatsDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+);
+
+NTSTATUS
+NTAPI
+H2StatsDeviceIoControlBatch(
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+);
+
+NTSTATUS
+NTAPI
+H2StatsClose(
+    _In_ HANDLE Handle
+);
+
+NTSTATUS
+NTAPI
+H2StatsStart(
+    VOID
+);
+
+VOID
+NTAPI
+H2StatsStop(
+    VOID
+);
+
+VOID
+NTAPI
+H2PrintStats(
+    VOID
+);
+
+BOOLEAN
+NTAPI
+H2StatsCheckIoctlCount(
+    _In_ LONG64 Issued
+);
+
+#endif
@@ -9,90 +9,539 @@
  */
 
 #include "string_helpers.h"
+#include "file_helpers.h"
 #include <wchar.h>
-#include <time.h>
 #include <ntintsafe.h>
+#include <stdarg.h>
+
+// The buffer that collects output of the current thread instead of the console
+__declspec(thread) PH2_OUTPUT_BUFFER H2ThreadOutput;
+
+// Text waiting to be written to the console (or the output file) by the current thread
+__declspec(thread) WCHAR H2ConsoleBuffer[H2_CONSOLE_BUFFER_SIZE];
+__declspec(thread) ULONG H2ConsoleLength;
+
+// The file that receives the output instead of the console
+HANDLE H2OutputFileHandle;
+
+// The first error from writing to the output file
+NTSTATUS H2OutputFileStatus = STATUS_SUCCESS;
 
 /**
-  * \brief Outputs a time duration value to the console.
+  * \brief Redirects the output of the current thread into a buffer.
   *
-  * \param[in] TimeSpan The time duration in 100-ns intervals.
+  * \param[in] Output The buffer to append to or NULL to write to the console.
+  *
+  * \return The previous buffer of the thread.
   */
-VOID H2PrintTimeSpan(
-    _In_ ULONG64 TimeSpan
+PH2_OUTPUT_BUFFER H2SetThreadOutput(
+    _In_opt_ PH2_OUTPUT_BUFFER Output
 )
 {
-    if (TimeSpan == 0)
-        wprintf_s(L"None");
-    else if (TimeSpan < TICKS_PER_MS)
-        wprintf_s(L"%I64u us", TimeSpan / TICKS_PER_US);
-    else if (TimeSpan < TICKS_PER_SEC)
-        wprintf_s(L"%I64u ms", TimeSpan / TICKS_PER_MS);
-    else if (TimeSpan < TICKS_PER_MIN)
-        wprintf_s(L"%I64u sec", TimeSpan / TICKS_PER_SEC);
-    else
-    {
-        ULONG seconds = (TimeSpan / TICKS_PER_SEC) % 60;
-        ULONG minutes = (TimeSpan / TICKS_PER_MIN) % 60;
-        ULONG hours = (TimeSpan / TICKS_PER_HOUR) % 24;
-        ULONG64 days = TimeSpan / TICKS_PER_DAY;
+    PH2_OUTPUT_BUFFER previous = H2ThreadOutput;
+
+    H2ThreadOutput = Output;
+    return previous;
+}
+
+/**
+  * \brief Writes text directly to the console or the output file, bypassing the buffers.
+  *
+  * \param[in] Text The text.
+  * \param[in] Length The number of characters in the text.
+  */
+VOID H2WriteOutputTarget(
+    _In_reads_(Length) PCWCH Text,
+    _In_ SIZE_T Length
+)
+{
+    CHAR utf8Buffer[H2_CONSOLE_BUFFER_SIZE];
+    ULONG utf8Length;
+    SIZE_T portion;
 
-        if (TimeSpan < TICKS_PER_HOUR)
+    if (!H2OutputFileHandle)
+    {
+        while (Length)
         {
-            if (seconds)
-                wprintf_s(L"%u min %u sec", minutes, seconds);
-            else
-                wprintf_s(L"%u min", minutes);
+            portion = min(Length, MAXLONG);
+            wprintf_s(L"%.*s", (LONG)portion, Text);
+            Text += portion;
+            Length -= portion;
         }
-        else if (TimeSpan < TICKS_PER_DAY)
+
+        return;
+    }
+
+    while (Length && NT_SUCCESS(H2OutputFileStatus))
+    {
+        // Each character takes at most three bytes in UTF-8
+        portion = min(Length, sizeof(utf8Buffer) / 3);
+
+        // Don't split surrogate pairs
+        if (portion < Length && IS_HIGH_SURROGATE(Text[portion - 1]))
+            portion--;
+
+        H2OutputFileStatus = RtlUnicodeToUTF8N(utf8Buffer, sizeof(utf8Buffer), &utf8Length, Text, (ULONG)(portion * sizeof(WCHAR)));
+
+        if (NT_SUCCESS(H2OutputFileStatus))
+            H2OutputFileStatus = H2WriteFile(H2OutputFileHandle, utf8Buffer, utf8Length);
+
+        Text += portion;
+        Length -= portion;
+    }
+}
+
+/**
+  * \brief Writes the pending console output of the current thread. Threads call it before exiting.
+  */
+VOID H2FlushOutput(
+    VOID
+)
+{
+    if (H2ConsoleLength)
+    {
+        H2WriteOutputTarget(H2ConsoleBuffer, H2ConsoleLength);
+        H2ConsoleLength = 0;
+    }
+}
+
+/**
+  * \brief Finds space for text in the buffer of the current thread or the console buffer.
+  *
+  * \param[in] Characters The number of characters to reserve.
+  *
+  * \return A buffer for the characters and a terminator, or NULL if the text doesn't fit.
+  */
+PWSTR H2ReserveOutput(
+    _In_ SIZE_T Characters
+)
+{
+    PH2_OUTPUT_BUFFER output = H2ThreadOutput;
+
+    if (!output)
+    {
+        if (H2ConsoleLength + Characters + 1 > H2_CONSOLE_BUFFER_SIZE)
+            H2FlushOutput();
+
+        if (Characters + 1 > H2_CONSOLE_BUFFER_SIZE)
+            return NULL;
+
+        return H2ConsoleBuffer + H2ConsoleLength;
+    }
+
+    // Grow the buffer geometrically to fit the text and the terminator
+    if (output->Length + Characters + 1 > output->Capacity)
+    {
+        SIZE_T capacity = max(output->Capacity * 2, output->Length + Characters + 1);
+        PWSTR buffer;
+
+        capacity = max(capacity, 0x200);
+
+        if (output->Buffer)
+            buffer = RtlReAllocateHeap(RtlProcessHeap(), 0, output->Buffer, capacity * sizeof(WCHAR));
+        else
+            buffer = RtlAllocateHeap(RtlProcessHeap(), 0, capacity * sizeof(WCHAR));
+
+        // Drop the text on allocation failures
+        if (!buffer)
+            return NULL;
+
+        output->Buffer = buffer;
+        output->Capacity = capacity;
+    }
+
+    return output->Buffer + output->Length;
+}
+
+/**
+  * \brief Completes appending text to the space from H2ReserveOutput.
+  *
+  * \param[in] Characters The number of characters written, excluding the terminator.
+  */
+VOID H2CommitOutput(
+    _In_ SIZE_T Characters
+)
+{
+    PH2_OUTPUT_BUFFER output = H2ThreadOutput;
+
+    if (output)
+    {
+        output->Length += Characters;
+        output->Buffer[output->Length] = UNICODE_NULL;
+    }
+    else
+    {
+        H2ConsoleLength += (ULONG)Characters;
+    }
+}
+
+/**
+  * \brief Outputs text to the console or the buffer of the current thread.
+  *
+  * \param[in] Text The text.
+  * \param[in] Length The number of characters in the text.
+  */
+VOID H2PrintText(
+    _In_reads_(Length) PCWCH Text,
+    _In_ SIZE_T Length
+)
+{
+    PWSTR buffer;
+
+    if (!Length)
+        return;
+
+    buffer = H2ReserveOutput(Length);
+
+    if (buffer)
+    {
+        memcpy(buffer, Text, Length * sizeof(WCHAR));
+        H2CommitOutput(Length);
+    }
+    else if (!H2ThreadOutput)
+    {
+        // Too long for the console buffer, which is already flushed
+        H2WriteOutputTarget(Text, Length);
+    }
+}
+
+/**
+  * \brief Outputs a zero-terminated string to the console or the buffer of the current thread.
+  *
+  * \param[in] String The string.
+  */
+VOID H2PrintString(
+    _In_ PCWSTR String
+)
+{
+    H2PrintText(String, wcslen(String));
+}
+
+/**
+  * \brief Outputs a counted string to the console or the buffer of the current thread.
+  *
+  * \param[in] String The string.
+  */
+VOID H2PrintUnicodeString(
+    _In_ PCUNICODE_STRING String
+)
+{
+    H2PrintText(String->Buffer, String->Length / sizeof(WCHAR));
+}
+
+/**
+  * \brief Formats an unsigned decimal number into the end of a buffer.
+  *
+  * \param[in] Value The number.
+  * \param[in] MinimumDigits The number of digits to pad to with zeros.
+  * \param[in] BufferEnd The end of a buffer with space for at least 20 digits.
+  *
+  * \return The start of the formatted number.
+  */
+PWCH H2FormatDecimal(
+    _In_ ULONG64 Value,
+    _In_ ULONG MinimumDigits,
+    _Inout_ PWCH BufferEnd
+)
+{
+    PWCH cursor = BufferEnd;
+
+    do
+    {
+        *--cursor = L'0' + (WCHAR)(Value % 10);
+        Value /= 10;
+    } while (Value || (ULONG)(BufferEnd - cursor) < MinimumDigits);
+
+    return cursor;
+}
+
+/**
+  * \brief Outputs an unsigned decimal number.
+  *
+  * \param[in] Value The number.
+  */
+VOID H2PrintUnsigned(
+    _In_ ULONG64 Value
+)
+{
+    WCHAR buffer[20];
+    PWCH start = H2FormatDecimal(Value, 0, buffer + ARRAYSIZE(buffer));
+
+    H2PrintText(start, buffer + ARRAYSIZE(buffer) - start);
+}
+
+/**
+  * \brief Outputs a signed decimal number.
+  *
+  * \param[in] Value The number.
+  */
+VOID H2PrintSigned(
+    _In_ LONG64 Value
+)
+{
+    WCHAR buffer[21];
+    PWCH start = H2FormatDecimal(Value < 0 ? 0 - (ULONG64)Value : (ULONG64)Value, 0, buffer + ARRAYSIZE(buffer));
+
+    if (Value < 0)
+        *--start = L'-';
+
+    H2PrintText(start, buffer + ARRAYSIZE(buffer) - start);
+}
+
+/**
+  * \brief Outputs an uppercase hexadecimal number without a prefix.
+  *
+  * \param[in] Value The number.
+  * \param[in] MinimumDigits The number of digits to pad to with zeros.
+  */
+VOID H2PrintHexadecimal(
+    _In_ ULONG64 Value,
+    _In_ ULONG MinimumDigits
+)
+{
+    WCHAR buffer[16];
+    PWCH cursor = buffer + ARRAYSIZE(buffer);
+
+    MinimumDigits = min(MinimumDigits, ARRAYSIZE(buffer));
+
+    do
+    {
+        *--cursor = L"0123456789ABCDEF"[Value & 0xF];
+        Value >>= 4;
+    } while (Value || (ULONG)(buffer + ARRAYSIZE(buffer) - cursor) < MinimumDigits);
+
+    H2PrintText(cursor, buffer + ARRAYSIZE(buffer) - cursor);
+}
+
+/**
+  * \brief Outputs text escaped for use inside a JSON string, without the quotes.
+  *
+  * \param[in] Text The text.
+  * \param[in] Length The number of characters in the text.
+  */
+VOID H2PrintJsonEscaped(
+    _In_reads_(Length) PCWCH Text,
+    _In_ SIZE_T Length
+)
+{
+    SIZE_T runStart = 0;
+    WCHAR escape[6] = { L'\\', L'u', L'0', L'0' };
+
+    for (SIZE_T i = 0; i < Length; i++)
+    {
+        if (Text[i] >= L' ' && Text[i] != L'"' && Text[i] != L'\\')
+            continue;
+
+        // Write the characters that need no escaping at once
+        H2PrintText(Text + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (Text[i])
         {
-            if (minutes && seconds)
-                wprintf_s(L"%u hours %u min %u sec", hours, minutes, seconds);
-            else if (minutes)
-                wprintf_s(L"%u hours %u min", hours, minutes);
-            else if (seconds)
-                wprintf_s(L"%u hours %u sec", hours, seconds);
-            else
-                wprintf_s(L"%u hours", hours);
+        case L'"':
+            H2PrintText(L"\\\"", 2);
+            break;
+        case L'\\':
+            H2PrintText(L"\\\\", 2);
+            break;
+        case L'\r':
+            H2PrintText(L"\\r", 2);
+            break;
+        case L'\n':
+            H2PrintText(L"\\n", 2);
+            break;
+        case L'\t':
+            H2PrintText(L"\\t", 2);
+            break;
+        default:
+            escape[4] = L"0123456789abcdef"[Text[i] >> 4];
+            escape[5] = L"0123456789abcdef"[Text[i] & 0xF];
+            H2PrintText(escape, ARRAYSIZE(escape));
         }
-        else
+    }
+
+    H2PrintText(Text + runStart, Length - runStart);
+}
+
+/**
+  * \brief Outputs formatted text to the console or the buffer of the current thread.
+  *
+  * \param[in] Format The format string.
+  */
+VOID __cdecl H2Print(
+    _In_z_ _Printf_format_string_ PCWSTR Format,
+    ...
+)
+{
+    va_list args;
+    va_list argsCopy;
+    LONG characters;
+    PWSTR buffer;
+
+    va_start(args, Format);
+
+    // Measuring consumes the arguments
+    va_copy(argsCopy, args);
+    characters = _vscwprintf(Format, argsCopy);
+    va_end(argsCopy);
+
+    if (characters <= 0)
+        goto CLEANUP;
+
+    buffer = H2ReserveOutput(characters);
+
+    if (buffer)
+    {
+        H2CommitOutput(vswprintf_s(buffer, characters + 1, Format, args));
+    }
+    else if (!H2ThreadOutput)
+    {
+        // Too long for the console buffer, which is already flushed
+        buffer = RtlAllocateHeap(RtlProcessHeap(), 0, (characters + 1) * sizeof(WCHAR));
+
+        if (buffer)
         {
-            if (hours && minutes)
-                wprintf_s(L"%I64u days %u hours %u min", days, hours, minutes);
-            else if (hours)
-                wprintf_s(L"%I64u days %u hours", days, hours);
-            else if (minutes)
-                wprintf_s(L"%I64u days %u minutes", days, minutes);
-            else
-                wprintf_s(L"%I64u days", days);
+            H2WriteOutputTarget(buffer, vswprintf_s(buffer, characters + 1, Format, args));
+            RtlFreeHeap(RtlProcessHeap(), 0, buffer);
         }
     }
+
+CLEANUP:
+    va_end(args);
+}
+
+/**
+  * \brief Writes the content of an output buffer to the console and empties it.
+  *
+  * \param[in,out] Output The buffer.
+  */
+VOID H2FlushOutputBuffer(
+    _Inout_ PH2_OUTPUT_BUFFER Output
+)
+{
+    PH2_OUTPUT_BUFFER previous = H2SetThreadOutput(NULL);
+
+    H2PrintText(Output->Buffer, Output->Length);
+    H2SetThreadOutput(previous);
+    Output->Length = 0;
+}
+
+/**
+  * \brief Releases the memory used by an output buffer.
+  *
+  * \param[in,out] Output The buffer.
+  */
+VOID H2FreeOutputBuffer(
+    _Inout_ PH2_OUTPUT_BUFFER Output
+)
+{
+    if (Output->Buffer)
+        RtlFreeHeap(RtlProcessHeap(), 0, Output->Buffer);
+
+    memset(Output, 0, sizeof(H2_OUTPUT_BUFFER));
+}
+
+/**
+  * \brief Sends the output to a UTF-8 file instead of the console.
+  *
+  * \param[in] FileName The name of the file to create or overwrite.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2OpenOutputFile(
+    _In_ PCWSTR FileName
+)
+{
+    H2FlushOutput();
+    return H2OpenFile(&H2OutputFileHandle, FileName, FILE_WRITE_DATA, FILE_SHARE_READ, FILE_OVERWRITE_IF);
+}
+
+/**
+  * \brief Writes the pending output to the output file and closes it.
+  *
+  * \return The first error from writing to the file, if any.
+  */
+NTSTATUS H2CloseOutputFile(
+    VOID
+)
+{
+    H2FlushOutput();
+
+    if (H2OutputFileHandle)
+    {
+        NtClose(H2OutputFileHandle);
+        H2OutputFileHandle = NULL;
+    }
+
+    return H2OutputFileStatus;
+}
+
+/**
+  * \brief Forwards formatted text to the console.
+  *
+  * \param[in] Printer The console printer.
+  * \param[in] Text The text.
+  * \param[in] Length The number of characters in the text.
+  */
+VOID H2ConsolePrinterWrite(
+    _In_ PH2_PRINTER Printer,
+    _In_reads_(Length) const H2_CHAR* Text,
+    _In_ size_t Length
+)
+{
+    UNREFERENCED_PARAMETER(Printer);
+    H2PrintText(Text, Length);
+}
+
+/**
+  * \brief Prepares a printer that formats text for the console (or the output file) of the current thread.
+  *
+  * \param[out] Printer The printer to initialize.
+  * \param[in] Raw Whether to print raw (machine-readable) property names and values.
+  * \param[in] Json Whether to print properties as members of a JSON object.
+  */
+VOID H2InitializeConsolePrinter(
+    _Out_ PH2_PRINTER Printer,
+    _In_ BOOLEAN Raw,
+    _In_ BOOLEAN Json
+)
+{
+    Printer->Write = H2ConsolePrinterWrite;
+    Printer->Context = NULL;
+    Printer->SystemTime = ((PLARGE_INTEGER)&USER_SHARED_DATA->SystemTime)->QuadPart;
+    Printer->TimeZoneBias = ((PLARGE_INTEGER)&USER_SHARED_DATA->TimeZoneBias)->QuadPart;
+    Printer->Raw = Raw;
+    Printer->Json = Json;
+}
+
+/**
+  * \brief Outputs a time duration value to the console.
+  *
+  * \param[in] TimeSpan The time duration in 100-ns intervals.
+  */
+VOID H2PrintTimeSpan(
+    _In_ ULONG64 TimeSpan
+)
+{
+    H2_PRINTER printer;
+
+    H2InitializeConsolePrinter(&printer, FALSE, FALSE);
+    H2WriteTimeSpan(&printer, TimeSpan);
 }
 
 /**
   * \brief Outputs a date and time value to the console.
   *
-  * \param[in] TimeStamp A native Windows tume (the number of 100-ns intervals since Jan 1, 1600).
+  * \param[in] TimeStamp A native Windows time (the number of 100-ns intervals since Jan 1, 1601).
   */
 VOID H2PrintTimeStamp(
     _In_ ULONG64 TimeStamp
 )
 {
-    time_t unixTime;
-    WCHAR buffer[20] = { 0 };
-    PLARGE_INTEGER timeZoneBias;
-
-    // Adjust for the current timezone
-    timeZoneBias = (PLARGE_INTEGER)(&USER_SHARED_DATA->TimeZoneBias);
-    unixTime = (TimeStamp - timeZoneBias->QuadPart) / TICKS_PER_SEC - SecondsToStartOf1970;
+    H2_PRINTER printer;
 
-    // Convert to calendar time
-    struct tm calendarTime;
-    gmtime_s(&calendarTime, &unixTime);
-
-    // Construct the string
-    wcsftime(buffer, sizeof(buffer) / sizeof(WCHAR), L"%F %T", &calendarTime);
-    wprintf_s(L"%s", buffer);
+    H2InitializeConsolePrinter(&printer, FALSE, FALSE);
+    H2WriteTimeStamp(&printer, (LONG64)TimeStamp);
 }
 
 /**
@@ -104,26 +553,10 @@ VOID H2PrintByteSize(
     _In_ ULONG64 Bytes
 )
 {
-    if (Bytes < BYTES_PER_KB)
-        wprintf_s(L"%I64u bytes", Bytes);
-    else if (Bytes < BYTES_PER_KB * 10 && (Bytes % BYTES_PER_KB != 0))
-        wprintf_s(L"%0.2f KiB", (float)(Bytes * 100 / BYTES_PER_KB) / 100);
-    else if (Bytes < BYTES_PER_KB * 100 && (Bytes % BYTES_PER_KB != 0))
-        wprintf_s(L"%0.1f KiB", (float)(Bytes * 10 / BYTES_PER_KB) / 10);
-    else if (Bytes < BYTES_PER_MB)
-        wprintf_s(L"%I64u KiB", Bytes / BYTES_PER_KB);
-    else if (Bytes < BYTES_PER_MB * 10 && (Bytes % BYTES_PER_MB != 0))
-        wprintf_s(L"%0.2f MiB", (float)(Bytes * 100 / BYTES_PER_MB) / 100);
-    else if (Bytes < BYTES_PER_MB * 100 && (Bytes % BYTES_PER_MB != 0))
-        wprintf_s(L"%0.1f MiB", (float)(Bytes * 10 / BYTES_PER_MB) / 10);
-    else if (Bytes < BYTES_PER_GB)
-        wprintf_s(L"%I64u MiB", Bytes / BYTES_PER_MB);
-    else if (Bytes < BYTES_PER_GB * 10 && (Bytes % BYTES_PER_GB != 0))
-        wprintf_s(L"%0.2f GiB", (float)(Bytes * 100 / BYTES_PER_GB) / 100);
-    else if (Bytes < BYTES_PER_GB * 100 && (Bytes % BYTES_PER_GB != 0))
-        wprintf_s(L"%0.1f GiB", (float)(Bytes * 10 / BYTES_PER_GB) / 10);
-    else
-        wprintf_s(L"%I64u GiB", Bytes / BYTES_PER_GB);
+    H2_PRINTER printer;
+
+    H2InitializeConsolePrinter(&printer, FALSE, FALSE);
+    H2WriteByteSize(&printer, Bytes);
 }
 
 /**
@@ -135,19 +568,10 @@ VOID H2PrintGuid(
     _In_ PGUID Guid
 )
 {
-    wprintf_s(L"{%08lX-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}",
-        Guid->Data1,
-        Guid->Data2,
-        Guid->Data3,
-        Guid->Data4[0],
-        Guid->Data4[1],
-        Guid->Data4[2],
-        Guid->Data4[3],
-        Guid->Data4[4],
-        Guid->Data4[5],
-        Guid->Data4[6],
-        Guid->Data4[7]
-    );
+    H2_PRINTER printer;
+
+    H2InitializeConsolePrinter(&printer, FALSE, FALSE);
+    H2WriteGuid(&printer, (const H2_GUID*)Guid);
 }
 
 /**
@@ -241,9 +665,9 @@ VOID H2PrintStatusWithDescription(
     UNICODE_STRING message;
 
     if (NT_SUCCESS(H2FindStatusDescription(Status, &message)))
-        wprintf_s(L"0x%0.8X (%wZ)", Status, &message);
+        H2Print(L"0x%0.8X (%wZ)", Status, &message);
     else
-        wprintf_s(L"0x%0.8X (no description available)", Status);
+        H2Print(L"0x%0.8X (no description available)", Status);
 }
 
 /**
@@ -13,14 +13,114 @@
 
 #include <phnt_windows.h>
 #include <phnt.h>
+#include "text_format.h"
 
-#define NS_PER_TICK                 100ull
-#define TICKS_PER_US                 10ull
-#define TICKS_PER_MS             10'000ull
-#define TICKS_PER_SEC        10'000'000ull
-#define TICKS_PER_MIN       600'000'000ull
-#define TICKS_PER_HOUR   36'000'000'000ull
-#define TICKS_PER_DAY   864'000'000'000ull
+// A growable buffer that collects the output of a worker thread
+typedef struct _H2_OUTPUT_BUFFER
+{
+    PWSTR Buffer;
+    SIZE_T Length; // in characters, excluding the terminator
+    SIZE_T Capacity; // in characters
+} H2_OUTPUT_BUFFER, *PH2_OUTPUT_BUFFER;
+
+// The number of characters each thread collects before writing them to the console
+#define H2_CONSOLE_BUFFER_SIZE 0x2000
+
+PH2_OUTPUT_BUFFER
+NTAPI
+H2SetThreadOutput(
+    _In_opt_ PH2_OUTPUT_BUFFER Output
+);
+
+VOID
+__cdecl
+H2Print(
+    _In_z_ _Printf_format_string_ PCWSTR Format,
+    ...
+);
+
+VOID
+NTAPI
+H2PrintText(
+    _In_reads_(Length) PCWCH Text,
+    _In_ SIZE_T Length
+);
+
+VOID
+NTAPI
+H2PrintString(
+    _In_ PCWSTR String
+);
+
+VOID
+NTAPI
+H2PrintUnicodeString(
+    _In_ PCUNICODE_STRING String
+);
+
+VOID
+NTAPI
+H2PrintUnsigned(
+    _In_ ULONG64 Value
+);
+
+VOID
+NTAPI
+H2PrintSigned(
+    _In_ LONG64 Value
+);
+
+VOID
+NTAPI
+H2PrintHexadecimal(
+    _In_ ULONG64 Value,
+    _In_ ULONG MinimumDigits
+);
+
+VOID
+NTAPI
+H2PrintJsonEscaped(
+    _In_reads_(Length) PCWCH Text,
+    _In_ SIZE_T Length
+);
+
+VOID
+NTAPI
+H2FlushOutput(
+    VOID
+);
+
+VOID
+NTAPI
+H2FlushOutputBuffer(
+    _Inout_ PH2_OUTPUT_BUFFER Output
+);
+
+VOID
+NTAPI
+H2FreeOutputBuffer(
+    _Inout_ PH2_OUTPUT_BUFFER Output
+);
+
+NTSTATUS
+NTAPI
+H2OpenOutputFile(
+    _In_ PCWSTR FileName
+);
+
+NTSTATUS
+NTAPI
+H2CloseOutputFile(
+    VOID
+);
+
+VOID
+NTAPI
+H2InitializeConsolePrinter(
+    _Out_ PH2_PRINTER Printer,
+    _In_ BOOLEAN Raw,
+    _In_ BOOLEAN Json
+);
 
 VOID
 NTAPI
@@ -34,10 +134,6 @@ H2PrintTimeStamp(
     _In_ ULONG64 TimeStamp
 );
 
-#define BYTES_PER_KB            1'024ull
-#define BYTES_PER_MB        1'048'576ull
-#define BYTES_PER_GB    1'073'741'824ull
-
 VOID
 NTAPI
 H2PrintByteSize(
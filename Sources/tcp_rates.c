@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "tcp_rates.h"
+#include "string_helpers.h"
+
+// The bytes per socket of all sample columns
+#define H2_TCP_SAMPLES_STRIDE (4 * sizeof(ULONG64) + 5 * sizeof(ULONG) + sizeof(UCHAR))
+
+// The bytes per socket of all rate columns
+#define H2_TCP_RATES_STRIDE (6 * sizeof(ULONG64) + 6 * sizeof(ULONG) + sizeof(UCHAR))
+
+/**
+  * \brief Allocates columns for samples of sockets. No socket has a sample initially.
+  *
+  * \param[out] Samples The samples to initialize. The caller must release them via H2FreeTcpSamples.
+  * \param[in] Count The number of sockets.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2AllocateTcpSamples(
+    _Out_ PH2_TCP_SAMPLES Samples,
+    _In_ ULONG Count
+)
+{
+    PUCHAR buffer;
+
+    memset(Samples, 0, sizeof(H2_TCP_SAMPLES));
+
+    // All columns share one allocation; wider ones go first to stay aligned
+    buffer = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, max(Count, 1) * H2_TCP_SAMPLES_STRIDE);
+
+    if (!buffer)
+        return STATUS_NO_MEMORY;
+
+    Samples->Count = Count;
+    Samples->Time = (PULONG64)buffer;
+    Samples->BytesIn = Samples->Time + Count;
+    Samples->BytesOut = Samples->BytesIn + Count;
+    Samples->BytesRetrans = Samples->BytesOut + Count;
+    Samples->FastRetrans = (PULONG)(Samples->BytesRetrans + Count);
+    Samples->TimeoutEpisodes = Samples->FastRetrans + Count;
+    Samples->SndLimTimeRwin = Samples->TimeoutEpisodes + Count;
+    Samples->SndLimTimeCwnd = Samples->SndLimTimeRwin + Count;
+    Samples->SndLimTimeSnd = Samples->SndLimTimeCwnd + Count;
+    Samples->Flags = (PUCHAR)(Samples->SndLimTimeSnd + Count);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Releases samples of sockets.
+  *
+  * \param[in,out] Samples The samples.
+  */
+VOID H2FreeTcpSamples(
+    _Inout_ PH2_TCP_SAMPLES Samples
+)
+{
+    // The first column starts the shared allocation
+    if (Samples->Time)
+        RtlFreeHeap(RtlProcessHeap(), 0, Samples->Time);
+
+    memset(Samples, 0, sizeof(H2_TCP_SAMPLES));
+}
+
+/**
+  * \brief Reads a high-resolution timestamp for a sample.
+  *
+  * \return The time in 100ns units.
+  */
+ULONG64 H2QueryTcpSampleTime(
+    VOID
+)
+{
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+
+    RtlQueryPerformanceCounter(&counter);
+    RtlQueryPerformanceFrequency(&frequency);
+
+    return (counter.QuadPart / frequency.QuadPart) * TICKS_PER_SEC +
+        (counter.QuadPart % frequency.QuadPart) * TICKS_PER_SEC / frequency.QuadPart;
+}
+
+/**
+  * \brief Records the counters of a socket.
+  *
+  * \param[in,out] Samples The samples.
+  * \param[in] Index The index of the socket.
+  * \param[in] Time The time of the query in 100ns units.
+  * \param[in] TcpInfo The TCP information of the socket.
+  * \param[in] TcpInfoVersion The version of the TCP information.
+  */
+VOID H2SetTcpSample(
+    _Inout_ PH2_TCP_SAMPLES Samples,
+    _In_ ULONG Index,
+    _In_ ULONG64 Time,
+    _In_ PTCP_INFO_v2 TcpInfo,
+    _In_ ULONG TcpInfoVersion
+)
+{
+    Samples->Time[Index] = Time;
+    Samples->BytesIn[Index] = TcpInfo->BytesIn;
+    Samples->BytesOut[Index] = TcpInfo->BytesOut;
+    Samples->BytesRetrans[Index] = TcpInfo->BytesRetrans;
+    Samples->FastRetrans[Index] = TcpInfo->FastRetrans;
+    Samples->TimeoutEpisodes[Index] = TcpInfo->TimeoutEpisodes;
+    Samples->Flags[Index] = H2_TCP_SAMPLE_COUNTERS;
+
+    if (TcpInfoVersion >= 1)
+    {
+        Samples->SndLimTimeRwin[Index] = TcpInfo->SndLimTimeRwin;
+        Samples->SndLimTimeCwnd[Index] = TcpInfo->SndLimTimeCwnd;
+        Samples->SndLimTimeSnd[Index] = TcpInfo->SndLimTimeSnd;
+        Samples->Flags[Index] |= H2_TCP_SAMPLE_LIMITS;
+    }
+}
+
+/**
+  * \brief Reorders samples to match a different order of sockets.
+  *
+  * \param[in] Source The samples to copy from.
+  * \param[in] SourceIndexes For each socket of the destination, its index in the source or H2_TCP_NO_SAMPLE.
+  * \param[in,out] Destination The samples to copy to.
+  */
+VOID H2GatherTcpSamples(
+    _In_ PH2_TCP_SAMPLES Source,
+    _In_reads_(Destination->Count) PULONG SourceIndexes,
+    _Inout_ PH2_TCP_SAMPLES Destination
+)
+{
+    for (ULONG i = 0; i < Destination->Count; i++)
+    {
+        ULONG index = SourceIndexes[i];
+
+        if (index >= Source->Count)
+        {
+            Destination->Flags[i] = 0;
+            continue;
+        }
+
+        Destination->Time[i] = Source->Time[index];
+        Destination->BytesIn[i] = Source->BytesIn[index];
+        Destination->BytesOut[i] = Source->BytesOut[index];
+        Destination->BytesRetrans[i] = Source->BytesRetrans[index];
+        Destination->FastRetrans[i] = Source->FastRetrans[index];
+        Destination->TimeoutEpisodes[i] = Source->TimeoutEpisodes[index];
+        Destination->SndLimTimeRwin[i] = Source->SndLimTimeRwin[index];
+        Destination->SndLimTimeCwnd[i] = Source->SndLimTimeCwnd[index];
+        Destination->SndLimTimeSnd[i] = Source->SndLimTimeSnd[index];
+        Destination->Flags[i] = Source->Flags[index];
+    }
+}
+
+/**
+  * \brief Allocates columns for rates of sockets.
+  *
+  * \param[out] Rates The rates to initialize. The caller must release them via H2FreeTcpRates.
+  * \param[in] Count The number of sockets.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2AllocateTcpRates(
+    _Out_ PH2_TCP_RATES Rates,
+    _In_ ULONG Count
+)
+{
+    PUCHAR buffer;
+
+    memset(Rates, 0, sizeof(H2_TCP_RATES));
+
+    // All columns share one allocation; wider ones go first to stay aligned
+    buffer = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, max(Count, 1) * H2_TCP_RATES_STRIDE);
+
+    if (!buffer)
+        return STATUS_NO_MEMORY;
+
+    Rates->Count = Count;
+    Rates->Interval = (PULONG64)buffer;
+    Rates->BytesIn = Rates->Interval + Count;
+    Rates->BytesOut = Rates->BytesIn + Count;
+    Rates->BytesRetrans = Rates->BytesOut + Count;
+    Rates->ReceiveGoodput = Rates->BytesRetrans + Count;
+    Rates->SendGoodput = Rates->ReceiveGoodput + Count;
+    Rates->RetransmitRatio = (PULONG)(Rates->SendGoodput + Count);
+    Rates->FastRetrans = Rates->RetransmitRatio + Count;
+    Rates->TimeoutEpisodes = Rates->FastRetrans + Count;
+    Rates->ReceiverLimited = Rates->TimeoutEpisodes + Count;
+    Rates->CongestionLimited = Rates->ReceiverLimited + Count;
+    Rates->SenderLimited = Rates->CongestionLimited + Count;
+    Rates->Flags = (PUCHAR)(Rates->SenderLimited + Count);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Releases rates of sockets.
+  *
+  * \param[in,out] Rates The rates.
+  */
+VOID H2FreeTcpRates(
+    _Inout_ PH2_TCP_RATES Rates
+)
+{
+    // The first column starts the shared allocation
+    if (Rates->Interval)
+        RtlFreeHeap(RtlProcessHeap(), 0, Rates->Interval);
+
+    memset(Rates, 0, sizeof(H2_TCP_RATES));
+}
+
+/**
+  * \brief Divides an amount by a time interval without overflowing on long intervals.
+  *
+  * \param[in] Amount The amount.
+  * \param[in] Interval The interval in 100ns units; must be non-zero.
+  *
+  * \return The amount per second.
+  */
+FORCEINLINE ULONG64 H2TcpRatesPerSecond(
+    _In_ ULONG64 Amount,
+    _In_ ULONG64 Interval
+)
+{
+    return (Amount / Interval) * TICKS_PER_SEC + (Amount % Interval) * TICKS_PER_SEC / Interval;
+}
+
+/**
+  * \brief Subtracts one column of 64-bit counters from another for sockets with the specified flags.
+  *
+  * \param[in] Count The number of sockets.
+  * \param[in] Flags The flags of sockets.
+  * \param[in] Required The flags a socket needs to get a difference instead of zero.
+  * \param[in] Current The later counters.
+  * \param[in] Previous The earlier counters.
+  * \param[out] Difference The differences.
+  */
+FORCEINLINE VOID H2TcpRatesSubtract64(
+    _In_ ULONG Count,
+    _In_reads_(Count) const UCHAR* __restrict Flags,
+    _In_ UCHAR Required,
+    _In_reads_(Count) const ULONG64* __restrict Current,
+    _In_reads_(Count) const ULONG64* __restrict Previous,
+    _Out_writes_(Count) ULONG64* __restrict Difference
+)
+{
+    for (ULONG i = 0; i < Count; i++)
+        Difference[i] = (Flags[i] & Required) ? Current[i] - Previous[i] : 0;
+}
+
+/**
+  * \brief Subtracts one column of 32-bit counters from another for sockets with the specified flags.
+  *
+  * \param[in] Count The number of sockets.
+  * \param[in] Flags The flags of sockets.
+  * \param[in] Required The flags a socket needs to get a difference instead of zero.
+  * \param[in] Current The later counters.
+  * \param[in] Previous The earlier counters.
+  * \param[out] Difference The differences.
+  */
+FORCEINLINE VOID H2TcpRatesSubtract32(
+    _In_ ULONG Count,
+    _In_reads_(Count) const UCHAR* __restrict Flags,
+    _In_ UCHAR Required,
+    _In_reads_(Count) const ULONG* __restrict Current,
+    _In_reads_(Count) const ULONG* __restrict Previous,
+    _Out_writes_(Count) ULONG* __restrict Difference
+)
+{
+    for (ULONG i = 0; i < Count; i++)
+        Difference[i] = (Flags[i] & Required) ? Current[i] - Previous[i] : 0;
+}
+
+/**
+  * \brief Computes what happened to sockets between two samples.
+  *  Differences come from one branch-free loop per column, so compilers vectorize them across
+  *  sockets; the divisions come last, since SIMD instructions cannot divide integers.
+  *
+  * \param[in] Previous The earlier samples.
+  * \param[in] Current The later samples of the same sockets in the same order.
+  * \param[in,out] Rates The rates with the same number of sockets.
+  */
+VOID H2ComputeTcpRates(
+    _In_ PH2_TCP_SAMPLES Previous,
+    _In_ PH2_TCP_SAMPLES Current,
+    _Inout_ PH2_TCP_RATES Rates
+)
+{
+    ULONG count = Rates->Count;
+    PUCHAR flags = Rates->Flags;
+
+    for (ULONG i = 0; i < count; i++)
+    {
+        // Counters that go backwards belong to a different connection
+        flags[i] = ((Current->Time[i] <= Previous->Time[i]) |
+            (Current->BytesIn[i] < Previous->BytesIn[i]) |
+            (Current->BytesOut[i] < Previous->BytesOut[i]) |
+            (Current->BytesRetrans[i] < Previous->BytesRetrans[i])) ? 0 : Previous->Flags[i] & Current->Flags[i];
+    }
+
+    H2TcpRatesSubtract64(count, flags, H2_TCP_SAMPLE_COUNTERS, Current->Time, Previous->Time, Rates->Interval);
+    H2TcpRatesSubtract64(count, flags, H2_TCP_SAMPLE_COUNTERS, Current->BytesIn, Previous->BytesIn, Rates->BytesIn);
+    H2TcpRatesSubtract64(count, flags, H2_TCP_SAMPLE_COUNTERS, Current->BytesOut, Previous->BytesOut, Rates->BytesOut);
+    H2TcpRatesSubtract64(count, flags, H2_TCP_SAMPLE_COUNTERS, Current->BytesRetrans, Previous->BytesRetrans, Rates->BytesRetrans);
+    H2TcpRatesSubtract32(count, flags, H2_TCP_SAMPLE_COUNTERS, Current->FastRetrans, Previous->FastRetrans, Rates->FastRetrans);
+    H2TcpRatesSubtract32(count, flags, H2_TCP_SAMPLE_COUNTERS, Current->TimeoutEpisodes, Previous->TimeoutEpisodes, Rates->TimeoutEpisodes);
+
+    // Milliseconds for now; the last pass turns them into ratios
+    H2TcpRatesSubtract32(count, flags, H2_TCP_SAMPLE_LIMITS, Current->SndLimTimeRwin, Previous->SndLimTimeRwin, Rates->ReceiverLimited);
+    H2TcpRatesSubtract32(count, flags, H2_TCP_SAMPLE_LIMITS, Current->SndLimTimeCwnd, Previous->SndLimTimeCwnd, Rates->CongestionLimited);
+    H2TcpRatesSubtract32(count, flags, H2_TCP_SAMPLE_LIMITS, Current->SndLimTimeSnd, Previous->SndLimTimeSnd, Rates->SenderLimited);
+
+    for (ULONG i = 0; i < count; i++)
+    {
+        ULONG64 limited;
+
+        if (!flags[i])
+        {
+            Rates->ReceiveGoodput[i] = 0;
+            Rates->SendGoodput[i] = 0;
+            Rates->RetransmitRatio[i] = 0;
+            continue;
+        }
+
+        // Retransmitted bytes count as sent, but they don't deliver anything new
+        Rates->ReceiveGoodput[i] = H2TcpRatesPerSecond(Rates->BytesIn[i], Rates->Interval[i]);
+        Rates->SendGoodput[i] = Rates->BytesOut[i] > Rates->BytesRetrans[i] ?
+            H2TcpRatesPerSecond(Rates->BytesOut[i] - Rates->BytesRetrans[i], Rates->Interval[i]) : 0;
+        Rates->RetransmitRatio[i] = Rates->BytesOut[i] ?
+            (ULONG)(min(Rates->BytesRetrans[i], Rates->BytesOut[i]) * H2_TCP_RATIO_SCALE / Rates->BytesOut[i]) : 0;
+
+        // The sender is always limited by something while it has data to send
+        limited = (ULONG64)Rates->ReceiverLimited[i] + Rates->CongestionLimited[i] + Rates->SenderLimited[i];
+
+        if (limited)
+        {
+            Rates->ReceiverLimited[i] = (ULONG)((ULONG64)Rates->ReceiverLimited[i] * H2_TCP_RATIO_SCALE / limited);
+            Rates->CongestionLimited[i] = (ULONG)((ULONG64)Rates->CongestionLimited[i] * H2_TCP_RATIO_SCALE / limited);
+            Rates->SenderLimited[i] = (ULONG)((ULONG64)Rates->SenderLimited[i] * H2_TCP_RATIO_SCALE / limited);
+        }
+        else
+        {
+            // Idle, or TCP_INFO v1 is not available
+            flags[i] &= ~H2_TCP_SAMPLE_LIMITS;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _TCP_RATES_H
+#define _TCP_RATES_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "ntafd.h"
+#include <mstcpip.h>
+
+//
+// TCP_INFO reports counters accumulated over the life of a connection. Rates come from two
+// samples of the same sockets: samples keep one array per counter (indexed by socket), so
+// computing rates for many sockets walks each array linearly. Computing rates makes no system
+// calls and only depends on the arrays it receives.
+//
+
+// Flags of samples and rates
+#define H2_TCP_SAMPLE_COUNTERS 0x01 // Byte and retransmission counters from TCP_INFO v0
+#define H2_TCP_SAMPLE_LIMITS 0x02 // Sender-limited times from TCP_INFO v1
+
+// Marks sockets without a previous sample when gathering
+#define H2_TCP_NO_SAMPLE MAXULONG
+
+// Ratios are in basis points (hundredths of a percent)
+#define H2_TCP_RATIO_SCALE 10000
+
+// Counters of TCP_INFO for many sockets at one point in time
+typedef struct _H2_TCP_SAMPLES
+{
+    ULONG Count;
+    PUCHAR Flags; // H2_TCP_SAMPLE_*; zero for sockets without a sample
+    PULONG64 Time; // In 100ns units
+    PULONG64 BytesIn;
+    PULONG64 BytesOut;
+    PULONG64 BytesRetrans;
+    PULONG FastRetrans;
+    PULONG TimeoutEpisodes;
+    PULONG SndLimTimeRwin; // In milliseconds
+    PULONG SndLimTimeCwnd;
+    PULONG SndLimTimeSnd;
+} H2_TCP_SAMPLES, *PH2_TCP_SAMPLES;
+
+// What happened to many sockets between two samples
+typedef struct _H2_TCP_RATES
+{
+    ULONG Count;
+    PUCHAR Flags; // H2_TCP_SAMPLE_* that both samples share and that hold steady
+    PULONG64 Interval; // In 100ns units
+    PULONG64 BytesIn;
+    PULONG64 BytesOut;
+    PULONG64 BytesRetrans;
+    PULONG64 ReceiveGoodput; // Bytes per second
+    PULONG64 SendGoodput; // Bytes per second, excluding retransmissions
+    PULONG RetransmitRatio; // Of sent bytes
+    PULONG FastRetrans;
+    PULONG TimeoutEpisodes;
+    PULONG ReceiverLimited; // Of the time the sender was limited
+    PULONG CongestionLimited;
+    PULONG SenderLimited;
+} H2_TCP_RATES, *PH2_TCP_RATES;
+
+NTSTATUS
+NTAPI
+H2AllocateTcpSamples(
+    _Out_ PH2_TCP_SAMPLES Samples,
+    _In_ ULONG Count
+);
+
+VOID
+NTAPI
+H2FreeTcpSamples(
+    _Inout_ PH2_TCP_SAMPLES Samples
+);
+
+ULONG64
+NTAPI
+H2QueryTcpSampleTime(
+    VOID
+);
+
+VOID
+NTAPI
+H2SetTcpSample(
+    _Inout_ PH2_TCP_SAMPLES Samples,
+    _In_ ULONG Index,
+    _In_ ULONG64 Time,
+    _In_ PTCP_INFO_v2 TcpInfo,
+    _In_ ULONG TcpInfoVersion
+);
+
+VOID
+NTAPI
+H2GatherTcpSamples(
+    _In_ PH2_TCP_SAMPLES Source,
+    _In_reads_(Destination->Count) PULONG SourceIndexes,
+    _Inout_ PH2_TCP_SAMPLES Destination
+);
+
+NTSTATUS
+NTAPI
+H2AllocateTcpRates(
+    _Out_ PH2_TCP_RATES Rates,
+    _In_ ULONG Count
+);
+
+VOID
+NTAPI
+H2FreeTcpRates(
+    _Inout_ PH2_TCP_RATES Rates
+);
+
+VOID
+NTAPI
+H2ComputeTcpRates(
+    _In_ PH2_TCP_SAMPLES Previous,
+    _In_ PH2_TCP_SAMPLES Current,
+    _Inout_ PH2_TCP_RATES Rates
+);
+
+#endif
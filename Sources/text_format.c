@@ -0,0 +1,498 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "text_format.h"
+
+// The number of days between Jan 1, 1601 and Jan 1, 1970
+#define H2_DAYS_BEFORE_1970 134774
+
+/**
+  * \brief Outputs text to a printer.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Text The text.
+  * \param[in] Length The number of characters in the text.
+  */
+void H2WriteText(
+    _In_ PH2_PRINTER Printer,
+    _In_reads_(Length) const H2_CHAR* Text,
+    _In_ size_t Length
+)
+{
+    if (Length)
+        Printer->Write(Printer, Text, Length);
+}
+
+/**
+  * \brief Outputs a zero-terminated string to a printer.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] String The string.
+  */
+void H2WriteString(
+    _In_ PH2_PRINTER Printer,
+    _In_ const H2_CHAR* String
+)
+{
+    size_t length = 0;
+
+    while (String[length])
+        length++;
+
+    H2WriteText(Printer, String, length);
+}
+
+/**
+  * \brief Formats an unsigned decimal number into the end of a buffer.
+  *
+  * \param[in] Value The number.
+  * \param[in] MinimumDigits The number of digits to pad to with zeros.
+  * \param[in] BufferEnd The end of a buffer with space for at least 20 digits.
+  *
+  * \return The start of the formatted number.
+  */
+H2_CHAR* H2WriteDecimalToBuffer(
+    _In_ H2_ULONG64 Value,
+    _In_ H2_ULONG MinimumDigits,
+    _Inout_ H2_CHAR* BufferEnd
+)
+{
+    H2_CHAR* cursor = BufferEnd;
+
+    do
+    {
+        *--cursor = (H2_CHAR)('0' + Value % 10);
+        Value /= 10;
+    } while (Value || (H2_ULONG)(BufferEnd - cursor) < MinimumDigits);
+
+    return cursor;
+}
+
+/**
+  * \brief Outputs an unsigned decimal number.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Value The number.
+  */
+void H2WriteUnsigned(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 Value
+)
+{
+    H2_CHAR buffer[20];
+    H2_CHAR* start = H2WriteDecimalToBuffer(Value, 0, buffer + 20);
+
+    H2WriteText(Printer, start, buffer + 20 - start);
+}
+
+/**
+  * \brief Outputs a signed decimal number.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Value The number.
+  */
+void H2WriteSigned(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_LONG64 Value
+)
+{
+    H2_CHAR buffer[21];
+    H2_CHAR* start = H2WriteDecimalToBuffer(Value < 0 ? 0 - (H2_ULONG64)Value : (H2_ULONG64)Value, 0, buffer + 21);
+
+    if (Value < 0)
+        *--start = '-';
+
+    H2WriteText(Printer, start, buffer + 21 - start);
+}
+
+/**
+  * \brief Outputs an uppercase hexadecimal number without a prefix.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Value The number.
+  * \param[in] MinimumDigits The number of digits to pad to with zeros.
+  */
+void H2WriteHexadecimal(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 Value,
+    _In_ H2_ULONG MinimumDigits
+)
+{
+    H2_CHAR buffer[16];
+    H2_CHAR* cursor = buffer + 16;
+
+    if (MinimumDigits > 16)
+        MinimumDigits = 16;
+
+    do
+    {
+        *--cursor = "0123456789ABCDEF"[Value & 0xF];
+        Value >>= 4;
+    } while (Value || (H2_ULONG)(buffer + 16 - cursor) < MinimumDigits);
+
+    H2WriteText(Printer, cursor, buffer + 16 - cursor);
+}
+
+/**
+  * \brief Outputs text escaped for use inside a JSON string, without the quotes.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Text The text.
+  * \param[in] Length The number of characters in the text.
+  */
+void H2WriteJsonEscaped(
+    _In_ PH2_PRINTER Printer,
+    _In_reads_(Length) const H2_CHAR* Text,
+    _In_ size_t Length
+)
+{
+    size_t runStart = 0;
+    H2_CHAR escape[6] = { '\\', 'u', '0', '0' };
+
+    for (size_t i = 0; i < Length; i++)
+    {
+        // Bytes of multi-byte UTF-8 sequences are above the space, too
+        if ((H2_ULONG)Text[i] >= ' ' && Text[i] != '"' && Text[i] != '\\')
+            continue;
+
+        // Write the characters that need no escaping at once
+        H2WriteText(Printer, Text + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (Text[i])
+        {
+        case '"':
+            H2WriteText(Printer, H2_T("\\\""), 2);
+            break;
+        case '\\':
+            H2WriteText(Printer, H2_T("\\\\"), 2);
+            break;
+        case '\r':
+            H2WriteText(Printer, H2_T("\\r"), 2);
+            break;
+        case '\n':
+            H2WriteText(Printer, H2_T("\\n"), 2);
+            break;
+        case '\t':
+            H2WriteText(Printer, H2_T("\\t"), 2);
+            break;
+        default:
+            escape[4] = "0123456789abcdef"[Text[i] >> 4];
+            escape[5] = "0123456789abcdef"[Text[i] & 0xF];
+            H2WriteText(Printer, escape, 6);
+        }
+    }
+
+    H2WriteText(Printer, Text + runStart, Length - runStart);
+}
+
+/**
+  * \brief Outputs a number followed by a unit.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Value The number.
+  * \param[in] Unit The unit, including the leading space.
+  * \param[in] Continues Whether to separate the quantity from the previous one with a space.
+  */
+void H2WriteQuantity(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 Value,
+    _In_ const H2_CHAR* Unit,
+    _In_ H2_BOOLEAN Continues
+)
+{
+    if (Continues)
+        H2WriteText(Printer, H2_T(" "), 1);
+
+    H2WriteUnsigned(Printer, Value);
+    H2WriteString(Printer, Unit);
+}
+
+/**
+  * \brief Outputs a time duration value.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] TimeSpan The time duration in 100-ns intervals.
+  */
+void H2WriteTimeSpan(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 TimeSpan
+)
+{
+    if (TimeSpan == 0)
+        H2WriteString(Printer, H2_T("None"));
+    else if (TimeSpan < TICKS_PER_MS)
+        H2WriteQuantity(Printer, TimeSpan / TICKS_PER_US, H2_T(" us"), FALSE);
+    else if (TimeSpan < TICKS_PER_SEC)
+        H2WriteQuantity(Printer, TimeSpan / TICKS_PER_MS, H2_T(" ms"), FALSE);
+    else if (TimeSpan < TICKS_PER_MIN)
+        H2WriteQuantity(Printer, TimeSpan / TICKS_PER_SEC, H2_T(" sec"), FALSE);
+    else
+    {
+        H2_ULONG seconds = (H2_ULONG)((TimeSpan / TICKS_PER_SEC) % 60);
+        H2_ULONG minutes = (H2_ULONG)((TimeSpan / TICKS_PER_MIN) % 60);
+        H2_ULONG hours = (H2_ULONG)((TimeSpan / TICKS_PER_HOUR) % 24);
+        H2_ULONG64 days = TimeSpan / TICKS_PER_DAY;
+
+        if (TimeSpan < TICKS_PER_HOUR)
+        {
+            H2WriteQuantity(Printer, minutes, H2_T(" min"), FALSE);
+
+            if (seconds)
+                H2WriteQuantity(Printer, seconds, H2_T(" sec"), TRUE);
+        }
+        else if (TimeSpan < TICKS_PER_DAY)
+        {
+            H2WriteQuantity(Printer, hours, H2_T(" hours"), FALSE);
+
+            if (minutes)
+                H2WriteQuantity(Printer, minutes, H2_T(" min"), TRUE);
+
+            if (seconds)
+                H2WriteQuantity(Printer, seconds, H2_T(" sec"), TRUE);
+        }
+        else
+        {
+            H2WriteQuantity(Printer, days, H2_T(" days"), FALSE);
+
+            if (hours)
+                H2WriteQuantity(Printer, hours, H2_T(" hours"), TRUE);
+
+            if (minutes)
+                H2WriteQuantity(Printer, minutes, hours ? H2_T(" min") : H2_T(" minutes"), TRUE);
+        }
+    }
+}
+
+/**
+  * \brief Outputs a date and time value in local time.
+  *
+  * \param[in] Printer The printer with the time zone bias.
+  * \param[in] TimeStamp A native Windows time (the number of 100-ns intervals since Jan 1, 1601).
+  */
+void H2WriteTimeStamp(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_LONG64 TimeStamp
+)
+{
+    H2_LONG64 localTime = TimeStamp - Printer->TimeZoneBias;
+    H2_LONG64 days;
+    H2_LONG64 era;
+    H2_ULONG64 secondOfDay;
+    H2_ULONG dayOfEra;
+    H2_ULONG yearOfEra;
+    H2_ULONG dayOfYear;
+    H2_ULONG shiftedMonth;
+    H2_LONG64 year;
+    H2_ULONG month;
+    H2_ULONG day;
+    H2_CHAR buffer[19];
+
+    // Times before 1601 show as its start
+    if (localTime < 0)
+        localTime = 0;
+
+    days = localTime / (H2_LONG64)TICKS_PER_DAY;
+    secondOfDay = ((H2_ULONG64)localTime % TICKS_PER_DAY) / TICKS_PER_SEC;
+
+    // Convert to calendar time, counting days from Mar 1, 0000 (719468 days before 1970) in 400-year eras
+    days += 719468 - H2_DAYS_BEFORE_1970;
+    era = days / 146097;
+    dayOfEra = (H2_ULONG)(days - era * 146097);
+    yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    shiftedMonth = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+
+    // Construct the "YYYY-MM-DD hh:mm:ss" string
+    H2WriteDecimalToBuffer(year > 9999 ? 9999 : (H2_ULONG64)year, 4, buffer + 4);
+    buffer[4] = '-';
+    H2WriteDecimalToBuffer(month, 2, buffer + 7);
+    buffer[7] = '-';
+    H2WriteDecimalToBuffer(day, 2, buffer + 10);
+    buffer[10] = ' ';
+    H2WriteDecimalToBuffer(secondOfDay / 3600, 2, buffer + 13);
+    buffer[13] = ':';
+    H2WriteDecimalToBuffer(secondOfDay / 60 % 60, 2, buffer + 16);
+    buffer[16] = ':';
+    H2WriteDecimalToBuffer(secondOfDay % 60, 2, buffer + 19);
+    H2WriteText(Printer, buffer, 19);
+}
+
+/**
+  * \brief Outputs a fraction of a binary unit with one or two decimal places (truncated).
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Bytes The number of bytes.
+  * \param[in] BytesPerUnit The size of the unit.
+  * \param[in] Decimals The number of decimal places: 1 or 2.
+  * \param[in] Unit The name of the unit, including the leading space.
+  */
+void H2WriteFractionalSize(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 Bytes,
+    _In_ H2_ULONG64 BytesPerUnit,
+    _In_ H2_ULONG Decimals,
+    _In_ const H2_CHAR* Unit
+)
+{
+    H2_ULONG64 scale = Decimals == 1 ? 10 : 100;
+    H2_ULONG64 scaled = Bytes * scale / BytesPerUnit;
+    H2_CHAR buffer[2];
+
+    H2WriteUnsigned(Printer, scaled / scale);
+    H2WriteText(Printer, H2_T("."), 1);
+    H2WriteDecimalToBuffer(scaled % scale, Decimals, buffer + Decimals);
+    H2WriteText(Printer, buffer, Decimals);
+    H2WriteString(Printer, Unit);
+}
+
+/**
+  * \brief Outputs a number of bytes value.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Bytes The number of bytes.
+  */
+void H2WriteByteSize(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 Bytes
+)
+{
+    if (Bytes < BYTES_PER_KB)
+        H2WriteQuantity(Printer, Bytes, H2_T(" bytes"), FALSE);
+    else if (Bytes < BYTES_PER_KB * 10 && (Bytes % BYTES_PER_KB != 0))
+        H2WriteFractionalSize(Printer, Bytes, BYTES_PER_KB, 2, H2_T(" KiB"));
+    else if (Bytes < BYTES_PER_KB * 100 && (Bytes % BYTES_PER_KB != 0))
+        H2WriteFractionalSize(Printer, Bytes, BYTES_PER_KB, 1, H2_T(" KiB"));
+    else if (Bytes < BYTES_PER_MB)
+        H2WriteQuantity(Printer, Bytes / BYTES_PER_KB, H2_T(" KiB"), FALSE);
+    else if (Bytes < BYTES_PER_MB * 10 && (Bytes % BYTES_PER_MB != 0))
+        H2WriteFractionalSize(Printer, Bytes, BYTES_PER_MB, 2, H2_T(" MiB"));
+    else if (Bytes < BYTES_PER_MB * 100 && (Bytes % BYTES_PER_MB != 0))
+        H2WriteFractionalSize(Printer, Bytes, BYTES_PER_MB, 1, H2_T(" MiB"));
+    else if (Bytes < BYTES_PER_GB)
+        H2WriteQuantity(Printer, Bytes / BYTES_PER_MB, H2_T(" MiB"), FALSE);
+    else if (Bytes < BYTES_PER_GB * 10 && (Bytes % BYTES_PER_GB != 0))
+        H2WriteFractionalSize(Printer, Bytes, BYTES_PER_GB, 2, H2_T(" GiB"));
+    else if (Bytes < BYTES_PER_GB * 100 && (Bytes % BYTES_PER_GB != 0))
+        H2WriteFractionalSize(Printer, Bytes, BYTES_PER_GB, 1, H2_T(" GiB"));
+    else
+        H2WriteQuantity(Printer, Bytes / BYTES_PER_GB, H2_T(" GiB"), FALSE);
+}
+
+/**
+  * \brief Outputs a GUID in braces with uppercase digits.
+  *
+  * \param[in] Printer The printer.
+  * \param[in] Guid The GUID value.
+  */
+void H2WriteGuid(
+    _In_ PH2_PRINTER Printer,
+    _In_ const H2_GUID* Guid
+)
+{
+    H2WriteText(Printer, H2_T("{"), 1);
+    H2WriteHexadecimal(Printer, Guid->Data1, 8);
+    H2WriteText(Printer, H2_T("-"), 1);
+    H2WriteHexadecimal(Printer, Guid->Data2, 4);
+    H2WriteText(Printer, H2_T("-"), 1);
+    H2WriteHexadecimal(Printer, Guid->Data3, 4);
+    H2WriteText(Printer, H2_T("-"), 1);
+
+    for (H2_ULONG i = 0; i < sizeof(Guid->Data4); i++)
+    {
+        if (i == 2)
+            H2WriteText(Printer, H2_T("-"), 1);
+
+        H2WriteHexadecimal(Printer, Guid->Data4[i], 2);
+    }
+
+    H2WriteText(Printer, H2_T("}"), 1);
+}
+
+/**
+  * \brief Converts UTF-16 text (such as device names from records) to the characters of formatted text.
+  *
+  * \param[out] Buffer The buffer that receives the text. Three characters per UTF-16 unit always fit.
+  * \param[in] BufferLength The size of the buffer in characters.
+  * \param[in] String The UTF-16 text.
+  * \param[in] Length The number of UTF-16 units in the text.
+  *
+  * \return The number of characters written. Characters that do not fit are dropped.
+  */
+size_t H2ConvertUtf16(
+    _Out_writes_(BufferLength) H2_CHAR* Buffer,
+    _In_ size_t BufferLength,
+    _In_reads_(Length) const H2_WCHAR* String,
+    _In_ size_t Length
+)
+{
+#ifdef _WIN32
+    // Already the same encoding
+    if (Length > BufferLength)
+        Length = BufferLength;
+
+    for (size_t i = 0; i < Length; i++)
+        Buffer[i] = String[i];
+
+    return Length;
+#else
+    size_t written = 0;
+    size_t size;
+    H2_ULONG codePoint;
+
+    for (size_t i = 0; i < Length; i++)
+    {
+        codePoint = String[i];
+
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < Length &&
+            String[i + 1] >= 0xDC00 && String[i + 1] <= 0xDFFF)
+        {
+            // Combine a surrogate pair
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (String[++i] - 0xDC00);
+        }
+        else if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+        {
+            // Unpaired surrogates have no UTF-8 form
+            codePoint = 0xFFFD;
+        }
+
+        size = codePoint < 0x80 ? 1 : codePoint < 0x800 ? 2 : codePoint < 0x10000 ? 3 : 4;
+
+        if (written + size > BufferLength)
+            break;
+
+        switch (size)
+        {
+        case 1:
+            Buffer[written++] = (H2_CHAR)codePoint;
+            break;
+        case 2:
+            Buffer[written++] = (H2_CHAR)(0xC0 | codePoint >> 6);
+            Buffer[written++] = (H2_CHAR)(0x80 | (codePoint & 0x3F));
+            break;
+        case 3:
+            Buffer[written++] = (H2_CHAR)(0xE0 | codePoint >> 12);
+            Buffer[written++] = (H2_CHAR)(0x80 | (codePoint >> 6 & 0x3F));
+            Buffer[written++] = (H2_CHAR)(0x80 | (codePoint & 0x3F));
+            break;
+        default:
+            Buffer[written++] = (H2_CHAR)(0xF0 | codePoint >> 18);
+            Buffer[written++] = (H2_CHAR)(0x80 | (codePoint >> 12 & 0x3F));
+            Buffer[written++] = (H2_CHAR)(0x80 | (codePoint >> 6 & 0x3F));
+            Buffer[written++] = (H2_CHAR)(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    return written;
+#endif
+}
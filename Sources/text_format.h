@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _TEXT_FORMAT_H
+#define _TEXT_FORMAT_H
+
+//
+// Formatting of numbers, durations, sizes, and times without Windows headers. The text goes
+// to a printer that the caller provides: the Windows tool forwards it to the console, while
+// the analyzer on other systems collects it per snapshot file.
+//
+
+#include "portable_types.h"
+
+typedef struct _H2_PRINTER *PH2_PRINTER;
+
+// Receives formatted text
+typedef void (*PH2_PRINTER_WRITE)(
+    _In_ PH2_PRINTER Printer,
+    _In_reads_(Length) const H2_CHAR* Text,
+    _In_ size_t Length
+    );
+
+typedef struct _H2_PRINTER
+{
+    PH2_PRINTER_WRITE Write;
+    void* Context;
+    H2_LONG64 SystemTime; // The moment elapsed times count back from, in 100-ns intervals since 1601
+    H2_LONG64 TimeZoneBias; // UTC minus local time, in 100-ns intervals
+    H2_BOOLEAN Raw; // Print raw (machine-readable) property names and values
+    H2_BOOLEAN Json; // Print properties as members of a JSON object
+} H2_PRINTER;
+
+#define NS_PER_TICK                 100ull
+#define TICKS_PER_US                 10ull
+#define TICKS_PER_MS              10000ull
+#define TICKS_PER_SEC          10000000ull
+#define TICKS_PER_MIN         600000000ull
+#define TICKS_PER_HOUR      36000000000ull
+#define TICKS_PER_DAY      864000000000ull
+
+#define BYTES_PER_KB               1024ull
+#define BYTES_PER_MB            1048576ull
+#define BYTES_PER_GB         1073741824ull
+
+void
+H2WriteText(
+    _In_ PH2_PRINTER Printer,
+    _In_reads_(Length) const H2_CHAR* Text,
+    _In_ size_t Length
+);
+
+void
+H2WriteString(
+    _In_ PH2_PRINTER Printer,
+    _In_ const H2_CHAR* String
+);
+
+void
+H2WriteUnsigned(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 Value
+);
+
+void
+H2WriteSigned(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_LONG64 Value
+);
+
+void
+H2WriteHexadecimal(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 Value,
+    _In_ H2_ULONG MinimumDigits
+);
+
+void
+H2WriteJsonEscaped(
+    _In_ PH2_PRINTER Printer,
+    _In_reads_(Length) const H2_CHAR* Text,
+    _In_ size_t Length
+);
+
+void
+H2WriteTimeSpan(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 TimeSpan
+);
+
+void
+H2WriteTimeStamp(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_LONG64 TimeStamp
+);
+
+void
+H2WriteByteSize(
+    _In_ PH2_PRINTER Printer,
+    _In_ H2_ULONG64 Bytes
+);
+
+void
+H2WriteGuid(
+    _In_ PH2_PRINTER Printer,
+    _In_ const H2_GUID* Guid
+);
+
+size_t
+H2ConvertUtf16(
+    _Out_writes_(BufferLength) H2_CHAR* Buffer,
+    _In_ size_t BufferLength,
+    _In_reads_(Length) const H2_WCHAR* String,
+    _In_ size_t Length
+);
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "timeline.h"
+#include "file_helpers.h"
+#include <stdio.h>
+
+#define H2_TIMELINE_BUFFER_SIZE 0x10000
+
+// The longest JSON line we produce for one event
+#define H2_TIMELINE_MAX_LINE 0x200
+
+typedef struct _H2_TIMELINE_EVENT
+{
+    LONG64 Timestamp; // In performance counter ticks
+    PCSTR Name;
+    ULONG_PTR Argument;
+    CHAR Phase; // 'B' or 'E'
+} H2_TIMELINE_EVENT, *PH2_TIMELINE_EVENT;
+
+typedef struct _H2_TIMELINE_RING
+{
+    struct _H2_TIMELINE_RING* Next;
+    ULONG ThreadId;
+    ULONG64 Written; // Only the owning thread writes
+    H2_TIMELINE_EVENT Events[H2_TIMELINE_RING_SIZE];
+} H2_TIMELINE_RING, *PH2_TIMELINE_RING;
+
+BOOLEAN H2TimelineActive;
+LARGE_INTEGER H2TimelineFrequency;
+LARGE_INTEGER H2TimelineStartTime;
+PH2_TIMELINE_RING volatile H2TimelineRings;
+__declspec(thread) PH2_TIMELINE_RING H2TimelineThreadRing;
+
+/**
+  * \brief Appends an event to the ring of the current thread. Use H2_TIMELINE_BEGIN and H2_TIMELINE_END instead.
+  *
+  * \param[in] Name The name of the phase. Must be a string literal since it's only read when saving.
+  * \param[in] Argument An optional value to show with the event.
+  * \param[in] Phase 'B' for the beginning of the phase or 'E' for its end.
+  */
+VOID H2TimelineRecord(
+    _In_ PCSTR Name,
+    _In_ ULONG_PTR Argument,
+    _In_ CHAR Phase
+)
+{
+    PH2_TIMELINE_RING ring = H2TimelineThreadRing;
+    PH2_TIMELINE_EVENT event;
+    LARGE_INTEGER timestamp;
+
+    if (!ring)
+    {
+        ring = RtlAllocateHeap(RtlProcessHeap(), 0, sizeof(H2_TIMELINE_RING));
+
+        // Losing events only leaves a gap in the timeline
+        if (!ring)
+            return;
+
+        ring->ThreadId = HandleToUlong(NtCurrentThreadId());
+        ring->Written = 0;
+
+        // Publish the ring for saving; rings are never removed until then
+        do
+        {
+            ring->Next = ReadPointerAcquire((PVOID volatile*)&H2TimelineRings);
+        } while (InterlockedCompareExchangePointer((PVOID volatile*)&H2TimelineRings, ring, ring->Next) != ring->Next);
+
+        H2TimelineThreadRing = ring;
+    }
+
+    RtlQueryPerformanceCounter(&timestamp);
+
+    event = &ring->Events[ring->Written & (H2_TIMELINE_RING_SIZE - 1)];
+    event->Timestamp = timestamp.QuadPart;
+    event->Name = Name;
+    event->Argument = Argument;
+    event->Phase = Phase;
+    ring->Written++;
+}
+
+/**
+  * \brief Starts recording phases on all threads.
+  */
+VOID H2TimelineStart(
+    VOID
+)
+{
+    RtlQueryPerformanceFrequency(&H2TimelineFrequency);
+    RtlQueryPerformanceCounter(&H2TimelineStartTime);
+    H2TimelineActive = TRUE;
+}
+
+/**
+  * \brief Stops recording and saves the events in the Chrome trace-event JSON format.
+  *  Other threads must not record events anymore.
+  *
+  * \param[in] FileName The name of the file to create or overwrite.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2TimelineSave(
+    _In_ PCWSTR FileName
+)
+{
+    NTSTATUS status;
+    HANDLE fileHandle;
+    PCHAR buffer;
+    ULONG used = 0;
+    ULONG processId = HandleToUlong(NtCurrentProcessId());
+    BOOLEAN first = TRUE;
+    PH2_TIMELINE_RING ring;
+
+    H2TimelineActive = FALSE;
+
+    buffer = RtlAllocateHeap(RtlProcessHeap(), 0, H2_TIMELINE_BUFFER_SIZE);
+
+    if (!buffer)
+    {
+        status = STATUS_NO_MEMORY;
+        goto CLEANUP;
+    }
+
+    status = H2OpenFile(&fileHandle, FileName, FILE_WRITE_DATA, FILE_SHARE_READ, FILE_OVERWRITE_IF);
+
+    if (!NT_SUCCESS(status))
+        goto CLEANUP;
+
+    used += sprintf_s(buffer, H2_TIMELINE_BUFFER_SIZE, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    for (ring = H2TimelineRings; ring && NT_SUCCESS(status); ring = ring->Next)
+    {
+        // A full ring starts at the oldest event that wasn't overwritten
+        ULONG64 start = ring->Written > H2_TIMELINE_RING_SIZE ? ring->Written - H2_TIMELINE_RING_SIZE : 0;
+
+        for (ULONG64 i = start; i < ring->Written; i++)
+        {
+            PH2_TIMELINE_EVENT event = &ring->Events[i & (H2_TIMELINE_RING_SIZE - 1)];
+            LONG64 ticks = event->Timestamp - H2TimelineStartTime.QuadPart;
+            ULONG64 time = (ticks / H2TimelineFrequency.QuadPart) * 10000000 +
+                (ticks % H2TimelineFrequency.QuadPart) * 10000000 / H2TimelineFrequency.QuadPart;
+
+            if (used + H2_TIMELINE_MAX_LINE > H2_TIMELINE_BUFFER_SIZE)
+            {
+                status = H2WriteFile(fileHandle, buffer, used);
+                used = 0;
+
+                if (!NT_SUCCESS(status))
+                    break;
+            }
+
+            // Timestamps are in microseconds
+            used += sprintf_s(
+                buffer + used,
+                H2_TIMELINE_BUFFER_SIZE - used,
+                "%s\r\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%llu,\"pid\":%lu,\"tid\":%lu",
+                first ? "" : ",",
+                event->Name,
+                event->Phase,
+                time / 10,
+                time % 10,
+                processId,
+                ring->ThreadId
+            );
+
+            if (event->Argument)
+                used += sprintf_s(buffer + used, H2_TIMELINE_BUFFER_SIZE - used, ",\"args\":{\"value\":\"0x%IX\"}", event->Argument);
+
+            used += sprintf_s(buffer + used, H2_TIMELINE_BUFFER_SIZE - used, "}");
+            first = FALSE;
+        }
+    }
+
+    if (NT_SUCCESS(status))
+    {
+        used += sprintf_s(buffer + used, H2_TIMELINE_BUFFER_SIZE - used, "\r\n]}\r\n");
+        status = H2WriteFile(fileHandle, buffer, used);
+    }
+
+    NtClose(fileHandle);
+
+CLEANUP:
+    if (buffer)
+        RtlFreeHeap(RtlProcessHeap(), 0, buffer);
+
+    // The rings of exited threads are no longer referenced
+    while (ring = H2TimelineRings)
+    {
+        H2TimelineRings = ring->Next;
+        RtlFreeHeap(RtlProcessHeap(), 0, ring);
+    }
+
+    H2TimelineThreadRing = NULL;
+    return status;
+}
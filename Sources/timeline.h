@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _TIMELINE_H
+#define _TIMELINE_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+
+//
+// The timeline collects begin and end events of the phases of a run. Each thread appends to
+// its own ring, so recording needs no synchronization; when a ring is full, the oldest events
+// are overwritten. Rings are only read after all other threads have exited, when the timeline
+// is saved in the Chrome trace-event format (viewable in chrome://tracing or Perfetto).
+//
+
+// The number of events each thread keeps; must be a power of two
+#define H2_TIMELINE_RING_SIZE 0x8000
+
+// Whether phases are being recorded
+extern BOOLEAN H2TimelineActive;
+
+VOID
+NTAPI
+H2TimelineRecord(
+    _In_ PCSTR Name,
+    _In_ ULONG_PTR Argument,
+    _In_ CHAR Phase
+);
+
+// Marks the beginning of a phase; the argument (such as a PID or a handle value) is optional
+#define H2_TIMELINE_BEGIN(Name, Argument) ((VOID)(H2TimelineActive && (H2TimelineRecord(Name, (ULONG_PTR)(Argument), 'B'), TRUE)))
+
+// Marks the end of the innermost phase
+#define H2_TIMELINE_END(Name) ((VOID)(H2TimelineActive && (H2TimelineRecord(Name, 0, 'E'), TRUE)))
+
+VOID
+NTAPI
+H2TimelineStart(
+    VOID
+);
+
+NTSTATUS
+NTAPI
+H2TimelineSave(
+    _In_ PCWSTR FileName
+);
+
+#endif
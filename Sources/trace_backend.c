@@ -0,0 +1,1290 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "trace_backend.h"
+#include "snapshot_helpers.h"
+#include "file_helpers.h"
+#include "ntafd.h"
+
+// Handles we give out keep a tag in the upper bits and a slot index in the rest
+#define H2_TRACE_HANDLE_TAG 0x30000000
+#define H2_TRACE_HANDLE_PAYLOAD_MASK 0x0FFFFFFF
+#define H2_TRACE_MAX_SLOTS (H2_TRACE_HANDLE_PAYLOAD_MASK >> 2)
+#define H2_TRACE_IS_TAGGED_HANDLE(Handle) (((ULONG_PTR)(Handle) & ~(ULONG_PTR)H2_TRACE_HANDLE_PAYLOAD_MASK) == H2_TRACE_HANDLE_TAG)
+
+#define H2_TRACE_BUFFER_SIZE 0x100000
+#define H2_TRACE_NO_RECORD MAXULONG
+
+typedef struct _H2_TRACE_SLOT
+{
+    HANDLE Handle; // The underlying handle while recording
+    H2_TRACE_IDENTITY Identity;
+    ULONG NextFree;
+} H2_TRACE_SLOT, *PH2_TRACE_SLOT;
+
+typedef struct _H2_TRACE_BUCKET
+{
+    ULONG Hash;
+    ULONG First; // The first record with the key, or H2_TRACE_NO_RECORD for empty buckets
+    volatile LONG Current; // The record to answer the next matching request with
+} H2_TRACE_BUCKET, *PH2_TRACE_BUCKET;
+
+// Shared state
+PCH2_BACKEND H2TraceInnerBackend;
+LARGE_INTEGER H2TraceFrequency;
+RTL_SRWLOCK H2TraceSlotLock = RTL_SRWLOCK_INIT;
+PH2_TRACE_SLOT H2TraceSlots;
+ULONG H2TraceSlotCount;
+ULONG H2TraceSlotCapacity;
+ULONG H2TraceFirstFreeSlot = H2_TRACE_NO_RECORD;
+
+// Recording state
+RTL_SRWLOCK H2TraceWriteLock = RTL_SRWLOCK_INIT;
+HANDLE H2TraceFileHandle;
+PUCHAR H2TraceBuffer;
+ULONG H2TraceBufferUsed;
+NTSTATUS H2TraceWriteStatus;
+
+// Replay state
+PUCHAR H2TraceView;
+PH2_TRACE_RECORD* H2TraceRecords;
+PULONG H2TraceNextRecord;
+PH2_TRACE_BUCKET H2TraceBuckets;
+ULONG H2TraceBucketMask;
+BOOLEAN H2TraceReproduceLatency;
+
+/**
+  * \brief Reads a high-resolution timestamp.
+  *
+  * \return The time in 100ns units.
+  */
+ULONG64 H2TraceQueryTime(
+    VOID
+)
+{
+    LARGE_INTEGER counter;
+
+    RtlQueryPerformanceCounter(&counter);
+
+    return (counter.QuadPart / H2TraceFrequency.QuadPart) * 10000000 +
+        (counter.QuadPart % H2TraceFrequency.QuadPart) * 10000000 / H2TraceFrequency.QuadPart;
+}
+
+/**
+  * \brief Issues a tagged handle that refers to a specific handle identity.
+  *
+  * \param[in] Handle The underlying handle, if any.
+  * \param[in] Identity The identity of the handle.
+  * \param[out] TaggedHandle A variable that receives the tagged handle.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2TraceAllocateHandle(
+    _In_opt_ HANDLE Handle,
+    _In_ PH2_TRACE_IDENTITY Identity,
+    _Out_ PHANDLE TaggedHandle
+)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    ULONG index;
+
+    RtlAcquireSRWLockExclusive(&H2TraceSlotLock);
+
+    if (H2TraceFirstFreeSlot != H2_TRACE_NO_RECORD)
+    {
+        // Reuse a released slot
+        index = H2TraceFirstFreeSlot;
+        H2TraceFirstFreeSlot = H2TraceSlots[index].NextFree;
+    }
+    else
+    {
+        if (H2TraceSlotCount >= H2TraceSlotCapacity)
+        {
+            ULONG newCapacity = H2TraceSlotCapacity ? H2TraceSlotCapacity * 2 : 0x40;
+            PH2_TRACE_SLOT newSlots;
+
+            if (newCapacity > H2_TRACE_MAX_SLOTS)
+                newCapacity = H2_TRACE_MAX_SLOTS;
+
+            if (H2TraceSlotCount >= newCapacity)
+                newSlots = NULL;
+            else if (H2TraceSlots)
+                newSlots = RtlReAllocateHeap(RtlProcessHeap(), 0, H2TraceSlots, newCapacity * sizeof(H2_TRACE_SLOT));
+            else
+                newSlots = RtlAllocateHeap(RtlProcessHeap(), 0, newCapacity * sizeof(H2_TRACE_SLOT));
+
+            if (!newSlots)
+            {
+                status = STATUS_INSUFFICIENT_RESOURCES;
+                goto CLEANUP;
+            }
+
+            H2TraceSlots = newSlots;
+            H2TraceSlotCapacity = newCapacity;
+        }
+
+        index = H2TraceSlotCount++;
+    }
+
+    H2TraceSlots[index].Handle = Handle;
+    H2TraceSlots[index].Identity = *Identity;
+    H2TraceSlots[index].NextFree = H2_TRACE_NO_RECORD;
+    *TaggedHandle = (HANDLE)(ULONG_PTR)(H2_TRACE_HANDLE_TAG | (index << 2));
+
+CLEANUP:
+    RtlReleaseSRWLockExclusive(&H2TraceSlotLock);
+    return status;
+}
+
+/**
+  * \brief Locates the underlying handle and the identity behind a handle.
+  *
+  * \param[in] TaggedHandle A tagged or an ordinary handle.
+  * \param[out] Handle A variable that receives the underlying handle.
+  * \param[out] Identity A variable that receives the identity, or H2TraceHandleNone for ordinary handles.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2TraceResolveHandle(
+    _In_ HANDLE TaggedHandle,
+    _Out_ PHANDLE Handle,
+    _Out_ PH2_TRACE_IDENTITY Identity
+)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    ULONG index;
+
+    if (!H2_TRACE_IS_TAGGED_HANDLE(TaggedHandle))
+    {
+        *Handle = TaggedHandle;
+        RtlZeroMemory(Identity, sizeof(H2_TRACE_IDENTITY));
+        return STATUS_SUCCESS;
+    }
+
+    index = (ULONG)(((ULONG_PTR)TaggedHandle & H2_TRACE_HANDLE_PAYLOAD_MASK) >> 2);
+    RtlAcquireSRWLockShared(&H2TraceSlotLock);
+
+    if (index < H2TraceSlotCount && H2TraceSlots[index].Identity.Kind != H2TraceHandleNone)
+    {
+        *Handle = H2TraceSlots[index].Handle;
+        *Identity = H2TraceSlots[index].Identity;
+    }
+    else
+    {
+        status = STATUS_INVALID_HANDLE;
+    }
+
+    RtlReleaseSRWLockShared(&H2TraceSlotLock);
+    return status;
+}
+
+/**
+  * \brief Releases a tagged handle.
+  *
+  * \param[in] TaggedHandle A tagged handle.
+  */
+VOID H2TraceReleaseHandle(
+    _In_ HANDLE TaggedHandle
+)
+{
+    ULONG index = (ULONG)(((ULONG_PTR)TaggedHandle & H2_TRACE_HANDLE_PAYLOAD_MASK) >> 2);
+
+    RtlAcquireSRWLockExclusive(&H2TraceSlotLock);
+
+    if (index < H2TraceSlotCount && H2TraceSlots[index].Identity.Kind != H2TraceHandleNone)
+    {
+        H2TraceSlots[index].Identity.Kind = H2TraceHandleNone;
+        H2TraceSlots[index].NextFree = H2TraceFirstFreeSlot;
+        H2TraceFirstFreeSlot = index;
+    }
+
+    RtlReleaseSRWLockExclusive(&H2TraceSlotLock);
+}
+
+/**
+  * \brief Replaces TDI handles from an IOCTL_AFD_QUERY_HANDLES response with tagged handles.
+  *
+  * \param[in] Socket The identity of the socket.
+  * \param[in] Record Whether the handles are real and should be preserved.
+  * \param[in,out] HandleInfo The response.
+  */
+VOID H2TraceWrapTdiHandles(
+    _In_ PH2_TRACE_IDENTITY Socket,
+    _In_ BOOLEAN Record,
+    _Inout_ PAFD_HANDLE_INFO HandleInfo
+)
+{
+    H2_TRACE_IDENTITY identity = *Socket;
+    PHANDLE handles[2] = { &HandleInfo->TdiAddressHandle, &HandleInfo->TdiConnectionHandle };
+
+    for (ULONG i = 0; i < RTL_NUMBER_OF(handles); i++)
+    {
+        if (*handles[i] == NULL || *handles[i] == INVALID_HANDLE_VALUE)
+            continue;
+
+        identity.Kind = i == 0 ? H2TraceHandleTdiAddress : H2TraceHandleTdiConnection;
+
+        if (!NT_SUCCESS(H2TraceAllocateHandle(Record ? *handles[i] : NULL, &identity, handles[i])))
+        {
+            // Don't leak the handle we cannot track
+            if (Record)
+                H2TraceInnerBackend->Close(*handles[i]);
+
+            *handles[i] = NULL;
+        }
+    }
+}
+
+/**
+  * \brief Converts an IOCTL input buffer into a form that doesn't depend on memory layout.
+  *
+  * \param[in] IoControlCode I/O control code
+  * \param[in] InBuffer Input buffer.
+  * \param[in] InBufferSize Input buffer size.
+  * \param[out] Buffer A buffer of H2_TRACE_MAX_INPUT bytes that receives the canonical input.
+  *
+  * \return The number of bytes written to the buffer.
+  */
+ULONG H2TraceCanonicalizeInput(
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_(H2_TRACE_MAX_INPUT) PUCHAR Buffer
+)
+{
+    if (!InBuffer)
+        return 0;
+
+    if (IoControlCode == IOCTL_AFD_GET_INFORMATION && InBufferSize >= sizeof(ULONG))
+    {
+        // Only the information type is meaningful in the input
+        *(PULONG)Buffer = ((PAFD_INFORMATION)InBuffer)->InformationType;
+        return sizeof(ULONG);
+    }
+
+    if (IoControlCode == IOCTL_AFD_TRANSPORT_IOCTL && InBufferSize >= sizeof(AFD_TL_IO_CONTROL_INFO))
+    {
+        PAFD_TL_IO_CONTROL_INFO controlInfo = InBuffer;
+        PH2_TRACE_TL_INPUT canonical = (PH2_TRACE_TL_INPUT)Buffer;
+        ULONG nestedSize = controlInfo->InputBuffer ? (ULONG)min(controlInfo->InputBufferLength, H2_TRACE_MAX_INPUT - sizeof(H2_TRACE_TL_INPUT)) : 0;
+
+        // Store the nested buffer by value instead of by pointer
+        canonical->Type = controlInfo->Type;
+        canonical->Level = controlInfo->Level;
+        canonical->IoControlCode = controlInfo->IoControlCode;
+        canonical->InputBufferLength = nestedSize;
+        RtlCopyMemory(canonical + 1, controlInfo->InputBuffer, nestedSize);
+        return sizeof(H2_TRACE_TL_INPUT) + nestedSize;
+    }
+
+    RtlCopyMemory(Buffer, InBuffer, min(InBufferSize, H2_TRACE_MAX_INPUT));
+    return min(InBufferSize, H2_TRACE_MAX_INPUT);
+}
+
+/**
+  * \brief Determines the size of a process snapshot buffer.
+  *
+  * \param[in] Snapshot A process snapshot.
+  *
+  * \return The number of bytes the snapshot occupies.
+  */
+ULONG H2TraceMeasureProcessSnapshot(
+    _In_ PSYSTEM_PROCESS_INFORMATION Snapshot
+)
+{
+    PSYSTEM_PROCESS_INFORMATION process = Snapshot;
+    ULONG_PTR end = 0;
+
+    do
+    {
+        ULONG_PTR entryEnd = (ULONG_PTR)process + sizeof(SYSTEM_PROCESS_INFORMATION) +
+            process->NumberOfThreads * sizeof(SYSTEM_THREAD_INFORMATION);
+
+        if (entryEnd > end)
+            end = entryEnd;
+
+        // Image names are stored inside the buffer
+        if (process->ImageName.Buffer && (ULONG_PTR)process->ImageName.Buffer > (ULONG_PTR)Snapshot &&
+            (ULONG_PTR)process->ImageName.Buffer + process->ImageName.MaximumLength > end)
+            end = (ULONG_PTR)process->ImageName.Buffer + process->ImageName.MaximumLength;
+
+    } while (process = H2NextProcess(process));
+
+    return (ULONG)(end - (ULONG_PTR)Snapshot);
+}
+
+/**
+  * \brief Writes data to the trace file.
+  *
+  * \param[in] Buffer The data.
+  * \param[in] Size The size of the data.
+  */
+VOID H2TraceWriteFile(
+    _In_reads_bytes_(Size) PVOID Buffer,
+    _In_ ULONG Size
+)
+{
+    NTSTATUS status;
+
+    if (!Size || !NT_SUCCESS(H2TraceWriteStatus))
+        return;
+
+    status = H2WriteFile(H2TraceFileHandle, Buffer, Size);
+
+    // Remember the first failure and stop writing; the inspection itself continues
+    if (!NT_SUCCESS(status))
+        H2TraceWriteStatus = status;
+}
+
+/**
+  * \brief Appends a record to the trace file.
+  *
+  * \param[in,out] Record The record header. The function fills in its size.
+  * \param[in] Input The input bytes, as specified by the record.
+  * \param[in] Output The output bytes, as specified by the record.
+  */
+VOID H2TraceAppendRecord(
+    _Inout_ PH2_TRACE_RECORD Record,
+    _In_reads_bytes_opt_(Record->InputSize) PVOID Input,
+    _In_reads_bytes_opt_(Record->OutputSize) PVOID Output
+)
+{
+    static const UCHAR padding[H2_TRACE_ALIGNMENT] = { 0 };
+    ULONG payloadSize;
+
+    if (!Input)
+        Record->InputSize = 0;
+
+    if (!Output)
+        Record->OutputSize = 0;
+
+    payloadSize = sizeof(H2_TRACE_RECORD) + Record->InputSize + Record->OutputSize;
+    Record->Size = (ULONG)ALIGN_UP_BY(payloadSize, H2_TRACE_ALIGNMENT);
+
+    RtlAcquireSRWLockExclusive(&H2TraceWriteLock);
+
+    if (H2TraceBufferUsed + Record->Size > H2_TRACE_BUFFER_SIZE)
+    {
+        H2TraceWriteFile(H2TraceBuffer, H2TraceBufferUsed);
+        H2TraceBufferUsed = 0;
+    }
+
+    if (Record->Size > H2_TRACE_BUFFER_SIZE)
+    {
+        // Large records (such as snapshots) bypass the buffer
+        H2TraceWriteFile(Record, sizeof(H2_TRACE_RECORD));
+        H2TraceWriteFile(Input, Record->InputSize);
+        H2TraceWriteFile(Output, Record->OutputSize);
+        H2TraceWriteFile((PVOID)padding, Record->Size - payloadSize);
+    }
+    else
+    {
+        PUCHAR cursor = H2TraceBuffer + H2TraceBufferUsed;
+
+        RtlCopyMemory(cursor, Record, sizeof(H2_TRACE_RECORD));
+        cursor += sizeof(H2_TRACE_RECORD);
+
+        if (Record->InputSize)
+            RtlCopyMemory(cursor, Input, Record->InputSize);
+
+        cursor += Record->InputSize;
+
+        if (Record->OutputSize)
+            RtlCopyMemory(cursor, Output, Record->OutputSize);
+
+        cursor += Record->OutputSize;
+
+        RtlZeroMemory(cursor, Record->Size - payloadSize);
+        H2TraceBufferUsed += Record->Size;
+    }
+
+    RtlReleaseSRWLockExclusive(&H2TraceWriteLock);
+}
+
+//
+// Recording backend
+//
+
+NTSTATUS H2TraceRecSnapshotProcesses(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+)
+{
+    H2_TRACE_RECORD record = { 0 };
+    ULONG64 start = H2TraceQueryTime();
+
+    record.Status = H2TraceInnerBackend->SnapshotProcesses(Snapshot);
+    record.Duration = H2TraceQueryTime() - start;
+    record.Type = H2TraceRecordSnapshotProcesses;
+
+    if (NT_SUCCESS(record.Status))
+    {
+        record.OutputSize = H2TraceMeasureProcessSnapshot(*Snapshot);
+        record.BaseAddress = (ULONG_PTR)*Snapshot;
+    }
+
+    H2TraceAppendRecord(&record, NULL, NT_SUCCESS(record.Status) ? *Snapshot : NULL);
+    return record.Status;
+}
+
+NTSTATUS H2TraceRecSnapshotHandles(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+)
+{
+    H2_TRACE_RECORD record = { 0 };
+    ULONG64 start = H2TraceQueryTime();
+
+    record.Status = H2TraceInnerBackend->SnapshotHandles(Snapshot);
+    record.Duration = H2TraceQueryTime() - start;
+    record.Type = H2TraceRecordSnapshotHandles;
+
+    if (NT_SUCCESS(record.Status))
+    {
+        record.OutputSize = (ULONG)(FIELD_OFFSET(SYSTEM_HANDLE_INFORMATION_EX, Handles) +
+            (*Snapshot)->NumberOfHandles * sizeof(SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX));
+        record.BaseAddress = (ULONG_PTR)*Snapshot;
+    }
+
+    H2TraceAppendRecord(&record, NULL, NT_SUCCESS(record.Status) ? *Snapshot : NULL);
+    return record.Status;
+}
+
+NTSTATUS H2TraceRecFindKernelTypeIndex(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+)
+{
+    H2_TRACE_RECORD record = { 0 };
+    ULONG64 start = H2TraceQueryTime();
+
+    record.Status = H2TraceInnerBackend->FindKernelTypeIndex(TypeName, Index);
+    record.Duration = H2TraceQueryTime() - start;
+    record.Type = H2TraceRecordFindKernelTypeIndex;
+    record.InputSize = min(TypeName->Length, H2_TRACE_MAX_INPUT);
+    record.OutputSize = NT_SUCCESS(record.Status) ? sizeof(ULONG) : 0;
+
+    H2TraceAppendRecord(&record, TypeName->Buffer, Index);
+    return record.Status;
+}
+
+NTSTATUS H2TraceRecOpenProcess(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+)
+{
+    H2_TRACE_RECORD record = { 0 };
+    ULONG64 start = H2TraceQueryTime();
+    HANDLE processHandle;
+
+    record.Status = H2TraceInnerBackend->OpenProcess(&processHandle, ProcessId, DesiredAccess);
+    record.Duration = H2TraceQueryTime() - start;
+    record.Type = H2TraceRecordOpenProcess;
+    record.Target.ProcessId = (ULONG)(ULONG_PTR)ProcessId;
+    record.Target.Kind = H2TraceHandleProcess;
+    record.Code = DesiredAccess;
+
+    H2TraceAppendRecord(&record, NULL, NULL);
+
+    if (!NT_SUCCESS(record.Status))
+        return record.Status;
+
+    if (!NT_SUCCESS(record.Status = H2TraceAllocateHandle(processHandle, &record.Target, ProcessHandle)))
+        H2TraceInnerBackend->Close(processHandle);
+
+    return record.Status;
+}
+
+NTSTATUS H2TraceRecDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+)
+{
+    H2_TRACE_RECORD record = { 0 };
+    H2_TRACE_IDENTITY process;
+    HANDLE processHandle;
+    HANDLE handle;
+    ULONG64 start;
+
+    record.Status = H2TraceResolveHandle(ProcessHandle, &processHandle, &process);
+
+    if (!NT_SUCCESS(record.Status))
+        return record.Status;
+
+    start = H2TraceQueryTime();
+    record.Status = H2TraceInnerBackend->DuplicateHandle(processHandle, SourceHandle, &handle);
+    record.Duration = H2TraceQueryTime() - start;
+    record.Type = H2TraceRecordDuplicateHandle;
+    record.Target.ProcessId = process.ProcessId;
+    record.Target.HandleValue = (ULONG)(ULONG_PTR)SourceHandle;
+    record.Target.Kind = H2TraceHandleFile;
+
+    H2TraceAppendRecord(&record, NULL, NULL);
+
+    if (!NT_SUCCESS(record.Status))
+        return record.Status;
+
+    if (!NT_SUCCESS(record.Status = H2TraceAllocateHandle(handle, &record.Target, TargetHandle)))
+        H2TraceInnerBackend->Close(handle);
+
+    return record.Status;
+}
+
+NTSTATUS H2TraceRecQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+)
+{
+    H2_TRACE_RECORD record = { 0 };
+    HANDLE fileHandle;
+    ULONG64 start;
+
+    record.Status = H2TraceResolveHandle(FileHandle, &fileHandle, &record.Target);
+
+    if (!NT_SUCCESS(record.Status))
+        return record.Status;
+
+    start = H2TraceQueryTime();
+    record.Status = H2TraceInnerBackend->QueryVolumeName(fileHandle, Buffer, BufferSize);
+    record.Duration = H2TraceQueryTime() - start;
+    record.Type = H2TraceRecordQueryVolumeName;
+    record.RequestedOutputSize = BufferSize;
+
+    if (!NT_ERROR(record.Status))
+        record.OutputSize = (ULONG)min(BufferSize, FIELD_OFFSET(FILE_VOLUME_NAME_INFORMATION, DeviceName) + Buffer->DeviceNameLength);
+
+    H2TraceAppendRecord(&record, NULL, Buffer);
+    return record.Status;
+}
+
+NTSTATUS H2TraceRecDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+)
+{
+    H2_TRACE_RECORD record = { 0 };
+    UCHAR input[H2_TRACE_MAX_INPUT];
+    HANDLE fileHandle;
+    ULONG64 start;
+
+    record.Status = H2TraceResolveHandle(FileHandle, &fileHandle, &record.Target);
+
+    if (!NT_SUCCESS(record.Status))
+        return record.Status;
+
+    // Capture the input before the call since buffers can overlap
+    record.InputSize = H2TraceCanonicalizeInput(IoControlCode, InBuffer, InBufferSize, input);
+
+    start = H2TraceQueryTime();
+    record.Status = H2TraceInnerBackend->DeviceIoControl(
+        fileHandle,
+        IoControlCode,
+        InBuffer,
+        InBufferSize,
+        OutputBuffer,
+        OutputBufferSize,
+        &record.BytesReturned
+    );
+    record.Duration = H2TraceQueryTime() - start;
+    record.Type = H2TraceRecordDeviceIoControl;
+    record.Code = IoControlCode;
+    record.RequestedOutputSize = OutputBufferSize;
+
+    if (!NT_ERROR(record.Status) && OutputBuffer)
+        record.OutputSize = min(record.BytesReturned, OutputBufferSize);
+
+    H2TraceAppendRecord(&record, input, OutputBuffer);
+
+    // Make the returned TDI handles resolvable
+    if (NT_SUCCESS(record.Status) && IoControlCode == IOCTL_AFD_QUERY_HANDLES && OutputBufferSize >= sizeof(AFD_HANDLE_INFO))
+        H2TraceWrapTdiHandles(&record.Target, TRUE, OutputBuffer);
+
+    if (BytesReturned)
+        *BytesReturned = record.BytesReturned;
+
+    return record.Status;
+}
+
+NTSTATUS H2TraceRecClose(
+    _In_ HANDLE Handle
+)
+{
+    NTSTATUS status;
+    H2_TRACE_IDENTITY identity;
+    HANDLE handle;
+
+    status = H2TraceResolveHandle(Handle, &handle, &identity);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    if (identity.Kind != H2TraceHandleNone)
+        H2TraceReleaseHandle(Handle);
+
+    return H2TraceInnerBackend->Close(handle);
+}
+
+/**
+  * \brief Issues independent IOCTLs on a file, recording each of them one after another.
+  */
+NTSTATUS H2TraceRecDeviceIoControlBatch(
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+)
+{
+    return H2SequentialDeviceIoControlBatch(H2TraceRecDeviceIoControl, FileHandle, Requests, NumberOfRequests);
+}
+
+const H2_BACKEND H2TraceRecordingBackend =
+{
+    L"Recording",
+    H2TraceRecSnapshotProcesses,
+    H2TraceRecSnapshotHandles,
+    H2TraceRecFindKernelTypeIndex,
+    H2TraceRecOpenProcess,
+    H2TraceRecDuplicateHandle,
+    H2TraceRecQueryVolumeName,
+    H2TraceRecDeviceIoControl,
+    H2TraceRecDeviceIoControlBatch,
+    H2TraceRecClose
+};
+
+//
+// Replay backend
+//
+
+/**
+  * \brief Computes a hash of a request.
+  *
+  * \return The FNV-1a hash of the request key.
+  */
+ULONG H2TraceHashKey(
+    _In_ USHORT Type,
+    _In_ PH2_TRACE_IDENTITY Target,
+    _In_ ULONG Code,
+    _In_ ULONG RequestedOutputSize,
+    _In_reads_bytes_(InputSize) PVOID Input,
+    _In_ ULONG InputSize
+)
+{
+    ULONG key[6] = { Type, Target->ProcessId, Target->HandleValue, Target->Kind, Code, RequestedOutputSize };
+    ULONG hash = 2166136261u;
+
+    for (ULONG i = 0; i < sizeof(key); i++)
+        hash = (hash ^ ((PUCHAR)key)[i]) * 16777619u;
+
+    for (ULONG i = 0; i < InputSize; i++)
+        hash = (hash ^ ((PUCHAR)Input)[i]) * 16777619u;
+
+    return hash;
+}
+
+/**
+  * \brief Determines if a recorded request has a specific key.
+  *
+  * \return Whether the request matches.
+  */
+BOOLEAN H2TraceMatchRecord(
+    _In_ PH2_TRACE_RECORD Record,
+    _In_ USHORT Type,
+    _In_ PH2_TRACE_IDENTITY Target,
+    _In_ ULONG Code,
+    _In_ ULONG RequestedOutputSize,
+    _In_reads_bytes_(InputSize) PVOID Input,
+    _In_ ULONG InputSize
+)
+{
+    return Record->Type == Type &&
+        Record->Target.ProcessId == Target->ProcessId &&
+        Record->Target.HandleValue == Target->HandleValue &&
+        Record->Target.Kind == Target->Kind &&
+        Record->Code == Code &&
+        Record->RequestedOutputSize == RequestedOutputSize &&
+        Record->InputSize == InputSize &&
+        RtlEqualMemory(Record + 1, Input, InputSize);
+}
+
+/**
+  * \brief Finds the recorded response to a request. Repeated requests receive subsequent responses.
+  *
+  * \return The record or NULL if the trace doesn't include the request.
+  */
+PH2_TRACE_RECORD H2TraceFindRecord(
+    _In_ USHORT Type,
+    _In_ PH2_TRACE_IDENTITY Target,
+    _In_ ULONG Code,
+    _In_ ULONG RequestedOutputSize,
+    _In_reads_bytes_(InputSize) PVOID Input,
+    _In_ ULONG InputSize
+)
+{
+    ULONG hash = H2TraceHashKey(Type, Target, Code, RequestedOutputSize, Input, InputSize);
+    PH2_TRACE_RECORD record;
+
+    for (ULONG i = hash & H2TraceBucketMask; H2TraceBuckets[i].First != H2_TRACE_NO_RECORD; i = (i + 1) & H2TraceBucketMask)
+    {
+        if (H2TraceBuckets[i].Hash == hash &&
+            H2TraceMatchRecord(H2TraceRecords[H2TraceBuckets[i].First], Type, Target, Code, RequestedOutputSize, Input, InputSize))
+        {
+            LONG current = H2TraceBuckets[i].Current;
+            ULONG next = H2TraceNextRecord[current];
+
+            // Advance to the next response, staying on the last one
+            if (next != H2_TRACE_NO_RECORD)
+                InterlockedCompareExchange(&H2TraceBuckets[i].Current, next, current);
+
+            record = H2TraceRecords[current];
+
+            // Take as long as the original request did
+            if (H2TraceReproduceLatency && record->Duration)
+            {
+                ULONG64 deadline = H2TraceQueryTime() + record->Duration;
+
+                while (H2TraceQueryTime() < deadline)
+                    YieldProcessor();
+            }
+
+            return record;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+  * \brief Retrieves the output bytes of a record.
+  */
+FORCEINLINE
+PVOID H2TraceRecordOutput(
+    _In_ PH2_TRACE_RECORD Record
+)
+{
+    return (PUCHAR)(Record + 1) + Record->InputSize;
+}
+
+NTSTATUS H2TraceReplaySnapshot(
+    _In_ USHORT Type,
+    _Outptr_ PVOID* Snapshot
+)
+{
+    H2_TRACE_IDENTITY target = { 0 };
+    PH2_TRACE_RECORD record;
+    PVOID buffer;
+
+    record = H2TraceFindRecord(Type, &target, 0, 0, NULL, 0);
+
+    if (!record)
+        return STATUS_NO_MATCH;
+
+    if (!NT_SUCCESS(record->Status))
+        return record->Status;
+
+    buffer = RtlAllocateHeap(RtlProcessHeap(), 0, max(record->OutputSize, 1));
+
+    if (!buffer)
+        return STATUS_NO_MEMORY;
+
+    RtlCopyMemory(buffer, H2TraceRecordOutput(record), record->OutputSize);
+
+    if (Type == H2TraceRecordSnapshotProcesses && record->OutputSize >= sizeof(SYSTEM_PROCESS_INFORMATION))
+    {
+        PSYSTEM_PROCESS_INFORMATION process = buffer;
+
+        // Point image names into the new buffer
+        do
+        {
+            ULONG64 offset = (ULONG_PTR)process->ImageName.Buffer - record->BaseAddress;
+
+            if (process->ImageName.Buffer && offset + process->ImageName.MaximumLength <= record->OutputSize)
+            {
+                process->ImageName.Buffer = (PWSTR)RtlOffsetToPointer(buffer, offset);
+            }
+            else
+            {
+                process->ImageName.Buffer = NULL;
+                process->ImageName.Length = 0;
+                process->ImageName.MaximumLength = 0;
+            }
+
+        } while (process = H2NextProcess(process));
+    }
+
+    *Snapshot = buffer;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS H2TraceReplaySnapshotProcesses(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+)
+{
+    return H2TraceReplaySnapshot(H2TraceRecordSnapshotProcesses, Snapshot);
+}
+
+NTSTATUS H2TraceReplaySnapshotHandles(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+)
+{
+    return H2TraceReplaySnapshot(H2TraceRecordSnapshotHandles, Snapshot);
+}
+
+NTSTATUS H2TraceReplayFindKernelTypeIndex(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+)
+{
+    H2_TRACE_IDENTITY target = { 0 };
+    PH2_TRACE_RECORD record;
+
+    record = H2TraceFindRecord(
+        H2TraceRecordFindKernelTypeIndex,
+        &target,
+        0,
+        0,
+        TypeName->Buffer,
+        min(TypeName->Length, H2_TRACE_MAX_INPUT)
+    );
+
+    if (!record)
+        return STATUS_NO_MATCH;
+
+    if (NT_SUCCESS(record->Status) && record->OutputSize >= sizeof(ULONG))
+        *Index = *(PULONG)H2TraceRecordOutput(record);
+
+    return record->Status;
+}
+
+NTSTATUS H2TraceReplayOpenProcess(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+)
+{
+    H2_TRACE_IDENTITY target = { 0 };
+    PH2_TRACE_RECORD record;
+
+    target.ProcessId = (ULONG)(ULONG_PTR)ProcessId;
+    target.Kind = H2TraceHandleProcess;
+    record = H2TraceFindRecord(H2TraceRecordOpenProcess, &target, DesiredAccess, 0, NULL, 0);
+
+    if (!record)
+        return STATUS_NO_MATCH;
+
+    if (!NT_SUCCESS(record->Status))
+        return record->Status;
+
+    return H2TraceAllocateHandle(NULL, &target, ProcessHandle);
+}
+
+NTSTATUS H2TraceReplayDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+)
+{
+    NTSTATUS status;
+    H2_TRACE_IDENTITY target = { 0 };
+    H2_TRACE_IDENTITY process;
+    HANDLE unused;
+    PH2_TRACE_RECORD record;
+
+    status = H2TraceResolveHandle(ProcessHandle, &unused, &process);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    if (process.Kind != H2TraceHandleProcess)
+        return STATUS_OBJECT_TYPE_MISMATCH;
+
+    target.ProcessId = process.ProcessId;
+    target.HandleValue = (ULONG)(ULONG_PTR)SourceHandle;
+    target.Kind = H2TraceHandleFile;
+    record = H2TraceFindRecord(H2TraceRecordDuplicateHandle, &target, 0, 0, NULL, 0);
+
+    if (!record)
+        return STATUS_NO_MATCH;
+
+    if (!NT_SUCCESS(record->Status))
+        return record->Status;
+
+    return H2TraceAllocateHandle(NULL, &target, TargetHandle);
+}
+
+NTSTATUS H2TraceReplayQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+)
+{
+    NTSTATUS status;
+    H2_TRACE_IDENTITY target;
+    HANDLE unused;
+    PH2_TRACE_RECORD record;
+
+    status = H2TraceResolveHandle(FileHandle, &unused, &target);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    record = H2TraceFindRecord(H2TraceRecordQueryVolumeName, &target, 0, BufferSize, NULL, 0);
+
+    if (!record)
+        return STATUS_NO_MATCH;
+
+    RtlCopyMemory(Buffer, H2TraceRecordOutput(record), min(record->OutputSize, BufferSize));
+    return record->Status;
+}
+
+NTSTATUS H2TraceReplayDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+)
+{
+    NTSTATUS status;
+    H2_TRACE_IDENTITY target;
+    UCHAR input[H2_TRACE_MAX_INPUT];
+    ULONG inputSize;
+    HANDLE unused;
+    PH2_TRACE_RECORD record;
+
+    status = H2TraceResolveHandle(FileHandle, &unused, &target);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    inputSize = H2TraceCanonicalizeInput(IoControlCode, InBuffer, InBufferSize, input);
+    record = H2TraceFindRecord(H2TraceRecordDeviceIoControl, &target, IoControlCode, OutputBufferSize, input, inputSize);
+
+    if (!record)
+        return STATUS_NO_MATCH;
+
+    if (OutputBuffer)
+        RtlCopyMemory(OutputBuffer, H2TraceRecordOutput(record), min(record->OutputSize, OutputBufferSize));
+
+    if (NT_SUCCESS(record->Status) && IoControlCode == IOCTL_AFD_QUERY_HANDLES && OutputBufferSize >= sizeof(AFD_HANDLE_INFO))
+        H2TraceWrapTdiHandles(&target, FALSE, OutputBuffer);
+
+    if (BytesReturned)
+        *BytesReturned = record->BytesReturned;
+
+    return record->Status;
+}
+
+NTSTATUS H2TraceReplayClose(
+    _In_ HANDLE Handle
+)
+{
+    if (!H2_TRACE_IS_TAGGED_HANDLE(Handle))
+        return STATUS_INVALID_HANDLE;
+
+    H2TraceReleaseHandle(Handle);
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Issues independent IOCTLs on a replayed file one after another.
+  */
+NTSTATUS H2TraceReplayDeviceIoControlBatch(
+    _In_ HANDLE FileHandle,
+    _Inout_updates_(NumberOfRequests) PH2_IOCTL_REQUEST Requests,
+    _In_ ULONG NumberOfRequests
+)
+{
+    return H2SequentialDeviceIoControlBatch(H2TraceReplayDeviceIoControl, FileHandle, Requests, NumberOfRequests);
+}
+
+const H2_BACKEND H2TraceReplayBackend =
+{
+    L"Replay",
+    H2TraceReplaySnapshotProcesses,
+    H2TraceReplaySnapshotHandles,
+    H2TraceReplayFindKernelTypeIndex,
+    H2TraceReplayOpenProcess,
+    H2TraceReplayDuplicateHandle,
+    H2TraceReplayQueryVolumeName,
+    H2TraceReplayDeviceIoControl,
+    H2TraceReplayDeviceIoControlBatch,
+    H2TraceReplayClose
+};
+
+/**
+  * \brief Indexes records of a mapped trace file for lookup by request.
+  *
+  * \param[in] View The mapped file.
+  * \param[in] ViewSize The size of the file.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2TraceBuildIndex(
+    _In_ PUCHAR View,
+    _In_ SIZE_T ViewSize
+)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    PH2_TRACE_HEADER header = (PH2_TRACE_HEADER)View;
+    SIZE_T offset = ALIGN_UP_BY(sizeof(H2_TRACE_HEADER), H2_TRACE_ALIGNMENT);
+    ULONG numberOfRecords = 0;
+    ULONG numberOfBuckets = 1;
+    PULONG tails = NULL;
+
+    if (ViewSize < sizeof(H2_TRACE_HEADER) || header->Magic != H2_TRACE_MAGIC)
+        return STATUS_FILE_INVALID;
+
+    if (header->Version != H2_TRACE_VERSION)
+        return STATUS_REVISION_MISMATCH;
+
+    // Snapshots from a recorder of a different bitness have a different layout
+    if (header->PointerSize != sizeof(PVOID))
+        return STATUS_NOT_SUPPORTED;
+
+    // Validate and count the records
+    while (offset < ViewSize)
+    {
+        PH2_TRACE_RECORD record = (PH2_TRACE_RECORD)(View + offset);
+
+        if (ViewSize - offset < sizeof(H2_TRACE_RECORD) ||
+            record->Size < sizeof(H2_TRACE_RECORD) ||
+            record->Size > ViewSize - offset ||
+            (ULONG64)record->InputSize + record->OutputSize > record->Size - sizeof(H2_TRACE_RECORD) ||
+            numberOfRecords >= H2_TRACE_NO_RECORD / 2)
+            return STATUS_FILE_CORRUPT_ERROR;
+
+        offset += ALIGN_UP_BY(record->Size, H2_TRACE_ALIGNMENT);
+        numberOfRecords++;
+    }
+
+    // Keep the table at most half full
+    while (numberOfBuckets < numberOfRecords * 2)
+        numberOfBuckets *= 2;
+
+    H2TraceRecords = RtlAllocateHeap(RtlProcessHeap(), 0, max(numberOfRecords, 1) * sizeof(PH2_TRACE_RECORD));
+    H2TraceNextRecord = RtlAllocateHeap(RtlProcessHeap(), 0, max(numberOfRecords, 1) * sizeof(ULONG));
+    H2TraceBuckets = RtlAllocateHeap(RtlProcessHeap(), 0, numberOfBuckets * sizeof(H2_TRACE_BUCKET));
+    tails = RtlAllocateHeap(RtlProcessHeap(), 0, numberOfBuckets * sizeof(ULONG));
+
+    if (!H2TraceRecords || !H2TraceNextRecord || !H2TraceBuckets || !tails)
+    {
+        status = STATUS_NO_MEMORY;
+        goto CLEANUP;
+    }
+
+    H2TraceBucketMask = numberOfBuckets - 1;
+
+    for (ULONG i = 0; i < numberOfBuckets; i++)
+        H2TraceBuckets[i].First = H2_TRACE_NO_RECORD;
+
+    offset = ALIGN_UP_BY(sizeof(H2_TRACE_HEADER), H2_TRACE_ALIGNMENT);
+
+    // Chain records with identical keys in the order they were recorded
+    for (ULONG i = 0; i < numberOfRecords; i++)
+    {
+        PH2_TRACE_RECORD record = (PH2_TRACE_RECORD)(View + offset);
+        ULONG hash = H2TraceHashKey(record->Type, &record->Target, record->Code, record->RequestedOutputSize, record + 1, record->InputSize);
+        ULONG bucket = hash & H2TraceBucketMask;
+
+        H2TraceRecords[i] = record;
+        H2TraceNextRecord[i] = H2_TRACE_NO_RECORD;
+        offset += ALIGN_UP_BY(record->Size, H2_TRACE_ALIGNMENT);
+
+        while (H2TraceBuckets[bucket].First != H2_TRACE_NO_RECORD)
+        {
+            if (H2TraceBuckets[bucket].Hash == hash &&
+                H2TraceMatchRecord(H2TraceRecords[H2TraceBuckets[bucket].First], record->Type, &record->Target, record->Code,
+                    record->RequestedOutputSize, record + 1, record->InputSize))
+                break;
+
+            bucket = (bucket + 1) & H2TraceBucketMask;
+        }
+
+        if (H2TraceBuckets[bucket].First == H2_TRACE_NO_RECORD)
+        {
+            H2TraceBuckets[bucket].Hash = hash;
+            H2TraceBuckets[bucket].First = i;
+            H2TraceBuckets[bucket].Current = i;
+        }
+        else
+        {
+            H2TraceNextRecord[tails[bucket]] = i;
+        }
+
+        tails[bucket] = i;
+    }
+
+CLEANUP:
+    if (tails)
+        RtlFreeHeap(RtlProcessHeap(), 0, tails);
+
+    return status;
+}
+
+/**
+  * \brief Releases the replay index.
+  */
+VOID H2TraceFreeIndex(
+    VOID
+)
+{
+    if (H2TraceRecords)
+        RtlFreeHeap(RtlProcessHeap(), 0, H2TraceRecords);
+
+    if (H2TraceNextRecord)
+        RtlFreeHeap(RtlProcessHeap(), 0, H2TraceNextRecord);
+
+    if (H2TraceBuckets)
+        RtlFreeHeap(RtlProcessHeap(), 0, H2TraceBuckets);
+
+    H2TraceRecords = NULL;
+    H2TraceNextRecord = NULL;
+    H2TraceBuckets = NULL;
+}
+
+/**
+  * \brief Starts recording all requests into a trace file.
+  *
+  * \param[in] FileName The name of the file to create or overwrite.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2TraceStartRecording(
+    _In_ PCWSTR FileName
+)
+{
+    NTSTATUS status;
+    PH2_TRACE_HEADER header;
+
+    if (H2TraceFileHandle || H2TraceView)
+        return STATUS_INVALID_PARAMETER_MIX;
+
+    H2TraceBuffer = RtlAllocateHeap(RtlProcessHeap(), 0, H2_TRACE_BUFFER_SIZE);
+
+    if (!H2TraceBuffer)
+        return STATUS_NO_MEMORY;
+
+    status = H2OpenFile(&H2TraceFileHandle, FileName, FILE_WRITE_DATA, FILE_SHARE_READ, FILE_OVERWRITE_IF);
+
+    if (!NT_SUCCESS(status))
+    {
+        RtlFreeHeap(RtlProcessHeap(), 0, H2TraceBuffer);
+        H2TraceBuffer = NULL;
+        H2TraceFileHandle = NULL;
+        return status;
+    }
+
+    header = (PH2_TRACE_HEADER)H2TraceBuffer;
+    header->Magic = H2_TRACE_MAGIC;
+    header->Version = H2_TRACE_VERSION;
+    header->PointerSize = sizeof(PVOID);
+    H2TraceBufferUsed = (ULONG)ALIGN_UP_BY(sizeof(H2_TRACE_HEADER), H2_TRACE_ALIGNMENT);
+    H2TraceWriteStatus = STATUS_SUCCESS;
+
+    RtlQueryPerformanceFrequency(&H2TraceFrequency);
+    H2TraceInnerBackend = H2Backend;
+    H2Backend = &H2TraceRecordingBackend;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Starts answering all requests from a trace file.
+  *
+  * \param[in] FileName The name of the trace file.
+  * \param[in] ReproduceLatency Whether each response should take as long as the original request.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2TraceStartReplay(
+    _In_ PCWSTR FileName,
+    _In_ BOOLEAN ReproduceLatency
+)
+{
+    NTSTATUS status;
+    PVOID view;
+    SIZE_T viewSize;
+
+    if (H2TraceFileHandle || H2TraceView)
+        return STATUS_INVALID_PARAMETER_MIX;
+
+    // Map the trace instead of reading it; records are used in place
+    status = H2MapFile(FileName, &view, &viewSize);
+
+    if (!NT_SUCCESS(status))
+        return status;
+
+    status = H2TraceBuildIndex(view, viewSize);
+
+    if (!NT_SUCCESS(status))
+    {
+        H2TraceFreeIndex();
+        H2UnmapFile(view);
+        return status;
+    }
+
+    RtlQueryPerformanceFrequency(&H2TraceFrequency);
+    H2TraceView = view;
+    H2TraceReproduceLatency = ReproduceLatency;
+    H2TraceInnerBackend = H2Backend;
+    H2Backend = &H2TraceReplayBackend;
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Stops recording or replaying and restores the previous backend.
+  *
+  * \return Successful or errant status of saving the trace.
+  */
+NTSTATUS H2TraceStop(
+    VOID
+)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+
+    if (H2TraceFileHandle)
+    {
+        // Flush the remaining records
+        H2TraceWriteFile(H2TraceBuffer, H2TraceBufferUsed);
+        status = H2TraceWriteStatus;
+
+        NtClose(H2TraceFileHandle);
+        RtlFreeHeap(RtlProcessHeap(), 0, H2TraceBuffer);
+        H2TraceFileHandle = NULL;
+        H2TraceBuffer = NULL;
+        H2TraceBufferUsed = 0;
+        H2Backend = H2TraceInnerBackend;
+    }
+
+    if (H2TraceView)
+    {
+        H2TraceFreeIndex();
+        H2UnmapFile(H2TraceView);
+        H2TraceView = NULL;
+        H2Backend = H2TraceInnerBackend;
+    }
+
+    if (H2TraceSlots)
+    {
+        RtlFreeHeap(RtlProcessHeap(), 0, H2TraceSlots);
+        H2TraceSlots = NULL;
+        H2TraceSlotCount = 0;
+        H2TraceSlotCapacity = 0;
+        H2TraceFirstFreeSlot = H2_TRACE_NO_RECORD;
+    }
+
+    return status;
+}
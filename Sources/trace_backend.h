@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _TRACE_BACKEND_H
+#define _TRACE_BACKEND_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+#include "backend.h"
+
+//
+// A trace file starts with H2_TRACE_HEADER, followed by a sequence of H2_TRACE_RECORD
+// structures. Each record is immediately followed by its input and output bytes and
+// padded to H2_TRACE_ALIGNMENT, so the file can be walked in place after mapping it.
+//
+
+#define H2_TRACE_MAGIC 0x52543248 // "H2TR"
+#define H2_TRACE_VERSION 1
+#define H2_TRACE_ALIGNMENT 8
+
+typedef struct _H2_TRACE_HEADER
+{
+    ULONG Magic;
+    USHORT Version;
+    USHORT PointerSize; // Snapshot layouts depend on the bitness of the recorder
+} H2_TRACE_HEADER, *PH2_TRACE_HEADER;
+
+typedef enum _H2_TRACE_RECORD_TYPE
+{
+    H2TraceRecordSnapshotProcesses = 1,
+    H2TraceRecordSnapshotHandles,
+    H2TraceRecordFindKernelTypeIndex,
+    H2TraceRecordOpenProcess,
+    H2TraceRecordDuplicateHandle,
+    H2TraceRecordQueryVolumeName,
+    H2TraceRecordDeviceIoControl,
+} H2_TRACE_RECORD_TYPE;
+
+typedef enum _H2_TRACE_HANDLE_KIND
+{
+    H2TraceHandleNone = 0,
+    H2TraceHandleProcess,
+    H2TraceHandleFile,
+    H2TraceHandleTdiAddress,
+    H2TraceHandleTdiConnection,
+} H2_TRACE_HANDLE_KIND;
+
+// Identifies a handle independently of its value in the recording process
+typedef struct _H2_TRACE_IDENTITY
+{
+    ULONG ProcessId;
+    ULONG HandleValue; // In the target process; for TDI handles, the value of the socket
+    ULONG Kind; // H2_TRACE_HANDLE_KIND
+} H2_TRACE_IDENTITY, *PH2_TRACE_IDENTITY;
+
+typedef struct _H2_TRACE_RECORD
+{
+    ULONG Size; // Including the header, payload, and padding
+    USHORT Type; // H2_TRACE_RECORD_TYPE
+    USHORT Reserved;
+    H2_TRACE_IDENTITY Target;
+    ULONG Code; // The IOCTL code or the requested access
+    ULONG RequestedOutputSize;
+    NTSTATUS Status;
+    ULONG BytesReturned;
+    ULONG InputSize;
+    ULONG OutputSize;
+    ULONG Spare;
+    ULONG64 BaseAddress; // The original address of the output, for relocating snapshots
+    ULONG64 Duration; // In 100ns units
+    // UCHAR Input[InputSize];
+    // UCHAR Output[OutputSize];
+} H2_TRACE_RECORD, *PH2_TRACE_RECORD;
+
+// The maximum number of bytes of input stored per request
+#define H2_TRACE_MAX_INPUT 0x100
+
+// The transport IOCTL input with the nested buffer stored inline instead of by pointer
+typedef struct _H2_TRACE_TL_INPUT
+{
+    ULONG Type;
+    ULONG Level;
+    ULONG IoControlCode;
+    ULONG InputBufferLength;
+    // UCHAR InputBuffer[InputBufferLength];
+} H2_TRACE_TL_INPUT, *PH2_TRACE_TL_INPUT;
+
+// A backend that forwards requests to the previous backend and saves them into a trace
+extern const H2_BACKEND H2TraceRecordingBackend;
+
+NTSTATUS
+NTAPI
+H2TraceRecSnapshotProcesses(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+);
+
+NTSTATUS
+NTAPI
+H2TraceRecSnapshotHandles(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+);
+
+NTSTATUS
+NTAPI
+H2TraceRecFindKernelTypeIndex(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+);
+
+NTSTATUS
+NTAPI
+H2TraceRecOpenProcess(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+);
+
+NTSTATUS
+NTAPI
+H2TraceRecDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+);
+
+NTSTATUS
+NTAPI
+H2TraceRecQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+);
+
+NTSTATUS
+NTAPI
+H2TraceRecDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+);
+
+NTSTATUS
+NTAPI
+H2TraceRecClose(
+    _In_ HANDLE Handle
+);
+
+// A backend that answers requests from a trace file
+extern const H2_BACKEND H2TraceReplayBackend;
+
+NTSTATUS
+NTAPI
+H2TraceReplaySnapshotProcesses(
+    _Outptr_ PSYSTEM_PROCESS_INFORMATION* Snapshot
+);
+
+NTSTATUS
+NTAPI
+H2TraceReplaySnapshotHandles(
+    _Outptr_ PSYSTEM_HANDLE_INFORMATION_EX* Snapshot
+);
+
+NTSTATUS
+NTAPI
+H2TraceReplayFindKernelTypeIndex(
+    _In_ PUNICODE_STRING TypeName,
+    _Out_ PULONG Index
+);
+
+NTSTATUS
+NTAPI
+H2TraceReplayOpenProcess(
+    _Out_ PHANDLE ProcessHandle,
+    _In_ HANDLE ProcessId,
+    _In_ ACCESS_MASK DesiredAccess
+);
+
+NTSTATUS
+NTAPI
+H2TraceReplayDuplicateHandle(
+    _In_ HANDLE ProcessHandle,
+    _In_ HANDLE SourceHandle,
+    _Out_ PHANDLE TargetHandle
+);
+
+NTSTATUS
+NTAPI
+H2TraceReplayQueryVolumeName(
+    _In_ HANDLE FileHandle,
+    _Out_writes_bytes_(BufferSize) PFILE_VOLUME_NAME_INFORMATION Buffer,
+    _In_ ULONG BufferSize
+);
+
+NTSTATUS
+NTAPI
+H2TraceReplayDeviceIoControl(
+    _In_ HANDLE FileHandle,
+    _In_ ULONG IoControlCode,
+    _In_reads_bytes_(InBufferSize) PVOID InBuffer,
+    _In_ ULONG InBufferSize,
+    _Out_writes_bytes_to_opt_(OutputBufferSize, *BytesReturned) PVOID OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ PULONG BytesReturned
+);
+
+NTSTATUS
+NTAPI
+H2TraceReplayClose(
+    _In_ HANDLE Handle
+);
+
+NTSTATUS
+NTAPI
+H2TraceStartRecording(
+    _In_ PCWSTR FileName
+);
+
+NTSTATUS
+NTAPI
+H2TraceStartReplay(
+    _In_ PCWSTR FileName,
+    _In_ BOOLEAN ReproduceLatency
+);
+
+NTSTATUS
+NTAPI
+H2TraceStop(
+    VOID
+);
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#include "worker_pool.h"
+#include "backend.h"
+#include "string_helpers.h"
+
+#define H2_WORK_RANGE(Next, End) ((LONG64)(((ULONG64)(End) << 32) | (ULONG)(Next)))
+#define H2_WORK_RANGE_NEXT(Range) ((ULONG)(Range))
+#define H2_WORK_RANGE_END(Range) ((ULONG)((ULONG64)(Range) >> 32))
+
+/**
+  * \brief Runs a work item and signals its completion.
+  *
+  * \param[in] Pool The work pool.
+  * \param[in] ItemIndex The index of the item.
+  */
+VOID H2RunWorkItem(
+    _In_ PH2_WORK_POOL Pool,
+    _In_ ULONG ItemIndex
+)
+{
+    Pool->Routine(Pool->Context, ItemIndex);
+    InterlockedExchange(&Pool->Completed[ItemIndex], TRUE);
+
+    if (Pool->CompletionEvent)
+        NtSetEvent(Pool->CompletionEvent, NULL);
+}
+
+/**
+  * \brief Takes the next item from the range of a worker.
+  *
+  * \param[in] Worker The worker that owns the range.
+  * \param[out] ItemIndex The index of the item.
+  *
+  * \return Whether the range had any items left.
+  */
+BOOLEAN H2PopWorkItem(
+    _In_ PH2_WORKER Worker,
+    _Out_ PULONG ItemIndex
+)
+{
+    LONG64 range;
+    ULONG next;
+    ULONG end;
+
+    do
+    {
+        range = ReadNoFence64(&Worker->Range);
+        next = H2_WORK_RANGE_NEXT(range);
+        end = H2_WORK_RANGE_END(range);
+
+        if (next >= end)
+            return FALSE;
+
+    } while (InterlockedCompareExchange64(&Worker->Range, H2_WORK_RANGE(next + 1, end), range) != range);
+
+    *ItemIndex = next;
+    return TRUE;
+}
+
+/**
+  * \brief Moves the second half of the remaining items of another worker to an idle worker.
+  *
+  * \param[in] Worker The idle worker with an empty range.
+  *
+  * \return Whether any items were stolen.
+  */
+BOOLEAN H2StealWorkItems(
+    _In_ PH2_WORKER Worker
+)
+{
+    PH2_WORK_POOL pool = Worker->Pool;
+
+    for (ULONG i = 1; i < pool->NumberOfWorkers; i++)
+    {
+        PH2_WORKER victim = &pool->Workers[(Worker->Index + i) % pool->NumberOfWorkers];
+        LONG64 range;
+        ULONG next;
+        ULONG end;
+        ULONG split;
+
+        do
+        {
+            range = ReadNoFence64(&victim->Range);
+            next = H2_WORK_RANGE_NEXT(range);
+            end = H2_WORK_RANGE_END(range);
+
+            if (next >= end)
+                break;
+
+            // Leave the victim the items it's about to reach first
+            split = next + (end - next) / 2;
+
+            if (InterlockedCompareExchange64(&victim->Range, H2_WORK_RANGE(next, split), range) == range)
+            {
+                // Nobody steals from an empty range, so we can publish ours unconditionally
+                InterlockedExchange64(&Worker->Range, H2_WORK_RANGE(split, end));
+                return TRUE;
+            }
+
+        } while (TRUE);
+    }
+
+    return FALSE;
+}
+
+/**
+  * \brief The entry point of a worker thread.
+  */
+NTSTATUS NTAPI H2WorkerThread(
+    _In_ PVOID Parameter
+)
+{
+    PH2_WORKER worker = Parameter;
+    ULONG itemIndex;
+
+    do
+    {
+        while (H2PopWorkItem(worker, &itemIndex))
+            H2RunWorkItem(worker->Pool, itemIndex);
+
+    } while (H2StealWorkItems(worker));
+
+    H2FlushOutput();
+    H2NativeReleaseThreadEvents();
+    return STATUS_SUCCESS;
+}
+
+/**
+  * \brief Starts processing work items on a pool of threads.
+  *
+  * \param[out] Pool The work pool to initialize. The caller must stop it via H2StopWorkPool.
+  * \param[in] NumberOfWorkers The number of threads to start or zero to run items on demand from H2WaitForWorkItem.
+  * \param[in] NumberOfItems The number of work items.
+  * \param[in] Routine The function that processes an item.
+  * \param[in] Context A parameter to pass to the routine.
+  *
+  * \return Successful or errant status.
+  */
+NTSTATUS H2StartWorkPool(
+    _Out_ PH2_WORK_POOL Pool,
+    _In_ ULONG NumberOfWorkers,
+    _In_ ULONG NumberOfItems,
+    _In_ PH2_WORK_ROUTINE Routine,
+    _In_opt_ PVOID Context
+)
+{
+    NTSTATUS status;
+
+    memset(Pool, 0, sizeof(H2_WORK_POOL));
+    Pool->Routine = Routine;
+    Pool->Context = Context;
+    Pool->NumberOfItems = NumberOfItems;
+
+    // Don't start more threads than there is work for
+    if (NumberOfWorkers > NumberOfItems)
+        NumberOfWorkers = NumberOfItems;
+
+    Pool->Completed = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, max(NumberOfItems, 1) * sizeof(LONG));
+
+    if (!Pool->Completed)
+        return STATUS_NO_MEMORY;
+
+    if (NumberOfWorkers == 0)
+        return STATUS_SUCCESS;
+
+    status = NtCreateEvent(&Pool->CompletionEvent, EVENT_ALL_ACCESS, NULL, SynchronizationEvent, FALSE);
+
+    if (!NT_SUCCESS(status))
+        goto FAILURE;
+
+    Pool->Workers = RtlAllocateHeap(RtlProcessHeap(), HEAP_ZERO_MEMORY, NumberOfWorkers * sizeof(H2_WORKER));
+
+    if (!Pool->Workers)
+    {
+        status = STATUS_NO_MEMORY;
+        goto FAILURE;
+    }
+
+    // Give each worker an equal contiguous share of items
+    for (ULONG i = 0; i < NumberOfWorkers; i++)
+    {
+        Pool->Workers[i].Pool = Pool;
+        Pool->Workers[i].Index = i;
+        Pool->Workers[i].Range = H2_WORK_RANGE(
+            (ULONG)((ULONG64)NumberOfItems * i / NumberOfWorkers),
+            (ULONG)((ULONG64)NumberOfItems * (i + 1) / NumberOfWorkers)
+        );
+    }
+
+    Pool->NumberOfWorkers = NumberOfWorkers;
+
+    for (ULONG i = 0; i < NumberOfWorkers; i++)
+    {
+        status = RtlCreateUserThread(
+            NtCurrentProcess(),
+            NULL,
+            FALSE,
+            0,
+            0,
+            0,
+            H2WorkerThread,
+            &Pool->Workers[i],
+            &Pool->Workers[i].ThreadHandle,
+            NULL
+        );
+
+        // The started workers will steal the items of the ones that failed to start
+        if (!NT_SUCCESS(status) && i == 0)
+            goto FAILURE;
+    }
+
+    return STATUS_SUCCESS;
+
+FAILURE:
+    H2StopWorkPool(Pool);
+    return status;
+}
+
+/**
+  * \brief Waits until a work item completes, running it on the current thread if the pool has no workers.
+  *
+  * \param[in] Pool The work pool.
+  * \param[in] ItemIndex The index of the item.
+  */
+VOID H2WaitForWorkItem(
+    _In_ PH2_WORK_POOL Pool,
+    _In_ ULONG ItemIndex
+)
+{
+    if (Pool->NumberOfWorkers == 0)
+    {
+        if (!Pool->Completed[ItemIndex])
+            H2RunWorkItem(Pool, ItemIndex);
+
+        return;
+    }
+
+    // The event is set after each completion, so re-check the flag on every wake
+    while (!ReadAcquire(&Pool->Completed[ItemIndex]))
+        NtWaitForSingleObject(Pool->CompletionEvent, FALSE, NULL);
+}
+
+/**
+  * \brief Waits for all workers to exit and releases the pool.
+  *
+  * \param[in,out] Pool The work pool.
+  */
+VOID H2StopWorkPool(
+    _Inout_ PH2_WORK_POOL Pool
+)
+{
+    if (Pool->Workers)
+    {
+        for (ULONG i = 0; i < Pool->NumberOfWorkers; i++)
+        {
+            if (Pool->Workers[i].ThreadHandle)
+            {
+                NtWaitForSingleObject(Pool->Workers[i].ThreadHandle, FALSE, NULL);
+                NtClose(Pool->Workers[i].ThreadHandle);
+            }
+        }
+
+        RtlFreeHeap(RtlProcessHeap(), 0, Pool->Workers);
+    }
+
+    if (Pool->CompletionEvent)
+        NtClose(Pool->CompletionEvent);
+
+    if (Pool->Completed)
+        RtlFreeHeap(RtlProcessHeap(), 0, (PVOID)Pool->Completed);
+
+    memset(Pool, 0, sizeof(H2_WORK_POOL));
+}
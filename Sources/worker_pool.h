@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2025 Hunt & Hackett.
+ *
+ * This project is licensed under the MIT license.
+ *
+ * Authors:
+ *     diversenok
+ *
+ */
+
+#ifndef _WORKER_POOL_H
+#define _WORKER_POOL_H
+
+#include <phnt_windows.h>
+#include <phnt.h>
+
+// Processes one work item
+typedef VOID (NTAPI *PH2_WORK_ROUTINE)(
+    _In_ PVOID Context,
+    _In_ ULONG ItemIndex
+    );
+
+// A range of work items owned by a worker; others steal from its end when idle
+typedef struct DECLSPEC_CACHEALIGN _H2_WORKER
+{
+    struct _H2_WORK_POOL* Pool;
+    ULONG Index;
+    HANDLE ThreadHandle;
+    volatile LONG64 Range; // The next item in the low part and the end in the high part
+} H2_WORKER, *PH2_WORKER;
+
+typedef struct _H2_WORK_POOL
+{
+    PH2_WORK_ROUTINE Routine;
+    PVOID Context;
+    ULONG NumberOfItems;
+    ULONG NumberOfWorkers; // Zero when items run on the waiting thread
+    PH2_WORKER Workers;
+    volatile LONG* Completed;
+    HANDLE CompletionEvent;
+} H2_WORK_POOL, *PH2_WORK_POOL;
+
+NTSTATUS
+NTAPI
+H2StartWorkPool(
+    _Out_ PH2_WORK_POOL Pool,
+    _In_ ULONG NumberOfWorkers,
+    _In_ ULONG NumberOfItems,
+    _In_ PH2_WORK_ROUTINE Routine,
+    _In_opt_ PVOID Context
+);
+
+VOID
+NTAPI
+H2WaitForWorkItem(
+    _In_ PH2_WORK_POOL Pool,
+    _In_ ULONG ItemIndex
+);
+
+VOID
+NTAPI
+H2StopWorkPool(
+    _Inout_ PH2_WORK_POOL Pool
+);
+
+#endif